@@ -0,0 +1,679 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+
+#include "../src/include/types.hpp"
+#include "../src/include/lib/algorithms.hpp"
+#include "../src/include/lib/batch.hpp"
+#include "../src/include/utils/cpuFeatures.hpp"
+#include "../src/include/utils/inputReader.hpp"
+#include "../src/include/utils/readPipeline.hpp"
+
+#if ZIPPY_X86
+#include <x86intrin.h>
+#endif
+
+using namespace std;
+
+namespace fs = std::filesystem;
+
+// Every allocation of the program is counted, so the benchmark shows how many of them the hashing makes per message
+namespace {
+    atomic<uint64> allocationsCount(0);
+
+    void *allocate(size_t size, size_t alignment) {
+        allocationsCount.fetch_add(1, memory_order_relaxed);
+        void *pointer;
+        if (alignment <= alignof(max_align_t)) {
+            pointer = malloc(size == 0 ? 1 : size);
+        } else {
+            // The size of the aligned allocation must be a multiple of the alignment
+            pointer = aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        }
+        if (pointer == nullptr) {
+            throw bad_alloc();
+        }
+        return pointer;
+    }
+}
+
+void *operator new(size_t size) {
+    return allocate(size, 0);
+}
+
+void *operator new(size_t size, align_val_t alignment) {
+    return allocate(size, size_t(alignment));
+}
+
+void operator delete(void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, align_val_t) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t, align_val_t) noexcept {
+    free(pointer);
+}
+
+namespace {
+
+    const uint64 KiB = 1024;
+    const uint64 MiB = 1024 * KiB;
+    const uint64 GiB = 1024 * MiB;
+
+    const vector<uint64> DEFAULT_SIZES = { 64, KiB, 16 * KiB, 256 * KiB, 4 * MiB, 64 * MiB, GiB };
+
+    // The latency of each message is recorded, the measurement stops after this many messages
+    const size_t MAX_SAMPLES_COUNT = 1 << 20;
+
+    // The larger messages aren't hashed before the measurement: the first of them warms up the caches anyway
+    const uint64 WARMUP_MAX_SIZE = 64 * MiB;
+
+    // The batch mode hashes this many files of the same size at once (the multi-buffer cores hash them in the lanes)
+    const size_t BATCH_FILES_COUNT = 64;
+
+    typedef chrono::steady_clock Clock;
+
+    enum class Mode {
+        // The streaming hasher over the buffer in memory
+        Memory,
+        // The single file through `hashFile` (the file is in the page cache)
+        File,
+        // The group of files through `hashFiles`
+        Batch,
+        // The single file is only read, without the hashing (the I/O time the file mode may hide behind the hashing)
+        Read,
+    };
+
+    string modeName(Mode mode) {
+        switch (mode) {
+            case Mode::Memory: return "memory";
+            case Mode::File: return "file";
+            case Mode::Batch: return "batch";
+            case Mode::Read: return "read";
+        }
+        return "unknown";
+    }
+
+    struct BenchOptions {
+        vector<const HashAlgorithm *> algorithms;
+        vector<Implementation> implementations;
+        vector<Mode> modes = { Mode::Memory, Mode::File, Mode::Batch };
+        vector<uint64> sizes = DEFAULT_SIZES;
+        // How the files are read by the file, batch and read modes
+        InputOptions inputOptions;
+        double minTime = 0.25;
+        string directory = fs::temp_directory_path().string();
+        string jsonPath;
+        // PBKDF2 is measured instead of the hashing if it isn't 0
+        uint32 kdfIterations = 0;
+    };
+
+    struct Result {
+        string algorithm;
+        string implementation;
+        Mode mode;
+        uint64 messageSize;
+        uint64 messagesCount;
+        double seconds;
+        // The reference cycles of the TSC (0 if there is no such counter), they don't follow the frequency scaling
+        uint64 cycles;
+        uint64 allocationsCount;
+        // In nanoseconds: 50th, 90th, 99th percentiles and the maximum
+        double latencies[4];
+    };
+
+    // PBKDF2 of one algorithm and implementation: `passwordsCount` keys of `outputSize` bytes each per call
+    struct KdfResult {
+        string algorithm;
+        string implementation;
+        string kind;
+        size_t passwordsCount;
+        size_t outputSize;
+        uint32 iterations;
+        uint64 callsCount;
+        double seconds;
+        // Each output block of each password costs `iterations` iterations
+        double iterationsPerSecond;
+    };
+
+    inline uint64 readCycles() {
+#if ZIPPY_X86
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    double toNanoseconds(Clock::duration duration) {
+        return chrono::duration<double, nano>(duration).count();
+    }
+
+    // Calls `hashMessages` (which hashes `messagesPerCall` messages) until `minTime` elapses
+    template <typename HashMessages>
+    void measure(Result &result, size_t messagesPerCall, double minTime, HashMessages hashMessages) {
+        vector<double> latencies;
+        latencies.reserve(MAX_SAMPLES_COUNT);
+
+        if (result.messageSize < WARMUP_MAX_SIZE) {
+            hashMessages();
+        }
+
+        uint64 startAllocationsCount = allocationsCount.load();
+        uint64 startCycles = readCycles();
+        Clock::time_point start = Clock::now();
+        Clock::time_point end = start;
+        while (latencies.size() < MAX_SAMPLES_COUNT && toNanoseconds(end - start) < minTime * 1e9) {
+            Clock::time_point callStart = Clock::now();
+            hashMessages();
+            end = Clock::now();
+            latencies.push_back(toNanoseconds(end - callStart) / messagesPerCall);
+        }
+        result.cycles = readCycles() - startCycles;
+        result.allocationsCount = allocationsCount.load() - startAllocationsCount;
+        result.seconds = toNanoseconds(end - start) / 1e9;
+        result.messagesCount = latencies.size() * messagesPerCall;
+
+        sort(latencies.begin(), latencies.end());
+        const double percentiles[] = { 0.5, 0.9, 0.99 };
+        for (uchar i = 0; i < 3; i++) {
+            result.latencies[i] = latencies[size_t(percentiles[i] * (latencies.size() - 1))];
+        }
+        result.latencies[3] = latencies.back();
+    }
+
+    string formatSize(uint64 size) {
+        const char *units[] = { "B", "KiB", "MiB", "GiB" };
+        uchar unit = 0;
+        while (unit < 3 && size >= 1024 && size % 1024 == 0) {
+            size /= 1024;
+            unit++;
+        }
+        return to_string(size) + " " + units[unit];
+    }
+
+    // Accepts the sizes like "64", "4K", "16M" or "1G"
+    uint64 parseSize(const string &text) {
+        size_t end;
+        uint64 size = stoull(text, &end);
+        string suffix = text.substr(end);
+        if (suffix == "K" || suffix == "k") {
+            return size * KiB;
+        } else if (suffix == "M" || suffix == "m") {
+            return size * MiB;
+        } else if (suffix == "G" || suffix == "g") {
+            return size * GiB;
+        } else if (!suffix.empty()) {
+            throw invalid_argument("Invalid size: " + text);
+        }
+        return size;
+    }
+
+    vector<string> splitList(const string &text) {
+        vector<string> items;
+        stringstream stream(text);
+        string item;
+        while (getline(stream, item, ',')) {
+            items.push_back(item);
+        }
+        return items;
+    }
+
+    bool isImplementationSupported(Implementation implementation) {
+        const CpuFeatures &features = getCpuFeatures();
+        switch (implementation) {
+            case Implementation::Ssse3: return features.ssse3;
+            case Implementation::Avx2: return features.avx2;
+            case Implementation::Avx512: return features.avx512f && features.avx512bw;
+            case Implementation::ShaNi: return features.sha && features.sse41;
+            case Implementation::Sse42: return features.sse42;
+            case Implementation::Pclmul: return features.pclmul && features.sse41;
+            default: return true;
+        }
+    }
+
+    // The content of the messages doesn't affect the speed, but it's not all zeroes anyway
+    void fillRandom(uchar *data, uint64 size) {
+        uint64 state = 0x9E3779B97F4A7C15ULL;
+        for (uint64 i = 0; i < size; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            data[i] = uchar(state);
+        }
+    }
+
+    void writeFile(const string &filePath, const uchar *data, uint64 size) {
+        ofstream file(filePath, ios::out | ios::binary | ios::trunc);
+        file.write((const char *)data, size);
+        file.close();
+        if (!file) {
+            throw invalid_argument("Can't write the file: " + filePath);
+        }
+    }
+
+    // The name of the way the reader actually reads the file (the pipeline may fall back to the thread)
+    string readMethodName(const InputReader &reader) {
+        if (reader.isMapped()) {
+            return "mmap";
+        }
+        if (reader.getPipeline() == nullptr) {
+            return "stream";
+        }
+        return reader.getPipeline()->getBackend() == ReadBackend::IoUring ? "uring" : "thread";
+    }
+
+    // Reads the whole file touching each page of it, so the mapped file is faulted in as well
+    void readFile(const string &filePath, const InputOptions &options) {
+        InputReader reader(filePath, options);
+        const uchar *data;
+        size_t size;
+        uchar sum = 0;
+        while (reader.next(data, size)) {
+            for (size_t offset = 0; offset < size; offset += 4096) {
+                sum += data[offset];
+            }
+        }
+        volatile uchar sink = sum;
+        (void)sink;
+    }
+
+    double averageNanoseconds(const Result &result) {
+        return result.seconds * 1e9 / result.messagesCount;
+    }
+
+    // Shows how much of the reading is hidden behind the hashing: the file mode ideally takes max(read, hash), not their sum
+    void printOverlap(const Result &read, const Result &memory, const Result &file) {
+        double readTime = averageNanoseconds(read) / 1e6;
+        double hashTime = averageNanoseconds(memory) / 1e6;
+        double fileTime = averageNanoseconds(file) / 1e6;
+        double sum = readTime + hashTime;
+        double maximum = max(readTime, hashTime);
+        cout << fixed << setprecision(2) << "            overlap: file " << fileTime << " ms, read " << readTime << " + hash "
+            << hashTime << " = " << sum << " ms, max " << maximum << " ms";
+        if (sum > maximum) {
+            cout << setprecision(0) << " (" << max(0.0, min(1.0, (sum - fileTime) / (sum - maximum))) * 100 << "% hidden)";
+        }
+        cout << endl;
+    }
+
+    void printResult(const Result &result) {
+        double bytesCount = double(result.messageSize) * result.messagesCount;
+        cout << left << setw(12) << result.algorithm << setw(8) << result.implementation << setw(8) << modeName(result.mode)
+            << right << setw(8) << formatSize(result.messageSize) << fixed << setprecision(2)
+            << setw(9) << bytesCount / result.seconds / 1e9 << " GB/s";
+        if (result.cycles != 0) {
+            cout << setw(7) << bytesCount / result.cycles << " B/cycle";
+        }
+        cout << "  p50 " << setprecision(0) << result.latencies[0] << " ns, p99 " << result.latencies[2] << " ns"
+            << setprecision(2) << ", " << double(result.allocationsCount) / result.messagesCount << " allocs/msg" << endl;
+    }
+
+    void printKdfResult(const KdfResult &result) {
+        cout << left << setw(12) << result.algorithm << setw(8) << result.implementation << setw(8) << result.kind
+            << right << setw(4) << result.passwordsCount << " x " << setw(4) << result.outputSize << " B" << fixed << setprecision(2)
+            << setw(9) << result.iterationsPerSecond / 1e6 << " M it/s  " << setprecision(3)
+            << result.seconds * 1e3 / result.callsCount << " ms/call" << endl;
+    }
+
+    void writeJson(const BenchOptions &options, const vector<Result> &results, const vector<KdfResult> &kdfResults, ostream &output) {
+        const CpuFeatures &features = getCpuFeatures();
+        output << boolalpha << "{\"version\":1,\"cpuFeatures\":{"
+            << "\"ssse3\":" << features.ssse3 << ",\"sse41\":" << features.sse41 << ",\"avx2\":" << features.avx2
+            << ",\"bmi2\":" << features.bmi2 << ",\"avx512f\":" << features.avx512f << ",\"avx512bw\":" << features.avx512bw
+            << ",\"sha\":" << features.sha << ",\"sse42\":" << features.sse42 << ",\"pclmul\":" << features.pclmul
+            << ",\"vpclmulqdq\":" << features.vpclmulqdq << "},\"minTime\":" << options.minTime << ",\"results\":[";
+        output << setprecision(6);
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result &result = results[i];
+            double bytesCount = double(result.messageSize) * result.messagesCount;
+            output << (i == 0 ? "\n" : ",\n") << "{\"algorithm\":\"" << result.algorithm << "\""
+                << ",\"implementation\":\"" << result.implementation << "\""
+                << ",\"mode\":\"" << modeName(result.mode) << "\""
+                << ",\"messageSize\":" << result.messageSize
+                << ",\"messagesCount\":" << result.messagesCount
+                << ",\"seconds\":" << result.seconds
+                << ",\"gigabytesPerSecond\":" << bytesCount / result.seconds / 1e9
+                << ",\"cycles\":" << result.cycles
+                << ",\"bytesPerCycle\":" << (result.cycles != 0 ? bytesCount / result.cycles : 0)
+                << ",\"latencyNs\":{\"p50\":" << result.latencies[0] << ",\"p90\":" << result.latencies[1]
+                << ",\"p99\":" << result.latencies[2] << ",\"max\":" << result.latencies[3] << "}"
+                << ",\"allocationsPerMessage\":" << double(result.allocationsCount) / result.messagesCount << "}";
+        }
+        output << "\n],\"kdfResults\":[";
+        for (size_t i = 0; i < kdfResults.size(); i++) {
+            const KdfResult &result = kdfResults[i];
+            output << (i == 0 ? "\n" : ",\n") << "{\"algorithm\":\"" << result.algorithm << "\""
+                << ",\"implementation\":\"" << result.implementation << "\""
+                << ",\"kind\":\"" << result.kind << "\""
+                << ",\"passwordsCount\":" << result.passwordsCount
+                << ",\"outputSize\":" << result.outputSize
+                << ",\"iterations\":" << result.iterations
+                << ",\"callsCount\":" << result.callsCount
+                << ",\"seconds\":" << result.seconds
+                << ",\"iterationsPerSecond\":" << result.iterationsPerSecond << "}";
+        }
+        output << "\n]}\n";
+    }
+
+    void printUsage() {
+        cout <<
+            "Usage: zippy_bench [options]\n"
+            "Measures the throughput, latency and allocations of the algorithms' cores.\n"
+            "Options:\n"
+            "  --algorithms <list>  comma-separated algorithms (default: all)\n"
+            "  --impl <list>        comma-separated implementations: scalar, ssse3, avx2, avx512, shani, sse42, pclmul, auto\n"
+            "                       (default: all the ones supported by this CPU)\n"
+            "  --modes <list>       memory (streaming hasher), file (single file), batch (many files at once),\n"
+            "                       read (single file without hashing) (default: memory, file, batch)\n"
+            "  --sizes <list>       sizes of messages, e.g. 64,4K,16M,1G (default: 64 B to 1 GiB)\n"
+            "  --max-size <n>       skip the default sizes larger than this\n"
+            "  --min-time <s>       time spent on each measurement in seconds (default: 0.25)\n"
+            "  --dir <directory>    where the files are created (default: the temporary directory)\n"
+            "  --io <method>        how the files are read: mmap, stream, uring, thread, uring-direct, thread-direct\n"
+            "                       (default: mmap)\n"
+            "  --io-depth <n>       count of reads in flight for uring and thread (default: 4)\n"
+            "  --kdf <iterations>   measure PBKDF2 (HMAC-SHA-256 and HMAC-SHA-512 by default) in iterations per second\n"
+            "                       instead of the hashing: a single key, the key of 8 output blocks, the keys of 64 passwords\n"
+            "  --json <file>        write the results as JSON into the file" << endl;
+    }
+
+    // Returns false if the usage has to be printed
+    bool parseOptions(int argc, char *argv[], BenchOptions &options) {
+        uint64 maxSize = 0;
+        uint32 ioDepth = DEFAULT_IO_DEPTH;
+        for (int i = 1; i < argc; i++) {
+            string option = argv[i];
+            if (option == "--help" || i + 1 >= argc) {
+                return false;
+            }
+            string value = argv[++i];
+            if (option == "--algorithms") {
+                for (const string &name : splitList(value)) {
+                    const HashAlgorithm *algorithm = findHashAlgorithm(name);
+                    if (algorithm == nullptr) {
+                        throw invalid_argument("Unknown algorithm: " + name);
+                    }
+                    options.algorithms.push_back(algorithm);
+                }
+            } else if (option == "--impl") {
+                for (const string &name : splitList(value)) {
+                    Implementation implementation;
+                    if (!parseImplementation(name, implementation)) {
+                        throw invalid_argument("Unknown implementation: " + name);
+                    }
+                    options.implementations.push_back(implementation);
+                }
+            } else if (option == "--modes") {
+                options.modes.clear();
+                for (const string &name : splitList(value)) {
+                    Mode mode = name == "memory" ? Mode::Memory : name == "file" ? Mode::File
+                        : name == "read" ? Mode::Read : Mode::Batch;
+                    if (modeName(mode) != name) {
+                        throw invalid_argument("Unknown mode: " + name);
+                    }
+                    options.modes.push_back(mode);
+                }
+            } else if (option == "--sizes") {
+                options.sizes.clear();
+                for (const string &size : splitList(value)) {
+                    options.sizes.push_back(parseSize(size));
+                }
+            } else if (option == "--max-size") {
+                maxSize = parseSize(value);
+            } else if (option == "--min-time") {
+                options.minTime = stod(value);
+            } else if (option == "--dir") {
+                options.directory = value;
+            } else if (option == "--json") {
+                options.jsonPath = value;
+            } else if (option == "--io") {
+                InputOptions &inputOptions = options.inputOptions;
+                inputOptions.allowMapping = value == "mmap";
+                inputOptions.ioDepth = value == "mmap" || value == "stream" ? 0 : DEFAULT_IO_DEPTH;
+                inputOptions.allowIoUring = value.rfind("uring", 0) == 0;
+                inputOptions.directIo = value == "uring-direct" || value == "thread-direct";
+                if (!inputOptions.allowMapping && value != "stream" && value != "uring" && value != "thread" && !inputOptions.directIo) {
+                    throw invalid_argument("Unknown reading method: " + value);
+                }
+            } else if (option == "--kdf") {
+                options.kdfIterations = stoul(value);
+                if (options.kdfIterations == 0) {
+                    throw invalid_argument("The count of iterations must be positive");
+                }
+            } else if (option == "--io-depth") {
+                ioDepth = stoul(value);
+            } else {
+                return false;
+            }
+        }
+
+        if (options.inputOptions.ioDepth != 0) {
+            options.inputOptions.ioDepth = ioDepth;
+        }
+        if (maxSize != 0) {
+            options.sizes.erase(
+                remove_if(options.sizes.begin(), options.sizes.end(), [maxSize](uint64 size) { return size > maxSize; }),
+                options.sizes.end()
+            );
+        }
+        if (options.algorithms.empty() && options.kdfIterations != 0) {
+            options.algorithms = { findHashAlgorithm("sha256"), findHashAlgorithm("sha512") };
+        } else if (options.algorithms.empty()) {
+            for (const HashAlgorithm &algorithm : getHashAlgorithms()) {
+                options.algorithms.push_back(&algorithm);
+            }
+        }
+        if (options.implementations.empty()) {
+            for (Implementation implementation : { Implementation::Scalar, Implementation::Ssse3, Implementation::Avx2,
+                Implementation::Avx512, Implementation::ShaNi, Implementation::Sse42, Implementation::Pclmul }) {
+                if (isImplementationSupported(implementation)) {
+                    options.implementations.push_back(implementation);
+                }
+            }
+        }
+        return true;
+    }
+
+    // Runs all the algorithms and implementations over the messages of the same size
+    void benchSize(const BenchOptions &options, uint64 size, const uchar *data, vector<Result> &results) {
+        bool useRead = find(options.modes.begin(), options.modes.end(), Mode::Read) != options.modes.end();
+        bool useFile = useRead || find(options.modes.begin(), options.modes.end(), Mode::File) != options.modes.end();
+        // The larger files are hashed one by one by the batch interface as well
+        bool useBatch = find(options.modes.begin(), options.modes.end(), Mode::Batch) != options.modes.end()
+            && size <= BATCH_LARGE_FILE_SIZE;
+
+        string filePrefix = (fs::path(options.directory) / ("zippy_bench_" + to_string(size) + "_")).string();
+        vector<string> filePaths;
+        if (useFile || useBatch) {
+            for (size_t i = 0; i < (useBatch ? BATCH_FILES_COUNT : 1); i++) {
+                filePaths.push_back(filePrefix + to_string(i));
+                writeFile(filePaths.back(), data, size);
+            }
+        }
+
+        const InputOptions &inputOptions = options.inputOptions;
+        // The reading doesn't depend on the algorithm, it's measured once
+        Result readResult { "read", "", Mode::Read, size };
+        if (useRead) {
+            readResult.implementation = readMethodName(InputReader(filePaths[0], inputOptions));
+            measure(readResult, 1, options.minTime, [&] {
+                readFile(filePaths[0], inputOptions);
+            });
+            printResult(readResult);
+            results.push_back(readResult);
+        }
+
+        for (const HashAlgorithm *algorithm : options.algorithms) {
+            for (Implementation implementation : options.implementations) {
+                forceImplementation(implementation);
+                Result memoryResult {};
+                Result fileResult {};
+                for (Mode mode : options.modes) {
+                    Result result { algorithm->name, implementationName(implementation), mode, size };
+                    try {
+                        if (mode == Mode::Memory) {
+                            unique_ptr<StreamingHasher> hasher = algorithm->createHasher();
+                            measure(result, 1, options.minTime, [&] {
+                                hasher->update(data, size);
+                                hasher->final();
+                            });
+                        } else if (mode == Mode::File) {
+                            measure(result, 1, options.minTime, [&] {
+                                algorithm->hashFile(filePaths[0], inputOptions);
+                            });
+                        } else if (mode == Mode::Read) {
+                            continue;
+                        } else if (useBatch) {
+                            measure(result, filePaths.size(), options.minTime, [&] {
+                                algorithm->hashFiles(filePaths, inputOptions);
+                            });
+                        } else {
+                            continue;
+                        }
+                    } catch (const invalid_argument &error) {
+                        // The forced implementation isn't supported by the CPU
+                        cerr << "zippy_bench: " << algorithm->name << ", " << result.implementation << ": " << error.what() << endl;
+                        break;
+                    }
+                    printResult(result);
+                    results.push_back(result);
+                    if (mode == Mode::Memory) {
+                        memoryResult = result;
+                    } else if (mode == Mode::File) {
+                        fileResult = result;
+                    }
+                }
+                if (useRead && memoryResult.messagesCount != 0 && fileResult.messagesCount != 0) {
+                    printOverlap(readResult, memoryResult, fileResult);
+                }
+            }
+        }
+        forceImplementation(Implementation::Auto);
+
+        for (const string &filePath : filePaths) {
+            error_code error;
+            fs::remove(filePath, error);
+        }
+    }
+
+    // PBKDF2 in the three shapes: the single block is iterated by the single stream, the blocks of the single key
+    // and the keys of many passwords share the lanes of the multi-buffer cores
+    void benchKdf(const BenchOptions &options, vector<KdfResult> &results) {
+        const uchar password[] = "correct horse battery staple";
+        const uchar salt[] = "NaCl and the 16B";
+        vector<ByteView> passwords(BATCH_FILES_COUNT);
+        vector<string> passwordsTexts(BATCH_FILES_COUNT);
+        for (size_t i = 0; i < passwords.size(); i++) {
+            passwordsTexts[i] = "password " + to_string(i);
+            passwords[i] = { (const uchar *)passwordsTexts[i].data(), passwordsTexts[i].size() };
+        }
+
+        for (const HashAlgorithm *hashAlgorithm : options.algorithms) {
+            const HmacAlgorithm *algorithm = findHmacAlgorithm(hashAlgorithm->name);
+            if (algorithm == nullptr) {
+                cerr << "zippy_bench: " << hashAlgorithm->name << " has no keyed functions" << endl;
+                continue;
+            }
+            for (Implementation implementation : options.implementations) {
+                forceImplementation(implementation);
+                const struct { const char *kind; size_t passwordsCount; size_t blocksCount; } shapes[] = {
+                    { "single", 1, 1 }, { "blocks", 1, 8 }, { "batch", BATCH_FILES_COUNT, 1 },
+                };
+                for (const auto &shape : shapes) {
+                    KdfResult result { algorithm->name, implementationName(implementation), shape.kind, shape.passwordsCount,
+                        shape.blocksCount * algorithm->digestSize, options.kdfIterations };
+                    vector<ByteView> callPasswords(passwords.begin(), passwords.begin() + shape.passwordsCount);
+                    if (shape.passwordsCount == 1) {
+                        callPasswords[0] = { password, sizeof(password) - 1 };
+                    }
+                    vector<ByteView> salts(shape.passwordsCount, { salt, sizeof(salt) - 1 });
+                    vector<uchar> keys(shape.passwordsCount * result.outputSize);
+                    try {
+                        Clock::time_point start = Clock::now();
+                        Clock::time_point end = start;
+                        do {
+                            algorithm->pbkdf2Batch(callPasswords, salts, options.kdfIterations, keys.data(), result.outputSize);
+                            result.callsCount++;
+                            end = Clock::now();
+                        } while (toNanoseconds(end - start) < options.minTime * 1e9);
+                        result.seconds = toNanoseconds(end - start) / 1e9;
+                    } catch (const invalid_argument &error) {
+                        // The forced implementation isn't supported by the CPU
+                        cerr << "zippy_bench: " << algorithm->name << ", " << result.implementation << ": " << error.what() << endl;
+                        break;
+                    }
+                    result.iterationsPerSecond = double(result.callsCount) * shape.passwordsCount * shape.blocksCount
+                        * options.kdfIterations / result.seconds;
+                    printKdfResult(result);
+                    results.push_back(result);
+                }
+            }
+        }
+        forceImplementation(Implementation::Auto);
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            printUsage();
+            return argc == 2 && string(argv[1]) == "--help" ? 0 : 1;
+        }
+    } catch (const exception &error) {
+        cerr << "zippy_bench: " << error.what() << endl;
+        return 1;
+    }
+    vector<Result> results;
+    vector<KdfResult> kdfResults;
+    if (options.kdfIterations != 0) {
+        benchKdf(options, kdfResults);
+    } else if (options.sizes.empty()) {
+        cerr << "zippy_bench: no sizes to measure" << endl;
+        return 1;
+    } else {
+        // All the messages are the prefixes of the same buffer
+        uint64 maxSize = *max_element(options.sizes.begin(), options.sizes.end());
+        unique_ptr<uchar[]> data(new uchar[maxSize]);
+        fillRandom(data.get(), maxSize);
+
+        try {
+            for (uint64 size : options.sizes) {
+                benchSize(options, size, data.get(), results);
+            }
+        } catch (const exception &error) {
+            cerr << "zippy_bench: " << error.what() << endl;
+            return 1;
+        }
+    }
+
+    if (!options.jsonPath.empty()) {
+        ofstream output(options.jsonPath, ios::out | ios::trunc);
+        writeJson(options, results, kdfResults, output);
+        output.close();
+        if (!output) {
+            cerr << "zippy_bench: can't write the results: " << options.jsonPath << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
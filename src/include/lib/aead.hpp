@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <memory>
+
+#include "../types.hpp"
+
+using namespace std;
+
+// The authenticated encryption with the associated data: the ciphertext is as long as the plaintext and is followed by the tag,
+// which authenticates the ciphertext and the associated data (the data that is authenticated, but not encrypted)
+namespace aead {
+
+    const uchar KEY_SIZE = 32;
+    const uchar NONCE_SIZE = 12;
+    const uchar TAG_SIZE = 16;
+
+    typedef array<uchar, KEY_SIZE> Key;
+
+    // The values are stored in the header of the encrypted files
+    enum class Algorithm : uchar {
+        ChaCha20Poly1305 = 1,
+        Aes256Gcm = 2
+    };
+
+    class Cipher {
+    public:
+        virtual ~Cipher() {}
+
+        // Encrypts the `size` bytes of the `input` into the `output` (they may be the same buffer) and writes the tag.
+        // A nonce must never be used twice with the same key
+        virtual void seal(
+            const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+            const uchar *input, size_t size, uchar *output, uchar *tag
+        ) const = 0;
+
+        // Decrypts the `size` bytes of the `input` into the `output` (they may be the same buffer).
+        // Returns false if the tag doesn't match, the output is zeroed then
+        virtual bool open(
+            const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+            const uchar *input, size_t size, uchar *output, const uchar *tag
+        ) const = 0;
+    };
+
+    // The cores are selected according to the CPU features (or the forced implementation) once per cipher
+    unique_ptr<Cipher> createCipher(Algorithm algorithm, const Key &key);
+
+    // AES-256-GCM where AES-NI and PCLMULQDQ are available, ChaCha20-Poly1305 otherwise (it's faster without them)
+    Algorithm getPreferredAlgorithm();
+
+    // "chacha20-poly1305" or "aes-256-gcm"
+    string algorithmName(Algorithm algorithm);
+
+    // Returns false if the name doesn't match any algorithm
+    bool parseAlgorithm(const string &name, Algorithm &algorithm);
+
+    // Compares the tags in the time that doesn't depend on where they differ
+    bool areTagsEqual(const uchar *first, const uchar *second);
+
+}
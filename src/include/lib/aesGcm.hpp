@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../types.hpp"
+#include "aead.hpp"
+#include "kernels/aesGcmKernels.hpp"
+
+using namespace std;
+
+namespace aes {
+
+    // AES-256 in the Galois/Counter Mode (NIST SP 800-38D) with the 96-bit nonce and the 128-bit tag.
+    // The cores are AES-NI with PCLMULQDQ where they are available. The scalar fallback uses the lookup tables,
+    // so unlike them it isn't constant-time
+    class Aes256Gcm : public aead::Cipher {
+    public:
+        // The messages are limited by the 32-bit block counter: up to 64 GiB each
+        static constexpr uint64 MAX_MESSAGE_SIZE = ((uint64(1) << 32) - 2) * _aes::BLOCK_SIZE_IN_BYTES;
+
+        explicit Aes256Gcm(const aead::Key &key);
+
+        void seal(
+            const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+            const uchar *input, size_t size, uchar *output, uchar *tag
+        ) const override;
+
+        bool open(
+            const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+            const uchar *input, size_t size, uchar *output, const uchar *tag
+        ) const override;
+
+    private:
+        bool useAesNi;
+        alignas(16) uchar roundKeys[_aes::ROUND_KEYS_SIZE];
+        // The hash key H = AES(0) as the powers for the PCLMULQDQ kernels or as the 4-bit tables for the scalar core
+        alignas(16) uchar hashKeyPowers[_aes::HASH_KEY_POWERS_COUNT * _aes::BLOCK_SIZE_IN_BYTES];
+        uint64 hashTableHigh[16];
+        uint64 hashTableLow[16];
+
+        void encryptBlock(const uchar *input, uchar *output) const;
+        void ghashBlocks(uchar *state, const uchar *data, size_t blocksCount) const;
+        void multiplyByHashKey(uchar *state) const;
+
+        // Both directions in a single pass: GHASH is computed over the ciphertext (the output or the input)
+        void crypt(
+            const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+            const uchar *input, size_t size, uchar *output, bool isEncrypting, uchar *tag
+        ) const;
+    };
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+#include "digest.hpp"
+
+using namespace std;
+
+// The common interface of the streaming hashers, so the same input may be fed to several algorithms at once
+class StreamingHasher {
+public:
+    virtual ~StreamingHasher() {}
+
+    virtual void update(const uchar *data, size_t size) = 0;
+
+    // Returns the digest and resets the hasher
+    virtual HashDigest final() = 0;
+};
+
+// Describes the hash algorithm available through the command line and the batch interfaces
+struct HashAlgorithm {
+    string name;
+    // The name used by the BSD-style (tagged) output, e.g. "SHA256 (file) = ..."
+    string tag;
+    uchar digestSize;
+
+    // Hashes a single file ("-" means the standard input)
+    HashDigest (*hashFile)(const string &filePath, const InputOptions &options);
+
+    // Hashes many files at once, the digests are returned in the order of the `filePaths`
+    vector<HashDigest> (*hashFiles)(const vector<string> &filePaths, const InputOptions &options);
+
+    // Hashes many messages in memory at once, the digests are returned in the order of the `messages`
+    vector<HashDigest> (*hashBuffers)(const vector<ByteView> &messages);
+
+    unique_ptr<StreamingHasher> (*createHasher)();
+};
+
+// Returns nullptr if there is no algorithm with such name
+const HashAlgorithm *findHashAlgorithm(const string &name);
+
+const vector<HashAlgorithm> &getHashAlgorithms();
+
+// The keyed functions built on the hash algorithm: HMAC, HKDF and PBKDF2 (SHA-2 only)
+struct HmacAlgorithm {
+    // The name of the hash algorithm, e.g. "sha256"
+    string name;
+    uchar digestSize;
+
+    // The key may be of any size
+    unique_ptr<StreamingHasher> (*createHasher)(const uchar *key, size_t keySize);
+
+    // The MACs of many messages in memory under the same key, in the order of the `messages`
+    vector<HashDigest> (*macBuffers)(const uchar *key, size_t keySize, const vector<ByteView> &messages);
+
+    void (*hkdf)(
+        const uchar *salt, size_t saltSize, const uchar *keyMaterial, size_t keyMaterialSize,
+        const uchar *info, size_t infoSize, uchar *output, size_t size
+    );
+
+    // The key of the password `i` (with the salt `i`) is written at `outputs + i * size`
+    void (*pbkdf2Batch)(const vector<ByteView> &passwords, const vector<ByteView> &salts, uint32 iterations, uchar *outputs, size_t size);
+};
+
+// Returns nullptr if there is no algorithm with such name or it has no keyed functions
+const HmacAlgorithm *findHmacAlgorithm(const string &name);
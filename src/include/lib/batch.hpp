@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+#include "../utils/stats.hpp"
+#include "algorithms.hpp"
+#include "hashCache.hpp"
+
+using namespace std;
+
+// The files larger than this are hashed by the separate (long) tasks of the thread pool,
+// the smaller ones are grouped, so the multi-buffer cores may hash them several at a time
+const uint64 BATCH_LARGE_FILE_SIZE = 1024 * 1024;
+const size_t BATCH_GROUP_MAX_FILES_COUNT = 64;
+const uint64 BATCH_GROUP_MAX_SIZE = 8 * 1024 * 1024;
+
+// The digests of the file are stored inline, so the results don't allocate on their way to the handler
+const size_t BATCH_MAX_ALGORITHMS_COUNT = 16;
+
+struct BatchOptions {
+    // 0 means the count of hardware threads
+    uint32 threadsCount = 0;
+    // Report the results in the order of the inputs (the directories are walked in the order of the file system)
+    bool keepOrder = false;
+    InputOptions inputOptions;
+    // The digests of the unchanged files are taken from the cache and the computed ones are stored there (if set).
+    // In the verification mode of the cache, the mismatching digests are reported as errors
+    HashCache *cache = nullptr;
+};
+
+struct BatchResult {
+    string filePath;
+    // One per algorithm, in the order of the algorithms
+    array<HashDigest, BATCH_MAX_ALGORITHMS_COUNT> digests;
+    // Empty if the file has been hashed successfully
+    string error;
+    // The time of the stages and the bytes read. The small files hashed together share the time of the group by their sizes
+    StatsCounters stats {};
+};
+
+// Is never called concurrently. Returning false stops the processing: the rest of the files are skipped
+typedef function<bool (const BatchResult &result)> BatchResultHandler;
+
+// Hashes the files and all the regular files found in the `directories` (recursively) on the work-stealing thread pool.
+// The large files are hashed by all the `algorithms` in a single pass, the groups of small ones by the multi-buffer cores.
+// The directories are walked concurrently with the hashing. The results are passed to the `handler` as soon as they
+// are ready, or in the order of the inputs if `keepOrder` is set. Returns the count of files that haven't been hashed
+// due to errors (among the ones passed to the handler).
+// Throws `invalid_argument` if there are more than `BATCH_MAX_ALGORITHMS_COUNT` algorithms
+size_t hashFilesInParallel(
+    const vector<const HashAlgorithm *> &algorithms, const vector<string> &filePaths, const vector<string> &directories,
+    const BatchOptions &options, const BatchResultHandler &handler
+);
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+
+using namespace std;
+
+namespace blake3 {
+    // The mapped files larger than this are hashed by several threads: the subtrees of this size
+    // (a power of two count of chunks) are compressed concurrently, then merged by the calling thread
+    const uint64 PARALLEL_SUBTREE_SIZE = 1024 * 1024;
+
+    typedef array<uchar, 32> Blake3Digest;
+    typedef array<uchar, 32> Blake3Key;
+
+    // Streaming BLAKE3 hasher.
+    // The input is split into the chunks of 1 KiB, which are the leaves of the binary tree. The complete subtrees
+    // are compressed by the multi-lane cores (many chunks at once), so even the single stream gets the SIMD parallelism.
+    // The message may be passed in portions of any size via `update`, its size isn't required up front
+    class Blake3Hasher {
+    public:
+        static const uchar BLOCK_SIZE_IN_BYTES = 64;
+        static const uint32 CHUNK_SIZE_IN_BYTES = 1024;
+        static const uchar DIGEST_SIZE_IN_BYTES = 32;
+        static const uchar KEY_SIZE_IN_BYTES = 32;
+
+        // The regular hash function
+        Blake3Hasher();
+
+        // The keyed hash function (the MAC, the PRF)
+        explicit Blake3Hasher(const Blake3Key &key);
+
+        // The key derivation function: the key material passed via `update` is hashed in the domain of the `context`,
+        // which is expected to be a hardcoded, globally unique and application-specific string
+        explicit Blake3Hasher(const string &context);
+
+        // Drops all the processed data and returns the hasher to the initial state (of the same mode and key)
+        void reset();
+
+        void update(const uchar *data, size_t size);
+
+        // The same as `update`, but the complete subtrees of `PARALLEL_SUBTREE_SIZE` are compressed concurrently
+        // by `threadsCount` threads (0 means the count of hardware threads). The digest doesn't depend on the count
+        void updateInParallel(const uchar *data, size_t size, uint32 threadsCount);
+
+        // Writes the first `size` bytes of the extendable output. The hasher is reset afterwards
+        void final(uchar *output, size_t size);
+
+        // Returns the default 32-byte digest. The hasher is reset afterwards and may be reused for the next message
+        Blake3Digest final();
+
+    private:
+        static const uchar MAX_TREE_DEPTH = 54;
+
+        uint32 key[8];
+        uchar flags;
+
+        // The chunk being hashed: its chaining value, the index and the incomplete block
+        uint32 chunkState[8];
+        uint64 chunkCounter;
+        uchar buffer[BLOCK_SIZE_IN_BYTES];
+        uchar bufferSize;
+        uchar compressedBlocksCount;
+
+        // The chaining values of the complete subtrees waiting for their siblings (the largest at the bottom)
+        uchar cvStack[MAX_TREE_DEPTH * 32];
+        uchar cvStackSize;
+
+        void (*hashLanes)(
+            const uchar *const *inputs, uchar blocksCount, const uint32 *key, uint64 counter, bool incrementCounter,
+            uchar flags, uchar startFlags, uchar endFlags, uchar *output
+        );
+        uchar lanesCount;
+
+        // The input of the compression function that may become the root: its chaining value or the extendable output
+        struct Output;
+
+        void initialize(const uint32 *key, uchar flags);
+        uint32 getChunkSize() const;
+        Output getChunkOutput() const;
+        Output getParentOutput(const uchar *block) const;
+        void updateChunk(const uchar *data, size_t size);
+        void startChunk(uint64 counter);
+        void finishChunk();
+        void mergeCvStack(uint64 chunksCount);
+        void pushCv(const uchar *cv, uint64 chunkCounter);
+
+        void hashMany(const uchar *const *inputs, size_t inputsCount, uchar blocksCount, uint64 counter, bool incrementCounter,
+            uchar inputFlags, uchar startFlags, uchar endFlags, uchar *output) const;
+        size_t compressChunksParallel(const uchar *data, size_t size, uint64 chunkCounter, uchar *output) const;
+        size_t compressParentsParallel(const uchar *cvs, size_t cvsCount, uchar *output) const;
+        size_t compressSubtreeWide(const uchar *data, size_t size, uint64 chunkCounter, uchar *output) const;
+        void compressSubtreeToParentNode(const uchar *data, size_t size, uint64 chunkCounter, uchar *output) const;
+    };
+
+    // Passing "-" as the `filePath` makes the function to hash the standard input.
+    // The mapped files are hashed by `options.threadsCount` threads
+    Blake3Digest hashFile(const string &filePath, const InputOptions &options = InputOptions());
+
+    // The same, but in the mode (and with the key) of the `hasher`, which is expected to be fresh (it isn't changed)
+    Blake3Digest hashFileWith(const Blake3Hasher &hasher, const string &filePath, const InputOptions &options = InputOptions());
+
+    // The digests are returned in the order of the `filePaths`
+    vector<Blake3Digest> hashFiles(const vector<string> &filePaths, const InputOptions &options = InputOptions());
+
+    // The messages in memory are hashed one by one: each of them gets the multi-lane cores on its own
+    vector<Blake3Digest> hashBuffers(const vector<ByteView> &messages);
+}
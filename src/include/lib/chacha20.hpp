@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../types.hpp"
+#include "aead.hpp"
+#include "kernels/chacha20Kernels.hpp"
+
+using namespace std;
+
+namespace chacha20 {
+
+    // ChaCha20-Poly1305 (RFC 8439): the ChaCha20 stream cipher with the 32-bit block counter and the 96-bit nonce,
+    // the Poly1305 one-time authenticator keyed by the first block of the key stream
+    class ChaCha20Poly1305 : public aead::Cipher {
+    public:
+        // The messages are limited by the 32-bit block counter: up to 256 GiB each
+        static constexpr uint64 MAX_MESSAGE_SIZE = (uint64(1) << 32) * _chacha20::BLOCK_SIZE_IN_BYTES - _chacha20::BLOCK_SIZE_IN_BYTES;
+
+        explicit ChaCha20Poly1305(const aead::Key &key);
+
+        void seal(
+            const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+            const uchar *input, size_t size, uchar *output, uchar *tag
+        ) const override;
+
+        bool open(
+            const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+            const uchar *input, size_t size, uchar *output, const uchar *tag
+        ) const override;
+
+    private:
+        uint32 key[8];
+        _chacha20::XorBlocksFunction *xorBlocks;
+        uchar lanesCount;
+
+        // The data are encrypted and authenticated in the portions of this size,
+        // so the ciphertext is still in the L1 cache when Poly1305 reads it
+        static constexpr size_t PORTION_SIZE = 4096;
+
+        // The key stream starting from the `counter` XORed with the input
+        void xorKeyStream(const uchar *nonce, uint32 counter, const uchar *input, uchar *output, size_t size) const;
+
+        // Both directions in a single pass: the tag is computed over the ciphertext (the output or the input)
+        void crypt(
+            const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+            const uchar *input, size_t size, uchar *output, bool isEncrypting, uchar *tag
+        ) const;
+    };
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <functional>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+#include "algorithms.hpp"
+#include "batch.hpp"
+
+using namespace std;
+
+// The line of the checksum file. The views point into the content of the file (or into the unescaped copies of the paths),
+// so they are valid while the file exists
+struct ChecksumEntry {
+    string_view filePath;
+    // The hexadecimal (of any case) or base64 form of the expected digest
+    string_view digest;
+    const HashAlgorithm *algorithm;
+};
+
+// The checksum file in the format of sha256sum (`<digest>  <file>` or `<digest> *<file>`)
+// or in the BSD-style one of `sha256sum --tag` (`SHA256 (<file>) = <digest>`), possibly mixed.
+// The lines starting with the backslash have the backslashes and the line breaks of the file names escaped.
+// The file is memory-mapped and parsed in place, so even the files of millions of lines are read without copying
+class ChecksumFile {
+public:
+    // Passing "-" as the `filePath` makes to read the standard input.
+    // The algorithm of each line is told by the tag or by the length of the digest (the first registered algorithm
+    // of such length wins) unless the `forcedAlgorithm` is set: the lines of any other algorithm are malformed then.
+    // Throws `invalid_argument` if the file can't be opened
+    ChecksumFile(const string &filePath, const HashAlgorithm *forcedAlgorithm = nullptr);
+
+    ChecksumFile(const ChecksumFile &) = delete;
+    ChecksumFile &operator=(const ChecksumFile &) = delete;
+
+    const vector<ChecksumEntry> &getEntries() const;
+
+    // The count of non-empty lines that are neither the entries nor the comments (starting with '#')
+    size_t getMalformedLinesCount() const;
+
+private:
+    InputReader reader;
+    // The content that can't be mapped (the standard input, pipes)
+    string content;
+    deque<string> unescapedPaths;
+    vector<ChecksumEntry> entries;
+    size_t malformedLinesCount;
+
+    bool parseLine(string_view line, const HashAlgorithm *forcedAlgorithm);
+};
+
+// Returns false if the `digest` is neither the hexadecimal nor the base64 form of `size` bytes
+bool decodeChecksumDigest(string_view digest, uchar size, uchar *output);
+
+enum class ChecksumStatus {
+    Ok,
+    Failed,
+    // The file can't be opened or read, the error tells why
+    Unreadable,
+};
+
+// Is never called concurrently. Returning false stops the verification: the rest of the entries are skipped
+typedef function<bool (const ChecksumEntry &entry, ChecksumStatus status, const string &error)> ChecksumResultHandler;
+
+// Hashes the files of the entries on the thread pool of the batch and compares their digests with the expected ones.
+// The entries of each algorithm are verified in turn (in the order of their first appearance), the results of them
+// are passed to the `handler` in the order of the entries
+void verifyChecksums(const vector<ChecksumEntry> &entries, const BatchOptions &options, const ChecksumResultHandler &handler);
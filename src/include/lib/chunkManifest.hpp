@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "../types.hpp"
+#include "chunker.hpp"
+
+using namespace std;
+
+enum class ManifestFormat {
+    Json,
+    // The compact one: 36 bytes per chunk, the offsets are implied by the sizes
+    Binary,
+};
+
+// The binary manifest starts with the magic and the version, followed by the little-endian fields:
+// min, average and max sizes (uint32), total size and chunks count (uint64), then the size (uint32) and the digest of each chunk
+const char CHUNK_MANIFEST_MAGIC[4] = { 'Z', 'C', 'D', 'C' };
+const uint32 CHUNK_MANIFEST_VERSION = 1;
+
+void writeManifest(const ChunkManifest &manifest, ManifestFormat format, ostream &output);
+
+// The format is detected by the content. Throws `invalid_argument` if the file can't be read or isn't a valid manifest
+ChunkManifest readManifest(const string &filePath);
+
+struct ManifestDiff {
+    // The indices of the chunks of the new manifest whose content isn't found anywhere in the old one
+    vector<size_t> changedChunks;
+    uint64 changedSize = 0;
+    uint64 reusedSize = 0;
+};
+
+// Finds the chunks that have to be transferred to turn the old file into the new one.
+// The chunks are matched by the digests regardless of their offsets, so the moved content is reused as well.
+// Throws `invalid_argument` if the manifests are chunked with different parameters (their chunks would never match)
+ManifestDiff diffManifests(const ChunkManifest &oldManifest, const ChunkManifest &newManifest);
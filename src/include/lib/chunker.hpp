@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+#include "sha2.hpp"
+
+using namespace std;
+
+// The default sizes suit the multi-gigabyte images: about 16 thousands of chunks per gigabyte
+const uint32 DEFAULT_CHUNK_MIN_SIZE = 16 * 1024;
+const uint32 DEFAULT_CHUNK_AVERAGE_SIZE = 64 * 1024;
+const uint32 DEFAULT_CHUNK_MAX_SIZE = 256 * 1024;
+
+// The chunks are handed to the thread pool in the batches of about this size
+const uint64 CHUNK_BATCH_SIZE = 4 * 1024 * 1024;
+
+struct ChunkingParameters {
+    uint32 minSize = DEFAULT_CHUNK_MIN_SIZE;
+    // Must be a power of two
+    uint32 averageSize = DEFAULT_CHUNK_AVERAGE_SIZE;
+    uint32 maxSize = DEFAULT_CHUNK_MAX_SIZE;
+};
+
+// Throws `invalid_argument` unless 64 <= min <= average <= max and the average size is a power of two not less than 256
+void validateChunkingParameters(const ChunkingParameters &parameters);
+
+// Finds the boundaries of the content-defined chunks in the manner of FastCDC: the gear rolling hash is computed
+// over the bytes of the chunk after its minimum size, and the chunk ends where the selected bits of the hash are zero.
+// The mask has more bits before the average size and less bits after it (the normalized chunking),
+// so the sizes of chunks are concentrated around the average one.
+// The boundaries depend on the content only, thus an insertion into the file changes the chunks around it only.
+// The input may be passed in portions of any size: the state of the current chunk is kept between the calls
+class ChunkBoundaryFinder {
+public:
+    explicit ChunkBoundaryFinder(const ChunkingParameters &parameters);
+
+    // Scans the data for the end of the current chunk and returns the count of bytes that belong to the chunk.
+    // The `isEnd` is set if the chunk ends there, otherwise all the data belongs to the chunk and it continues in the next portion
+    size_t find(const uchar *data, size_t size, bool &isEnd);
+
+private:
+    ChunkingParameters parameters;
+    uint64 smallChunkMask;
+    uint64 largeChunkMask;
+
+    uint64 chunkSize;
+    uint64 hash;
+};
+
+struct Chunk {
+    uint64 offset;
+    uint32 size;
+    sha2::Sha256Digest digest;
+};
+
+struct ChunkManifest {
+    ChunkingParameters parameters;
+    uint64 totalSize = 0;
+    vector<Chunk> chunks;
+};
+
+struct ChunkingOptions {
+    ChunkingParameters parameters;
+    // 0 means the count of hardware threads
+    uint32 threadsCount = 0;
+    InputOptions inputOptions;
+};
+
+// Splits the file ("-" means the standard input) into the content-defined chunks and hashes each of them by SHA-256.
+// The input is chunked sequentially while the chunks are hashed in batches on the thread pool.
+// Throws `invalid_argument` if the file can't be opened or the parameters are invalid
+ChunkManifest chunkFile(const string &filePath, const ChunkingOptions &options = ChunkingOptions());
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+#include "kernels/crc32Kernels.hpp"
+
+using namespace std;
+
+// CRC-32 of ISO-HDLC (gzip, zlib, PNG): the reflected polynomial 0xEDB88320, the initial value and the final XOR 0xFFFFFFFF.
+// CRC-32C (iSCSI, ext4, SCTP): the same with the Castagnoli polynomial 0x82F63B78
+namespace crc32 {
+
+    // Continues the checksum of the preceding data (0 for the empty one) with the next portion
+    uint32 update(uint32 crc, const uchar *data, size_t size);
+
+    // The checksum of the concatenation of two portions from their checksums and the size of the second one,
+    // so the portions may be checksummed in parallel
+    uint32 combine(uint32 firstCrc, uint32 secondCrc, uint64 secondSize);
+
+    // The same as `update` for CRC-32C
+    uint32 updateCastagnoli(uint32 crc, const uchar *data, size_t size);
+
+    // The checksum as the big endian bytes, in the order of its usual hexadecimal form
+    typedef array<uchar, 4> Crc32Digest;
+
+    struct Crc32Variant {
+        static _crc32::UpdateFunction *selectUpdateFunction() {
+            return _crc32::selectUpdateFunction();
+        }
+    };
+
+    struct Crc32cVariant {
+        static _crc32::UpdateFunction *selectUpdateFunction() {
+            return _crc32::selectCastagnoliUpdateFunction();
+        }
+    };
+
+    // Streaming CRC hasher, it has no buffer: the portions of any size go to the core as they are.
+    // Instantiated for the variants above
+    template <typename Variant>
+    class CrcHasher {
+    public:
+        static const uchar DIGEST_SIZE_IN_BYTES = 4;
+
+        // Throws `invalid_argument` if the forced implementation isn't supported by the CPU
+        CrcHasher();
+
+        // Drops all the processed data
+        void reset();
+
+        void update(const uchar *data, size_t size);
+
+        // Returns the checksum, the hasher is reset afterwards and may be reused for the next message
+        Crc32Digest final();
+
+    private:
+        // The register of the CRC, without the inversions
+        uint32 crc;
+        _crc32::UpdateFunction *updateFunction;
+    };
+
+    typedef CrcHasher<Crc32Variant> Crc32Hasher;
+    typedef CrcHasher<Crc32cVariant> Crc32cHasher;
+
+    // Passing "-" as the `filePath` makes the function to checksum the standard input
+    template <typename Variant>
+    Crc32Digest hashFile(const string &filePath, const InputOptions &options = InputOptions());
+
+    // The files are checksummed one by one: the core is bound by the memory bandwidth, not by its latency.
+    // The checksums are returned in the order of the `filePaths`
+    template <typename Variant>
+    vector<Crc32Digest> hashFiles(const vector<string> &filePaths, const InputOptions &options = InputOptions());
+
+    template <typename Variant>
+    vector<Crc32Digest> hashBuffers(const vector<ByteView> &messages);
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+
+using namespace std;
+
+// DEFLATE (RFC 1951): LZ77 over the 32 KiB window with the Huffman coding of the literals, lengths and distances
+namespace deflate {
+
+    // The matches may refer this far back, so the portion compressed on its own sees this much of the preceding input
+    const uint32 WINDOW_SIZE = 32 * 1024;
+
+    // 0 stores the data as is, 1-3 take the longest match found at each position (greedy matching),
+    // 4-9 also try the next position before taking the match (lazy matching) and search the longer hash chains
+    const int MIN_LEVEL = 0;
+    const int MAX_LEVEL = 9;
+    const int DEFAULT_LEVEL = 6;
+
+    // Compresses the `size` bytes at the `data` into the DEFLATE blocks appended to the `output`.
+    // The `dictionarySize` bytes before the `data` (up to the WINDOW_SIZE) are the end of the preceding portion:
+    // the matches may refer to them, so the portions compressed in parallel lose almost nothing against the single stream.
+    // Unless `isLast`, the output ends with the empty stored block (the sync flush of zlib): it's byte-aligned
+    // and the next portion's blocks may follow it. The last portion ends with the final block
+    void compressPortion(const uchar *data, size_t size, size_t dictionarySize, int level, bool isLast, vector<uchar> &output);
+
+    // Reads the input as the stream of bits (the least significant bit of a byte first, as DEFLATE packs them)
+    // and the byte-aligned fields of the container around it
+    class BitReader {
+    public:
+        explicit BitReader(InputReader &reader);
+
+        BitReader(const BitReader &) = delete;
+        BitReader &operator=(const BitReader &) = delete;
+
+        // Up to 32 bits. Throws `invalid_argument` if the input ends earlier
+        uint32 readBits(uchar count);
+
+        // The bits up to the next byte boundary are skipped
+        void alignToByte();
+
+        // Byte-aligned: copies the next `size` bytes. Throws `invalid_argument` if the input ends earlier
+        void readBytes(uchar *target, size_t size);
+
+        // Byte-aligned: true if there is no more input
+        bool isEnd();
+
+        // The count of bytes read from the input so far
+        uint64 getInputSize() const;
+
+    private:
+        friend class Inflater;
+
+        InputReader &reader;
+        const uchar *data;
+        size_t size;
+        uint64 inputSize;
+
+        // The bits above the `bitsCount` may hold a copy of the next bytes, which are added again by the next refill
+        uint64 bits;
+        uchar bitsCount;
+
+        bool nextPortion();
+        // Makes at least 56 bits available unless the input ends
+        void refill();
+        void consume(uchar count);
+    };
+
+    // Decompresses a DEFLATE stream from the `reader` up to the end of its final block and passes the output
+    // to the `sink` in the portions of up to a few megabytes. The reader is left right after the final block.
+    // Throws `invalid_argument` if the data is corrupted or ends early
+    void inflate(BitReader &reader, const function<void (const uchar *data, size_t size)> &sink);
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <ostream>
+
+#include "../types.hpp"
+#include "../utils/hexadecimal.hpp"
+#include "../utils/base64.hpp"
+
+using namespace std;
+
+// The digest of any of the algorithms. The bytes are stored inline (in the order of the canonical hexadecimal form),
+// so the digests are passed around and formatted without the heap allocations
+class HashDigest {
+public:
+    static constexpr uchar MAX_SIZE = 64;
+    static constexpr uchar MAX_HEX_SIZE = MAX_SIZE * 2;
+    static constexpr uchar MAX_BASE64_SIZE = base64EncodedSize(MAX_SIZE);
+
+    HashDigest() : bytes {}, size(0) {}
+
+    // The digests of the particular algorithms are the fixed-size arrays (e.g. `md::Md5Digest`)
+    template <size_t SIZE>
+    HashDigest(const array<uchar, SIZE> &digest) : bytes {}, size(SIZE) {
+        static_assert(SIZE <= MAX_SIZE, "The digest is too large");
+        memcpy(bytes.data(), digest.data(), SIZE);
+    }
+
+    HashDigest(const uchar *data, uchar size) : bytes {}, size(min(size, MAX_SIZE)) {
+        memcpy(bytes.data(), data, this->size);
+    }
+
+    const uchar *data() const {
+        return bytes.data();
+    }
+
+    uchar getSize() const {
+        return size;
+    }
+
+    // Writes `getSize() * 2` characters into the `output`, returns the end of them
+    char *encodeHex(char *output) const {
+        return ::encodeHex(bytes.data(), size, output);
+    }
+
+    // Writes `base64EncodedSize(getSize())` characters into the `output`, returns the end of them
+    char *encodeBase64(char *output) const {
+        return ::encodeBase64(bytes.data(), size, output);
+    }
+
+    string toHex() const {
+        return ::toHex(bytes.data(), size);
+    }
+
+    bool operator==(const HashDigest &other) const {
+        return size == other.size && memcmp(bytes.data(), other.bytes.data(), size) == 0;
+    }
+
+    bool operator!=(const HashDigest &other) const {
+        return !(*this == other);
+    }
+
+private:
+    array<uchar, MAX_SIZE> bytes;
+    uchar size;
+};
+
+// Prints the hexadecimal form through the buffer on the stack
+inline ostream &operator<<(ostream &output, const HashDigest &digest) {
+    char hex[HashDigest::MAX_HEX_SIZE];
+    return output.write(hex, digest.encodeHex(hex) - hex);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <ostream>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+#include "aead.hpp"
+
+using namespace std;
+
+// The encrypted file is the header followed by the segments: the plaintext is split into the segments of the same size
+// (the last one may be shorter, and it's empty only if the whole plaintext is), each of them is encrypted on its own
+// and followed by its tag. The segment i starts at ENCRYPTION_HEADER_SIZE + i * (segment size + TAG_SIZE), so any of them
+// is decrypted without the others, and they are encrypted and decrypted in parallel.
+//
+// The header: "ZPYE", the version (1), the algorithm (see `aead::Algorithm`), log2 of the segment size, zero and 24 bytes
+// of the random salt. The key of the file is derived from the key and the salt (BLAKE3 in the key derivation mode),
+// so the nonces never repeat across the files: the nonce of a segment is its index (88-bit big endian) followed by 1 for the last
+// segment and 0 for the others, thus the reordered, removed and appended segments aren't authenticated. The header is
+// the associated data of each segment
+const uint32 ENCRYPTION_HEADER_SIZE = 32;
+
+const uint32 MIN_SEGMENT_SIZE = 4 * 1024;
+const uint32 MAX_SEGMENT_SIZE = 16 * 1024 * 1024;
+const uint32 DEFAULT_SEGMENT_SIZE = 64 * 1024;
+
+struct EncryptionOptions {
+    aead::Algorithm algorithm = aead::getPreferredAlgorithm();
+    // A power of two from MIN_SEGMENT_SIZE to MAX_SEGMENT_SIZE
+    uint32 segmentSize = DEFAULT_SEGMENT_SIZE;
+    // 0 means the count of hardware threads
+    uint32 threadsCount = 0;
+    InputOptions inputOptions;
+};
+
+struct DecryptionOptions {
+    // 0 means the count of hardware threads
+    uint32 threadsCount = 0;
+    InputOptions inputOptions;
+};
+
+struct EncryptionResult {
+    uint64 plaintextSize = 0;
+    uint64 ciphertextSize = 0;
+    aead::Algorithm algorithm = aead::Algorithm::ChaCha20Poly1305;
+    uint32 segmentSize = 0;
+};
+
+// Encrypts the file ("-" means the standard input) into the output. The segments are encrypted on the thread pool
+// while the next ones are read and written in order as soon as they are ready, so the memory doesn't depend on the size of
+// the file. Throws `invalid_argument` if the file can't be read, the output can't be written or the options are invalid
+EncryptionResult encryptFile(const string &filePath, ostream &output, const aead::Key &key, const EncryptionOptions &options = EncryptionOptions());
+
+// Decrypts the file ("-" means the standard input) into the output. Only the authenticated segments are written,
+// so if the file is corrupted, truncated or the key is wrong, the output ends before the first segment that isn't.
+// Throws `invalid_argument` then, or if the file can't be read or the output can't be written
+EncryptionResult decryptFile(const string &filePath, ostream &output, const aead::Key &key, const DecryptionOptions &options = DecryptionOptions());
+
+// The key file holds the 32 bytes of the key as they are or as 64 hexadecimal digits (the line break after them is ignored).
+// Throws `invalid_argument` if it can't be read or is neither of them
+aead::Key readKeyFile(const string &filePath);
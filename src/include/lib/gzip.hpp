@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <ostream>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+#include "deflate.hpp"
+#include "sha2.hpp"
+
+using namespace std;
+
+// The input is split into the blocks compressed in parallel (in the manner of pigz): each block is compressed on its own,
+// with the last 32 KiB of the previous block as the dictionary, and the blocks are byte-aligned by the sync flush,
+// so their outputs are simply concatenated into a single DEFLATE stream
+const uint32 DEFAULT_COMPRESSION_BLOCK_SIZE = 128 * 1024;
+const uint32 MIN_COMPRESSION_BLOCK_SIZE = deflate::WINDOW_SIZE;
+
+struct CompressionOptions {
+    // See `deflate::compressPortion`
+    int level = deflate::DEFAULT_LEVEL;
+    uint32 blockSize = DEFAULT_COMPRESSION_BLOCK_SIZE;
+    // 0 means the count of hardware threads
+    uint32 threadsCount = 0;
+    // The SHA-256 of the uncompressed data is computed while it's read
+    bool computeSha256 = false;
+    InputOptions inputOptions;
+};
+
+struct DecompressionOptions {
+    // The SHA-256 of the decompressed data is computed while it's written
+    bool computeSha256 = false;
+    InputOptions inputOptions;
+};
+
+struct CompressionResult {
+    uint64 uncompressedSize = 0;
+    uint64 compressedSize = 0;
+    // Set if requested by the options
+    sha2::Sha256Digest sha256 {};
+};
+
+// Compresses the file ("-" means the standard input) into the gzip format (RFC 1952) written to the output.
+// The blocks are compressed on the thread pool while the next ones are read, and written in order as soon as they are ready.
+// Throws `invalid_argument` if the file can't be read, the output can't be written or the options are invalid
+CompressionResult compressFile(const string &filePath, ostream &output, const CompressionOptions &options = CompressionOptions());
+
+// Decompresses the gzip file ("-" means the standard input), including the concatenated ones, into the output.
+// The CRC-32 and the size of each member are verified. Throws `invalid_argument` if the file can't be read,
+// isn't a valid gzip file or the output can't be written
+CompressionResult decompressFile(const string &filePath, ostream &output, const DecompressionOptions &options = DecompressionOptions());
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "../types.hpp"
+#include "algorithms.hpp"
+#include "digest.hpp"
+
+using namespace std;
+
+// The cache file starts with the magic and the version, followed by the count of entries (uint64)
+// and the entries of 112 bytes sorted by (device, inode, algorithm). The fields are stored in the native byte order:
+// the devices and inodes make sense on this machine only anyway
+const char HASH_CACHE_MAGIC[4] = { 'Z', 'H', 'C', 'F' };
+const uint32 HASH_CACHE_VERSION = 1;
+
+// The oldest entries are dropped once the cache grows larger
+const size_t HASH_CACHE_MAX_ENTRIES_COUNT = 1 << 21;
+
+// The files modified this recently aren't cached: their next modification may keep the same timestamp
+const uint64 HASH_CACHE_MIN_FILE_AGE_NS = 2000000000;
+
+// Identifies the content of the file: any modification changes the size or the modification time
+struct FileIdentity {
+    uint64 device;
+    uint64 inode;
+    uint64 size;
+    uint64 modificationTimeNs;
+
+    bool operator==(const FileIdentity &other) const {
+        return device == other.device && inode == other.inode && size == other.size && modificationTimeNs == other.modificationTimeNs;
+    }
+};
+
+// Returns false if the file can't be cached: it doesn't exist, isn't a regular file or is the standard input ("-")
+bool getFileIdentity(const string &filePath, FileIdentity &identity);
+
+// The persistent cache of digests keyed by the identities of files and the algorithms.
+// The cache file is memory-mapped on construction and is never modified in place: `save` writes the new file
+// and renames it over the old one, so the concurrent processes always see the complete file
+class HashCache {
+public:
+    // The file may not exist yet. In the verification mode nothing is found in the cache,
+    // while the digests being stored are compared with the cached ones.
+    // Throws `invalid_argument` if the existing file isn't a valid cache
+    HashCache(const string &filePath, bool verify = false);
+    ~HashCache();
+
+    HashCache(const HashCache &) = delete;
+    HashCache &operator=(const HashCache &) = delete;
+
+    // Returns true if the digests of all the `algorithms` are cached, they are written into the `digests` in the same order
+    bool find(const FileIdentity &identity, const vector<const HashAlgorithm *> &algorithms, HashDigest *digests) const;
+
+    // Keeps the digests of the file (in the order of the `algorithms`) until `save`.
+    // They are skipped if the file has changed since its `identity` has been taken or it's modified too recently.
+    // In the verification mode, throws `invalid_argument` if any of them doesn't match the cached one (it's replaced anyway).
+    // May be called concurrently
+    void store(const string &filePath, const FileIdentity &identity, const vector<const HashAlgorithm *> &algorithms, const HashDigest *digests);
+
+    // Merges the stored digests into the cache file under the exclusive lock (`<file>.lock`), so the digests stored
+    // by the concurrent processes aren't lost. Throws `invalid_argument` if the file can't be written
+    void save();
+
+    // Defined in the implementation file along with the format
+    struct Entry;
+
+private:
+    string filePath;
+    bool verify;
+
+    const uchar *mapping;
+    uint64 mappingSize;
+    const Entry *entries;
+    uint64 entriesCount;
+
+    mutex lock;
+    vector<Entry> storedEntries;
+
+    const Entry *findEntry(const FileIdentity &identity, uint32 algorithmId) const;
+};
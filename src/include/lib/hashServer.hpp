@@ -0,0 +1,119 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <functional>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+#include "../utils/threadPool.hpp"
+
+using namespace std;
+
+// The protocol of `zippy serve` over the Unix domain stream socket. All the integers are little-endian.
+//
+// The client sends the frames of requests, each frame is a batch of any count of them:
+//   uint32 size (of the rest of the frame), uint32 requestsCount, and for each request:
+//   uint64 id, uint8 source (SERVE_SOURCE_*), uint8 algorithmsCount, algorithmsCount x (uint8 size, name),
+//   uint32 size, data (the path of the file, the message itself, or nothing for the descriptor)
+// The descriptors are passed by SCM_RIGHTS along with the frame, the requests of the descriptor source take them in order.
+//
+// The server sends a response per request as soon as it's ready, so the responses come out of order:
+//   uint32 size (of the rest of the frame), uint64 id, uint8 status (SERVE_STATUS_*), and
+//   uint8 digestsCount, digestsCount x (uint8 size, digest) in the order of the algorithms if the status is OK,
+//   uint16 size, the error message otherwise
+const uchar SERVE_SOURCE_PATH = 0;
+const uchar SERVE_SOURCE_DESCRIPTOR = 1;
+const uchar SERVE_SOURCE_INLINE = 2;
+
+const uchar SERVE_STATUS_OK = 0;
+const uchar SERVE_STATUS_UNKNOWN_ALGORITHM = 1;
+const uchar SERVE_STATUS_INVALID_REQUEST = 2;
+const uchar SERVE_STATUS_IO_ERROR = 3;
+// The request hasn't been admitted: the server has too many requests in progress, it may be retried later
+const uchar SERVE_STATUS_BUSY = 4;
+const uchar SERVE_STATUS_INTERNAL_ERROR = 5;
+
+const uint32 DEFAULT_SERVE_MAX_QUEUED_REQUESTS = 4096;
+const uint32 DEFAULT_SERVE_MAX_CONNECTION_REQUESTS = 256;
+const uint32 DEFAULT_SERVE_MAX_FRAME_SIZE = 64 * 1024 * 1024;
+const uint32 DEFAULT_SERVE_MAX_CONNECTIONS = 64;
+
+// The inline messages up to this size with a single algorithm are grouped by the algorithm within a frame
+// and hashed by the multi-buffer cores, up to `SERVE_GROUP_MAX_REQUESTS_COUNT` messages at a time
+const uint32 SERVE_GROUP_MAX_MESSAGE_SIZE = 64 * 1024;
+const size_t SERVE_GROUP_MAX_REQUESTS_COUNT = 64;
+
+struct ServeOptions {
+    string socketPath;
+    // The count of workers hashing the requests of all the connections, 0 means the count of hardware threads
+    uint32 threadsCount = 0;
+    // The admission control: the requests beyond this count (being hashed or waiting for a worker, over all the connections)
+    // are answered with SERVE_STATUS_BUSY right away instead of growing the queue and the latency of everyone
+    uint32 maxQueuedRequests = DEFAULT_SERVE_MAX_QUEUED_REQUESTS;
+    // The requests of a single connection whose responses haven't been sent yet. Once reached, the connection isn't read
+    // until some of them are sent, so the client that doesn't read the responses can't make the server buffer them
+    uint32 maxConnectionRequests = DEFAULT_SERVE_MAX_CONNECTION_REQUESTS;
+    // The larger frames close the connection
+    uint32 maxFrameSize = DEFAULT_SERVE_MAX_FRAME_SIZE;
+    // The connections beyond this count are closed right after they are accepted
+    uint32 maxConnections = DEFAULT_SERVE_MAX_CONNECTIONS;
+    InputOptions inputOptions;
+    // Reports the failures of the connections (e.g. the malformed frames), which close them. May be called concurrently
+    function<void (const string &message)> errorHandler;
+};
+
+// The daemon hashing the requests of many clients on the shared work-stealing thread pool.
+// Each connection has a reader and a writer thread, the hashing itself runs on the pool: the large files and the descriptors
+// as the long tasks, so they can't hold up the small requests of the other clients
+class HashServer {
+public:
+    // Binds the socket (replacing the stale one, i.e. the socket file nobody listens on).
+    // Throws `invalid_argument` if the socket can't be bound or another server listens on it
+    explicit HashServer(const ServeOptions &options);
+
+    // Removes the socket file
+    ~HashServer();
+
+    HashServer(const HashServer &) = delete;
+    HashServer &operator=(const HashServer &) = delete;
+
+    // Accepts the connections until `stop` is called, then waits for the responses to all the admitted requests
+    void run();
+
+    // May be called from any thread and from the signal handler
+    void stop();
+
+private:
+    struct Request;
+    class Connection;
+
+    ServeOptions options;
+    int listenFd;
+    // `stop` writes into the pipe to wake up `run`
+    int stopPipe[2];
+    ThreadPool pool;
+
+    mutex lock;
+    condition_variable isConnectionClosed;
+    // All are guarded by the `lock`. Each connection owns its thread, which moves itself to the `finishedThreads`
+    // at the end, so `run` joins every thread before it returns and the server never outlives them
+    unordered_map<Connection *, thread> connections;
+    vector<thread> finishedThreads;
+    uint32 queuedRequestsCount;
+
+    void serveConnection(Connection *connection);
+    void handleFrame(Connection &connection, const shared_ptr<vector<uchar>> &frame);
+    // The tasks keep the frame alive: the paths and the messages point into it
+    void submitRequest(Connection &connection, const shared_ptr<vector<uchar>> &frame, Request &&request);
+    void submitGroup(Connection &connection, const shared_ptr<vector<uchar>> &frame, vector<Request> &&group);
+    void joinFinishedThreads();
+    bool admitRequest();
+    void completeRequests(uint32 count);
+    void reportError(const string &message);
+};
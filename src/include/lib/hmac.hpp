@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+#include "../types.hpp"
+#include "sha2.hpp"
+
+using namespace std;
+
+namespace sha2 {
+
+    // HMAC (RFC 2104) over the SHA-2 variants. The key is absorbed once, on construction: the states after the key block
+    // XORed with the inner and the outer pads (the midstates) are kept, so each message costs its own blocks
+    // and the two final ones only. The message may be passed in portions of any size via `update`.
+    // Instantiated for the variants of sha2.hpp
+    template <typename Variant>
+    class HmacHasher {
+    public:
+        typedef typename Variant::Word Word;
+        typedef typename Sha2Hasher<Variant>::Digest Digest;
+
+        static constexpr uchar BLOCK_SIZE_IN_BYTES = Sha2Family<Word>::BLOCK_SIZE_IN_BYTES;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = Variant::DIGEST_SIZE_IN_BYTES;
+
+        // The key of any size: the one longer than the block is hashed first.
+        // Throws `invalid_argument` if the forced implementation isn't supported by the CPU
+        HmacHasher(const uchar *key, size_t keySize);
+
+        // The midstates are wiped
+        ~HmacHasher();
+
+        HmacHasher(const HmacHasher &) = delete;
+        HmacHasher &operator=(const HmacHasher &) = delete;
+
+        // Drops all the processed data, the key stays
+        void reset();
+
+        void update(const uchar *data, size_t size);
+
+        // Returns the MAC, the hasher is reset afterwards and may be reused for the next message under the same key
+        Digest final();
+
+        // The states after the key block XORed with the inner and the outer pads (8 words each)
+        const Word *getInnerState() const;
+        const Word *getOuterState() const;
+
+    private:
+        Word innerState[8];
+        Word outerState[8];
+        Sha2Hasher<Variant> hasher;
+    };
+
+    typedef HmacHasher<Sha256Variant> HmacSha256Hasher;
+    typedef HmacHasher<Sha512Variant> HmacSha512Hasher;
+
+    // The MACs of many messages under the same key. When the CPU has the suitable SIMD instructions, the small messages
+    // are processed in the lanes of the multi-buffer core: the inner hashes first, then the outer ones over them.
+    // The MACs are returned in the order of the `messages`
+    template <typename Variant>
+    vector<typename HmacHasher<Variant>::Digest> macBuffers(const uchar *key, size_t keySize, const vector<ByteView> &messages);
+
+    // HKDF (RFC 5869): the pseudorandom key is extracted from the input key material by HMAC under the salt
+    // (the empty salt means the zeroes), then expanded into `size` bytes of the output bound to the `info`.
+    // Throws `invalid_argument` if the `size` exceeds 255 digests
+    template <typename Variant>
+    typename HmacHasher<Variant>::Digest hkdfExtract(const uchar *salt, size_t saltSize, const uchar *keyMaterial, size_t keyMaterialSize);
+
+    template <typename Variant>
+    void hkdfExpand(const uchar *key, size_t keySize, const uchar *info, size_t infoSize, uchar *output, size_t size);
+
+    template <typename Variant>
+    void hkdf(
+        const uchar *salt, size_t saltSize, const uchar *keyMaterial, size_t keyMaterialSize,
+        const uchar *info, size_t infoSize, uchar *output, size_t size
+    );
+
+    // PBKDF2 (RFC 8018) with HMAC as the pseudorandom function. Each iteration costs two blocks from the midstates.
+    // The output blocks don't depend on each other, so when the output is longer than a digest,
+    // they are iterated in the lanes of the multi-buffer core at once.
+    // Throws `invalid_argument` if the `iterations` is 0 or the `size` is 0
+    template <typename Variant>
+    void pbkdf2(const uchar *password, size_t passwordSize, const uchar *salt, size_t saltSize, uint32 iterations, uchar *output, size_t size);
+
+    // The keys of many passwords at once, each with its own salt (the count of `salts` is the count of `passwords`):
+    // the output blocks of all of them share the lanes. The key of the password `i` is written at `outputs + i * size`
+    template <typename Variant>
+    void pbkdf2Batch(const vector<ByteView> &passwords, const vector<ByteView> &salts, uint32 iterations, uchar *outputs, size_t size);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../../types.hpp"
+
+// The cores of AES-256-GCM shared between the scalar implementation and the accelerated kernels
+namespace aes {
+    namespace _aes {
+        const uchar BLOCK_SIZE_IN_BYTES = 16;
+        const uchar ROUNDS_COUNT = 14;
+        // The expanded key: the round keys one after another, in the byte order the AES-NI instructions take them
+        const uint32 ROUND_KEYS_SIZE = (ROUNDS_COUNT + 1) * BLOCK_SIZE_IN_BYTES;
+        // The GHASH of this many blocks is reduced once (their products with H^8..H^1 are summed first)
+        const uchar HASH_KEY_POWERS_COUNT = 8;
+
+        // The kernels below are available on x86 only, with AES-NI, PCLMULQDQ and SSE4.1
+
+        // The powers H^1..H^8 of the hash key in the form the kernels multiply them (16 bytes each)
+        void initializeHashKeyPowersPclmul(const uchar *hashKey, uchar *hashKeyPowers);
+
+        // Absorbs the whole blocks into the GHASH `state` (16 bytes in the order of the specification)
+        void ghashBlocksPclmul(const uchar *hashKeyPowers, uchar *state, const uchar *data, size_t blocksCount);
+
+        // The counter mode from the `counterBlock` (the nonce and the 32-bit big endian counter) and the GHASH of
+        // the ciphertext: the output when encrypting, the input otherwise. The last block may be incomplete,
+        // it's zero-padded for GHASH
+        void cryptAesNi(
+            const uchar *roundKeys, const uchar *hashKeyPowers, const uchar *counterBlock,
+            const uchar *input, uchar *output, size_t size, bool isEncrypting, uchar *state
+        );
+
+        void encryptBlockAesNi(const uchar *roundKeys, const uchar *input, uchar *output);
+    }
+}
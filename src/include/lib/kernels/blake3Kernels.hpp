@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../../types.hpp"
+
+// The cores of BLAKE3 shared between the scalar implementation and the accelerated kernels
+namespace blake3 {
+    namespace _blake3 {
+        const uint32 CHUNK_SIZE_IN_BYTES = 1024;
+        const uchar BLOCK_SIZE_IN_BYTES = 64;
+        const uchar OUTPUT_SIZE_IN_BYTES = 32;
+        const uchar ROUNDS_COUNT = 7;
+        // The count of lanes of the widest core
+        const uchar MAX_LANES = 16;
+
+        // The domain separation flags of the compression function
+        const uchar CHUNK_START = 1 << 0;
+        const uchar CHUNK_END = 1 << 1;
+        const uchar PARENT = 1 << 2;
+        const uchar ROOT = 1 << 3;
+        const uchar KEYED_HASH = 1 << 4;
+        const uchar DERIVE_KEY_CONTEXT = 1 << 5;
+        const uchar DERIVE_KEY_MATERIAL = 1 << 6;
+
+        // The same as the initial hash values of SHA-256
+        alignas(32) inline constexpr uint32 IV[] = {
+            0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+        };
+
+        // The order of the message words used by each round (the permutation is applied once per round)
+        inline constexpr uchar MESSAGE_SCHEDULE[ROUNDS_COUNT][16] = {
+            { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+            { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+            { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+            { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+            { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+            { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+            { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 }
+        };
+
+        // The multi-lane cores: each SIMD lane compresses its own input (a chunk or a pair of chaining values of a parent).
+        // Each input is `blocksCount` consecutive blocks starting from `inputs[lane]`. The `counter` of the lane is increased
+        // by the lane index if `incrementCounter` is set. The first block gets the `startFlags`, the last one the `endFlags`.
+        // The chaining values of lanes are written to `output` one after another (32 bytes each)
+        typedef void HashLanesFunction (
+            const uchar *const *inputs, uchar blocksCount, const uint32 *key, uint64 counter, bool incrementCounter,
+            uchar flags, uchar startFlags, uchar endFlags, uchar *output
+        );
+
+        // 4 lanes, available on x86 only
+        void hashLanesX4Ssse3(
+            const uchar *const *inputs, uchar blocksCount, const uint32 *key, uint64 counter, bool incrementCounter,
+            uchar flags, uchar startFlags, uchar endFlags, uchar *output
+        );
+
+        // 8 lanes, available on x86 only
+        void hashLanesX8Avx2(
+            const uchar *const *inputs, uchar blocksCount, const uint32 *key, uint64 counter, bool incrementCounter,
+            uchar flags, uchar startFlags, uchar endFlags, uchar *output
+        );
+
+        // 16 lanes, available on x86 only
+        void hashLanesX16Avx512(
+            const uchar *const *inputs, uchar blocksCount, const uint32 *key, uint64 counter, bool incrementCounter,
+            uchar flags, uchar startFlags, uchar endFlags, uchar *output
+        );
+
+        // Picks the multi-lane core according to the CPU features (or the forced implementation).
+        // Returns nullptr if there is no suitable core, the inputs are compressed one by one then
+        HashLanesFunction *selectHashLanesFunction(uchar &lanesCount);
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+// The generic rounds of the BLAKE3 compression function, fully unrolled at compile time. The words of the state are
+// either the plain 32-bit words (the scalar core) or the vectors of the multi-lane cores, whose elements belong
+// to the different chunks (or parents) of the tree. This header is included into the instruction set specific regions
+// (see `ZIPPY_BEGIN_TARGET_REGION`) the same way as multiBufferRounds.hpp, thus it must be included after <utility>
+// and blake3Kernels.hpp.
+//
+// The `Ops` structure provides the vector type and the operations over the vectors of 32-bit words:
+//   Vector, set1, add, bitXor, rotateRight<n>
+//   and for the multi-lane cores LANES, load, store and loadWords, which loads the sixteen words of the block
+//   of each lane transposed (words[i] holds the word i of all lanes)
+
+namespace {
+
+    template <typename Ops>
+    inline void blake3G(
+        typename Ops::Vector &a, typename Ops::Vector &b, typename Ops::Vector &c, typename Ops::Vector &d,
+        typename Ops::Vector x, typename Ops::Vector y
+    ) {
+        a = Ops::add(Ops::add(a, b), x);
+        d = Ops::template rotateRight<16>(Ops::bitXor(d, a));
+        c = Ops::add(c, d);
+        b = Ops::template rotateRight<12>(Ops::bitXor(b, c));
+        a = Ops::add(Ops::add(a, b), y);
+        d = Ops::template rotateRight<8>(Ops::bitXor(d, a));
+        c = Ops::add(c, d);
+        b = Ops::template rotateRight<7>(Ops::bitXor(b, c));
+    }
+
+    // Mixes the columns of the 4 x 4 state, then its diagonals
+    template <typename Ops, size_t round>
+    inline void blake3Round(typename Ops::Vector *v, const typename Ops::Vector *m) {
+        constexpr const uchar *s = blake3::_blake3::MESSAGE_SCHEDULE[round];
+        blake3G<Ops>(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]]);
+        blake3G<Ops>(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]]);
+        blake3G<Ops>(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]]);
+        blake3G<Ops>(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]]);
+        blake3G<Ops>(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]]);
+        blake3G<Ops>(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+        blake3G<Ops>(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]]);
+        blake3G<Ops>(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]]);
+    }
+
+    template <typename Ops, size_t... rounds>
+    inline void blake3Rounds(typename Ops::Vector *v, const typename Ops::Vector *m, index_sequence<rounds...>) {
+        (blake3Round<Ops, rounds>(v, m), ...);
+    }
+
+    // The full blocks of `Ops::LANES` inputs at once (see `HashLanesFunction`)
+    template <typename Ops>
+    void blake3HashLanes(
+        const uchar *const *inputs, uchar blocksCount, const uint32 *key, uint64 counter, bool incrementCounter,
+        uchar flags, uchar startFlags, uchar endFlags, uchar *output
+    ) {
+        typedef typename Ops::Vector Vector;
+        using namespace blake3::_blake3;
+
+        uint32 counterLow[Ops::LANES], counterHigh[Ops::LANES];
+        for (uchar lane = 0; lane < Ops::LANES; lane++) {
+            uint64 laneCounter = counter + (incrementCounter ? lane : 0);
+            counterLow[lane] = uint32(laneCounter);
+            counterHigh[lane] = uint32(laneCounter >> 32);
+        }
+
+        Vector h[8];
+        for (uchar i = 0; i < 8; i++) {
+            h[i] = Ops::set1(key[i]);
+        }
+
+        uchar blockFlags = flags | startFlags;
+        for (uchar block = 0; block < blocksCount; block++) {
+            if (block + 1 == blocksCount) {
+                blockFlags |= endFlags;
+            }
+
+            Vector m[16];
+            Ops::loadWords(inputs, block * BLOCK_SIZE_IN_BYTES, m, false); // BLAKE3 words are little endian
+
+            Vector v[16] = {
+                h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+                Ops::set1(IV[0]), Ops::set1(IV[1]), Ops::set1(IV[2]), Ops::set1(IV[3]),
+                Ops::load(counterLow), Ops::load(counterHigh), Ops::set1(BLOCK_SIZE_IN_BYTES), Ops::set1(blockFlags)
+            };
+            blake3Rounds<Ops>(v, m, make_index_sequence<ROUNDS_COUNT>());
+            for (uchar i = 0; i < 8; i++) {
+                h[i] = Ops::bitXor(v[i], v[i + 8]);
+            }
+            blockFlags = flags;
+        }
+
+        // The chaining values are transposed back, each lane gets its own 32 bytes
+        uint32 words[8][Ops::LANES];
+        for (uchar i = 0; i < 8; i++) {
+            Ops::store(words[i], h[i]);
+        }
+        for (uchar lane = 0; lane < Ops::LANES; lane++) {
+            for (uchar i = 0; i < 8; i++) {
+                uchar *target = output + lane * OUTPUT_SIZE_IN_BYTES + i * 4;
+                target[0] = uchar(words[i][lane]);
+                target[1] = uchar(words[i][lane] >> 8);
+                target[2] = uchar(words[i][lane] >> 16);
+                target[3] = uchar(words[i][lane] >> 24);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "../../types.hpp"
+
+// The cores of ChaCha20 shared between the scalar implementation and the accelerated kernels
+namespace chacha20 {
+    namespace _chacha20 {
+        const uchar BLOCK_SIZE_IN_BYTES = 64;
+        const uchar DOUBLE_ROUNDS_COUNT = 10;
+
+        // "expand 32-byte k"
+        inline constexpr uint32 CONSTANTS[4] = { 0x61707865, 0x3320646E, 0x79622D32, 0x6B206574 };
+
+        // The multi-block cores: each SIMD lane computes its own block of the key stream. The `state` is the sixteen words
+        // of the first block, the counter (the word 12) is increased by one for each next block. The key stream of
+        // `groupsCount` groups of the lanes' count of consecutive blocks is XORed with the `input` into the `output`
+        typedef void XorBlocksFunction(const uint32 *state, const uchar *input, uchar *output, size_t groupsCount);
+
+        void xorBlocksScalar(const uint32 *state, const uchar *input, uchar *output, size_t blocksCount);
+
+        // 4 blocks at once, available on x86 only
+        void xorBlocksX4Ssse3(const uint32 *state, const uchar *input, uchar *output, size_t groupsCount);
+
+        // 8 blocks at once, available on x86 only
+        void xorBlocksX8Avx2(const uint32 *state, const uchar *input, uchar *output, size_t groupsCount);
+
+        // Picks the widest core according to the CPU features (or the forced implementation), the scalar one has 1 lane
+        XorBlocksFunction *selectXorBlocksFunction(uchar &lanesCount);
+    }
+}
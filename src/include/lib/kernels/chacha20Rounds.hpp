@@ -0,0 +1,69 @@
+#pragma once
+
+// The generic rounds of ChaCha20. The words of the state are either the plain 32-bit words (the scalar core) or the vectors
+// of the multi-block cores, whose elements belong to the consecutive blocks of the key stream. This header is included
+// into the instruction set specific regions (see `ZIPPY_BEGIN_TARGET_REGION`) the same way as blake3Rounds.hpp,
+// thus it must be included after chacha20Kernels.hpp.
+//
+// The `Ops` structure provides the vector type and the operations over the vectors of 32-bit words:
+//   Vector, LANES, load, set1, add, bitXor, rotateLeft<n>
+//   and xorBlocks, which transposes the sixteen words of the lanes back into the blocks (words[i] holds the word i
+//   of all lanes) and XORs them with the input
+
+namespace {
+
+    template <typename Ops>
+    inline void chacha20QuarterRound(typename Ops::Vector &a, typename Ops::Vector &b, typename Ops::Vector &c, typename Ops::Vector &d) {
+        a = Ops::add(a, b); d = Ops::template rotateLeft<16>(Ops::bitXor(d, a));
+        c = Ops::add(c, d); b = Ops::template rotateLeft<12>(Ops::bitXor(b, c));
+        a = Ops::add(a, b); d = Ops::template rotateLeft<8>(Ops::bitXor(d, a));
+        c = Ops::add(c, d); b = Ops::template rotateLeft<7>(Ops::bitXor(b, c));
+    }
+
+    // Mixes the columns of the 4 x 4 state, then its diagonals
+    template <typename Ops>
+    inline void chacha20DoubleRound(typename Ops::Vector *x) {
+        chacha20QuarterRound<Ops>(x[0], x[4], x[8], x[12]);
+        chacha20QuarterRound<Ops>(x[1], x[5], x[9], x[13]);
+        chacha20QuarterRound<Ops>(x[2], x[6], x[10], x[14]);
+        chacha20QuarterRound<Ops>(x[3], x[7], x[11], x[15]);
+        chacha20QuarterRound<Ops>(x[0], x[5], x[10], x[15]);
+        chacha20QuarterRound<Ops>(x[1], x[6], x[11], x[12]);
+        chacha20QuarterRound<Ops>(x[2], x[7], x[8], x[13]);
+        chacha20QuarterRound<Ops>(x[3], x[4], x[9], x[14]);
+    }
+
+    // The `groupsCount` groups of `Ops::LANES` blocks (see `XorBlocksFunction`)
+    template <typename Ops>
+    void chacha20XorBlocks(const uint32 *state, const uchar *input, uchar *output, size_t groupsCount) {
+        typedef typename Ops::Vector Vector;
+        using namespace chacha20::_chacha20;
+        const size_t groupSize = size_t(Ops::LANES) * BLOCK_SIZE_IN_BYTES;
+
+        Vector initial[16];
+        for (uchar i = 0; i < 16; i++) {
+            initial[i] = Ops::set1(state[i]);
+        }
+
+        uint32 counters[Ops::LANES];
+        for (size_t group = 0; group < groupsCount; group++, input += groupSize, output += groupSize) {
+            for (uchar lane = 0; lane < Ops::LANES; lane++) {
+                counters[lane] = state[12] + uint32(group * Ops::LANES + lane);
+            }
+            initial[12] = Ops::load(counters);
+
+            Vector x[16];
+            for (uchar i = 0; i < 16; i++) {
+                x[i] = initial[i];
+            }
+            for (uchar round = 0; round < DOUBLE_ROUNDS_COUNT; round++) {
+                chacha20DoubleRound<Ops>(x);
+            }
+            for (uchar i = 0; i < 16; i++) {
+                x[i] = Ops::add(x[i], initial[i]);
+            }
+            Ops::xorBlocks(x, input, output);
+        }
+    }
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+
+#include "../../types.hpp"
+
+using namespace std;
+
+// The cores of CRC-32 and CRC-32C shared between the table-driven implementation and the accelerated kernels.
+// The cores take and return the register of the CRC, without the initial and the final inversions
+namespace crc32 {
+    namespace _crc32 {
+        // The reflected polynomials of CRC-32 (ISO-HDLC) and CRC-32C (Castagnoli)
+        const uint32 POLYNOMIAL = 0xEDB88320;
+        const uint32 CASTAGNOLI_POLYNOMIAL = 0x82F63B78;
+
+        typedef uint32 UpdateFunction (uint32 crc, const uchar *data, size_t size);
+
+        // The product of the polynomials modulo the CRC polynomial (in the reflected bit order: the 1 is 1 << 31)
+        constexpr uint32 multiplyModulo(uint32 first, uint32 second, uint32 polynomial) {
+            uint32 product = 0;
+            for (uint32 mask = 1u << 31; mask != 0; mask >>= 1) {
+                if (first & mask) {
+                    product ^= second;
+                }
+                second = second & 1 ? (second >> 1) ^ polynomial : second >> 1;
+            }
+            return product;
+        }
+
+        // x^exponent modulo the polynomial, by squaring
+        constexpr uint32 powerModulo(uint64 exponent, uint32 polynomial) {
+            uint32 result = 1u << 31;
+            uint32 square = 1u << 30;
+            for (; exponent != 0; exponent >>= 1) {
+                if (exponent & 1) {
+                    result = multiplyModulo(result, square, polynomial);
+                }
+                square = multiplyModulo(square, square, polynomial);
+            }
+            return result;
+        }
+
+        // Appending `size` zero bytes multiplies the register by x^(8 * size). The table k gives the product
+        // for the byte k of the register, so the shift costs 4 lookups
+        typedef array<array<uint32, 256>, 4> ShiftTables;
+
+        constexpr ShiftTables generateShiftTables(uint64 size, uint32 polynomial) {
+            ShiftTables tables {};
+            uint32 shift = powerModulo(8 * size, polynomial);
+            for (uint32 k = 0; k < 4; k++) {
+                for (uint32 byte = 0; byte < 256; byte++) {
+                    tables[k][byte] = multiplyModulo(shift, byte << (8 * k), polynomial);
+                }
+            }
+            return tables;
+        }
+
+        inline uint32 shiftRegister(const ShiftTables &tables, uint32 crc) {
+            return tables[0][crc & 0xFF] ^ tables[1][(crc >> 8) & 0xFF] ^ tables[2][(crc >> 16) & 0xFF] ^ tables[3][crc >> 24];
+        }
+
+        // The slice-by-8 cores
+        uint32 updateScalar(uint32 crc, const uchar *data, size_t size);
+        uint32 updateCastagnoliScalar(uint32 crc, const uchar *data, size_t size);
+
+        // The accelerated kernels are available on x86 only, on the other platforms they fall back to the scalar cores.
+        // Folds 64 bytes at a time in four 128-bit accumulators by PCLMULQDQ, then reduces them by the Barrett reduction
+        uint32 updatePclmul(uint32 crc, const uchar *data, size_t size);
+
+        // The same folding with VPCLMULQDQ, 256 bytes at a time in four 512-bit accumulators
+        uint32 updateAvx512(uint32 crc, const uchar *data, size_t size);
+
+        // The crc32 instruction of SSE4.2 over three interleaved streams (its latency is 3 cycles, the throughput is 1),
+        // whose registers are merged by the shift tables
+        uint32 updateCastagnoliSse42(uint32 crc, const uchar *data, size_t size);
+
+        // Pick the fastest core supported by the CPU, or the forced one (see `forceImplementation`)
+        UpdateFunction *selectUpdateFunction();
+        UpdateFunction *selectCastagnoliUpdateFunction();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <utility>
+
+#include "../../types.hpp"
+
+using namespace std;
+
+// The Keccak-f[1600] permutation shared between the scalar sponge and the multi-buffer kernels.
+// The state is 5 x 5 lanes of 64 bits, the lane (x, y) is stored at the index x + 5 * y
+namespace sha3 {
+    namespace _keccak {
+        const uchar STATE_WORDS = 25;
+        const uchar ROUNDS_COUNT = 24;
+
+        alignas(64) inline constexpr uint64 ROUND_CONSTANTS[] = {
+            0x0000000000000001, 0x0000000000008082, 0x800000000000808A, 0x8000000080008000,
+            0x000000000000808B, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+            0x000000000000008A, 0x0000000000000088, 0x0000000080008009, 0x000000008000000A,
+            0x000000008000808B, 0x800000000000008B, 0x8000000000008089, 0x8000000000008003,
+            0x8000000000008002, 0x8000000000000080, 0x000000000000800A, 0x800000008000000A,
+            0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+        };
+
+        // The rotation of each lane by the rho step and its new place after the pi step
+        inline constexpr uchar RHO[] = { 0, 1, 62, 28, 27, 36, 44, 6, 55, 20, 3, 10, 43, 25, 39, 41, 45, 15, 21, 8, 18, 2, 61, 56, 14 };
+        inline constexpr uchar PI[] = { 0, 10, 20, 5, 15, 16, 1, 11, 21, 6, 7, 17, 2, 12, 22, 23, 8, 18, 3, 13, 14, 24, 9, 19, 4 };
+
+        // The multi-buffer cores: each SIMD lane absorbs its own message.
+        // The states of lanes are stored transposed: `states[word * lanesCount + lane]`.
+        // Each lane absorbs `blocksCount` consecutive blocks of `rate` bytes starting from `data[lane]`
+        typedef void MultiBufferBlocksFunction (uint64 *states, const uchar *const *data, uint64 blocksCount, uchar rate);
+
+        // 4 lanes, available on x86 only
+        void absorbBlocksX4Avx2(uint64 *states, const uchar *const *data, uint64 blocksCount, uchar rate);
+
+        // 8 lanes, available on x86 only
+        void absorbBlocksX8Avx512(uint64 *states, const uchar *const *data, uint64 blocksCount, uchar rate);
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+// The generic rounds of Keccak-f[1600], fully unrolled at compile time. The lanes are either the plain 64-bit words
+// (the scalar core) or the vectors of the multi-buffer cores, whose elements belong to the states of different messages.
+// This header is included into the instruction set specific regions (see `ZIPPY_BEGIN_TARGET_REGION`) the same way
+// as multiBufferRounds.hpp, thus it must be included after <utility> and keccakKernels.hpp.
+//
+// The `Ops` structure provides the lane type and the operations over the lanes:
+//   Vector, set1, bitXor, bitXor3, bitAnd, bitOr, bitNot, chi (x ^ (~y & z)), rotateLeft<n>
+//   and LANE_COMPLEMENTING. With the lane complementing, the lanes (1, 0), (2, 0), (3, 1), (2, 2), (2, 3) and (0, 4)
+//   are kept inverted between the rounds (the "bebigokimisa" pattern of the Keccak team), which turns all but one NOT
+//   of each plane of the chi step into the ORs. It pays off on the cores that lack the and-not instruction
+
+namespace {
+
+    // The lanes that are kept inverted with the lane complementing
+    inline constexpr bool isLaneComplemented(size_t lane) {
+        return lane == 1 || lane == 2 || lane == 8 || lane == 12 || lane == 17 || lane == 20;
+    }
+
+    template <typename Ops, size_t i>
+    inline void keccakRhoPi(typename Ops::Vector *B, const typename Ops::Vector *A, const typename Ops::Vector *D) {
+        typename Ops::Vector lane = Ops::bitXor(A[i], D[i % 5]);
+        if constexpr (sha3::_keccak::RHO[i] == 0) {
+            B[sha3::_keccak::PI[i]] = lane;
+        } else {
+            B[sha3::_keccak::PI[i]] = Ops::template rotateLeft<sha3::_keccak::RHO[i]>(lane);
+        }
+    }
+
+    template <typename Ops, size_t... lanes>
+    inline void keccakRhoPiLanes(typename Ops::Vector *B, const typename Ops::Vector *A, const typename Ops::Vector *D, index_sequence<lanes...>) {
+        (keccakRhoPi<Ops, lanes>(B, A, D), ...);
+    }
+
+    template <typename Ops, size_t i>
+    inline void keccakChi(typename Ops::Vector *A, const typename Ops::Vector *B) {
+        A[i] = Ops::chi(B[i], B[i / 5 * 5 + (i + 1) % 5], B[i / 5 * 5 + (i + 2) % 5]);
+    }
+
+    template <typename Ops, size_t... lanes>
+    inline void keccakChiLanes(typename Ops::Vector *A, const typename Ops::Vector *B, index_sequence<lanes...>) {
+        (keccakChi<Ops, lanes>(A, B), ...);
+    }
+
+    // The chi step over the complemented lanes: the inverted inputs and outputs are accounted by the choice
+    // of AND or OR for each lane, so there is a single NOT per plane
+    template <typename Ops>
+    inline void keccakChiComplemented(typename Ops::Vector *A, const typename Ops::Vector *B) {
+        using Vector = typename Ops::Vector;
+        Vector notB;
+
+        A[0] = Ops::bitXor(B[0], Ops::bitOr(B[1], B[2]));
+        A[1] = Ops::bitXor(B[1], Ops::bitOr(Ops::bitNot(B[2]), B[3]));
+        A[2] = Ops::bitXor(B[2], Ops::bitAnd(B[3], B[4]));
+        A[3] = Ops::bitXor(B[3], Ops::bitOr(B[4], B[0]));
+        A[4] = Ops::bitXor(B[4], Ops::bitAnd(B[0], B[1]));
+
+        A[5] = Ops::bitXor(B[5], Ops::bitOr(B[6], B[7]));
+        A[6] = Ops::bitXor(B[6], Ops::bitAnd(B[7], B[8]));
+        A[7] = Ops::bitXor(B[7], Ops::bitOr(B[8], Ops::bitNot(B[9])));
+        A[8] = Ops::bitXor(B[8], Ops::bitOr(B[9], B[5]));
+        A[9] = Ops::bitXor(B[9], Ops::bitAnd(B[5], B[6]));
+
+        notB = Ops::bitNot(B[13]);
+        A[10] = Ops::bitXor(B[10], Ops::bitOr(B[11], B[12]));
+        A[11] = Ops::bitXor(B[11], Ops::bitAnd(B[12], B[13]));
+        A[12] = Ops::bitXor(B[12], Ops::bitAnd(notB, B[14]));
+        A[13] = Ops::bitXor(notB, Ops::bitOr(B[14], B[10]));
+        A[14] = Ops::bitXor(B[14], Ops::bitAnd(B[10], B[11]));
+
+        notB = Ops::bitNot(B[18]);
+        A[15] = Ops::bitXor(B[15], Ops::bitAnd(B[16], B[17]));
+        A[16] = Ops::bitXor(B[16], Ops::bitOr(B[17], B[18]));
+        A[17] = Ops::bitXor(B[17], Ops::bitOr(notB, B[19]));
+        A[18] = Ops::bitXor(notB, Ops::bitAnd(B[19], B[15]));
+        A[19] = Ops::bitXor(B[19], Ops::bitOr(B[15], B[16]));
+
+        notB = Ops::bitNot(B[21]);
+        A[20] = Ops::bitXor(B[20], Ops::bitAnd(notB, B[22]));
+        A[21] = Ops::bitXor(notB, Ops::bitOr(B[22], B[23]));
+        A[22] = Ops::bitXor(B[22], Ops::bitAnd(B[23], B[24]));
+        A[23] = Ops::bitXor(B[23], Ops::bitOr(B[24], B[20]));
+        A[24] = Ops::bitXor(B[24], Ops::bitAnd(B[20], B[21]));
+    }
+
+    template <typename Ops, size_t round>
+    inline void keccakRound(typename Ops::Vector *A) {
+        using Vector = typename Ops::Vector;
+
+        // Theta: each lane gets the parities of two neighbouring columns
+        Vector C[5], D[5], B[25];
+        for (uchar x = 0; x < 5; x++) {
+            C[x] = Ops::bitXor3(Ops::bitXor3(A[x], A[x + 5], A[x + 10]), A[x + 15], A[x + 20]);
+        }
+        for (uchar x = 0; x < 5; x++) {
+            D[x] = Ops::bitXor(C[(x + 4) % 5], Ops::template rotateLeft<1>(C[(x + 1) % 5]));
+        }
+
+        keccakRhoPiLanes<Ops>(B, A, D, make_index_sequence<25>());
+        if constexpr (Ops::LANE_COMPLEMENTING) {
+            keccakChiComplemented<Ops>(A, B);
+        } else {
+            keccakChiLanes<Ops>(A, B, make_index_sequence<25>());
+        }
+
+        // Iota
+        A[0] = Ops::bitXor(A[0], Ops::set1(sha3::_keccak::ROUND_CONSTANTS[round]));
+    }
+
+    template <typename Ops, size_t... rounds>
+    inline void keccakRounds(typename Ops::Vector *A, index_sequence<rounds...>) {
+        (keccakRound<Ops, rounds>(A), ...);
+    }
+
+    template <typename Ops>
+    inline void keccakPermute(typename Ops::Vector *A) {
+        keccakRounds<Ops>(A, make_index_sequence<sha3::_keccak::ROUNDS_COUNT>());
+    }
+
+    // The multi-buffer absorbing: `states[word * LANES + lane]`, the rate is a multiple of 8 bytes.
+    // `Ops::gatherWord(data, offset)` loads the little-endian 64-bit word at the `offset` of each lane
+    template <typename Ops>
+    void keccakMultiBufferBlocks(uint64 *states, const uchar *const *data, uint64 blocksCount, uchar rate) {
+        typename Ops::Vector A[25];
+        for (uchar i = 0; i < 25; i++) {
+            A[i] = Ops::load(states + i * Ops::LANES);
+        }
+
+        for (uint64 block = 0, offset = 0; block < blocksCount; block++) {
+            for (uchar word = 0; word < rate / 8; word++, offset += 8) {
+                A[word] = Ops::bitXor(A[word], Ops::gatherWord(data, offset));
+            }
+            keccakPermute<Ops>(A);
+        }
+
+        for (uchar i = 0; i < 25; i++) {
+            Ops::store(states + i * Ops::LANES, A[i]);
+        }
+    }
+
+}
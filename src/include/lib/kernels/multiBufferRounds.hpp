@@ -0,0 +1,225 @@
+#pragma once
+
+// The generic multi-buffer rounds of MD5, SHA-256 and SHA-512: each SIMD lane processes its own message.
+// This header is included into the instruction set specific regions (see `ZIPPY_BEGIN_TARGET_REGION`),
+// thus it must be included after <utility> and the kernels' headers (md5Kernels.hpp, sha256Kernels.hpp, sha512Kernels.hpp):
+// everything defined here is compiled for the instruction set of the region.
+//
+// The `Ops` structure provides the vector type and the operations over the vectors of words
+// (32-bit ones for MD5 and SHA-256, 64-bit ones for SHA-512):
+//   Vector, LANES, load, store, set1, add, bitXor, bitAnd, bitOr, choose, majority,
+//   rotateLeft<n>, rotateRight<n>, shiftRight<n>
+//   and loadWords, which loads the sixteen words of the block of each lane transposed (words[i] holds the word i of all lanes).
+
+namespace {
+
+    template <typename Ops, size_t i>
+    inline void md5MultiBufferStep(
+        typename Ops::Vector &a, typename Ops::Vector &b, typename Ops::Vector &c, typename Ops::Vector &d,
+        const typename Ops::Vector *M
+    ) {
+        typename Ops::Vector F;
+        if constexpr (i < 16) {
+            F = Ops::choose(b, c, d); // Round 1
+        } else if constexpr (i < 32) {
+            F = Ops::choose(d, b, c); // Round 2
+        } else if constexpr (i < 48) {
+            F = Ops::bitXor(Ops::bitXor(b, c), d); // Round 3
+        } else {
+            F = Ops::bitXor(c, Ops::bitOr(b, Ops::bitXor(d, Ops::set1(0xFFFFFFFF)))); // Round 4
+        }
+
+        F = Ops::add(Ops::add(F, a), Ops::add(Ops::set1(md::_md5::K[i]), M[md::_md5::messageIndex(i)]));
+        a = d; d = c; c = b;
+        b = Ops::add(b, Ops::template rotateLeft<md::_md5::s[i]>(F));
+    }
+
+    template <typename Ops, size_t... rounds>
+    inline void md5MultiBufferRounds(
+        typename Ops::Vector &a, typename Ops::Vector &b, typename Ops::Vector &c, typename Ops::Vector &d,
+        const typename Ops::Vector *M, index_sequence<rounds...>
+    ) {
+        (md5MultiBufferStep<Ops, rounds>(a, b, c, d, M), ...);
+    }
+
+    template <typename Ops>
+    void md5MultiBufferBlocks(uint32 *states, const uchar *const *data, uint64 blocksCount) {
+        typedef typename Ops::Vector Vector;
+        Vector A = Ops::load(states), B = Ops::load(states + Ops::LANES);
+        Vector C = Ops::load(states + 2 * Ops::LANES), D = Ops::load(states + 3 * Ops::LANES);
+
+        for (uint64 block = 0; block < blocksCount; block++) {
+            Vector M[16];
+            Ops::loadWords(data, block * 64, M, false); // MD5 words are little endian
+
+            Vector a = A, b = B, c = C, d = D;
+            md5MultiBufferRounds<Ops>(a, b, c, d, M, make_index_sequence<64>());
+            A = Ops::add(A, a); B = Ops::add(B, b); C = Ops::add(C, c); D = Ops::add(D, d);
+        }
+
+        Ops::store(states, A); Ops::store(states + Ops::LANES, B);
+        Ops::store(states + 2 * Ops::LANES, C); Ops::store(states + 3 * Ops::LANES, D);
+    }
+
+    template <typename Ops, size_t i>
+    inline void sha256MultiBufferStep(typename Ops::Vector *v, typename Ops::Vector *w) {
+        typedef typename Ops::Vector Vector;
+        // The registers aren't moved between the rounds: the round i uses the variables shifted by i
+        Vector &a = v[(64 - i) % 8], &b = v[(65 - i) % 8], &c = v[(66 - i) % 8], &d = v[(67 - i) % 8];
+        Vector &e = v[(68 - i) % 8], &f = v[(69 - i) % 8], &g = v[(70 - i) % 8], &h = v[(71 - i) % 8];
+
+        if constexpr (i >= 16) {
+            Vector w15 = w[(i - 15) % 16], w2 = w[(i - 2) % 16];
+            Vector s0 = Ops::bitXor(Ops::bitXor(Ops::template rotateRight<7>(w15), Ops::template rotateRight<18>(w15)), Ops::template shiftRight<3>(w15));
+            Vector s1 = Ops::bitXor(Ops::bitXor(Ops::template rotateRight<17>(w2), Ops::template rotateRight<19>(w2)), Ops::template shiftRight<10>(w2));
+            w[i % 16] = Ops::add(Ops::add(w[i % 16], s0), Ops::add(w[(i - 7) % 16], s1));
+        }
+
+        Vector S1 = Ops::bitXor(Ops::bitXor(Ops::template rotateRight<6>(e), Ops::template rotateRight<11>(e)), Ops::template rotateRight<25>(e));
+        Vector temp1 = Ops::add(Ops::add(h, S1), Ops::add(Ops::choose(e, f, g), Ops::add(Ops::set1(sha2::_sha256::k[i]), w[i % 16])));
+        Vector S0 = Ops::bitXor(Ops::bitXor(Ops::template rotateRight<2>(a), Ops::template rotateRight<13>(a)), Ops::template rotateRight<22>(a));
+        Vector temp2 = Ops::add(S0, Ops::majority(a, b, c));
+        d = Ops::add(d, temp1);
+        h = Ops::add(temp1, temp2);
+    }
+
+    template <typename Ops, size_t... rounds>
+    inline void sha256MultiBufferRounds(typename Ops::Vector *v, typename Ops::Vector *w, index_sequence<rounds...>) {
+        (sha256MultiBufferStep<Ops, rounds>(v, w), ...);
+    }
+
+    template <typename Ops>
+    void sha256MultiBufferBlocks(uint32 *states, const uchar *const *data, uint64 blocksCount) {
+        typedef typename Ops::Vector Vector;
+        Vector h[8];
+        for (uchar i = 0; i < 8; i++) {
+            h[i] = Ops::load(states + i * Ops::LANES);
+        }
+
+        for (uint64 block = 0; block < blocksCount; block++) {
+            Vector w[16];
+            Ops::loadWords(data, block * 64, w, true); // SHA-256 words are big endian
+
+            Vector v[8];
+            for (uchar i = 0; i < 8; i++) {
+                v[i] = h[i];
+            }
+            sha256MultiBufferRounds<Ops>(v, w, make_index_sequence<64>());
+            // After 64 rounds the variables are back in their original places
+            for (uchar i = 0; i < 8; i++) {
+                h[i] = Ops::add(h[i], v[i]);
+            }
+        }
+
+        for (uchar i = 0; i < 8; i++) {
+            Ops::store(states + i * Ops::LANES, h[i]);
+        }
+    }
+
+    template <typename Ops, size_t i>
+    inline void sha512MultiBufferStep(typename Ops::Vector *v, typename Ops::Vector *w) {
+        typedef typename Ops::Vector Vector;
+        Vector &a = v[(80 - i) % 8], &b = v[(81 - i) % 8], &c = v[(82 - i) % 8], &d = v[(83 - i) % 8];
+        Vector &e = v[(84 - i) % 8], &f = v[(85 - i) % 8], &g = v[(86 - i) % 8], &h = v[(87 - i) % 8];
+
+        if constexpr (i >= 16) {
+            Vector w15 = w[(i - 15) % 16], w2 = w[(i - 2) % 16];
+            Vector s0 = Ops::bitXor(Ops::bitXor(Ops::template rotateRight<1>(w15), Ops::template rotateRight<8>(w15)), Ops::template shiftRight<7>(w15));
+            Vector s1 = Ops::bitXor(Ops::bitXor(Ops::template rotateRight<19>(w2), Ops::template rotateRight<61>(w2)), Ops::template shiftRight<6>(w2));
+            w[i % 16] = Ops::add(Ops::add(w[i % 16], s0), Ops::add(w[(i - 7) % 16], s1));
+        }
+
+        Vector S1 = Ops::bitXor(Ops::bitXor(Ops::template rotateRight<14>(e), Ops::template rotateRight<18>(e)), Ops::template rotateRight<41>(e));
+        Vector temp1 = Ops::add(Ops::add(h, S1), Ops::add(Ops::choose(e, f, g), Ops::add(Ops::set1(sha2::_sha512::k[i]), w[i % 16])));
+        Vector S0 = Ops::bitXor(Ops::bitXor(Ops::template rotateRight<28>(a), Ops::template rotateRight<34>(a)), Ops::template rotateRight<39>(a));
+        Vector temp2 = Ops::add(S0, Ops::majority(a, b, c));
+        d = Ops::add(d, temp1);
+        h = Ops::add(temp1, temp2);
+    }
+
+    template <typename Ops, size_t... rounds>
+    inline void sha512MultiBufferRounds(typename Ops::Vector *v, typename Ops::Vector *w, index_sequence<rounds...>) {
+        (sha512MultiBufferStep<Ops, rounds>(v, w), ...);
+    }
+
+    template <typename Ops>
+    void sha512MultiBufferBlocks(uint64 *states, const uchar *const *data, uint64 blocksCount) {
+        typedef typename Ops::Vector Vector;
+        Vector h[8];
+        for (uchar i = 0; i < 8; i++) {
+            h[i] = Ops::load(states + i * Ops::LANES);
+        }
+
+        for (uint64 block = 0; block < blocksCount; block++) {
+            Vector w[16];
+            Ops::loadWords(data, block * 128, w, true);
+
+            Vector v[8];
+            for (uchar i = 0; i < 8; i++) {
+                v[i] = h[i];
+            }
+            sha512MultiBufferRounds<Ops>(v, w, make_index_sequence<80>());
+            // After 80 rounds the variables are back in their original places
+            for (uchar i = 0; i < 8; i++) {
+                h[i] = Ops::add(h[i], v[i]);
+            }
+        }
+
+        for (uchar i = 0; i < 8; i++) {
+            Ops::store(states + i * Ops::LANES, h[i]);
+        }
+    }
+
+    // Transposes the 8x8 matrix of 32-bit words: the row i holds eight consecutive words of the lane i
+    inline void transpose8x8(__m256i *rows) {
+        __m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]), t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+        __m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]), t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+        __m256i t4 = _mm256_unpacklo_epi32(rows[4], rows[5]), t5 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+        __m256i t6 = _mm256_unpacklo_epi32(rows[6], rows[7]), t7 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+
+        __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+        __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+        __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+        __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+
+        rows[0] = _mm256_permute2x128_si256(u0, u4, 0x20); rows[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+        rows[1] = _mm256_permute2x128_si256(u1, u5, 0x20); rows[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+        rows[2] = _mm256_permute2x128_si256(u2, u6, 0x20); rows[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+        rows[3] = _mm256_permute2x128_si256(u3, u7, 0x20); rows[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+    }
+
+    // Loads the words `firstWord`..`firstWord + 7` of the block of the lanes `firstLane`..`firstLane + 7` transposed
+    inline void loadTransposedWords8(const uchar *const *data, uint64 offset, uchar firstLane, uchar firstWord, __m256i *words, bool byteSwap) {
+        const __m256i byteSwapMask = _mm256_set_epi64x(
+            0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL, 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL
+        );
+        for (uchar lane = 0; lane < 8; lane++) {
+            words[lane] = _mm256_loadu_si256((const __m256i *)(data[firstLane + lane] + offset + firstWord * 4));
+        }
+        transpose8x8(words);
+        if (byteSwap) {
+            for (uchar i = 0; i < 8; i++) {
+                words[i] = _mm256_shuffle_epi8(words[i], byteSwapMask);
+            }
+        }
+    }
+
+    // Loads the 64-bit words `firstWord`..`firstWord + 3` of the block of the lanes `firstLane`..`firstLane + 3` transposed
+    inline void loadTransposedWords4x64(const uchar *const *data, uint64 offset, uchar firstLane, uchar firstWord, __m256i *words) {
+        const __m256i byteSwapMask = _mm256_set_epi64x(
+            0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL
+        );
+        __m256i rows[4];
+        for (uchar lane = 0; lane < 4; lane++) {
+            rows[lane] = _mm256_loadu_si256((const __m256i *)(data[firstLane + lane] + offset + firstWord * 8));
+        }
+
+        __m256i t0 = _mm256_unpacklo_epi64(rows[0], rows[1]), t1 = _mm256_unpackhi_epi64(rows[0], rows[1]);
+        __m256i t2 = _mm256_unpacklo_epi64(rows[2], rows[3]), t3 = _mm256_unpackhi_epi64(rows[2], rows[3]);
+        words[0] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(t0, t2, 0x20), byteSwapMask);
+        words[1] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(t1, t3, 0x20), byteSwapMask);
+        words[2] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(t0, t2, 0x31), byteSwapMask);
+        words[3] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(t1, t3, 0x31), byteSwapMask);
+    }
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <utility>
+
+#include "../../types.hpp"
+
+using namespace std;
+
+// The cores of SHA-256 shared between the scalar implementation and the accelerated kernels.
+// Each core processes `blocksCount` consecutive 64-bytes blocks of `data` and updates the `state` in place
+namespace sha2 {
+    namespace _sha256 {
+        typedef void BlocksFunction (uint32 *state, const uchar *data, uint64 blocksCount);
+
+        // The round constants are kept outside of the compression function, so they aren't rebuilt for each block
+        alignas(64) inline constexpr uint32 k[] = {
+            0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+            0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+            0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+            0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+            0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+            0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+            0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+            0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+        };
+
+        // Use with care: don't pass the number higher than 31 as the `shift` value.
+        // This function don't perform any edge-case checks
+        inline uint32 rightRotate(uint32 original, uchar shift) {
+            return (original << (32 - shift)) | (original >> shift);
+        }
+
+        // The round `i` with the word of the schedule and the round constant already added (w[i] + k[i]).
+        // The rounds are unrolled at compile time and the variables aren't moved between them:
+        // the round `i` uses the variables shifted by `i`, so they are back in their places after 64 rounds
+        template <size_t i>
+        inline void compressRound(uint32 *v, uint32 wk) {
+            uint32 &a = v[(64 - i) % 8], &b = v[(65 - i) % 8], &c = v[(66 - i) % 8], &d = v[(67 - i) % 8];
+            uint32 &e = v[(68 - i) % 8], &f = v[(69 - i) % 8], &g = v[(70 - i) % 8], &h = v[(71 - i) % 8];
+            uint32 S1 = (rightRotate(e, 6)) ^ (rightRotate(e, 11)) ^ (rightRotate(e, 25));
+            uint32 ch = g ^ (e & (f ^ g)); // (e & f) ^ (~e & g)
+            uint32 temp1 = h + S1 + ch + wk;
+            uint32 S0 = (rightRotate(a, 2)) ^ (rightRotate(a, 13)) ^ (rightRotate(a, 22));
+            uint32 maj = (a & b) | (c & (a | b)); // (a & b) ^ (a & c) ^ (b & c)
+            d += temp1;
+            h = temp1 + S0 + maj;
+        }
+
+        template <size_t... rounds>
+        inline void compressScheduledRounds(uint32 *v, const uint32 *wk, index_sequence<rounds...>) {
+            (compressRound<rounds>(v, wk[rounds]), ...);
+        }
+
+        // Performs the 64 rounds over the schedule with the round constants already added (w[i] + k[i])
+        inline void compressScheduledBlock(uint32 *h, const uint32 *wk) {
+            uint32 v[8] = { h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7] };
+            compressScheduledRounds(v, wk, make_index_sequence<64>());
+            for (uchar i = 0; i < 8; i++) {
+                h[i] += v[i];
+            }
+        }
+
+        void processBlocksScalar(uint32 *state, const uchar *data, uint64 blocksCount);
+
+        // The accelerated kernels are available on x86 only, on the other platforms they fall back to the scalar core.
+        // The message schedule is expanded with SSSE3, four words at a time
+        void processBlocksSsse3(uint32 *state, const uchar *data, uint64 blocksCount);
+
+        // The message schedules of two consecutive blocks are expanded at once in the halves of AVX2 registers
+        void processBlocksAvx2(uint32 *state, const uchar *data, uint64 blocksCount);
+
+        // Uses the SHA extensions (sha256rnds2, sha256msg1, sha256msg2)
+        void processBlocksShaNi(uint32 *state, const uchar *data, uint64 blocksCount);
+
+        // Picks the fastest core supported by the CPU, or the forced one (see `forceImplementation`)
+        BlocksFunction *selectBlocksFunction();
+
+        // The multi-buffer cores: each SIMD lane processes its own message.
+        // The states of lanes are stored transposed: `states[word * lanesCount + lane]`.
+        // Each lane processes `blocksCount` consecutive 64-bytes blocks starting from `data[lane]`
+        typedef void MultiBufferBlocksFunction (uint32 *states, const uchar *const *data, uint64 blocksCount);
+
+        // 8 lanes, available on x86 only
+        void processBlocksX8Avx2(uint32 *states, const uchar *const *data, uint64 blocksCount);
+
+        // 16 lanes, available on x86 only
+        void processBlocksX16Avx512(uint32 *states, const uchar *const *data, uint64 blocksCount);
+
+        // Picks the multi-buffer core according to the CPU features (or the forced implementation).
+        // Returns nullptr if there is no suitable core
+        MultiBufferBlocksFunction *selectMultiBufferFunction(uchar &lanesCount);
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <utility>
+
+#include "../../types.hpp"
+
+using namespace std;
+
+// The cores of SHA-512 shared between the scalar implementation and the accelerated kernels.
+// Each core processes `blocksCount` consecutive 128-bytes blocks of `data` and updates the `state` in place
+namespace sha2 {
+    namespace _sha512 {
+        typedef void BlocksFunction (uint64 *state, const uchar *data, uint64 blocksCount);
+
+        // The round constants are kept outside of the compression function, so they aren't rebuilt for each block
+        alignas(64) inline constexpr uint64 k[] = {
+            0x428A2F98D728AE22, 0x7137449123EF65CD, 0xB5C0FBCFEC4D3B2F, 0xE9B5DBA58189DBBC,
+            0x3956C25BF348B538, 0x59F111F1B605D019, 0x923F82A4AF194F9B, 0xAB1C5ED5DA6D8118,
+            0xD807AA98A3030242, 0x12835B0145706FBE, 0x243185BE4EE4B28C, 0x550C7DC3D5FFB4E2,
+            0x72BE5D74F27B896F, 0x80DEB1FE3B1696B1, 0x9BDC06A725C71235, 0xC19BF174CF692694,
+            0xE49B69C19EF14AD2, 0xEFBE4786384F25E3, 0x0FC19DC68B8CD5B5, 0x240CA1CC77AC9C65,
+            0x2DE92C6F592B0275, 0x4A7484AA6EA6E483, 0x5CB0A9DCBD41FBD4, 0x76F988DA831153B5,
+            0x983E5152EE66DFAB, 0xA831C66D2DB43210, 0xB00327C898FB213F, 0xBF597FC7BEEF0EE4,
+            0xC6E00BF33DA88FC2, 0xD5A79147930AA725, 0x06CA6351E003826F, 0x142929670A0E6E70,
+            0x27B70A8546D22FFC, 0x2E1B21385C26C926, 0x4D2C6DFC5AC42AED, 0x53380D139D95B3DF,
+            0x650A73548BAF63DE, 0x766A0ABB3C77B2A8, 0x81C2C92E47EDAEE6, 0x92722C851482353B,
+            0xA2BFE8A14CF10364, 0xA81A664BBC423001, 0xC24B8B70D0F89791, 0xC76C51A30654BE30,
+            0xD192E819D6EF5218, 0xD69906245565A910, 0xF40E35855771202A, 0x106AA07032BBD1B8,
+            0x19A4C116B8D2D0C8, 0x1E376C085141AB53, 0x2748774CDF8EEB99, 0x34B0BCB5E19B48A8,
+            0x391C0CB3C5C95A63, 0x4ED8AA4AE3418ACB, 0x5B9CCA4F7763E373, 0x682E6FF3D6B2B8A3,
+            0x748F82EE5DEFB2FC, 0x78A5636F43172F60, 0x84C87814A1F0AB72, 0x8CC702081A6439EC,
+            0x90BEFFFA23631E28, 0xA4506CEBDE82BDE9, 0xBEF9A3F7B2C67915, 0xC67178F2E372532B,
+            0xCA273ECEEA26619C, 0xD186B8C721C0C207, 0xEADA7DD6CDE0EB1E, 0xF57D4F7FEE6ED178,
+            0x06F067AA72176FBA, 0x0A637DC5A2C898A6, 0x113F9804BEF90DAE, 0x1B710B35131C471B,
+            0x28DB77F523047D84, 0x32CAAB7B40C72493, 0x3C9EBE0A15C9BEBC, 0x431D67C49C100D4C,
+            0x4CC5D4BECB3E42B6, 0x597F299CFC657E2A, 0x5FCB6FAB3AD6FAEC, 0x6C44198C4A475817,
+        };
+
+        // Use with care: don't pass the number higher than 63 as the `shift` value.
+        // This function don't perform any edge-case checks
+        inline uint64 rightRotate(uint64 original, uchar shift) {
+            return (original << (64 - shift)) | (original >> shift);
+        }
+
+        // The round `i` with the word of the schedule and the round constant already added (w[i] + k[i]).
+        // The rounds are unrolled at compile time and the variables aren't moved between them:
+        // the round `i` uses the variables shifted by `i`, so they are back in their places after 80 rounds
+        template <size_t i>
+        inline void compressRound(uint64 *v, uint64 wk) {
+            uint64 &a = v[(80 - i) % 8], &b = v[(81 - i) % 8], &c = v[(82 - i) % 8], &d = v[(83 - i) % 8];
+            uint64 &e = v[(84 - i) % 8], &f = v[(85 - i) % 8], &g = v[(86 - i) % 8], &h = v[(87 - i) % 8];
+            uint64 S1 = (rightRotate(e, 14)) ^ (rightRotate(e, 18)) ^ (rightRotate(e, 41));
+            uint64 ch = g ^ (e & (f ^ g)); // (e & f) ^ (~e & g)
+            uint64 temp1 = h + S1 + ch + wk;
+            uint64 S0 = (rightRotate(a, 28)) ^ (rightRotate(a, 34)) ^ (rightRotate(a, 39));
+            uint64 maj = (a & b) | (c & (a | b)); // (a & b) ^ (a & c) ^ (b & c)
+            d += temp1;
+            h = temp1 + S0 + maj;
+        }
+
+        template <size_t... rounds>
+        inline void compressScheduledRounds(uint64 *v, const uint64 *wk, index_sequence<rounds...>) {
+            (compressRound<rounds>(v, wk[rounds]), ...);
+        }
+
+        // Performs the 80 rounds over the schedule with the round constants already added (w[i] + k[i])
+        inline void compressScheduledBlock(uint64 *h, const uint64 *wk) {
+            uint64 v[8] = { h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7] };
+            compressScheduledRounds(v, wk, make_index_sequence<80>());
+            for (uchar i = 0; i < 8; i++) {
+                h[i] += v[i];
+            }
+        }
+
+        void processBlocksScalar(uint64 *state, const uchar *data, uint64 blocksCount);
+
+        // The accelerated kernels are available on x86 only, on the other platforms they fall back to the scalar core.
+        // The message schedule is expanded with SSSE3, two words at a time
+        void processBlocksSsse3(uint64 *state, const uchar *data, uint64 blocksCount);
+
+        // The message schedules of two consecutive blocks are expanded at once in the halves of AVX2 registers
+        void processBlocksAvx2(uint64 *state, const uchar *data, uint64 blocksCount);
+
+        // The message schedules of four consecutive blocks are expanded at once in the quarters of AVX-512 registers
+        void processBlocksAvx512(uint64 *state, const uchar *data, uint64 blocksCount);
+
+        // Picks the fastest core supported by the CPU, or the forced one (see `forceImplementation`)
+        BlocksFunction *selectBlocksFunction();
+
+        // The multi-buffer cores: each SIMD lane processes its own message.
+        // The states of lanes are stored transposed: `states[word * lanesCount + lane]`.
+        // Each lane processes `blocksCount` consecutive 128-bytes blocks starting from `data[lane]`
+        typedef void MultiBufferBlocksFunction (uint64 *states, const uchar *const *data, uint64 blocksCount);
+
+        // 4 lanes, available on x86 only
+        void processBlocksX4Avx2(uint64 *states, const uchar *const *data, uint64 blocksCount);
+
+        // 8 lanes, available on x86 only
+        void processBlocksX8Avx512(uint64 *states, const uchar *const *data, uint64 blocksCount);
+
+        // Picks the multi-buffer core according to the CPU features (or the forced implementation).
+        // Returns nullptr if there is no suitable core
+        MultiBufferBlocksFunction *selectMultiBufferFunction(uchar &lanesCount);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../../types.hpp"
+
+using namespace std;
+
+// The cores of XXH3 (64-bit) shared between the scalar implementation and the accelerated kernels.
+// The long input is split into the stripes of 64 bytes, each of them is accumulated into eight 64-bit lanes with the part
+// of the secret 8 bytes further than the previous one. After 16 stripes (the block) the accumulators are scrambled
+namespace xxhash {
+    namespace _xxh3 {
+        const uchar STRIPE_SIZE_IN_BYTES = 64;
+        const uchar SECRET_SIZE_IN_BYTES = 192;
+        const uchar ACCUMULATORS_COUNT = 8;
+        const uchar STRIPES_PER_BLOCK = (SECRET_SIZE_IN_BYTES - STRIPE_SIZE_IN_BYTES) / 8;
+        // The scrambling takes the last 64 bytes of the secret
+        const uchar SCRAMBLE_SECRET_OFFSET = SECRET_SIZE_IN_BYTES - STRIPE_SIZE_IN_BYTES;
+
+        const uint32 PRIME32_1 = 0x9E3779B1;
+        const uint32 PRIME32_2 = 0x85EBCA77;
+        const uint32 PRIME32_3 = 0xC2B2AE3D;
+
+        // The default secret of the reference implementation
+        alignas(64) inline constexpr uchar SECRET[SECRET_SIZE_IN_BYTES] = {
+            0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+            0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+            0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+            0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+            0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+            0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+            0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+            0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+            0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+            0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+            0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+            0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+        };
+
+        // Accumulates `stripesCount` consecutive stripes of `data`. The `stripeIndex` is the position of the first one
+        // within its block, it's advanced past the last one (the accumulators are scrambled at the end of each block)
+        typedef void StripesFunction (uint64 *accumulators, const uchar *data, size_t stripesCount, uchar &stripeIndex);
+
+        // The single stripe with the secret at `secret` (the last stripe of the message takes it at its own offset)
+        void accumulateStripeScalar(uint64 *accumulators, const uchar *data, const uchar *secret);
+
+        void accumulateStripesScalar(uint64 *accumulators, const uchar *data, size_t stripesCount, uchar &stripeIndex);
+
+        // The accelerated kernels are available on x86 only, on the other platforms they fall back to the scalar core.
+        // The lanes are multiplied by pmuludq (the 32-bit halves of each lane): 2 lanes per SSE register (the SSSE3 core
+        // takes the SSE2 instructions only), 4 per AVX2 one and all the 8 in the AVX-512 one
+        void accumulateStripesSsse3(uint64 *accumulators, const uchar *data, size_t stripesCount, uchar &stripeIndex);
+        void accumulateStripesAvx2(uint64 *accumulators, const uchar *data, size_t stripesCount, uchar &stripeIndex);
+        void accumulateStripesAvx512(uint64 *accumulators, const uchar *data, size_t stripesCount, uchar &stripeIndex);
+
+        // Picks the fastest core supported by the CPU, or the forced one (see `forceImplementation`)
+        StripesFunction *selectStripesFunction();
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// The generic loop over the stripes of XXH3. This header is included into the instruction set specific regions
+// (see `ZIPPY_BEGIN_TARGET_REGION`) the same way as chacha20Rounds.hpp, thus it must be included after xxh3Kernels.hpp.
+//
+// The `Ops` structure provides the vector type of the accumulators and the operations over the stripe:
+//   Vector, VECTORS_COUNT (the vectors per 8 accumulators), load, store,
+//   accumulate (the stripe with its part of the secret) and scramble (the accumulators with the end of the secret)
+
+namespace {
+
+    template <typename Ops>
+    void xxh3AccumulateStripes(uint64 *accumulators, const uchar *data, size_t stripesCount, uchar &stripeIndex) {
+        typedef typename Ops::Vector Vector;
+        using namespace xxhash::_xxh3;
+
+        // The accumulators stay in the registers for the whole run of stripes
+        Vector x[Ops::VECTORS_COUNT];
+        for (uchar i = 0; i < Ops::VECTORS_COUNT; i++) {
+            x[i] = Ops::load(accumulators + i * (ACCUMULATORS_COUNT / Ops::VECTORS_COUNT));
+        }
+
+        // The stripes up to the end of each block, the index is kept local as the stores through a byte may alias the input
+        uchar index = stripeIndex;
+        while (stripesCount != 0) {
+            size_t blockStripesCount = stripesCount < size_t(STRIPES_PER_BLOCK - index) ? stripesCount : STRIPES_PER_BLOCK - index;
+            for (const uchar *end = data + blockStripesCount * STRIPE_SIZE_IN_BYTES; data != end; data += STRIPE_SIZE_IN_BYTES) {
+                Ops::accumulate(x, data, SECRET + index++ * 8);
+            }
+            stripesCount -= blockStripesCount;
+            if (index == STRIPES_PER_BLOCK) {
+                Ops::scramble(x, SECRET + SCRAMBLE_SECRET_OFFSET);
+                index = 0;
+            }
+        }
+        stripeIndex = index;
+
+        for (uchar i = 0; i < Ops::VECTORS_COUNT; i++) {
+            Ops::store(accumulators + i * (ACCUMULATORS_COUNT / Ops::VECTORS_COUNT), x[i]);
+        }
+    }
+
+}
@@ -1,13 +1,53 @@
 #pragma once
 
+#include <array>
 #include <string>
+#include <vector>
 
 #include "../types.hpp"
+#include "../utils/inputReader.hpp"
 
 using namespace std;
 
 namespace md {
-    inline string md5FromStream(istream &stream, uint64 messageSize);
+    // The raw digest, in the order of the hexadecimal form
+    typedef array<uchar, 16> Md5Digest;
 
-    string md5(string filePath);
+    // Streaming MD5 hasher.
+    // The message may be passed in portions of any size via `update`: the incomplete 64-bytes blocks
+    // are buffered internally until the next portion arrives, so the size of the message isn't required up front.
+    class Md5Hasher {
+    public:
+        static const uchar BLOCK_SIZE_IN_BYTES = 64;
+        static const uchar DIGEST_SIZE_IN_BYTES = 16;
+
+        Md5Hasher();
+
+        // Drops all the processed data and returns the hasher to the initial state
+        void reset();
+
+        void update(const uchar *data, size_t size);
+
+        // Pads the message, processes the final block(s) and returns the digest.
+        // The hasher is reset afterwards and may be reused for the next message
+        Md5Digest final();
+
+    private:
+        uint32 state[4];
+        uchar buffer[BLOCK_SIZE_IN_BYTES];
+        uchar bufferSize;
+        uint64 messageSize;
+    };
+
+    // Hashes the rest of the reader's input
+    Md5Digest md5FromReader(InputReader &reader);
+
+    Md5Digest md5(const string &filePath, const InputOptions &options = InputOptions());
+
+    // Hashes many files at once. When the CPU has the suitable SIMD instructions, the small files are hashed
+    // in the lanes of the multi-buffer core, several files at a time. The digests are returned in the order of the `filePaths`
+    vector<Md5Digest> md5Batch(const vector<string> &filePaths, const InputOptions &options = InputOptions());
+
+    // The same for the messages in memory
+    vector<Md5Digest> md5BatchBuffers(const vector<ByteView> &messages);
 }
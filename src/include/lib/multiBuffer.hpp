@@ -0,0 +1,278 @@
+#pragma once
+
+#include <functional>
+#include <cstring>
+#include <algorithm>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+
+using namespace std;
+
+// Hashes many independent messages at once: each SIMD lane of the multi-buffer core processes its own message.
+// A single message is hashed by a serial chain of blocks, so the throughput of a single stream is limited
+// by the latency of the rounds. The lanes are independent, so the core keeps all of them busy at once.
+// Once the message of any lane is completed, the lane is refilled with the next message.
+template <typename Word>
+class MultiBufferEngine {
+public:
+    static const uchar MAX_LANES = 16;
+    // The Keccak state takes 25 words, its largest rate is 168 bytes (SHAKE128)
+    static const uchar MAX_STATE_WORDS = 25;
+    static const uchar MAX_BLOCK_SIZE = 168;
+
+    // The states of lanes are stored transposed: `states[word * lanesCount + lane]`
+    typedef void BlocksFunction (Word *states, const uchar *const *data, uint64 blocksCount);
+
+    struct Message {
+        const uchar *data;
+        uint64 size;
+        // The identifier of the message passed back along with its digest
+        size_t index;
+    };
+
+    // Provides the next message. Returns false when there are no more messages
+    typedef function<bool (Message &message)> MessageSource;
+
+    // Receives the final state (hash values) of the message
+    typedef function<void (size_t index, const Word *state)> StateSink;
+
+    struct Algorithm {
+        uchar blockSize;
+        uchar stateWords;
+        const Word *initialState;
+        // The size of the message length field appended during the padding (the length is counted in bits)
+        uchar lengthFieldSize;
+        bool bigEndianLength;
+        // The first byte of the padding: the set bit for the Merkle-Damgard constructions,
+        // the domain separation bits followed by the set bit for the Keccak sponge
+        uchar paddingByte = 0x80;
+        // The sponge pads with the set bit at the end of the block instead of the length (`lengthFieldSize` is 0)
+        bool setsLastBit = false;
+        // The bytes already absorbed into the initial state (e.g. the key block of HMAC), counted by the length field
+        uint64 prefixSize = 0;
+    };
+
+    MultiBufferEngine(const Algorithm &algorithm, BlocksFunction *processBlocks, uchar lanesCount)
+        : algorithm(algorithm), processBlocks(processBlocks), lanesCount(lanesCount) {}
+
+    void run(const MessageSource &source, const StateSink &sink) {
+        Lane lanes[MAX_LANES];
+        Word states[MAX_STATE_WORDS * MAX_LANES];
+        const uchar *pointers[MAX_LANES];
+
+        uchar activeLanesCount = 0;
+        for (uchar lane = 0; lane < lanesCount; lane++) {
+            activeLanesCount += loadNextMessage(source, lanes[lane], states, lane);
+        }
+
+        while (activeLanesCount > 0) {
+            // All the lanes run for the count of blocks left in the shortest segment.
+            // The idle lanes are pointed to the data of an active lane: their results are just ignored
+            uint64 blocksCount = UINT64_MAX;
+            const uchar *activeData = nullptr;
+            for (uchar lane = 0; lane < lanesCount; lane++) {
+                if (lanes[lane].isActive) {
+                    blocksCount = min(blocksCount, lanes[lane].blocksLeft);
+                    activeData = lanes[lane].data;
+                }
+            }
+            for (uchar lane = 0; lane < lanesCount; lane++) {
+                pointers[lane] = lanes[lane].isActive ? lanes[lane].data : activeData;
+            }
+
+            processBlocks(states, pointers, blocksCount);
+
+            for (uchar lane = 0; lane < lanesCount; lane++) {
+                Lane &current = lanes[lane];
+                if (!current.isActive) {
+                    continue;
+                }
+                current.data += blocksCount * algorithm.blockSize;
+                current.blocksLeft -= blocksCount;
+                if (current.blocksLeft > 0) {
+                    continue;
+                }
+
+                if (!current.isInTail) {
+                    // The complete blocks of the message are over, the padded tail goes next
+                    current.isInTail = true;
+                    current.data = current.tail;
+                    current.blocksLeft = current.tailBlocksCount;
+                    continue;
+                }
+
+                Word state[MAX_STATE_WORDS];
+                for (uchar word = 0; word < algorithm.stateWords; word++) {
+                    state[word] = states[word * lanesCount + lane];
+                }
+                sink(current.index, state);
+
+                activeLanesCount -= 1 - loadNextMessage(source, current, states, lane);
+            }
+        }
+    }
+
+private:
+    struct Lane {
+        bool isActive;
+        bool isInTail;
+        size_t index;
+        const uchar *data;
+        uint64 blocksLeft;
+        // The last incomplete block of the message along with the padding: one or two blocks
+        uchar tail[2 * MAX_BLOCK_SIZE];
+        uchar tailBlocksCount;
+    };
+
+    Algorithm algorithm;
+    BlocksFunction *processBlocks;
+    uchar lanesCount;
+
+    // Returns 1 if the lane has got the next message, 0 otherwise
+    uchar loadNextMessage(const MessageSource &source, Lane &lane, Word *states, uchar laneIndex) {
+        Message message;
+        if (!source(message)) {
+            lane.isActive = false;
+            return 0;
+        }
+
+        for (uchar word = 0; word < algorithm.stateWords; word++) {
+            states[word * lanesCount + laneIndex] = algorithm.initialState[word];
+        }
+
+        lane.isActive = true;
+        lane.index = message.index;
+        lane.data = message.data;
+        lane.blocksLeft = message.size / algorithm.blockSize;
+        fillTail(lane, message);
+
+        lane.isInTail = lane.blocksLeft == 0;
+        if (lane.isInTail) {
+            lane.data = lane.tail;
+            lane.blocksLeft = lane.tailBlocksCount;
+        }
+        return 1;
+    }
+
+    void fillTail(Lane &lane, const Message &message) {
+        uchar bytesLeft = message.size % algorithm.blockSize;
+        memcpy(lane.tail, message.data + message.size - bytesLeft, bytesLeft);
+
+        // The padding byte, then the zeroes up to the length field (or the end of the block)
+        lane.tail[bytesLeft] = algorithm.paddingByte;
+        lane.tailBlocksCount = bytesLeft + 1 + algorithm.lengthFieldSize <= algorithm.blockSize ? 1 : 2;
+        uint32 tailSize = lane.tailBlocksCount * algorithm.blockSize;
+        memset(lane.tail + bytesLeft + 1, 0, tailSize - bytesLeft - 1);
+
+        if (algorithm.setsLastBit) {
+            lane.tail[tailSize - 1] |= 0x80;
+            return;
+        }
+
+        // The bits of the length above the lowest 64 ones
+        uint64 totalSize = algorithm.prefixSize + message.size;
+        if (algorithm.lengthFieldSize > 8) {
+            lane.tail[tailSize - 9] = totalSize >> 61;
+        }
+
+        uint64 messageSizeInBits = totalSize << 3;
+        for (uchar i = 0; i < 8; i++) {
+            uchar byte = (messageSizeInBits >> (i * 8)) & 0xFF;
+            if (algorithm.bigEndianLength) {
+                lane.tail[tailSize - 1 - i] = byte;
+            } else {
+                lane.tail[tailSize - algorithm.lengthFieldSize + i] = byte;
+            }
+        }
+    }
+};
+
+// The files larger than this are hashed one by one: the long messages gain nothing from the lanes,
+// while the single stream cores may be faster (e.g. the hardware accelerated ones)
+const uint64 MULTI_BUFFER_MAX_MESSAGE_SIZE = 1024 * 1024;
+
+// The smaller batches are hashed one by one
+const size_t MULTI_BUFFER_MIN_BATCH_SIZE = 4;
+
+// Hashes the files with the multi-buffer engine. The files are mapped lazily, once any lane is ready for the next message,
+// and unmapped as soon as their digests are evaluated. The files that can't be mapped (or are too large)
+// are hashed afterwards by the `hashFile` function. The digests are returned in the order of the `filePaths`
+template <typename Word, typename Digest>
+vector<Digest> hashFilesWithMultiBuffer(
+    const vector<string> &filePaths, const InputOptions &options, MultiBufferEngine<Word> &engine,
+    Digest (*toDigest)(const Word *state), const function<Digest (const string &filePath)> &hashFile
+) {
+    vector<Digest> digests(filePaths.size());
+    vector<unique_ptr<InputReader>> readers(filePaths.size());
+    vector<size_t> skippedFiles;
+
+    size_t nextFile = 0;
+    auto source = [&](typename MultiBufferEngine<Word>::Message &message) {
+        for (; nextFile < filePaths.size(); nextFile++) {
+            if (filePaths[nextFile] != "-" && options.allowMapping && options.ioDepth == 0) {
+                unique_ptr<InputReader> reader(new InputReader(filePaths[nextFile], options));
+                if (reader->isMapped() && reader->getMappingSize() <= MULTI_BUFFER_MAX_MESSAGE_SIZE) {
+                    size_t size;
+                    reader->next(message.data, size);
+                    message.size = size;
+                    message.index = nextFile;
+                    readers[nextFile++] = move(reader);
+                    return true;
+                }
+            }
+            skippedFiles.push_back(nextFile);
+        }
+        return false;
+    };
+    auto sink = [&](size_t index, const Word *state) {
+        digests[index] = toDigest(state);
+        readers[index].reset();
+    };
+    engine.run(source, sink);
+
+    for (size_t index : skippedFiles) {
+        digests[index] = hashFile(filePaths[index]);
+    }
+
+    return digests;
+}
+
+// The same for the messages in memory. The messages larger than `MULTI_BUFFER_MAX_MESSAGE_SIZE`
+// are hashed afterwards by the `hashBuffer` function. The digests are returned in the order of the `messages`
+template <typename Word, typename Digest>
+vector<Digest> hashBuffersWithMultiBuffer(
+    const vector<ByteView> &messages, MultiBufferEngine<Word> &engine,
+    Digest (*toDigest)(const Word *state), const function<Digest (const ByteView &message)> &hashBuffer
+) {
+    vector<Digest> digests(messages.size());
+    vector<size_t> skippedMessages;
+
+    size_t nextMessage = 0;
+    auto source = [&](typename MultiBufferEngine<Word>::Message &message) {
+        for (; nextMessage < messages.size(); nextMessage++) {
+            if (messages[nextMessage].size <= MULTI_BUFFER_MAX_MESSAGE_SIZE) {
+                message.data = messages[nextMessage].data;
+                message.size = messages[nextMessage].size;
+                message.index = nextMessage++;
+                return true;
+            }
+            skippedMessages.push_back(nextMessage);
+        }
+        return false;
+    };
+    auto sink = [&](size_t index, const Word *state) {
+        digests[index] = toDigest(state);
+    };
+    engine.run(source, sink);
+
+    for (size_t index : skippedMessages) {
+        digests[index] = hashBuffer(messages[index]);
+    }
+
+    return digests;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+#include "algorithms.hpp"
+
+using namespace std;
+
+// The portions of the input are fed to all the hashers in the slices of this size,
+// so the slice stays in the L2 cache while it's hashed by every algorithm
+const size_t MULTI_DIGEST_SLICE_SIZE = 64 * 1024;
+
+// The ring of buffers shared by the per-algorithm threads: the reader may be ahead of the slowest hasher
+// by at most `MULTI_DIGEST_RING_SLOTS_COUNT` slots
+const size_t MULTI_DIGEST_RING_SLOTS_COUNT = 8;
+const size_t MULTI_DIGEST_RING_SLOT_SIZE = 1024 * 1024;
+
+struct MultiDigestOptions {
+    // Hash with each algorithm on its own thread. The threads share the read-only buffers of the input,
+    // so the input is still read once. Pays off when the input is cached and the digests are computed at the similar speed
+    bool threadPerAlgorithm = false;
+    InputOptions inputOptions;
+};
+
+// Computes the digests of the file ("-" means the standard input) by all the `algorithms` in a single pass:
+// each portion of the input is read once and fed to all the hashers.
+// The digests are returned in the order of the `algorithms`
+vector<HashDigest> hashWithAlgorithms(
+    const string &filePath, const vector<const HashAlgorithm *> &algorithms, const MultiDigestOptions &options = MultiDigestOptions()
+);
+
+// Computes the digests of the rest of the descriptor's input (from its current position up to the end) in the same way.
+// The descriptor stays open, it may be a pipe or a socket as well.
+// Throws `invalid_argument` if the descriptor can't be read
+vector<HashDigest> hashDescriptorWithAlgorithms(int fd, const vector<const HashAlgorithm *> &algorithms);
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+
+using namespace std;
+
+namespace sha2 {
+    // The parameters shared by the variants of the same word size. The cores (and all the accelerated kernels)
+    // are selected per family, so each of them serves all the variants of its word size
+    template <typename Word>
+    struct Sha2Family;
+
+    // SHA-224 and SHA-256
+    template <>
+    struct Sha2Family<uint32> {
+        static constexpr uchar BLOCK_SIZE_IN_BYTES = 64;
+        static constexpr uchar ROUNDS_COUNT = 64;
+        // The message size (in bits) appended by the padding
+        static constexpr uchar LENGTH_FIELD_SIZE = 8;
+        // 2 ^ 61 - 1 bytes: the size in bits has to fit the 64-bit length field
+        static constexpr uint64 MAX_MESSAGE_SIZE = 0x1FFFFFFFFFFFFFFF;
+    };
+
+    // SHA-384, SHA-512, SHA-512/224 and SHA-512/256
+    template <>
+    struct Sha2Family<uint64> {
+        static constexpr uchar BLOCK_SIZE_IN_BYTES = 128;
+        static constexpr uchar ROUNDS_COUNT = 80;
+        static constexpr uchar LENGTH_FIELD_SIZE = 16;
+        // The 128-bit length field fits any size of the 64-bit counter
+        static constexpr uint64 MAX_MESSAGE_SIZE = 0xFFFFFFFFFFFFFFFF;
+    };
+
+    // The variants differ in the initial state and the truncation of the digest only (FIPS 180-4)
+    struct Sha224Variant {
+        typedef uint32 Word;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 28;
+        static constexpr Word INITIAL_STATE[8] = {
+            0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939, 0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4
+        };
+    };
+
+    struct Sha256Variant {
+        typedef uint32 Word;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 32;
+        static constexpr Word INITIAL_STATE[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+    };
+
+    struct Sha384Variant {
+        typedef uint64 Word;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 48;
+        static constexpr Word INITIAL_STATE[8] = {
+            0xcbbb9d5dc1059ed8, 0x629a292a367cd507, 0x9159015a3070dd17, 0x152fecd8f70e5939,
+            0x67332667ffc00b31, 0x8eb44a8768581511, 0xdb0c2e0d64f98fa7, 0x47b5481dbefa4fa4
+        };
+    };
+
+    struct Sha512Variant {
+        typedef uint64 Word;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 64;
+        static constexpr Word INITIAL_STATE[8] = {
+            0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+            0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+        };
+    };
+
+    struct Sha512_224Variant {
+        typedef uint64 Word;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 28;
+        static constexpr Word INITIAL_STATE[8] = {
+            0x8c3d37c819544da2, 0x73e1996689dcd4d6, 0x1dfab7ae32ff9c82, 0x679dd514582f9fcf,
+            0x0f6d2b697bd44da8, 0x77e36f7304c48942, 0x3f9d85a86a1d36c8, 0x1112e6ad91d692a1
+        };
+    };
+
+    struct Sha512_256Variant {
+        typedef uint64 Word;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 32;
+        static constexpr Word INITIAL_STATE[8] = {
+            0x22312194fc2bf72c, 0x9f555fa3c84c64c2, 0x2393b86b6f53b151, 0x963877195940eabd,
+            0x96283ee2a88effe3, 0xbe5e1e2553863992, 0x2b0199fc2c85b8aa, 0x0eb72ddc81c52ca2
+        };
+    };
+
+    // Streaming SHA-2 hasher.
+    // The message may be passed in portions of any size via `update`: the incomplete blocks
+    // are buffered internally until the next portion arrives, so the size of the message isn't required up front.
+    // Instantiated for the variants above only
+    template <typename Variant>
+    class Sha2Hasher {
+    public:
+        typedef typename Variant::Word Word;
+        typedef Sha2Family<Word> Family;
+        // The raw (big-endian) digest, in the order of the hexadecimal form
+        typedef array<uchar, Variant::DIGEST_SIZE_IN_BYTES> Digest;
+
+        static constexpr uchar BLOCK_SIZE_IN_BYTES = Family::BLOCK_SIZE_IN_BYTES;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = Variant::DIGEST_SIZE_IN_BYTES;
+
+        // The core is selected according to the CPU features (or the forced implementation) on construction.
+        // Throws `invalid_argument` if the forced implementation isn't supported by the CPU
+        Sha2Hasher();
+
+        // Drops all the processed data and returns the hasher to the initial state
+        void reset();
+
+        // Continues the message from the `midstate` its first `processedSize` bytes (whole blocks) have given,
+        // e.g. the key block of HMAC. Drops the data processed so far
+        void resume(const Word *midstate, uint64 processedSize);
+
+        // Throws `invalid_argument` if the total size of the message exceeds the limit of the family
+        void update(const uchar *data, size_t size);
+
+        // Pads the message, processes the final block(s) and returns the digest.
+        // The hasher is reset afterwards and may be reused for the next message
+        Digest final();
+
+    private:
+        Word state[8];
+        uchar buffer[BLOCK_SIZE_IN_BYTES];
+        uchar bufferSize;
+        uint64 messageSize;
+        void (*processBlocks)(Word *state, const uchar *data, uint64 blocksCount);
+
+        // Pads the message and processes the final block(s)
+        void processFinalBlocks();
+    };
+
+    typedef Sha2Hasher<Sha224Variant> Sha224Hasher;
+    typedef Sha2Hasher<Sha256Variant> Sha256Hasher;
+    typedef Sha2Hasher<Sha384Variant> Sha384Hasher;
+    typedef Sha2Hasher<Sha512Variant> Sha512Hasher;
+    typedef Sha2Hasher<Sha512_224Variant> Sha512_224Hasher;
+    typedef Sha2Hasher<Sha512_256Variant> Sha512_256Hasher;
+
+    typedef Sha224Hasher::Digest Sha224Digest;
+    typedef Sha256Hasher::Digest Sha256Digest;
+    typedef Sha384Hasher::Digest Sha384Digest;
+    typedef Sha512Hasher::Digest Sha512Digest;
+    typedef Sha512_224Hasher::Digest Sha512_224Digest;
+    typedef Sha512_256Hasher::Digest Sha512_256Digest;
+
+    // Passing "-" as the `filePath` makes the function to hash the standard input
+    template <typename Variant>
+    typename Sha2Hasher<Variant>::Digest hashFile(const string &filePath, const InputOptions &options = InputOptions());
+
+    // Hashes many files at once. When the CPU has the suitable SIMD instructions, the small files are hashed
+    // in the lanes of the multi-buffer core, several files at a time. The digests are returned in the order of the `filePaths`
+    template <typename Variant>
+    vector<typename Sha2Hasher<Variant>::Digest> hashFiles(const vector<string> &filePaths, const InputOptions &options = InputOptions());
+
+    // The same for the messages in memory
+    template <typename Variant>
+    vector<typename Sha2Hasher<Variant>::Digest> hashBuffers(const vector<ByteView> &messages);
+}
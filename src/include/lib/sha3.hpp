@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+
+using namespace std;
+
+namespace sha3 {
+    // The variants of the Keccak sponge (FIPS 202) differ in the rate, the domain separation suffix
+    // and the size of the digest. The capacity is twice the security level, the rest of the 200-byte state is the rate
+    struct Sha3_224Variant {
+        static constexpr uchar RATE_IN_BYTES = 144;
+        static constexpr uchar SUFFIX = 0x06;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 28;
+    };
+
+    struct Sha3_256Variant {
+        static constexpr uchar RATE_IN_BYTES = 136;
+        static constexpr uchar SUFFIX = 0x06;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 32;
+    };
+
+    struct Sha3_384Variant {
+        static constexpr uchar RATE_IN_BYTES = 104;
+        static constexpr uchar SUFFIX = 0x06;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 48;
+    };
+
+    struct Sha3_512Variant {
+        static constexpr uchar RATE_IN_BYTES = 72;
+        static constexpr uchar SUFFIX = 0x06;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 64;
+    };
+
+    // The extendable-output functions produce the output of any size via `squeeze`.
+    // The digest returned by `final` has the size of twice the security level (as `sha3sum` does)
+    struct Shake128Variant {
+        static constexpr uchar RATE_IN_BYTES = 168;
+        static constexpr uchar SUFFIX = 0x1F;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 32;
+    };
+
+    struct Shake256Variant {
+        static constexpr uchar RATE_IN_BYTES = 136;
+        static constexpr uchar SUFFIX = 0x1F;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = 64;
+    };
+
+    // Streaming Keccak sponge.
+    // The message may be passed in portions of any size via `update`: the incomplete blocks
+    // are buffered internally until the next portion arrives, so the size of the message isn't required up front.
+    // Instantiated for the variants above only
+    template <typename Variant>
+    class Sha3Hasher {
+    public:
+        typedef array<uchar, Variant::DIGEST_SIZE_IN_BYTES> Digest;
+
+        static constexpr uchar BLOCK_SIZE_IN_BYTES = Variant::RATE_IN_BYTES;
+        static constexpr uchar DIGEST_SIZE_IN_BYTES = Variant::DIGEST_SIZE_IN_BYTES;
+
+        Sha3Hasher();
+
+        // Drops all the processed data and returns the hasher to the initial state
+        void reset();
+
+        // Throws `invalid_argument` if the output has already been squeezed
+        void update(const uchar *data, size_t size);
+
+        // Pads the message on the first call, then writes the next `size` bytes of the output.
+        // May be called many times: the output continues where the previous call has stopped
+        void squeeze(uchar *output, size_t size);
+
+        // Pads the message and returns the first bytes of the output.
+        // The hasher is reset afterwards and may be reused for the next message
+        Digest final();
+
+    private:
+        // The lanes are stored complemented (see keccakRounds.hpp)
+        uint64 state[25];
+        uchar buffer[BLOCK_SIZE_IN_BYTES];
+        uchar bufferSize;
+        bool isSqueezing;
+        // The bytes of the current block already squeezed out
+        uchar squeezedSize;
+
+        void absorbBlock(const uchar *block);
+    };
+
+    typedef Sha3Hasher<Sha3_224Variant> Sha3_224Hasher;
+    typedef Sha3Hasher<Sha3_256Variant> Sha3_256Hasher;
+    typedef Sha3Hasher<Sha3_384Variant> Sha3_384Hasher;
+    typedef Sha3Hasher<Sha3_512Variant> Sha3_512Hasher;
+    typedef Sha3Hasher<Shake128Variant> Shake128Hasher;
+    typedef Sha3Hasher<Shake256Variant> Shake256Hasher;
+
+    // Passing "-" as the `filePath` makes the function to hash the standard input
+    template <typename Variant>
+    typename Sha3Hasher<Variant>::Digest hashFile(const string &filePath, const InputOptions &options = InputOptions());
+
+    // Hashes many files at once. When the CPU has the suitable SIMD instructions, the small files are hashed
+    // in the lanes of the multi-buffer core, several files at a time. The digests are returned in the order of the `filePaths`
+    template <typename Variant>
+    vector<typename Sha3Hasher<Variant>::Digest> hashFiles(const vector<string> &filePaths, const InputOptions &options = InputOptions());
+
+    // The same for the messages in memory
+    template <typename Variant>
+    vector<typename Sha3Hasher<Variant>::Digest> hashBuffers(const vector<ByteView> &messages);
+}
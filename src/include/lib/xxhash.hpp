@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "../types.hpp"
+#include "../utils/inputReader.hpp"
+#include "kernels/xxh3Kernels.hpp"
+
+using namespace std;
+
+// XXH64 and XXH3 (64-bit) of the xxHash family with the seed 0 and the default secret, as `xxhsum -H1` and `xxhsum -H3`.
+// They are non-cryptographic: fast checksums against the accidental corruption, not against the adversary
+namespace xxhash {
+
+    // The hash as the big endian bytes, the canonical form of the reference implementation
+    typedef array<uchar, 8> XxhashDigest;
+
+    // Streaming XXH64 hasher.
+    // The input is split into the stripes of 32 bytes, each of them updates four independent 64-bit lanes.
+    // The 64-bit multiplication has no vector form before AVX-512, so the core is scalar (4 chains hide the latency)
+    class Xxh64Hasher {
+    public:
+        static const uchar STRIPE_SIZE_IN_BYTES = 32;
+        static const uchar DIGEST_SIZE_IN_BYTES = 8;
+
+        Xxh64Hasher();
+
+        // Drops all the processed data
+        void reset();
+
+        void update(const uchar *data, size_t size);
+
+        // Returns the hash, the hasher is reset afterwards and may be reused for the next message
+        XxhashDigest final();
+
+    private:
+        uint64 lanes[4];
+        uchar buffer[STRIPE_SIZE_IN_BYTES];
+        uchar bufferSize;
+        uint64 messageSize;
+    };
+
+    // Streaming XXH3 (64-bit) hasher.
+    // The messages up to 240 bytes are hashed by the dedicated short paths in `final`. The longer ones are accumulated
+    // stripe by stripe by the SIMD cores, except the last stripe, which is taken at its own secret offset in `final`
+    class Xxh3Hasher {
+    public:
+        static const uint32 BUFFER_SIZE_IN_BYTES = 256;
+        static const uchar MAX_SHORT_MESSAGE_SIZE = 240;
+        static const uchar DIGEST_SIZE_IN_BYTES = 8;
+
+        // Throws `invalid_argument` if the forced implementation isn't supported by the CPU
+        Xxh3Hasher();
+
+        // Drops all the processed data
+        void reset();
+
+        void update(const uchar *data, size_t size);
+
+        // Returns the hash, the hasher is reset afterwards and may be reused for the next message
+        XxhashDigest final();
+
+    private:
+        uint64 accumulators[_xxh3::ACCUMULATORS_COUNT];
+        uchar stripeIndex;
+        // The unprocessed input at the start, the last accumulated stripe at the end
+        // (the final stripe overlaps it when less than a stripe is left)
+        uchar buffer[BUFFER_SIZE_IN_BYTES];
+        uint32 bufferSize;
+        uint64 messageSize;
+        _xxh3::StripesFunction *accumulateStripes;
+    };
+
+    // Passing "-" as the `filePath` makes the function to hash the standard input.
+    // Instantiated for the hashers above
+    template <typename Hasher>
+    XxhashDigest hashFile(const string &filePath, const InputOptions &options = InputOptions());
+
+    // The files are hashed one by one: the cores are bound by the memory bandwidth, not by their latency.
+    // The hashes are returned in the order of the `filePaths`
+    template <typename Hasher>
+    vector<XxhashDigest> hashFiles(const vector<string> &filePaths, const InputOptions &options = InputOptions());
+
+    template <typename Hasher>
+    vector<XxhashDigest> hashBuffers(const vector<ByteView> &messages);
+
+}
@@ -1,7 +1,15 @@
 #pragma once
 
+#include <cstddef>
+
 typedef unsigned char uchar;
 typedef unsigned short uint16;
 typedef unsigned int uint32;
 typedef unsigned long uint64;
 typedef unsigned long long uint64ll;
+
+// The message in memory (e.g. one of the batch), the bytes are owned by the caller
+struct ByteView {
+    const uchar *data;
+    size_t size;
+};
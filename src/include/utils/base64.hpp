@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+#include "../types.hpp"
+
+using namespace std;
+
+// The count of characters the `size` bytes are encoded into (with the padding)
+constexpr size_t base64EncodedSize(size_t size) {
+    return (size + 2) / 3 * 4;
+}
+
+// Writes the standard (RFC 4648) base64 form of `size` bytes with the padding (`base64EncodedSize(size)` characters,
+// without the terminating zero) into the `output` and returns the end of the written characters
+char *encodeBase64(const uchar *data, size_t size, char *output);
+
+// The same as above, but allocates the string
+string toBase64(const uchar *data, size_t size);
+
+// Reads `size` bytes from their base64 form (`base64EncodedSize(size)` characters with the padding) into the `output`.
+// Returns false if the characters or the padding are invalid
+bool decodeBase64(const char *text, size_t size, uchar *output);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+
+#include "../types.hpp"
+
+using namespace std;
+
+// The SIMD and hardware-accelerated kernels are compiled for the x86 targets only.
+// Each kernel is marked with the set of required instructions via the `ZIPPY_TARGET` attribute,
+// so the rest of the program is still compiled for the baseline architecture
+// and the kernels are selected at runtime according to the CPU features
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ZIPPY_X86 1
+#define ZIPPY_TARGET(instructions) __attribute__((target(instructions)))
+#else
+#define ZIPPY_X86 0
+#define ZIPPY_TARGET(instructions)
+#endif
+
+// The same as `ZIPPY_TARGET`, but applied to all the functions (including the templates) defined in the region.
+// It allows to share the generic kernels' code between the instruction sets: such code must be included into the region
+// after all the standard headers and must have the internal linkage, so the differently compiled copies never mix up
+#define ZIPPY_PRAGMA(directive) _Pragma(#directive)
+#if ZIPPY_X86 && defined(__clang__)
+#define ZIPPY_BEGIN_TARGET_REGION(instructions) ZIPPY_PRAGMA(clang attribute push(__attribute__((target(instructions))), apply_to = function))
+#define ZIPPY_END_TARGET_REGION() ZIPPY_PRAGMA(clang attribute pop)
+#elif ZIPPY_X86
+#define ZIPPY_BEGIN_TARGET_REGION(instructions) ZIPPY_PRAGMA(GCC push_options) ZIPPY_PRAGMA(GCC target(instructions))
+#define ZIPPY_END_TARGET_REGION() ZIPPY_PRAGMA(GCC pop_options)
+#else
+#define ZIPPY_BEGIN_TARGET_REGION(instructions)
+#define ZIPPY_END_TARGET_REGION()
+#endif
+
+struct CpuFeatures {
+    bool ssse3 = false;
+    bool sse41 = false;
+    bool sse42 = false;
+    bool pclmul = false;
+    bool aesni = false;
+    bool avx2 = false;
+    bool bmi2 = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512vl = false;
+    bool vpclmulqdq = false;
+    bool sha = false;
+};
+
+// The features are detected via CPUID once, on the first call.
+// The AVX features are reported only if the operating system preserves the corresponding registers
+const CpuFeatures &getCpuFeatures();
+
+// The variants of the algorithms' cores
+enum class Implementation {
+    Auto,
+    Scalar,
+    Ssse3,
+    Avx2,
+    Avx512,
+    ShaNi,
+    AesNi,
+    Sse42,
+    Pclmul
+};
+
+// Forces the particular implementation of the cores (used for testing and benchmarking).
+// The algorithms that don't have the forced variant are using the scalar one
+void forceImplementation(Implementation implementation);
+
+Implementation getForcedImplementation();
+
+// Returns false if the name doesn't match any implementation
+bool parseImplementation(const string &name, Implementation &implementation);
+
+string implementationName(Implementation implementation);
+
+// Throws `invalid_argument` if the forced implementation can't be executed by this CPU
+void ensureImplementationSupported(Implementation implementation, bool isSupported);
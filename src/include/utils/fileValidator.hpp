@@ -1,12 +1,19 @@
 #pragma once
 
 #include <string>
-#include <istream>
 
 #include "../types.hpp"
+#include "inputReader.hpp"
 
 using namespace std;
 
-typedef string HashFunction (istream &stream, uint64 messageSize);
+// Passing "-" as the `filePath` makes the function to hash the standard input
+template <typename Digest>
+Digest validateFileForHashFunction(const string &filePath, Digest (*hashFunction)(InputReader &reader), const InputOptions &options = InputOptions()) {
+    // There is no need to get the size of file (message) up front: the hashers are processing
+    // the input until its end, thus the pipes and growing files are handled as well.
+    // The reader throws if the file can't be opened
+    InputReader reader(filePath, options);
 
-string validateFileForHashFunction(string filePath, uint64 maxMessageSize, HashFunction hashFunction);
+    return hashFunction(reader);
+}
@@ -1,14 +1,18 @@
 #pragma once
 
 #include <string>
-#include <vector>
 
 #include "../types.hpp"
 
 using namespace std;
 
-string toHex(vector<uint32> data, bool useLittleEndian = false, bool useColonDelimeter = false);
+// Writes the lowercase hexadecimal form of `size` bytes (`size * 2` characters, without the terminating zero)
+// into the `output` and returns the end of the written characters. Doesn't allocate: the caller provides the buffer
+char *encodeHex(const uchar *data, size_t size, char *output);
 
-string toHex(vector<uint64> data, bool useLittleEndian = false, bool useColonDelimeter = false);
+// The same as above, but allocates the string. Meant for the places where the speed doesn't matter
+string toHex(const uchar *data, size_t size);
 
-string toHex(vector<uchar> data, bool useColonDelimeter = false);
+// Reads `size` bytes from their hexadecimal form (`size * 2` characters of any case) into the `output`.
+// Returns false if there are any other characters
+bool decodeHex(const char *text, size_t size, uchar *output);
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <istream>
+#include <fstream>
+#include <memory>
+
+#include "../types.hpp"
+
+using namespace std;
+
+// The default size of the buffer the input is read into when it can't be memory-mapped.
+// The large buffer lets the hashers process many blocks per call and reduces the count of reads
+const uint32 DEFAULT_READ_BUFFER_SIZE = 1024 * 1024;
+
+// The read buffer is aligned to the cache line size (which is also the size of the widest SIMD register)
+const uint32 READ_BUFFER_ALIGNMENT = 64;
+
+// The size of the portions in which the memory-mapped input is handed to the hashers
+const uint64 MAPPED_PORTION_SIZE = 16 * 1024 * 1024;
+
+// The count of reads kept in flight by the overlapped reading when only the direct I/O is requested
+const uint32 DEFAULT_IO_DEPTH = 4;
+
+struct InputOptions {
+    // May be disabled to force the stream-based reading of regular files
+    bool allowMapping = true;
+    uint32 readBufferSize = DEFAULT_READ_BUFFER_SIZE;
+    // The count of threads a single mapped file may be hashed by (the tree-based algorithms only, e.g. BLAKE3),
+    // 0 means the count of hardware threads
+    uint32 threadsCount = 1;
+    // The count of reads kept in flight while the previous portions are hashed (see `ReadPipeline`).
+    // 0 disables the overlapped reading. Otherwise the regular files aren't mapped
+    uint32 ioDepth = 0;
+    // The overlapped reads bypass the page cache (O_DIRECT), if the file system allows it
+    bool directIo = false;
+    // May be disabled to force the reads by the background thread instead of io_uring
+    bool allowIoUring = true;
+};
+
+class ReadPipeline;
+
+// Provides the content of a file as a sequence of contiguous read-only portions.
+// The regular files are memory-mapped, so the portions point right into the mapping and no copying is involved.
+// Otherwise (pipes, the standard input, special files, platforms without `mmap`)
+// the input is read through the stream into an internal buffer.
+// If `InputOptions::ioDepth` is set, the regular files are read by the `ReadPipeline` instead,
+// which reads the next portions while the current one is being processed.
+class InputReader {
+public:
+    // Passing "-" as the `filePath` makes the reader to read the standard input.
+    // Throws `invalid_argument` if the file can't be opened
+    InputReader(const string &filePath, const InputOptions &options = InputOptions());
+    ~InputReader();
+
+    InputReader(const InputReader &) = delete;
+    InputReader &operator=(const InputReader &) = delete;
+
+    // Points the `data` to the next portion of the input.
+    // Returns false when the end of input has been reached
+    bool next(const uchar *&data, size_t &size);
+
+    // Reads the next portion of the input into the caller's buffer (the portion of the mapped input is copied).
+    // Lets the caller to own the buffers, e.g. to keep several portions of the stream at once.
+    // Returns the count of bytes read, 0 when the end of input has been reached
+    size_t read(uchar *target, size_t capacity);
+
+    bool isMapped() const;
+
+    // The whole content of the mapped file (valid while the reader exists), nullptr if the input isn't mapped
+    const uchar *getMapping() const;
+
+    // The size of the mapped file, 0 if the input isn't mapped
+    uint64 getMappingSize() const;
+
+    // The pipeline the file is read by, nullptr if the input isn't read by the pipeline
+    const ReadPipeline *getPipeline() const;
+
+private:
+    const uchar *mapping;
+    uint64 mappingSize;
+    uint64 mappingOffset;
+
+    istream *stream;
+    ifstream fileStream;
+    uchar *buffer;
+    uint32 bufferSize;
+
+    unique_ptr<ReadPipeline> pipeline;
+    // The rest of the pipeline's portion that hasn't been copied by `read` yet
+    const uchar *pendingData;
+    size_t pendingSize;
+
+    size_t readInto(uchar *target, size_t capacity);
+    bool tryMapFile(const string &filePath);
+    bool tryOpenPipeline(const string &filePath, const InputOptions &options);
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+
+#include "../types.hpp"
+#include "inputReader.hpp"
+
+using namespace std;
+
+// The buffers, the offsets and the sizes of the direct reads are aligned to the logical block size of the device.
+// 4 KiB suits all the common devices
+const uint32 DIRECT_IO_ALIGNMENT = 4096;
+
+enum class ReadBackend {
+    // The reads are queued to the kernel via io_uring (Linux 5.1+), no extra threads are involved
+    IoUring,
+    // The background thread reads the portions into the ring of buffers in advance
+    Thread,
+};
+
+// Reads the regular file sequentially while the caller processes the portions read before.
+// Up to `InputOptions::ioDepth` reads of `InputOptions::readBufferSize` are in flight at once, so the latency
+// of the storage (e.g. the network-backed block devices) is hidden behind the hashing: the total time
+// approaches the larger of the I/O and compute times instead of their sum
+class ReadPipeline {
+public:
+    virtual ~ReadPipeline() {}
+
+    // Points the `data` to the next portion of the file. The portion stays valid until the next call,
+    // then its buffer is given to the next read. Returns false when the end of file has been reached.
+    // Throws `invalid_argument` if the read has failed
+    virtual bool next(const uchar *&data, size_t &size) = 0;
+
+    virtual ReadBackend getBackend() const = 0;
+};
+
+// Takes the ownership of the descriptor `fd` of the regular file of `fileSize` bytes.
+// io_uring is used if it's allowed by the `options` and available (the kernel may lack it or block it by seccomp),
+// otherwise the reads are made by the background thread. The `isDirect` descriptor has been opened with O_DIRECT
+unique_ptr<ReadPipeline> createReadPipeline(int fd, uint64 fileSize, bool isDirect, const InputOptions &options);
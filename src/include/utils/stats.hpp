@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+
+#include "../types.hpp"
+
+using namespace std;
+
+// The instrumentation of the hot paths: the time spent in each stage of the processing of files and the counts of bytes and reads.
+// The time is measured in the TSC cycles (the nanoseconds of the steady clock where there is no TSC) and the counters are
+// thread-local, so the instrumentation costs a couple of timestamps per portion of the input and no synchronization.
+// The instrumentation is compiled out if ZIPPY_STATS is 0 (the CMake option ZIPPY_STATS), all the counters stay zero then
+#ifndef ZIPPY_STATS
+#define ZIPPY_STATS 1
+#endif
+
+// Open: opening, stat and mapping of the file. Read: waiting for the portions of the input (the stream, the read pipeline).
+// Hash: the rest of the processing of the file. Format: the printing of the digests and the writing of the (de)compressed data.
+// Compress: the compression and the decompression (the checksums of the data are counted as hashing).
+// Encrypt: the encryption and the decryption, including their authentication tags.
+// The pages of the memory-mapped files are read on the first access, so their reading is counted as hashing
+enum class Stage : uchar {
+    Open = 0,
+    Read = 1,
+    Hash = 2,
+    Format = 3,
+    Compress = 4,
+    Encrypt = 5
+};
+
+const size_t STAGES_COUNT = 6;
+
+// The counters of a file, of a thread or of the whole process
+struct StatsCounters {
+    array<uint64, STAGES_COUNT> ticks {};
+    uint64 bytes = 0;
+    // The portions the input has been read in
+    uint64 reads = 0;
+    uint64 files = 0;
+
+    uint64 getTicks(Stage stage) const {
+        return ticks[(size_t)stage];
+    }
+
+    StatsCounters &operator+=(const StatsCounters &other);
+    StatsCounters operator-(const StatsCounters &other) const;
+
+    // The counters of the file hashed among the `totalBytes` of the group: the group's time is shared by the sizes of files
+    StatsCounters share(uint64 bytes, uint64 totalBytes) const;
+};
+
+// The hardware counters of the process (Linux perf_event, the user-space part only)
+struct PerfReadout {
+    uint64 cycles = 0;
+    uint64 instructions = 0;
+    uint64 cacheMisses = 0;
+};
+
+#if ZIPPY_STATS
+
+uint64 readTicks();
+
+double ticksToSeconds(uint64 ticks);
+
+void addStageTicks(Stage stage, uint64 ticks);
+
+// Counts the portion of the input that has been read
+void addReadBytes(uint64 bytes);
+
+// The counters of the current thread since its start
+StatsCounters getThreadStats();
+
+// The sum of the counters of all the threads (including the finished ones) since the start or since `resetProcessStats`
+StatsCounters getProcessStats();
+
+void resetProcessStats();
+
+// Adds the time of its life to the stage of the current thread
+class StageTimer {
+public:
+    explicit StageTimer(Stage stage) : stage(stage), start(readTicks()) {}
+
+    ~StageTimer() {
+        addStageTicks(stage, readTicks() - start);
+    }
+
+    StageTimer(const StageTimer &) = delete;
+    StageTimer &operator=(const StageTimer &) = delete;
+
+private:
+    Stage stage;
+    uint64 start;
+};
+
+// Measures the processing of the file (or of the group of files) by the current thread.
+// The time that isn't spent in the other stages is counted as the `stage` (hashing or decompression)
+class FileStatsScope {
+public:
+    explicit FileStatsScope(Stage stage = Stage::Hash) : stage(stage), start(getThreadStats()), startTicks(readTicks()) {}
+
+    // Returns the counters of the file(s) and counts the rest of their time and the `filesCount` in the thread's counters
+    StatsCounters finish(uint64 filesCount = 1);
+
+private:
+    Stage stage;
+    StatsCounters start;
+    uint64 startTicks;
+};
+
+#else
+
+inline uint64 readTicks() {
+    return 0;
+}
+
+inline double ticksToSeconds(uint64) {
+    return 0;
+}
+
+inline void addStageTicks(Stage, uint64) {}
+
+inline void addReadBytes(uint64) {}
+
+inline StatsCounters getThreadStats() {
+    return StatsCounters();
+}
+
+inline StatsCounters getProcessStats() {
+    return StatsCounters();
+}
+
+inline void resetProcessStats() {}
+
+class StageTimer {
+public:
+    explicit StageTimer(Stage) {}
+};
+
+class FileStatsScope {
+public:
+    explicit FileStatsScope(Stage = Stage::Hash) {}
+
+    StatsCounters finish(uint64 = 1) {
+        return StatsCounters();
+    }
+};
+
+#endif
+
+// Counts the cycles, instructions and cache misses of the process while it exists.
+// The threads started after it are counted once they have exited (e.g. the workers of the finished batch)
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    // False if the counters aren't supported or aren't permitted (see /proc/sys/kernel/perf_event_paranoid)
+    bool isAvailable() const;
+
+    PerfReadout read() const;
+
+private:
+    array<int, 3> fds;
+};
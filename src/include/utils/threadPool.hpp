@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+#include "../types.hpp"
+
+using namespace std;
+
+// The work-stealing thread pool.
+// Each worker has its own queue of tasks: the submitted tasks are spread over the queues, and the worker
+// that has run out of its own tasks steals them from the back of the other queues.
+// The long tasks (e.g. the hashing of large files) are kept in the separate queue and are never executed
+// by all the workers at once while there are short tasks, so the long tasks can't starve the short ones.
+class ThreadPool {
+public:
+    typedef function<void ()> Task;
+
+    // 0 means the count of hardware threads
+    explicit ThreadPool(uint32 threadsCount = 0);
+
+    // Waits for all the submitted tasks
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // The tasks must not throw
+    void submit(Task task, bool isLong = false);
+
+    // Blocks until all the submitted tasks are completed
+    void wait();
+
+    uint32 getThreadsCount() const;
+
+private:
+    struct Queue {
+        mutex lock;
+        deque<Task> tasks;
+    };
+
+    vector<unique_ptr<Queue>> queues;
+    Queue longTasks;
+    vector<thread> threads;
+
+    atomic<uint32> nextQueue;
+    atomic<uint32> runningLongTasksCount;
+    uint32 maxRunningLongTasksCount;
+
+    mutex stateLock;
+    condition_variable hasTasks;
+    condition_variable isIdle;
+    // Both are guarded by the `stateLock`
+    size_t queuedTasksCount;
+    size_t pendingTasksCount;
+    bool isStopping;
+
+    void runWorker(uint32 index);
+    bool takeTask(uint32 index, Task &task, bool &isLong);
+    bool takeLongTask(Task &task, bool force);
+    bool popFront(Queue &queue, Task &task);
+    bool popBack(Queue &queue, Task &task);
+};
@@ -0,0 +1,107 @@
+#ifndef ZIPPY_H
+#define ZIPPY_H
+
+/*
+ * The C interface of libzippy: the one-shot, streaming and batch hashing of the memory buffers, the files
+ * and the file descriptors by any of the algorithms of the command line tool (md5, sha256, sha3-256, blake3, ...).
+ *
+ * The interface is stable: the functions are never changed once released, the new ones are added instead,
+ * and the version below is increased. The digests are written in the order of their canonical hexadecimal form,
+ * `zippyDigestSize` bytes each (at most ZIPPY_MAX_DIGEST_SIZE).
+ * All the functions are thread-safe, a single hasher must not be used by several threads at once.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ZIPPY_API __attribute__((visibility("default")))
+#else
+#define ZIPPY_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ZIPPY_API_VERSION 2
+#define ZIPPY_MAX_DIGEST_SIZE 64
+
+typedef enum ZippyStatus {
+    ZIPPY_OK = 0,
+    ZIPPY_UNKNOWN_ALGORITHM = 1,
+    ZIPPY_INVALID_ARGUMENT = 2,
+    /* The file can't be opened or read */
+    ZIPPY_IO_ERROR = 3,
+    ZIPPY_OUT_OF_MEMORY = 4,
+    ZIPPY_INTERNAL_ERROR = 5
+} ZippyStatus;
+
+typedef struct ZippyHasher ZippyHasher;
+
+/* The counters of the files and descriptors hashed by all the threads of the process (since version 2).
+ * The time of each stage is summed over the threads, the reading of the memory-mapped files is counted as hashing */
+typedef struct ZippyStats {
+    uint64_t files;
+    uint64_t bytes;
+    /* The portions the input has been read in */
+    uint64_t reads;
+    /* Opening, stat and mapping of the files */
+    uint64_t openNanoseconds;
+    /* Waiting for the portions of the input */
+    uint64_t readNanoseconds;
+    uint64_t hashNanoseconds;
+} ZippyStats;
+
+/* The ZIPPY_API_VERSION the library has been built with */
+ZIPPY_API uint32_t zippyApiVersion(void);
+
+/* The short description of the status, never NULL */
+ZIPPY_API const char *zippyStatusMessage(ZippyStatus status);
+
+/* The name of the algorithm with the `index` (starting from 0), NULL if there are no more algorithms */
+ZIPPY_API const char *zippyAlgorithmName(size_t index);
+
+/* The size of the digest in bytes, 0 if there is no such algorithm */
+ZIPPY_API size_t zippyDigestSize(const char *algorithm);
+
+/* Hashes the message in memory */
+ZIPPY_API ZippyStatus zippyHash(const char *algorithm, const void *data, size_t size, uint8_t *digest);
+
+/* The streaming hasher: the message is passed in portions of any size */
+ZIPPY_API ZippyStatus zippyHasherCreate(const char *algorithm, ZippyHasher **hasher);
+ZIPPY_API ZippyStatus zippyHasherUpdate(ZippyHasher *hasher, const void *data, size_t size);
+/* Writes the digest and resets the hasher, so it may be reused for the next message */
+ZIPPY_API ZippyStatus zippyHasherFinal(ZippyHasher *hasher, uint8_t *digest);
+ZIPPY_API void zippyHasherDestroy(ZippyHasher *hasher);
+
+/* Hashes the file ("-" means the standard input). The regular files are memory-mapped */
+ZIPPY_API ZippyStatus zippyHashFile(const char *algorithm, const char *filePath, uint8_t *digest);
+
+/* Hashes the rest of the input of the descriptor (from its current position up to the end).
+ * The descriptor stays open, it may be a pipe or a socket as well */
+ZIPPY_API ZippyStatus zippyHashDescriptor(const char *algorithm, int fd, uint8_t *digest);
+
+/* Hashes `count` messages in memory at once: the small ones go through the multi-buffer cores, several at a time.
+ * The digest of the message `i` is written at `digests + i * zippyDigestSize(algorithm)` */
+ZIPPY_API ZippyStatus zippyHashBatch(
+    const char *algorithm, const void *const *messages, const size_t *sizes, size_t count, uint8_t *digests
+);
+
+/* Hashes `count` files by `threadsCount` threads (0 means the count of cores). The digests are placed as by `zippyHashBatch`.
+ * The status of each file is written into `statuses` (may be NULL). Returns ZIPPY_IO_ERROR if any of the files has failed */
+ZIPPY_API ZippyStatus zippyHashFiles(
+    const char *algorithm, const char *const *filePaths, size_t count, uint32_t threadsCount, uint8_t *digests, ZippyStatus *statuses
+);
+
+/* Fills the stats accumulated since the start of the process or since the last zippyResetStats.
+ * The `size` is sizeof(ZippyStats) of the caller, so the structure may grow in the later versions.
+ * The stats stay zero if the library has been built without the instrumentation (ZIPPY_STATS=OFF) */
+ZIPPY_API ZippyStatus zippyGetStats(ZippyStats *stats, size_t size);
+ZIPPY_API void zippyResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "zippy.h"
+
+// The C++ interface of libzippy. It's a header-only layer over the C interface, so it relies on the stable ABI
+// of the library only and may be used with any C++ standard library. The failures are thrown as the exceptions:
+// `invalid_argument` for the unknown algorithms and the arguments, `runtime_error` for the input that can't be read,
+// `bad_alloc` when there is no memory left.
+// Unlike the internal headers, this one never brings the `std` namespace into the code that includes it
+namespace zippy {
+    typedef std::vector<uint8_t> Digest;
+
+    inline void throwIfFailed(ZippyStatus status) {
+        switch (status) {
+            case ZIPPY_OK:
+                return;
+            case ZIPPY_IO_ERROR:
+                throw std::runtime_error(zippyStatusMessage(status));
+            case ZIPPY_OUT_OF_MEMORY:
+                throw std::bad_alloc();
+            default:
+                throw std::invalid_argument(zippyStatusMessage(status));
+        }
+    }
+
+    inline std::vector<std::string> getAlgorithmNames() {
+        std::vector<std::string> names;
+        for (size_t i = 0; zippyAlgorithmName(i) != nullptr; i++) {
+            names.push_back(zippyAlgorithmName(i));
+        }
+        return names;
+    }
+
+    // Throws `invalid_argument` if there is no such algorithm
+    inline size_t getDigestSize(const std::string &algorithm) {
+        size_t size = zippyDigestSize(algorithm.c_str());
+        if (size == 0) {
+            throwIfFailed(ZIPPY_UNKNOWN_ALGORITHM);
+        }
+        return size;
+    }
+
+    inline Digest hash(const std::string &algorithm, const void *data, size_t size) {
+        Digest digest(getDigestSize(algorithm));
+        throwIfFailed(zippyHash(algorithm.c_str(), data, size, digest.data()));
+        return digest;
+    }
+
+    inline Digest hash(const std::string &algorithm, const std::string &message) {
+        return hash(algorithm, message.data(), message.size());
+    }
+
+    // Passing "-" as the `filePath` hashes the standard input
+    inline Digest hashFile(const std::string &algorithm, const std::string &filePath) {
+        Digest digest(getDigestSize(algorithm));
+        throwIfFailed(zippyHashFile(algorithm.c_str(), filePath.c_str(), digest.data()));
+        return digest;
+    }
+
+    // Hashes the rest of the input of the descriptor, which stays open
+    inline Digest hashDescriptor(const std::string &algorithm, int fd) {
+        Digest digest(getDigestSize(algorithm));
+        throwIfFailed(zippyHashDescriptor(algorithm.c_str(), fd, digest.data()));
+        return digest;
+    }
+
+    // The digests are returned in the order of the `messages`
+    inline std::vector<Digest> hashBatch(const std::string &algorithm, const std::vector<std::string> &messages) {
+        size_t digestSize = getDigestSize(algorithm);
+        std::vector<const void *> data;
+        std::vector<size_t> sizes;
+        for (const std::string &message : messages) {
+            data.push_back(message.data());
+            sizes.push_back(message.size());
+        }
+
+        std::vector<uint8_t> digests(digestSize * messages.size());
+        throwIfFailed(zippyHashBatch(algorithm.c_str(), data.data(), sizes.data(), messages.size(), digests.data()));
+
+        std::vector<Digest> results;
+        for (size_t i = 0; i < messages.size(); i++) {
+            results.emplace_back(digests.begin() + i * digestSize, digests.begin() + (i + 1) * digestSize);
+        }
+        return results;
+    }
+
+    // Hashes the files by `threadsCount` threads (0 means the count of cores).
+    // The digests are returned in the order of the `filePaths`, the ones of the failed files are empty
+    inline std::vector<Digest> hashFiles(const std::string &algorithm, const std::vector<std::string> &filePaths, uint32_t threadsCount = 0) {
+        size_t digestSize = getDigestSize(algorithm);
+        std::vector<const char *> paths;
+        for (const std::string &filePath : filePaths) {
+            paths.push_back(filePath.c_str());
+        }
+
+        std::vector<uint8_t> digests(digestSize * filePaths.size());
+        std::vector<ZippyStatus> statuses(filePaths.size());
+        ZippyStatus status = zippyHashFiles(algorithm.c_str(), paths.data(), paths.size(), threadsCount, digests.data(), statuses.data());
+        if (status != ZIPPY_IO_ERROR) {
+            throwIfFailed(status);
+        }
+
+        std::vector<Digest> results(filePaths.size());
+        for (size_t i = 0; i < filePaths.size(); i++) {
+            if (statuses[i] == ZIPPY_OK) {
+                results[i].assign(digests.begin() + i * digestSize, digests.begin() + (i + 1) * digestSize);
+            }
+        }
+        return results;
+    }
+
+    // The counters of the files hashed by the process since its start or since `resetStats`
+    inline ZippyStats getStats() {
+        ZippyStats stats {};
+        throwIfFailed(zippyGetStats(&stats, sizeof(stats)));
+        return stats;
+    }
+
+    inline void resetStats() {
+        zippyResetStats();
+    }
+
+    // The streaming hasher: the message is passed in portions of any size
+    class Hasher {
+    public:
+        explicit Hasher(const std::string &algorithm) : digestSize(getDigestSize(algorithm)) {
+            ZippyHasher *created = nullptr;
+            throwIfFailed(zippyHasherCreate(algorithm.c_str(), &created));
+            hasher.reset(created);
+        }
+
+        void update(const void *data, size_t size) {
+            throwIfFailed(zippyHasherUpdate(hasher.get(), data, size));
+        }
+
+        void update(const std::string &data) {
+            update(data.data(), data.size());
+        }
+
+        // Returns the digest and resets the hasher
+        Digest final() {
+            Digest digest(digestSize);
+            throwIfFailed(zippyHasherFinal(hasher.get(), digest.data()));
+            return digest;
+        }
+
+    private:
+        struct Deleter {
+            void operator()(ZippyHasher *hasher) const {
+                zippyHasherDestroy(hasher);
+            }
+        };
+
+        size_t digestSize;
+        std::unique_ptr<ZippyHasher, Deleter> hasher;
+    };
+}
@@ -0,0 +1,47 @@
+#include "../include/lib/aead.hpp"
+
+#include "../include/lib/chacha20.hpp"
+#include "../include/lib/aesGcm.hpp"
+#include "../include/utils/cpuFeatures.hpp"
+
+namespace aead {
+
+    unique_ptr<Cipher> createCipher(Algorithm algorithm, const Key &key) {
+        if (algorithm == Algorithm::Aes256Gcm) {
+            return unique_ptr<Cipher>(new aes::Aes256Gcm(key));
+        }
+        return unique_ptr<Cipher>(new chacha20::ChaCha20Poly1305(key));
+    }
+
+    Algorithm getPreferredAlgorithm() {
+        const CpuFeatures &features = getCpuFeatures();
+        return features.aesni && features.pclmul && features.sse41 ? Algorithm::Aes256Gcm : Algorithm::ChaCha20Poly1305;
+    }
+
+    string algorithmName(Algorithm algorithm) {
+        switch (algorithm) {
+            case Algorithm::ChaCha20Poly1305: return "chacha20-poly1305";
+            case Algorithm::Aes256Gcm: return "aes-256-gcm";
+        }
+        return "unknown";
+    }
+
+    bool parseAlgorithm(const string &name, Algorithm &algorithm) {
+        for (Algorithm candidate : { Algorithm::ChaCha20Poly1305, Algorithm::Aes256Gcm }) {
+            if (algorithmName(candidate) == name) {
+                algorithm = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool areTagsEqual(const uchar *first, const uchar *second) {
+        uchar difference = 0;
+        for (uchar i = 0; i < TAG_SIZE; i++) {
+            difference |= first[i] ^ second[i];
+        }
+        return difference == 0;
+    }
+
+}
@@ -0,0 +1,312 @@
+#include "../include/lib/aesGcm.hpp"
+
+#include <array>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../include/utils/cpuFeatures.hpp"
+
+namespace aes {
+
+    // Compiler may mix up the functions defined inside a different module with the equal names and signatures.
+    // Thus, we have to move all those functions and variables in the algorithm-specific inner namespace
+    namespace _aes {
+        const uchar KEY_WORDS_COUNT = 8;
+        const uchar ROUND_CONSTANTS[7] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40 };
+
+        constexpr uchar rotateLeft8(uchar x, uchar shift) {
+            return uchar((x << shift) | (x >> (8 - shift)));
+        }
+
+        // The multiplication by x in GF(2^8) modulo x^8 + x^4 + x^3 + x + 1
+        constexpr uchar multiplyByX(uchar x) {
+            return uchar((x << 1) ^ (x & 0x80 ? 0x1B : 0));
+        }
+
+        // The multiplicative inverse followed by the affine transformation. The generator 3 walks over all the non-zero
+        // elements, while its inverse walks them backwards, so they give the element and its inverse at once
+        constexpr array<uchar, 256> generateSbox() {
+            array<uchar, 256> sbox {};
+            uchar element = 1, inverse = 1;
+            do {
+                element = uchar(element ^ multiplyByX(element));
+                inverse ^= uchar(inverse << 1);
+                inverse ^= uchar(inverse << 2);
+                inverse ^= uchar(inverse << 4);
+                if (inverse & 0x80) {
+                    inverse ^= 0x09;
+                }
+                sbox[element] = uchar(inverse ^ rotateLeft8(inverse, 1) ^ rotateLeft8(inverse, 2)
+                    ^ rotateLeft8(inverse, 3) ^ rotateLeft8(inverse, 4) ^ 0x63);
+            } while (element != 1);
+            sbox[0] = 0x63;
+            return sbox;
+        }
+
+        constexpr array<uchar, 256> SBOX = generateSbox();
+
+        typedef array<array<uint32, 256>, 4> RoundTables;
+
+        // The table k gives the column of MixColumns for the S-box of the byte in the row k, so a round is 16 lookups
+        constexpr RoundTables generateRoundTables() {
+            RoundTables tables {};
+            for (uint32 byte = 0; byte < 256; byte++) {
+                uint32 s = SBOX[byte];
+                uint32 s2 = multiplyByX(uchar(s));
+                tables[0][byte] = s2 | s << 8 | s << 16 | (s2 ^ s) << 24;
+                for (uchar k = 1; k < 4; k++) {
+                    tables[k][byte] = tables[k - 1][byte] << 8 | tables[k - 1][byte] >> 24;
+                }
+            }
+            return tables;
+        }
+
+        constexpr RoundTables ROUND_TABLES = generateRoundTables();
+
+        inline uint32 loadLittleEndian32(const uchar *data) {
+            return data[0] | data[1] << 8 | data[2] << 16 | uint32(data[3]) << 24;
+        }
+
+        inline void storeLittleEndian32(uint32 word, uchar *output) {
+            output[0] = uchar(word);
+            output[1] = uchar(word >> 8);
+            output[2] = uchar(word >> 16);
+            output[3] = uchar(word >> 24);
+        }
+
+        inline uint64 loadBigEndian64(const uchar *data) {
+            uint64 value = 0;
+            for (uchar i = 0; i < 8; i++) {
+                value = value << 8 | data[i];
+            }
+            return value;
+        }
+
+        inline void storeBigEndian64(uint64 value, uchar *output) {
+            for (uchar i = 0; i < 8; i++) {
+                output[i] = uchar(value >> (56 - 8 * i));
+            }
+        }
+
+        inline uint32 substituteWord(uint32 word) {
+            return SBOX[word & 0xFF] | SBOX[(word >> 8) & 0xFF] << 8 | SBOX[(word >> 16) & 0xFF] << 16 | uint32(SBOX[word >> 24]) << 24;
+        }
+
+        // The words are little endian: the first byte of the column is the lowest one
+        void expandKey(const uchar *key, uchar *roundKeys) {
+            uint32 words[ROUND_KEYS_SIZE / 4];
+            for (uchar i = 0; i < KEY_WORDS_COUNT; i++) {
+                words[i] = loadLittleEndian32(key + i * 4);
+            }
+            for (uchar i = KEY_WORDS_COUNT; i < ROUND_KEYS_SIZE / 4; i++) {
+                uint32 word = words[i - 1];
+                if (i % KEY_WORDS_COUNT == 0) {
+                    word = substituteWord(word >> 8 | word << 24) ^ ROUND_CONSTANTS[i / KEY_WORDS_COUNT - 1];
+                } else if (i % KEY_WORDS_COUNT == 4) {
+                    word = substituteWord(word);
+                }
+                words[i] = words[i - KEY_WORDS_COUNT] ^ word;
+            }
+            for (uchar i = 0; i < ROUND_KEYS_SIZE / 4; i++) {
+                storeLittleEndian32(words[i], roundKeys + i * 4);
+            }
+        }
+
+        void encryptBlockScalar(const uchar *roundKeys, const uchar *input, uchar *output) {
+            const RoundTables &t = ROUND_TABLES;
+            uint32 s[4];
+            for (uchar column = 0; column < 4; column++) {
+                s[column] = loadLittleEndian32(input + column * 4) ^ loadLittleEndian32(roundKeys + column * 4);
+            }
+            // ShiftRows takes the row k of the column from the column k places further
+            for (uchar round = 1; round < ROUNDS_COUNT; round++) {
+                const uchar *roundKey = roundKeys + round * BLOCK_SIZE_IN_BYTES;
+                uint32 next[4];
+                for (uchar column = 0; column < 4; column++) {
+                    next[column] = t[0][s[column] & 0xFF] ^ t[1][(s[(column + 1) & 3] >> 8) & 0xFF]
+                        ^ t[2][(s[(column + 2) & 3] >> 16) & 0xFF] ^ t[3][s[(column + 3) & 3] >> 24]
+                        ^ loadLittleEndian32(roundKey + column * 4);
+                }
+                memcpy(s, next, sizeof(s));
+            }
+            // The last round has no MixColumns
+            const uchar *roundKey = roundKeys + ROUNDS_COUNT * BLOCK_SIZE_IN_BYTES;
+            for (uchar column = 0; column < 4; column++) {
+                uint32 word = SBOX[s[column] & 0xFF] | SBOX[(s[(column + 1) & 3] >> 8) & 0xFF] << 8
+                    | SBOX[(s[(column + 2) & 3] >> 16) & 0xFF] << 16 | uint32(SBOX[s[(column + 3) & 3] >> 24]) << 24;
+                storeLittleEndian32(word ^ loadLittleEndian32(roundKey + column * 4), output + column * 4);
+            }
+        }
+
+        // The reductions of the 4 bits shifted out of the product by the multiplication by x^4
+        const uint16 REMAINDERS[16] = {
+            0x0000, 0x1C20, 0x3840, 0x2460, 0x7080, 0x6CA0, 0x48C0, 0x54E0,
+            0xE100, 0xFD20, 0xD940, 0xC560, 0x9180, 0x8DA0, 0xA9C0, 0xB5E0
+        };
+
+        // The products of H and all the 4-bit values (Shoup's method), in the reflected bit order of GHASH
+        void generateHashTables(const uchar *hashKey, uint64 *high, uint64 *low) {
+            uint64 vh = loadBigEndian64(hashKey), vl = loadBigEndian64(hashKey + 8);
+            high[0] = low[0] = 0;
+            high[8] = vh;
+            low[8] = vl;
+            for (uchar i = 4; i > 0; i >>= 1) {
+                uint64 reduction = (vl & 1) * 0xE100000000000000;
+                vl = vh << 63 | vl >> 1;
+                vh = (vh >> 1) ^ reduction;
+                high[i] = vh;
+                low[i] = vl;
+            }
+            for (uchar i = 2; i <= 8; i *= 2) {
+                for (uchar j = 1; j < i; j++) {
+                    high[i + j] = high[i] ^ high[j];
+                    low[i + j] = low[i] ^ low[j];
+                }
+            }
+        }
+
+        void selectCores(bool &useAesNi) {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+            useAesNi = (implementation == Implementation::Auto || implementation == Implementation::AesNi)
+                && features.aesni && features.pclmul && features.sse41;
+            if (implementation == Implementation::AesNi) {
+                ensureImplementationSupported(implementation, useAesNi);
+            }
+        }
+    }
+
+    Aes256Gcm::Aes256Gcm(const aead::Key &key) {
+        _aes::selectCores(useAesNi);
+        _aes::expandKey(key.data(), roundKeys);
+
+        uchar hashKey[_aes::BLOCK_SIZE_IN_BYTES] = {};
+        encryptBlock(hashKey, hashKey);
+        if (useAesNi) {
+            _aes::initializeHashKeyPowersPclmul(hashKey, hashKeyPowers);
+        } else {
+            _aes::generateHashTables(hashKey, hashTableHigh, hashTableLow);
+        }
+    }
+
+    void Aes256Gcm::encryptBlock(const uchar *input, uchar *output) const {
+        if (useAesNi) {
+            _aes::encryptBlockAesNi(roundKeys, input, output);
+        } else {
+            _aes::encryptBlockScalar(roundKeys, input, output);
+        }
+    }
+
+    // The state is multiplied by H four bits at a time, from the last byte to the first one
+    void Aes256Gcm::multiplyByHashKey(uchar *state) const {
+        uchar index = state[15] & 0x0F;
+        uint64 high = hashTableHigh[index], low = hashTableLow[index];
+        for (int i = 15; i >= 0; i--) {
+            for (uchar half = i == 15 ? 1 : 0; half < 2; half++) {
+                index = half == 0 ? state[i] & 0x0F : state[i] >> 4;
+                uchar remainder = low & 0x0F;
+                low = high << 60 | low >> 4;
+                high = (high >> 4) ^ uint64(_aes::REMAINDERS[remainder]) << 48;
+                high ^= hashTableHigh[index];
+                low ^= hashTableLow[index];
+            }
+        }
+        _aes::storeBigEndian64(high, state);
+        _aes::storeBigEndian64(low, state + 8);
+    }
+
+    void Aes256Gcm::ghashBlocks(uchar *state, const uchar *data, size_t blocksCount) const {
+        if (useAesNi) {
+            _aes::ghashBlocksPclmul(hashKeyPowers, state, data, blocksCount);
+            return;
+        }
+        for (; blocksCount > 0; blocksCount--, data += _aes::BLOCK_SIZE_IN_BYTES) {
+            for (uchar i = 0; i < _aes::BLOCK_SIZE_IN_BYTES; i++) {
+                state[i] ^= data[i];
+            }
+            multiplyByHashKey(state);
+        }
+    }
+
+    void Aes256Gcm::crypt(
+        const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+        const uchar *input, size_t size, uchar *output, bool isEncrypting, uchar *tag
+    ) const {
+        using namespace _aes;
+        if (size > MAX_MESSAGE_SIZE) {
+            throw invalid_argument("The message is too long for AES-256-GCM");
+        }
+
+        // The pre-counter block J0 = nonce || 1 masks the tag, the message is encrypted from the counter 2
+        alignas(16) uchar counterBlock[BLOCK_SIZE_IN_BYTES] = {};
+        memcpy(counterBlock, nonce, aead::NONCE_SIZE);
+        counterBlock[15] = 1;
+        uchar tagMask[BLOCK_SIZE_IN_BYTES];
+        encryptBlock(counterBlock, tagMask);
+        counterBlock[15] = 2;
+
+        alignas(16) uchar state[BLOCK_SIZE_IN_BYTES] = {};
+        size_t fullSize = associatedDataSize / BLOCK_SIZE_IN_BYTES * BLOCK_SIZE_IN_BYTES;
+        ghashBlocks(state, associatedData, fullSize / BLOCK_SIZE_IN_BYTES);
+        if (fullSize != associatedDataSize) {
+            uchar block[BLOCK_SIZE_IN_BYTES] = {};
+            memcpy(block, associatedData + fullSize, associatedDataSize - fullSize);
+            ghashBlocks(state, block, 1);
+        }
+
+        if (useAesNi) {
+            cryptAesNi(roundKeys, hashKeyPowers, counterBlock, input, output, size, isEncrypting, state);
+        } else {
+            uint32 counter = 2;
+            for (size_t offset = 0; offset < size; offset += BLOCK_SIZE_IN_BYTES, counter++) {
+                counterBlock[12] = uchar(counter >> 24);
+                counterBlock[13] = uchar(counter >> 16);
+                counterBlock[14] = uchar(counter >> 8);
+                counterBlock[15] = uchar(counter);
+                uchar keyStream[BLOCK_SIZE_IN_BYTES];
+                encryptBlockScalar(roundKeys, counterBlock, keyStream);
+
+                // The incomplete last block is zero-padded for GHASH
+                size_t blockSize = min(size - offset, size_t(BLOCK_SIZE_IN_BYTES));
+                uchar ciphertext[BLOCK_SIZE_IN_BYTES] = {};
+                for (uchar i = 0; i < blockSize; i++) {
+                    uchar in = input[offset + i];
+                    uchar out = in ^ keyStream[i];
+                    output[offset + i] = out;
+                    ciphertext[i] = isEncrypting ? out : in;
+                }
+                ghashBlocks(state, ciphertext, 1);
+            }
+        }
+
+        uchar sizes[BLOCK_SIZE_IN_BYTES];
+        storeBigEndian64(uint64(associatedDataSize) * 8, sizes);
+        storeBigEndian64(uint64(size) * 8, sizes + 8);
+        ghashBlocks(state, sizes, 1);
+        for (uchar i = 0; i < BLOCK_SIZE_IN_BYTES; i++) {
+            tag[i] = state[i] ^ tagMask[i];
+        }
+    }
+
+    void Aes256Gcm::seal(
+        const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+        const uchar *input, size_t size, uchar *output, uchar *tag
+    ) const {
+        crypt(nonce, associatedData, associatedDataSize, input, size, output, true, tag);
+    }
+
+    bool Aes256Gcm::open(
+        const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+        const uchar *input, size_t size, uchar *output, const uchar *tag
+    ) const {
+        uchar expectedTag[aead::TAG_SIZE];
+        crypt(nonce, associatedData, associatedDataSize, input, size, output, false, expectedTag);
+        if (!aead::areTagsEqual(tag, expectedTag)) {
+            memset(output, 0, size);
+            return false;
+        }
+        return true;
+    }
+
+}
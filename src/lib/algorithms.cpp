@@ -0,0 +1,138 @@
+#include "../include/lib/algorithms.hpp"
+
+#include "../include/lib/md5.hpp"
+#include "../include/lib/sha2.hpp"
+#include "../include/lib/hmac.hpp"
+#include "../include/lib/sha3.hpp"
+#include "../include/lib/blake3.hpp"
+#include "../include/lib/crc32.hpp"
+#include "../include/lib/xxhash.hpp"
+
+namespace {
+
+    template <typename Hasher>
+    class StreamingHasherAdapter : public StreamingHasher {
+    public:
+        void update(const uchar *data, size_t size) override {
+            hasher.update(data, size);
+        }
+
+        HashDigest final() override {
+            return hasher.final();
+        }
+
+    private:
+        Hasher hasher;
+    };
+
+    template <typename Hasher>
+    unique_ptr<StreamingHasher> createHasher() {
+        return make_unique<StreamingHasherAdapter<Hasher>>();
+    }
+
+    // The algorithms return the digests of their own fixed-size types
+    template <auto hashFile>
+    HashDigest hashFileAdapter(const string &filePath, const InputOptions &options) {
+        return hashFile(filePath, options);
+    }
+
+    template <auto hashFiles>
+    vector<HashDigest> hashFilesAdapter(const vector<string> &filePaths, const InputOptions &options) {
+        auto digests = hashFiles(filePaths, options);
+        return vector<HashDigest>(digests.begin(), digests.end());
+    }
+
+    template <auto hashBuffers>
+    vector<HashDigest> hashBuffersAdapter(const vector<ByteView> &messages) {
+        auto digests = hashBuffers(messages);
+        return vector<HashDigest>(digests.begin(), digests.end());
+    }
+
+    template <typename Variant>
+    class HmacHasherAdapter : public StreamingHasher {
+    public:
+        HmacHasherAdapter(const uchar *key, size_t keySize) : hasher(key, keySize) {}
+
+        void update(const uchar *data, size_t size) override {
+            hasher.update(data, size);
+        }
+
+        HashDigest final() override {
+            return hasher.final();
+        }
+
+    private:
+        sha2::HmacHasher<Variant> hasher;
+    };
+
+    template <typename Variant>
+    unique_ptr<StreamingHasher> createHmacHasher(const uchar *key, size_t keySize) {
+        return make_unique<HmacHasherAdapter<Variant>>(key, keySize);
+    }
+
+    template <typename Variant>
+    vector<HashDigest> macBuffersAdapter(const uchar *key, size_t keySize, const vector<ByteView> &messages) {
+        auto macs = sha2::macBuffers<Variant>(key, keySize, messages);
+        return vector<HashDigest>(macs.begin(), macs.end());
+    }
+
+    template <typename Variant>
+    HmacAlgorithm makeHmacAlgorithm(const string &name) {
+        return {
+            name, Variant::DIGEST_SIZE_IN_BYTES, createHmacHasher<Variant>, macBuffersAdapter<Variant>,
+            sha2::hkdf<Variant>, sha2::pbkdf2Batch<Variant>
+        };
+    }
+
+}
+
+// The order matters for the untagged checksum lines: the first algorithm of the digest size is assumed
+const vector<HashAlgorithm> &getHashAlgorithms() {
+    static const vector<HashAlgorithm> algorithms = {
+        { "md5", "MD5", md::Md5Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<md::md5>, hashFilesAdapter<md::md5Batch>, hashBuffersAdapter<md::md5BatchBuffers>, createHasher<md::Md5Hasher> },
+        { "sha224", "SHA224", sha2::Sha224Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha2::hashFile<sha2::Sha224Variant>>, hashFilesAdapter<sha2::hashFiles<sha2::Sha224Variant>>, hashBuffersAdapter<sha2::hashBuffers<sha2::Sha224Variant>>, createHasher<sha2::Sha224Hasher> },
+        { "sha256", "SHA256", sha2::Sha256Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha2::hashFile<sha2::Sha256Variant>>, hashFilesAdapter<sha2::hashFiles<sha2::Sha256Variant>>, hashBuffersAdapter<sha2::hashBuffers<sha2::Sha256Variant>>, createHasher<sha2::Sha256Hasher> },
+        { "sha384", "SHA384", sha2::Sha384Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha2::hashFile<sha2::Sha384Variant>>, hashFilesAdapter<sha2::hashFiles<sha2::Sha384Variant>>, hashBuffersAdapter<sha2::hashBuffers<sha2::Sha384Variant>>, createHasher<sha2::Sha384Hasher> },
+        { "sha512", "SHA512", sha2::Sha512Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha2::hashFile<sha2::Sha512Variant>>, hashFilesAdapter<sha2::hashFiles<sha2::Sha512Variant>>, hashBuffersAdapter<sha2::hashBuffers<sha2::Sha512Variant>>, createHasher<sha2::Sha512Hasher> },
+        { "sha512-224", "SHA512-224", sha2::Sha512_224Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha2::hashFile<sha2::Sha512_224Variant>>, hashFilesAdapter<sha2::hashFiles<sha2::Sha512_224Variant>>, hashBuffersAdapter<sha2::hashBuffers<sha2::Sha512_224Variant>>, createHasher<sha2::Sha512_224Hasher> },
+        { "sha512-256", "SHA512-256", sha2::Sha512_256Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha2::hashFile<sha2::Sha512_256Variant>>, hashFilesAdapter<sha2::hashFiles<sha2::Sha512_256Variant>>, hashBuffersAdapter<sha2::hashBuffers<sha2::Sha512_256Variant>>, createHasher<sha2::Sha512_256Hasher> },
+        { "sha3-224", "SHA3-224", sha3::Sha3_224Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha3::hashFile<sha3::Sha3_224Variant>>, hashFilesAdapter<sha3::hashFiles<sha3::Sha3_224Variant>>, hashBuffersAdapter<sha3::hashBuffers<sha3::Sha3_224Variant>>, createHasher<sha3::Sha3_224Hasher> },
+        { "sha3-256", "SHA3-256", sha3::Sha3_256Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha3::hashFile<sha3::Sha3_256Variant>>, hashFilesAdapter<sha3::hashFiles<sha3::Sha3_256Variant>>, hashBuffersAdapter<sha3::hashBuffers<sha3::Sha3_256Variant>>, createHasher<sha3::Sha3_256Hasher> },
+        { "sha3-384", "SHA3-384", sha3::Sha3_384Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha3::hashFile<sha3::Sha3_384Variant>>, hashFilesAdapter<sha3::hashFiles<sha3::Sha3_384Variant>>, hashBuffersAdapter<sha3::hashBuffers<sha3::Sha3_384Variant>>, createHasher<sha3::Sha3_384Hasher> },
+        { "sha3-512", "SHA3-512", sha3::Sha3_512Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha3::hashFile<sha3::Sha3_512Variant>>, hashFilesAdapter<sha3::hashFiles<sha3::Sha3_512Variant>>, hashBuffersAdapter<sha3::hashBuffers<sha3::Sha3_512Variant>>, createHasher<sha3::Sha3_512Hasher> },
+        { "shake128", "SHAKE128", sha3::Shake128Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha3::hashFile<sha3::Shake128Variant>>, hashFilesAdapter<sha3::hashFiles<sha3::Shake128Variant>>, hashBuffersAdapter<sha3::hashBuffers<sha3::Shake128Variant>>, createHasher<sha3::Shake128Hasher> },
+        { "shake256", "SHAKE256", sha3::Shake256Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<sha3::hashFile<sha3::Shake256Variant>>, hashFilesAdapter<sha3::hashFiles<sha3::Shake256Variant>>, hashBuffersAdapter<sha3::hashBuffers<sha3::Shake256Variant>>, createHasher<sha3::Shake256Hasher> },
+        { "blake3", "BLAKE3", blake3::Blake3Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<blake3::hashFile>, hashFilesAdapter<blake3::hashFiles>, hashBuffersAdapter<blake3::hashBuffers>, createHasher<blake3::Blake3Hasher> },
+        { "crc32", "CRC32", crc32::Crc32Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<crc32::hashFile<crc32::Crc32Variant>>, hashFilesAdapter<crc32::hashFiles<crc32::Crc32Variant>>, hashBuffersAdapter<crc32::hashBuffers<crc32::Crc32Variant>>, createHasher<crc32::Crc32Hasher> },
+        { "crc32c", "CRC32C", crc32::Crc32cHasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<crc32::hashFile<crc32::Crc32cVariant>>, hashFilesAdapter<crc32::hashFiles<crc32::Crc32cVariant>>, hashBuffersAdapter<crc32::hashBuffers<crc32::Crc32cVariant>>, createHasher<crc32::Crc32cHasher> },
+        { "xxh64", "XXH64", xxhash::Xxh64Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<xxhash::hashFile<xxhash::Xxh64Hasher>>, hashFilesAdapter<xxhash::hashFiles<xxhash::Xxh64Hasher>>, hashBuffersAdapter<xxhash::hashBuffers<xxhash::Xxh64Hasher>>, createHasher<xxhash::Xxh64Hasher> },
+        { "xxh3", "XXH3", xxhash::Xxh3Hasher::DIGEST_SIZE_IN_BYTES, hashFileAdapter<xxhash::hashFile<xxhash::Xxh3Hasher>>, hashFilesAdapter<xxhash::hashFiles<xxhash::Xxh3Hasher>>, hashBuffersAdapter<xxhash::hashBuffers<xxhash::Xxh3Hasher>>, createHasher<xxhash::Xxh3Hasher> },
+    };
+    return algorithms;
+}
+
+const HashAlgorithm *findHashAlgorithm(const string &name) {
+    for (const HashAlgorithm &algorithm : getHashAlgorithms()) {
+        if (algorithm.name == name) {
+            return &algorithm;
+        }
+    }
+    return nullptr;
+}
+
+const HmacAlgorithm *findHmacAlgorithm(const string &name) {
+    static const vector<HmacAlgorithm> algorithms = {
+        makeHmacAlgorithm<sha2::Sha224Variant>("sha224"),
+        makeHmacAlgorithm<sha2::Sha256Variant>("sha256"),
+        makeHmacAlgorithm<sha2::Sha384Variant>("sha384"),
+        makeHmacAlgorithm<sha2::Sha512Variant>("sha512"),
+        makeHmacAlgorithm<sha2::Sha512_224Variant>("sha512-224"),
+        makeHmacAlgorithm<sha2::Sha512_256Variant>("sha512-256"),
+    };
+    for (const HmacAlgorithm &algorithm : algorithms) {
+        if (algorithm.name == name) {
+            return &algorithm;
+        }
+    }
+    return nullptr;
+}
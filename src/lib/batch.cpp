@@ -0,0 +1,305 @@
+#include "../include/lib/batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#include "../include/lib/multiDigest.hpp"
+#include "../include/utils/threadPool.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    // Passes the results to the handler one at a time, restoring the order of the inputs if needed.
+    // Once the handler asks to stop, the rest of the results are dropped
+    class ResultCollector {
+    public:
+        ResultCollector(bool keepOrder, const BatchResultHandler &handler)
+            : keepOrder(keepOrder), handler(handler), stopped(false), nextIndex(0), errorsCount(0) {}
+
+        void add(size_t index, BatchResult result) {
+            lock_guard<mutex> guard(lock);
+            if (stopped) {
+                return;
+            }
+            if (!keepOrder) {
+                pass(result);
+                return;
+            }
+
+            pendingResults.emplace(index, move(result));
+            for (auto next = pendingResults.find(nextIndex); next != pendingResults.end() && !stopped; next = pendingResults.find(nextIndex)) {
+                pass(next->second);
+                pendingResults.erase(next);
+                nextIndex++;
+            }
+            if (stopped) {
+                pendingResults.clear();
+            }
+        }
+
+        // Lets the tasks skip the files whose results would be dropped anyway
+        bool isStopped() const {
+            return stopped;
+        }
+
+        size_t getErrorsCount() const {
+            return errorsCount;
+        }
+
+    private:
+        bool keepOrder;
+        const BatchResultHandler &handler;
+        atomic<bool> stopped;
+        mutex lock;
+        map<size_t, BatchResult> pendingResults;
+        size_t nextIndex;
+        size_t errorsCount;
+
+        void pass(const BatchResult &result) {
+            if (!result.error.empty()) {
+                errorsCount++;
+            }
+            if (!handler(result)) {
+                stopped = true;
+            }
+        }
+    };
+
+    struct File {
+        size_t index;
+        string path;
+        uint64 size;
+    };
+
+    typedef vector<const HashAlgorithm *> Algorithms;
+
+    // Takes the identity of the file and looks its digests up in the cache.
+    // Returns true if all of them are found: the result is complete then
+    bool findCachedDigests(const Algorithms &algorithms, HashCache *cache, const string &path, FileIdentity &identity,
+        bool &isCacheable, BatchResult &result) {
+        StageTimer timer(Stage::Open);
+        isCacheable = cache != nullptr && getFileIdentity(path, identity);
+        return isCacheable && cache->find(identity, algorithms, result.digests.data());
+    }
+
+    void hashFile(const Algorithms &algorithms, const File &file, const BatchOptions &options, ResultCollector &collector) {
+        if (collector.isStopped()) {
+            return;
+        }
+        FileStatsScope statsScope;
+        BatchResult result { file.path, {}, "" };
+        try {
+            FileIdentity identity;
+            bool isCacheable;
+            if (!findCachedDigests(algorithms, options.cache, file.path, identity, isCacheable, result)) {
+                if (algorithms.size() == 1) {
+                    result.digests[0] = algorithms[0]->hashFile(file.path, options.inputOptions);
+                } else {
+                    // The file is read once for all the algorithms. The pool already keeps the cores busy,
+                    // so the algorithms don't get the threads of their own
+                    MultiDigestOptions multiDigestOptions;
+                    multiDigestOptions.inputOptions = options.inputOptions;
+                    vector<HashDigest> digests = hashWithAlgorithms(file.path, algorithms, multiDigestOptions);
+                    copy(digests.begin(), digests.end(), result.digests.begin());
+                }
+                if (isCacheable) {
+                    options.cache->store(file.path, identity, algorithms, result.digests.data());
+                }
+            }
+        } catch (const exception &error) {
+            result.error = error.what();
+        }
+        result.stats = statsScope.finish();
+        collector.add(file.index, move(result));
+    }
+
+    // The small files are cached after the first algorithm has read them, so the multi-buffer cores win
+    // over the single pass here: the group is hashed by each of the algorithms in turn
+    void hashGroup(const Algorithms &algorithms, const vector<File> &group, const BatchOptions &options, ResultCollector &collector) {
+        if (collector.isStopped()) {
+            return;
+        }
+
+        FileStatsScope statsScope;
+
+        // The cached files are reported right away, the rest of them are hashed
+        vector<File> files;
+        vector<FileIdentity> identities;
+        vector<bool> areCacheable;
+        for (const File &file : group) {
+            BatchResult result { file.path, {}, "" };
+            FileIdentity identity;
+            bool isCacheable;
+            if (findCachedDigests(algorithms, options.cache, file.path, identity, isCacheable, result)) {
+                collector.add(file.index, move(result));
+                continue;
+            }
+            files.push_back(file);
+            identities.push_back(identity);
+            areCacheable.push_back(isCacheable);
+        }
+        if (files.empty()) {
+            return;
+        }
+
+        vector<string> paths;
+        for (const File &file : files) {
+            paths.push_back(file.path);
+        }
+
+        vector<vector<HashDigest>> digests;
+        try {
+            for (const HashAlgorithm *algorithm : algorithms) {
+                digests.push_back(algorithm->hashFiles(paths, options.inputOptions));
+            }
+        } catch (const exception &) {
+            // Some of the files can't be hashed: hash them one by one to find out which ones
+            for (const File &file : files) {
+                hashFile(algorithms, file, options, collector);
+            }
+            return;
+        }
+
+        StatsCounters groupStats = statsScope.finish(files.size());
+        uint64 groupSize = 0;
+        for (const File &file : files) {
+            groupSize += file.size;
+        }
+
+        for (size_t i = 0; i < files.size(); i++) {
+            BatchResult result { files[i].path, {}, "" };
+            result.stats = groupStats.share(files[i].size, groupSize);
+            for (size_t j = 0; j < digests.size(); j++) {
+                result.digests[j] = digests[j][i];
+            }
+            if (areCacheable[i]) {
+                try {
+                    options.cache->store(files[i].path, identities[i], algorithms, result.digests.data());
+                } catch (const exception &error) {
+                    result.error = error.what();
+                }
+            }
+            collector.add(files[i].index, move(result));
+        }
+    }
+
+    // Groups the small files and submits the tasks to the pool
+    class TaskScheduler {
+    public:
+        TaskScheduler(const Algorithms &algorithms, const BatchOptions &options, ThreadPool &pool, ResultCollector &collector)
+            : algorithms(algorithms), options(options), pool(pool), collector(collector), filesCount(0), groupSize(0) {}
+
+        // Returns false once the handler has asked to stop, so the inputs may be left unvisited
+        bool addFile(const string &path, bool isSizeKnown, uint64 size) {
+            if (collector.isStopped()) {
+                return false;
+            }
+            File file { filesCount++, path, size };
+
+            // The files of unknown size (the standard input, pipes) are treated as the large ones
+            if (!isSizeKnown || size > BATCH_LARGE_FILE_SIZE) {
+                pool.submit([this, file] { hashFile(algorithms, file, options, collector); }, true);
+                return true;
+            }
+
+            group.push_back(file);
+            groupSize += size;
+            if (group.size() >= BATCH_GROUP_MAX_FILES_COUNT || groupSize >= BATCH_GROUP_MAX_SIZE) {
+                flush();
+            }
+            return true;
+        }
+
+        void addError(const string &path, const string &error) {
+            collector.add(filesCount++, BatchResult { path, {}, error });
+        }
+
+        void flush() {
+            if (group.empty()) {
+                return;
+            }
+            pool.submit([this, files = move(group)] { hashGroup(algorithms, files, options, collector); });
+            group.clear();
+            groupSize = 0;
+        }
+
+    private:
+        const Algorithms &algorithms;
+        const BatchOptions &options;
+        ThreadPool &pool;
+        ResultCollector &collector;
+        size_t filesCount;
+        vector<File> group;
+        uint64 groupSize;
+    };
+
+    void walkDirectory(const string &directory, TaskScheduler &scheduler) {
+        error_code error;
+        fs::recursive_directory_iterator iterator(directory, fs::directory_options::skip_permission_denied, error);
+        if (error) {
+            scheduler.addError(directory, error.message());
+            return;
+        }
+
+        for (; iterator != fs::recursive_directory_iterator(); iterator.increment(error)) {
+            if (error) {
+                scheduler.addError(directory, error.message());
+                return;
+            }
+
+            const fs::directory_entry &entry = *iterator;
+            if (!entry.is_regular_file(error)) {
+                continue;
+            }
+            uint64 size;
+            {
+                StageTimer timer(Stage::Open);
+                size = entry.file_size(error);
+            }
+            if (!scheduler.addFile(entry.path().string(), !error, size)) {
+                return;
+            }
+        }
+    }
+
+}
+
+size_t hashFilesInParallel(
+    const vector<const HashAlgorithm *> &algorithms, const vector<string> &filePaths, const vector<string> &directories,
+    const BatchOptions &options, const BatchResultHandler &handler
+) {
+    if (algorithms.size() > BATCH_MAX_ALGORITHMS_COUNT) {
+        throw invalid_argument("Too many algorithms: at most " + to_string(BATCH_MAX_ALGORITHMS_COUNT) + " are supported at once");
+    }
+
+    ResultCollector collector(options.keepOrder, handler);
+    {
+        ThreadPool pool(options.threadsCount);
+        TaskScheduler scheduler(algorithms, options, pool, collector);
+
+        for (const string &filePath : filePaths) {
+            error_code error;
+            uint64 size;
+            {
+                StageTimer timer(Stage::Open);
+                size = filePath == "-" ? 0 : fs::file_size(filePath, error);
+            }
+            if (!scheduler.addFile(filePath, filePath != "-" && !error, size)) {
+                break;
+            }
+        }
+        for (const string &directory : directories) {
+            walkDirectory(directory, scheduler);
+        }
+        scheduler.flush();
+
+        // The pool waits for all the tasks on destruction
+    }
+
+    return collector.getErrorsCount();
+}
@@ -0,0 +1,554 @@
+#include "../include/lib/blake3.hpp"
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+
+#include "../include/lib/kernels/blake3Kernels.hpp"
+#include "../include/utils/cpuFeatures.hpp"
+#include "../include/utils/threadPool.hpp"
+
+namespace {
+
+    // The words of the single compression are the general purpose registers
+    struct ScalarOps {
+        typedef uint32 Vector;
+
+        static inline Vector set1(uint32 x) { return x; }
+        static inline Vector add(Vector x, Vector y) { return x + y; }
+        static inline Vector bitXor(Vector x, Vector y) { return x ^ y; }
+
+        template <int shift>
+        static inline Vector rotateRight(Vector x) { return (x >> shift) | (x << (32 - shift)); }
+    };
+
+}
+
+#include "../include/lib/kernels/blake3Rounds.hpp"
+
+namespace blake3 {
+
+    // Compiler may mix up the functions defined inside a different module with the equal names and signatures.
+    // Thus, we have to move all those functions and variables in the algorithm-specific inner namespace
+    namespace _blake3 {
+        inline uint32 loadLittleEndian(const uchar *data) {
+            return data[0] | data[1] << 8 | data[2] << 16 | uint32(data[3]) << 24;
+        }
+
+        inline void storeLittleEndian(uint32 word, uchar *output) {
+            output[0] = uchar(word);
+            output[1] = uchar(word >> 8);
+            output[2] = uchar(word >> 16);
+            output[3] = uchar(word >> 24);
+        }
+
+        inline void loadWords(const uchar *data, uint32 *words, uchar count) {
+            for (uchar i = 0; i < count; i++) {
+                words[i] = loadLittleEndian(data + i * 4);
+            }
+        }
+
+        inline void storeWords(const uint32 *words, uchar *output, uchar count) {
+            for (uchar i = 0; i < count; i++) {
+                storeLittleEndian(words[i], output + i * 4);
+            }
+        }
+
+        inline void compress(uint32 *v, const uint32 *cv, const uchar *block, uchar blockSize, uint64 counter, uchar flags) {
+            uint32 m[16];
+            loadWords(block, m, 16);
+
+            for (uchar i = 0; i < 8; i++) {
+                v[i] = cv[i];
+            }
+            v[8] = IV[0]; v[9] = IV[1]; v[10] = IV[2]; v[11] = IV[3];
+            v[12] = uint32(counter); v[13] = uint32(counter >> 32); v[14] = blockSize; v[15] = flags;
+            blake3Rounds<ScalarOps>(v, m, make_index_sequence<ROUNDS_COUNT>());
+        }
+
+        // Replaces the chaining value by the next one
+        void compressInPlace(uint32 *cv, const uchar *block, uchar blockSize, uint64 counter, uchar flags) {
+            uint32 v[16];
+            compress(v, cv, block, blockSize, counter, flags);
+            for (uchar i = 0; i < 8; i++) {
+                cv[i] = v[i] ^ v[i + 8];
+            }
+        }
+
+        // The 64 bytes of the extendable output
+        void compressXof(const uint32 *cv, const uchar *block, uchar blockSize, uint64 counter, uchar flags, uchar *output) {
+            uint32 v[16];
+            compress(v, cv, block, blockSize, counter, flags);
+            for (uchar i = 0; i < 8; i++) {
+                storeLittleEndian(v[i] ^ v[i + 8], output + i * 4);
+                storeLittleEndian(v[i + 8] ^ cv[i], output + 32 + i * 4);
+            }
+        }
+
+        // The chaining value of the chunk shorter than 1 KiB (it's never empty)
+        void hashPartialChunk(const uint32 *key, uchar flags, uint64 counter, const uchar *data, size_t size, uchar *output) {
+            uint32 cv[8];
+            memcpy(cv, key, sizeof(cv));
+            uchar startFlag = CHUNK_START;
+            for (; size > BLOCK_SIZE_IN_BYTES; data += BLOCK_SIZE_IN_BYTES, size -= BLOCK_SIZE_IN_BYTES) {
+                compressInPlace(cv, data, BLOCK_SIZE_IN_BYTES, counter, flags | startFlag);
+                startFlag = 0;
+            }
+            uchar block[BLOCK_SIZE_IN_BYTES] = {};
+            memcpy(block, data, size);
+            compressInPlace(cv, block, size, counter, flags | startFlag | CHUNK_END);
+            storeWords(cv, output, 8);
+        }
+
+        inline uchar countSetBits(uint64 x) {
+            uchar count = 0;
+            for (; x != 0; x &= x - 1) {
+                count++;
+            }
+            return count;
+        }
+
+        inline uint64 roundDownToPowerOf2(uint64 x) {
+            while ((x & (x - 1)) != 0) {
+                x &= x - 1;
+            }
+            return x;
+        }
+
+        // The left subtree takes the largest power of two count of chunks, the right one gets at least a byte
+        inline size_t getLeftSubtreeSize(size_t size) {
+            return roundDownToPowerOf2((size - 1) / CHUNK_SIZE_IN_BYTES) * CHUNK_SIZE_IN_BYTES;
+        }
+
+        HashLanesFunction *selectHashLanesFunction(uchar &lanesCount) {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx512) && features.avx512f && features.avx2) {
+                lanesCount = 16;
+                return hashLanesX16Avx512;
+            }
+            if (implementation == Implementation::Avx512) {
+                ensureImplementationSupported(implementation, false);
+            }
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx2) && features.avx2) {
+                lanesCount = 8;
+                return hashLanesX8Avx2;
+            }
+            if (implementation == Implementation::Avx2) {
+                ensureImplementationSupported(implementation, false);
+            }
+            // The 4 lanes need nothing newer than SSSE3 (the byte shuffles make the rotations by 8 and 16)
+            if ((implementation == Implementation::Auto || implementation == Implementation::Ssse3) && features.ssse3) {
+                lanesCount = 4;
+                return hashLanesX4Ssse3;
+            }
+            if (implementation == Implementation::Ssse3) {
+                ensureImplementationSupported(implementation, false);
+            }
+            lanesCount = 1;
+            return nullptr;
+        }
+    }
+
+    struct Blake3Hasher::Output {
+        uint32 cv[8];
+        uchar block[BLOCK_SIZE_IN_BYTES];
+        uchar blockSize;
+        uint64 counter;
+        uchar flags;
+
+        void getChainingValue(uchar *output) const {
+            uint32 words[8];
+            memcpy(words, cv, sizeof(words));
+            _blake3::compressInPlace(words, block, blockSize, counter, flags);
+            _blake3::storeWords(words, output, 8);
+        }
+
+        // The root is compressed once per 64 bytes of the output, with the increasing counter
+        void getRootBytes(uchar *output, size_t size) const {
+            for (uint64 outputCounter = 0; size > 0; outputCounter++) {
+                uchar wideBlock[64];
+                _blake3::compressXof(cv, block, blockSize, outputCounter, flags | _blake3::ROOT, wideBlock);
+                size_t bytesToCopy = min(size, sizeof(wideBlock));
+                memcpy(output, wideBlock, bytesToCopy);
+                output += bytesToCopy;
+                size -= bytesToCopy;
+            }
+        }
+    };
+
+    Blake3Hasher::Blake3Hasher() {
+        initialize(_blake3::IV, 0);
+    }
+
+    Blake3Hasher::Blake3Hasher(const Blake3Key &key) {
+        uint32 words[8];
+        _blake3::loadWords(key.data(), words, 8);
+        initialize(words, _blake3::KEYED_HASH);
+    }
+
+    Blake3Hasher::Blake3Hasher(const string &context) {
+        // The context is hashed into the key of the key material
+        initialize(_blake3::IV, _blake3::DERIVE_KEY_CONTEXT);
+        update((const uchar *)context.data(), context.size());
+        uchar contextKey[KEY_SIZE_IN_BYTES];
+        final(contextKey, sizeof(contextKey));
+
+        uint32 words[8];
+        _blake3::loadWords(contextKey, words, 8);
+        initialize(words, _blake3::DERIVE_KEY_MATERIAL);
+    }
+
+    void Blake3Hasher::initialize(const uint32 *key, uchar flags) {
+        memcpy(this->key, key, sizeof(this->key));
+        this->flags = flags;
+        hashLanes = _blake3::selectHashLanesFunction(lanesCount);
+        reset();
+    }
+
+    void Blake3Hasher::reset() {
+        startChunk(0);
+        cvStackSize = 0;
+    }
+
+    void Blake3Hasher::startChunk(uint64 counter) {
+        memcpy(chunkState, key, sizeof(chunkState));
+        chunkCounter = counter;
+        bufferSize = 0;
+        compressedBlocksCount = 0;
+    }
+
+    uint32 Blake3Hasher::getChunkSize() const {
+        return compressedBlocksCount * BLOCK_SIZE_IN_BYTES + bufferSize;
+    }
+
+    Blake3Hasher::Output Blake3Hasher::getChunkOutput() const {
+        Output output;
+        memcpy(output.cv, chunkState, sizeof(output.cv));
+        memcpy(output.block, buffer, bufferSize);
+        memset(output.block + bufferSize, 0, BLOCK_SIZE_IN_BYTES - bufferSize);
+        output.blockSize = bufferSize;
+        output.counter = chunkCounter;
+        output.flags = flags | (compressedBlocksCount == 0 ? _blake3::CHUNK_START : 0) | _blake3::CHUNK_END;
+        return output;
+    }
+
+    Blake3Hasher::Output Blake3Hasher::getParentOutput(const uchar *block) const {
+        Output output;
+        memcpy(output.cv, key, sizeof(output.cv));
+        memcpy(output.block, block, BLOCK_SIZE_IN_BYTES);
+        output.blockSize = BLOCK_SIZE_IN_BYTES;
+        output.counter = 0;
+        output.flags = flags | _blake3::PARENT;
+        return output;
+    }
+
+    // The last block of the chunk is kept in the buffer: it's compressed with the end flag (and maybe as the root)
+    void Blake3Hasher::updateChunk(const uchar *data, size_t size) {
+        if (bufferSize > 0) {
+            size_t bytesToCopy = min(size, size_t(BLOCK_SIZE_IN_BYTES - bufferSize));
+            memcpy(buffer + bufferSize, data, bytesToCopy);
+            bufferSize += bytesToCopy;
+            data += bytesToCopy;
+            size -= bytesToCopy;
+            if (size == 0) {
+                return;
+            }
+            _blake3::compressInPlace(chunkState, buffer, BLOCK_SIZE_IN_BYTES, chunkCounter,
+                flags | (compressedBlocksCount == 0 ? _blake3::CHUNK_START : 0));
+            compressedBlocksCount++;
+            bufferSize = 0;
+        }
+
+        for (; size > BLOCK_SIZE_IN_BYTES; data += BLOCK_SIZE_IN_BYTES, size -= BLOCK_SIZE_IN_BYTES) {
+            _blake3::compressInPlace(chunkState, data, BLOCK_SIZE_IN_BYTES, chunkCounter,
+                flags | (compressedBlocksCount == 0 ? _blake3::CHUNK_START : 0));
+            compressedBlocksCount++;
+        }
+
+        memcpy(buffer, data, size);
+        bufferSize = size;
+    }
+
+    // The complete chunk goes to the stack once it's known that it isn't the last one
+    void Blake3Hasher::finishChunk() {
+        uchar cv[32];
+        getChunkOutput().getChainingValue(cv);
+        pushCv(cv, chunkCounter);
+        startChunk(chunkCounter + 1);
+    }
+
+    // The stack keeps a subtree per set bit of the count of chunks, the rest are merged into their parents.
+    // The merging is lazy: it's done once the next chunk arrives, so the root is never merged as a regular parent
+    void Blake3Hasher::mergeCvStack(uint64 chunksCount) {
+        uchar expectedSize = _blake3::countSetBits(chunksCount);
+        while (cvStackSize > expectedSize) {
+            uchar *parent = cvStack + (cvStackSize - 2) * 32;
+            getParentOutput(parent).getChainingValue(parent);
+            cvStackSize--;
+        }
+    }
+
+    void Blake3Hasher::pushCv(const uchar *cv, uint64 chunkCounter) {
+        mergeCvStack(chunkCounter);
+        memcpy(cvStack + cvStackSize * 32, cv, 32);
+        cvStackSize++;
+    }
+
+    void Blake3Hasher::hashMany(const uchar *const *inputs, size_t inputsCount, uchar blocksCount, uint64 counter, bool incrementCounter,
+        uchar inputFlags, uchar startFlags, uchar endFlags, uchar *output) const {
+        size_t i = 0;
+        if (hashLanes != nullptr) {
+            for (; i + lanesCount <= inputsCount; i += lanesCount) {
+                hashLanes(inputs + i, blocksCount, key, counter + (incrementCounter ? i : 0), incrementCounter,
+                    inputFlags, startFlags, endFlags, output + i * 32);
+            }
+        }
+
+        // The rest of inputs are compressed one by one
+        for (; i < inputsCount; i++) {
+            uint32 cv[8];
+            memcpy(cv, key, sizeof(cv));
+            for (uchar block = 0; block < blocksCount; block++) {
+                uchar blockFlags = inputFlags | (block == 0 ? startFlags : 0) | (block + 1 == blocksCount ? endFlags : 0);
+                _blake3::compressInPlace(cv, inputs[i] + block * BLOCK_SIZE_IN_BYTES, BLOCK_SIZE_IN_BYTES,
+                    counter + (incrementCounter ? i : 0), blockFlags);
+            }
+            _blake3::storeWords(cv, output + i * 32, 8);
+        }
+    }
+
+    // Up to `lanesCount` chunks at once, the last one may be partial. Returns the count of chaining values
+    size_t Blake3Hasher::compressChunksParallel(const uchar *data, size_t size, uint64 chunkCounter, uchar *output) const {
+        const uchar *chunks[_blake3::MAX_LANES];
+        size_t chunksCount = 0;
+        for (; size - chunksCount * CHUNK_SIZE_IN_BYTES >= CHUNK_SIZE_IN_BYTES; chunksCount++) {
+            chunks[chunksCount] = data + chunksCount * CHUNK_SIZE_IN_BYTES;
+        }
+        hashMany(chunks, chunksCount, CHUNK_SIZE_IN_BYTES / BLOCK_SIZE_IN_BYTES, chunkCounter, true,
+            flags, _blake3::CHUNK_START, _blake3::CHUNK_END, output);
+
+        size_t offset = chunksCount * CHUNK_SIZE_IN_BYTES;
+        if (size > offset) {
+            _blake3::hashPartialChunk(key, flags, chunkCounter + chunksCount, data + offset, size - offset, output + chunksCount * 32);
+            return chunksCount + 1;
+        }
+        return chunksCount;
+    }
+
+    // Up to `lanesCount` parents at once, the odd chaining value is passed as is. Returns the count of chaining values
+    size_t Blake3Hasher::compressParentsParallel(const uchar *cvs, size_t cvsCount, uchar *output) const {
+        const uchar *parents[_blake3::MAX_LANES];
+        size_t parentsCount = 0;
+        for (; cvsCount - 2 * parentsCount >= 2; parentsCount++) {
+            parents[parentsCount] = cvs + 2 * parentsCount * 32;
+        }
+        hashMany(parents, parentsCount, 1, 0, false, flags | _blake3::PARENT, 0, 0, output);
+
+        if (cvsCount > 2 * parentsCount) {
+            memcpy(output + parentsCount * 32, cvs + 2 * parentsCount * 32, 32);
+            return parentsCount + 1;
+        }
+        return parentsCount;
+    }
+
+    // Compresses the subtree down to `lanesCount` chaining values (at least two of them if there are several chunks),
+    // so the widest core is kept busy at each level of the tree. Returns the count of chaining values
+    size_t Blake3Hasher::compressSubtreeWide(const uchar *data, size_t size, uint64 chunkCounter, uchar *output) const {
+        if (size <= lanesCount * CHUNK_SIZE_IN_BYTES) {
+            return compressChunksParallel(data, size, chunkCounter, output);
+        }
+
+        size_t leftSize = _blake3::getLeftSubtreeSize(size);
+        // The scalar core still gives two chaining values per subtree
+        uchar degree = leftSize > CHUNK_SIZE_IN_BYTES && lanesCount == 1 ? 2 : lanesCount;
+        uchar cvs[2 * _blake3::MAX_LANES * 32];
+        size_t leftCount = compressSubtreeWide(data, leftSize, chunkCounter, cvs);
+        size_t rightCount = compressSubtreeWide(data + leftSize, size - leftSize, chunkCounter + leftSize / CHUNK_SIZE_IN_BYTES, cvs + degree * 32);
+
+        // Only the scalar core gets a single chaining value per half: they are returned as is
+        if (leftCount == 1) {
+            memcpy(output, cvs, 64);
+            return 2;
+        }
+        return compressParentsParallel(cvs, leftCount + rightCount, output);
+    }
+
+    // The subtree of more than one chunk is compressed to the two chaining values of its root
+    void Blake3Hasher::compressSubtreeToParentNode(const uchar *data, size_t size, uint64 chunkCounter, uchar *output) const {
+        uchar cvs[_blake3::MAX_LANES * 32];
+        size_t cvsCount = compressSubtreeWide(data, size, chunkCounter, cvs);
+
+        while (cvsCount > 2) {
+            uchar parents[_blake3::MAX_LANES / 2 * 32];
+            cvsCount = compressParentsParallel(cvs, cvsCount, parents);
+            memcpy(cvs, parents, cvsCount * 32);
+        }
+        memcpy(output, cvs, 64);
+    }
+
+    void Blake3Hasher::update(const uchar *data, size_t size) {
+        // Complete the chunk that has been left incomplete by the previous portion of data
+        if (getChunkSize() > 0) {
+            size_t bytesToCopy = min(size, size_t(CHUNK_SIZE_IN_BYTES - getChunkSize()));
+            updateChunk(data, bytesToCopy);
+            data += bytesToCopy;
+            size -= bytesToCopy;
+            if (size == 0) {
+                return;
+            }
+            finishChunk();
+        }
+
+        // The largest complete subtrees are compressed right from the passed data. The last chunk is always left
+        // for the chunk state (even if it's complete): it may be the root
+        while (size > CHUNK_SIZE_IN_BYTES) {
+            // The subtree must be aligned to its size within the whole input
+            uint64 subtreeSize = _blake3::roundDownToPowerOf2(size);
+            while (((subtreeSize - 1) & (chunkCounter * CHUNK_SIZE_IN_BYTES)) != 0) {
+                subtreeSize /= 2;
+            }
+            uint64 subtreeChunksCount = subtreeSize / CHUNK_SIZE_IN_BYTES;
+
+            if (subtreeSize <= CHUNK_SIZE_IN_BYTES) {
+                uchar cv[32];
+                _blake3::hashPartialChunk(key, flags, chunkCounter, data, subtreeSize, cv);
+                pushCv(cv, chunkCounter);
+            } else {
+                uchar cvs[64];
+                compressSubtreeToParentNode(data, subtreeSize, chunkCounter, cvs);
+                pushCv(cvs, chunkCounter);
+                pushCv(cvs + 32, chunkCounter + subtreeChunksCount / 2);
+            }
+            startChunk(chunkCounter + subtreeChunksCount);
+            data += subtreeSize;
+            size -= subtreeSize;
+        }
+
+        if (size > 0) {
+            updateChunk(data, size);
+            mergeCvStack(chunkCounter);
+        }
+    }
+
+    void Blake3Hasher::updateInParallel(const uchar *data, size_t size, uint32 threadsCount) {
+        const uint64 subtreeChunksCount = PARALLEL_SUBTREE_SIZE / CHUNK_SIZE_IN_BYTES;
+
+        // The data up to the boundary of the subtree (and the small inputs) are hashed by the calling thread
+        uint64 position = chunkCounter * CHUNK_SIZE_IN_BYTES + getChunkSize();
+        size_t bytesToAlign = min(uint64(size), (PARALLEL_SUBTREE_SIZE - position % PARALLEL_SUBTREE_SIZE) % PARALLEL_SUBTREE_SIZE);
+        update(data, bytesToAlign);
+        data += bytesToAlign;
+        size -= bytesToAlign;
+        if (threadsCount == 1 || size <= PARALLEL_SUBTREE_SIZE) {
+            update(data, size);
+            return;
+        }
+        if (getChunkSize() > 0) {
+            finishChunk();
+        }
+
+        // The subtrees are independent: each of them is compressed to the pair of chaining values of its root.
+        // At least a byte is left for the chunk state, it holds the root of the whole tree
+        size_t subtreesCount = (size - 1) / PARALLEL_SUBTREE_SIZE;
+        vector<uchar> cvs(subtreesCount * 64);
+        uint64 firstChunk = chunkCounter;
+        {
+            ThreadPool pool(threadsCount);
+            for (size_t i = 0; i < subtreesCount; i++) {
+                pool.submit([this, data, firstChunk, subtreeChunksCount, &cvs, i] {
+                    compressSubtreeToParentNode(data + i * PARALLEL_SUBTREE_SIZE, PARALLEL_SUBTREE_SIZE,
+                        firstChunk + i * subtreeChunksCount, cvs.data() + i * 64);
+                });
+            }
+        }
+
+        for (size_t i = 0; i < subtreesCount; i++) {
+            uint64 counter = firstChunk + i * subtreeChunksCount;
+            pushCv(cvs.data() + i * 64, counter);
+            pushCv(cvs.data() + i * 64 + 32, counter + subtreeChunksCount / 2);
+        }
+        startChunk(firstChunk + subtreesCount * subtreeChunksCount);
+
+        update(data + subtreesCount * PARALLEL_SUBTREE_SIZE, size - subtreesCount * PARALLEL_SUBTREE_SIZE);
+    }
+
+    void Blake3Hasher::final(uchar *output, size_t size) {
+        // The single chunk is the root itself
+        if (cvStackSize == 0) {
+            getChunkOutput().getRootBytes(output, size);
+            reset();
+            return;
+        }
+
+        // The stack isn't merged yet: the subtrees are merged from the rightmost one up to the root
+        Output root;
+        size_t cvsLeft;
+        if (getChunkSize() > 0) {
+            cvsLeft = cvStackSize;
+            root = getChunkOutput();
+        } else {
+            cvsLeft = cvStackSize - 2;
+            root = getParentOutput(cvStack + cvsLeft * 32);
+        }
+        while (cvsLeft > 0) {
+            cvsLeft--;
+            uchar parent[BLOCK_SIZE_IN_BYTES];
+            memcpy(parent, cvStack + cvsLeft * 32, 32);
+            root.getChainingValue(parent + 32);
+            root = getParentOutput(parent);
+        }
+        root.getRootBytes(output, size);
+        reset();
+    }
+
+    Blake3Digest Blake3Hasher::final() {
+        Blake3Digest digest;
+        final(digest.data(), digest.size());
+        return digest;
+    }
+
+    Blake3Digest hashFile(const string &filePath, const InputOptions &options) {
+        return hashFileWith(Blake3Hasher(), filePath, options);
+    }
+
+    Blake3Digest hashFileWith(const Blake3Hasher &hasher, const string &filePath, const InputOptions &options) {
+        Blake3Hasher fileHasher = hasher;
+        InputReader reader(filePath, options);
+
+        // The whole mapping is split between the threads at once
+        if (reader.isMapped() && options.threadsCount != 1) {
+            fileHasher.updateInParallel(reader.getMapping(), reader.getMappingSize(), options.threadsCount);
+            return fileHasher.final();
+        }
+
+        // Feed the hasher until the end of input: its size doesn't have to be known up front
+        const uchar *data;
+        size_t size;
+        while (reader.next(data, size)) {
+            fileHasher.update(data, size);
+        }
+        return fileHasher.final();
+    }
+
+    vector<Blake3Digest> hashFiles(const vector<string> &filePaths, const InputOptions &options) {
+        vector<Blake3Digest> digests;
+        for (const string &filePath : filePaths) {
+            digests.push_back(hashFile(filePath, options));
+        }
+        return digests;
+    }
+
+    vector<Blake3Digest> hashBuffers(const vector<ByteView> &messages) {
+        Blake3Hasher hasher;
+        vector<Blake3Digest> digests;
+        for (const ByteView &message : messages) {
+            hasher.update(message.data, message.size);
+            digests.push_back(hasher.final());
+        }
+        return digests;
+    }
+
+}
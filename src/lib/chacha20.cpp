@@ -0,0 +1,267 @@
+#include "../include/lib/chacha20.hpp"
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../include/utils/cpuFeatures.hpp"
+
+namespace {
+
+    inline uint32 loadLittleEndian32(const uchar *data) {
+        return data[0] | data[1] << 8 | data[2] << 16 | uint32(data[3]) << 24;
+    }
+
+    // The single block in the general purpose registers
+    struct ScalarOps {
+        typedef uint32 Vector;
+        static const uchar LANES = 1;
+
+        static inline Vector load(const uint32 *source) { return *source; }
+        static inline Vector set1(uint32 x) { return x; }
+        static inline Vector add(Vector x, Vector y) { return x + y; }
+        static inline Vector bitXor(Vector x, Vector y) { return x ^ y; }
+
+        template <int shift>
+        static inline Vector rotateLeft(Vector x) { return (x << shift) | (x >> (32 - shift)); }
+
+        static inline void xorBlocks(const Vector *words, const uchar *input, uchar *output) {
+            for (uchar i = 0; i < 16; i++) {
+                uint32 word = words[i] ^ loadLittleEndian32(input + i * 4);
+                output[i * 4] = uchar(word);
+                output[i * 4 + 1] = uchar(word >> 8);
+                output[i * 4 + 2] = uchar(word >> 16);
+                output[i * 4 + 3] = uchar(word >> 24);
+            }
+        }
+    };
+
+}
+
+#include "../include/lib/kernels/chacha20Rounds.hpp"
+
+namespace chacha20 {
+
+    // Compiler may mix up the functions defined inside a different module with the equal names and signatures.
+    // Thus, we have to move all those functions and variables in the algorithm-specific inner namespace
+    namespace _chacha20 {
+        void xorBlocksScalar(const uint32 *state, const uchar *input, uchar *output, size_t blocksCount) {
+            chacha20XorBlocks<ScalarOps>(state, input, output, blocksCount);
+        }
+
+        XorBlocksFunction *selectXorBlocksFunction(uchar &lanesCount) {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx2) && features.avx2) {
+                lanesCount = 8;
+                return xorBlocksX8Avx2;
+            }
+            if (implementation == Implementation::Avx2) {
+                ensureImplementationSupported(implementation, false);
+            }
+            if ((implementation == Implementation::Auto || implementation == Implementation::Ssse3) && features.ssse3) {
+                lanesCount = 4;
+                return xorBlocksX4Ssse3;
+            }
+            if (implementation == Implementation::Ssse3) {
+                ensureImplementationSupported(implementation, false);
+            }
+            lanesCount = 1;
+            return xorBlocksScalar;
+        }
+
+        // The 64 x 64-bit products of the limbs need the 128-bit integers of GCC and Clang
+        typedef unsigned __int128 uint128;
+
+        const uint64 LIMB_MASK = (uint64(1) << 44) - 1;
+        const uint64 TOP_LIMB_MASK = (uint64(1) << 42) - 1;
+
+        inline uint64 loadLittleEndian64(const uchar *data) {
+            return loadLittleEndian32(data) | uint64(loadLittleEndian32(data + 4)) << 32;
+        }
+
+        inline void storeLittleEndian64(uint64 value, uchar *output) {
+            for (uchar i = 0; i < 8; i++) {
+                output[i] = uchar(value >> (8 * i));
+            }
+        }
+
+        // The polynomial evaluated modulo 2^130 - 5 over the 16-byte blocks of the message. The 130-bit numbers
+        // are kept in three limbs of 44, 44 and 42 bits (as in poly1305-donna), so the products fit 128 bits
+        class Poly1305 {
+        public:
+            explicit Poly1305(const uchar *key) : h {} {
+                uint64 t0 = loadLittleEndian64(key);
+                uint64 t1 = loadLittleEndian64(key + 8);
+                // The clamping of r
+                r[0] = t0 & 0xFFC0FFFFFFF;
+                r[1] = ((t0 >> 44) | (t1 << 20)) & 0xFFFFFC0FFFF;
+                r[2] = (t1 >> 24) & 0x00FFFFFFC0F;
+                pad[0] = loadLittleEndian64(key + 16);
+                pad[1] = loadLittleEndian64(key + 24);
+            }
+
+            // The data zero-padded to a multiple of 16 bytes, the way the AEAD construction authenticates it
+            void updatePadded(const uchar *data, size_t size) {
+                size_t fullSize = size & ~size_t(15);
+                processBlocks(data, fullSize / 16);
+                if (fullSize != size) {
+                    uchar block[16] = {};
+                    memcpy(block, data + fullSize, size - fullSize);
+                    processBlocks(block, 1);
+                }
+            }
+
+            void final(uchar *tag) {
+                uint64 h0 = h[0], h1 = h[1], h2 = h[2];
+                uint64 carry = h1 >> 44; h1 &= LIMB_MASK;
+                h2 += carry; carry = h2 >> 42; h2 &= TOP_LIMB_MASK;
+                h0 += carry * 5; carry = h0 >> 44; h0 &= LIMB_MASK;
+                h1 += carry; carry = h1 >> 44; h1 &= LIMB_MASK;
+                h2 += carry; carry = h2 >> 42; h2 &= TOP_LIMB_MASK;
+                h0 += carry * 5; carry = h0 >> 44; h0 &= LIMB_MASK;
+                h1 += carry;
+
+                // h - p = h + 5 - 2^130 is taken if it isn't negative, without the branches
+                uint64 g0 = h0 + 5; carry = g0 >> 44; g0 &= LIMB_MASK;
+                uint64 g1 = h1 + carry; carry = g1 >> 44; g1 &= LIMB_MASK;
+                uint64 g2 = h2 + carry - (uint64(1) << 42);
+                uint64 mask = (g2 >> 63) - 1;
+                h0 = (h0 & ~mask) | (g0 & mask);
+                h1 = (h1 & ~mask) | (g1 & mask);
+                h2 = (h2 & ~mask) | (g2 & mask);
+
+                // The tag is (h + s) mod 2^128
+                h0 += pad[0] & LIMB_MASK; carry = h0 >> 44; h0 &= LIMB_MASK;
+                h1 += ((pad[0] >> 44) | (pad[1] << 20)) & LIMB_MASK; h1 += carry; carry = h1 >> 44; h1 &= LIMB_MASK;
+                h2 += (pad[1] >> 24) + carry;
+                storeLittleEndian64(h0 | (h1 << 44), tag);
+                storeLittleEndian64((h1 >> 20) | (h2 << 24), tag + 8);
+            }
+
+        private:
+            uint64 r[3];
+            uint64 h[3];
+            uint64 pad[2];
+
+            // Each block gets the 2^128 bit
+            void processBlocks(const uchar *data, size_t blocksCount) {
+                const uint64 r0 = r[0], r1 = r[1], r2 = r[2];
+                // 2^130 = 5 modulo p: the products at 2^132 and above come back multiplied by 4 * 5
+                const uint64 s1 = r1 * 20, s2 = r2 * 20;
+                uint64 h0 = h[0], h1 = h[1], h2 = h[2];
+                for (; blocksCount > 0; blocksCount--, data += 16) {
+                    uint64 t0 = loadLittleEndian64(data);
+                    uint64 t1 = loadLittleEndian64(data + 8);
+                    h0 += t0 & LIMB_MASK;
+                    h1 += ((t0 >> 44) | (t1 << 20)) & LIMB_MASK;
+                    h2 += ((t1 >> 24) & TOP_LIMB_MASK) | (uint64(1) << 40);
+
+                    uint128 d0 = uint128(h0) * r0 + uint128(h1) * s2 + uint128(h2) * s1;
+                    uint128 d1 = uint128(h0) * r1 + uint128(h1) * r0 + uint128(h2) * s2;
+                    uint128 d2 = uint128(h0) * r2 + uint128(h1) * r1 + uint128(h2) * r0;
+
+                    uint64 carry = uint64(d0 >> 44); h0 = uint64(d0) & LIMB_MASK;
+                    d1 += carry; carry = uint64(d1 >> 44); h1 = uint64(d1) & LIMB_MASK;
+                    d2 += carry; carry = uint64(d2 >> 42); h2 = uint64(d2) & TOP_LIMB_MASK;
+                    h0 += carry * 5; carry = h0 >> 44; h0 &= LIMB_MASK;
+                    h1 += carry;
+                }
+                h[0] = h0; h[1] = h1; h[2] = h2;
+            }
+        };
+    }
+
+    ChaCha20Poly1305::ChaCha20Poly1305(const aead::Key &key) {
+        for (uchar i = 0; i < 8; i++) {
+            this->key[i] = loadLittleEndian32(key.data() + i * 4);
+        }
+        xorBlocks = _chacha20::selectXorBlocksFunction(lanesCount);
+    }
+
+    void ChaCha20Poly1305::xorKeyStream(const uchar *nonce, uint32 counter, const uchar *input, uchar *output, size_t size) const {
+        using namespace _chacha20;
+        uint32 state[16];
+        memcpy(state, CONSTANTS, sizeof(CONSTANTS));
+        memcpy(state + 4, key, sizeof(key));
+        state[12] = counter;
+        for (uchar i = 0; i < 3; i++) {
+            state[13 + i] = loadLittleEndian32(nonce + i * 4);
+        }
+
+        size_t groupSize = size_t(lanesCount) * BLOCK_SIZE_IN_BYTES;
+        size_t groupsCount = size / groupSize;
+        xorBlocks(state, input, output, groupsCount);
+        state[12] += uint32(groupsCount * lanesCount);
+        input += groupsCount * groupSize;
+        output += groupsCount * groupSize;
+        size -= groupsCount * groupSize;
+
+        // The rest is shorter than a group: the whole blocks, then the incomplete one
+        size_t blocksCount = size / BLOCK_SIZE_IN_BYTES;
+        xorBlocksScalar(state, input, output, blocksCount);
+        state[12] += uint32(blocksCount);
+        size_t offset = blocksCount * BLOCK_SIZE_IN_BYTES;
+        if (offset < size) {
+            uchar block[BLOCK_SIZE_IN_BYTES] = {};
+            memcpy(block, input + offset, size - offset);
+            xorBlocksScalar(state, block, block, 1);
+            memcpy(output + offset, block, size - offset);
+        }
+    }
+
+    void ChaCha20Poly1305::crypt(
+        const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+        const uchar *input, size_t size, uchar *output, bool isEncrypting, uchar *tag
+    ) const {
+        using namespace _chacha20;
+        if (size > MAX_MESSAGE_SIZE) {
+            throw invalid_argument("The message is too long for ChaCha20-Poly1305");
+        }
+
+        // The one-time key is the beginning of the block 0, the message is encrypted from the block 1
+        uchar oneTimeKey[BLOCK_SIZE_IN_BYTES] = {};
+        xorKeyStream(nonce, 0, oneTimeKey, oneTimeKey, BLOCK_SIZE_IN_BYTES);
+        Poly1305 poly1305(oneTimeKey);
+        poly1305.updatePadded(associatedData, associatedDataSize);
+
+        for (size_t offset = 0; offset < size; offset += PORTION_SIZE) {
+            size_t portionSize = min(PORTION_SIZE, size - offset);
+            if (!isEncrypting) {
+                poly1305.updatePadded(input + offset, portionSize);
+            }
+            xorKeyStream(nonce, uint32(1 + offset / BLOCK_SIZE_IN_BYTES), input + offset, output + offset, portionSize);
+            if (isEncrypting) {
+                poly1305.updatePadded(output + offset, portionSize);
+            }
+        }
+
+        uchar sizes[16];
+        storeLittleEndian64(associatedDataSize, sizes);
+        storeLittleEndian64(size, sizes + 8);
+        poly1305.updatePadded(sizes, sizeof(sizes));
+        poly1305.final(tag);
+    }
+
+    void ChaCha20Poly1305::seal(
+        const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+        const uchar *input, size_t size, uchar *output, uchar *tag
+    ) const {
+        crypt(nonce, associatedData, associatedDataSize, input, size, output, true, tag);
+    }
+
+    bool ChaCha20Poly1305::open(
+        const uchar *nonce, const uchar *associatedData, size_t associatedDataSize,
+        const uchar *input, size_t size, uchar *output, const uchar *tag
+    ) const {
+        uchar expectedTag[aead::TAG_SIZE];
+        crypt(nonce, associatedData, associatedDataSize, input, size, output, false, expectedTag);
+        if (!aead::areTagsEqual(tag, expectedTag)) {
+            memset(output, 0, size);
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,200 @@
+#include "../include/lib/checksumFile.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "../include/utils/hexadecimal.hpp"
+#include "../include/utils/base64.hpp"
+
+namespace {
+
+    const HashAlgorithm *findAlgorithmByTag(string_view tag) {
+        for (const HashAlgorithm &algorithm : getHashAlgorithms()) {
+            if (algorithm.tag == tag) {
+                return &algorithm;
+            }
+        }
+        return nullptr;
+    }
+
+    // Finds the algorithm whose digest may be written so. The hexadecimal forms are tried first:
+    // the digits are the valid base64 characters as well
+    const HashAlgorithm *findAlgorithmByDigest(string_view digest) {
+        uchar bytes[HashDigest::MAX_SIZE];
+        for (const HashAlgorithm &algorithm : getHashAlgorithms()) {
+            if (digest.size() == algorithm.digestSize * 2 && decodeHex(digest.data(), algorithm.digestSize, bytes)) {
+                return &algorithm;
+            }
+        }
+        for (const HashAlgorithm &algorithm : getHashAlgorithms()) {
+            if (digest.size() == base64EncodedSize(algorithm.digestSize) && decodeBase64(digest.data(), algorithm.digestSize, bytes)) {
+                return &algorithm;
+            }
+        }
+        return nullptr;
+    }
+
+    // Reverts the escaping of sha256sum. Returns false if there are unknown escape sequences
+    bool unescapeFilePath(string_view filePath, string &result) {
+        result.reserve(filePath.size());
+        for (size_t i = 0; i < filePath.size(); i++) {
+            if (filePath[i] != '\\') {
+                result += filePath[i];
+                continue;
+            }
+            if (++i == filePath.size()) {
+                return false;
+            }
+            if (filePath[i] == '\\') {
+                result += '\\';
+            } else if (filePath[i] == 'n') {
+                result += '\n';
+            } else if (filePath[i] == 'r') {
+                result += '\r';
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}
+
+ChecksumFile::ChecksumFile(const string &filePath, const HashAlgorithm *forcedAlgorithm)
+    : reader(filePath), malformedLinesCount(0) {
+    string_view text;
+    if (reader.isMapped()) {
+        text = string_view((const char *)reader.getMapping(), reader.getMappingSize());
+    } else {
+        const uchar *data;
+        size_t size;
+        while (reader.next(data, size)) {
+            content.append((const char *)data, size);
+        }
+        text = content;
+    }
+
+    while (!text.empty()) {
+        const char *lineEnd = (const char *)memchr(text.data(), '\n', text.size());
+        size_t lineSize = lineEnd == nullptr ? text.size() : lineEnd - text.data();
+        string_view line = text.substr(0, lineSize);
+        text.remove_prefix(lineEnd == nullptr ? lineSize : lineSize + 1);
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (!parseLine(line, forcedAlgorithm)) {
+            malformedLinesCount++;
+        }
+    }
+}
+
+const vector<ChecksumEntry> &ChecksumFile::getEntries() const {
+    return entries;
+}
+
+size_t ChecksumFile::getMalformedLinesCount() const {
+    return malformedLinesCount;
+}
+
+bool ChecksumFile::parseLine(string_view line, const HashAlgorithm *forcedAlgorithm) {
+    bool isEscaped = line[0] == '\\';
+    if (isEscaped) {
+        line.remove_prefix(1);
+    }
+
+    ChecksumEntry entry { {}, {}, nullptr };
+    size_t tagEnd = line.find(" (");
+    const HashAlgorithm *taggedAlgorithm = tagEnd == string_view::npos ? nullptr : findAlgorithmByTag(line.substr(0, tagEnd));
+    if (taggedAlgorithm != nullptr) {
+        // `TAG (<file>) = <digest>`: the file name may contain the parentheses, so the last separator is taken
+        size_t pathEnd = line.rfind(") = ");
+        if (pathEnd == string_view::npos || pathEnd < tagEnd + 2) {
+            return false;
+        }
+        entry.filePath = line.substr(tagEnd + 2, pathEnd - tagEnd - 2);
+        entry.digest = line.substr(pathEnd + 4);
+        entry.algorithm = taggedAlgorithm;
+    } else {
+        // `<digest>  <file>` or `<digest> *<file>` (the binary mode makes no difference here)
+        size_t digestEnd = line.find(' ');
+        if (digestEnd == string_view::npos || digestEnd + 2 > line.size() || (line[digestEnd + 1] != ' ' && line[digestEnd + 1] != '*')) {
+            return false;
+        }
+        entry.digest = line.substr(0, digestEnd);
+        entry.filePath = line.substr(digestEnd + 2);
+        entry.algorithm = forcedAlgorithm != nullptr ? forcedAlgorithm : findAlgorithmByDigest(entry.digest);
+    }
+
+    uchar bytes[HashDigest::MAX_SIZE];
+    if (entry.filePath.empty() || entry.algorithm == nullptr || (forcedAlgorithm != nullptr && entry.algorithm != forcedAlgorithm)
+        || !decodeChecksumDigest(entry.digest, entry.algorithm->digestSize, bytes)) {
+        return false;
+    }
+
+    if (isEscaped && entry.filePath.find('\\') != string_view::npos) {
+        string filePath;
+        if (!unescapeFilePath(entry.filePath, filePath)) {
+            return false;
+        }
+        // The deque never moves the strings, so the views stay valid
+        unescapedPaths.push_back(move(filePath));
+        entry.filePath = unescapedPaths.back();
+    }
+    entries.push_back(entry);
+    return true;
+}
+
+bool decodeChecksumDigest(string_view digest, uchar size, uchar *output) {
+    if (digest.size() == size_t(size) * 2) {
+        return decodeHex(digest.data(), size, output);
+    }
+    if (digest.size() == base64EncodedSize(size)) {
+        return decodeBase64(digest.data(), size, output);
+    }
+    return false;
+}
+
+void verifyChecksums(const vector<ChecksumEntry> &entries, const BatchOptions &options, const ChecksumResultHandler &handler) {
+    // The indices of the entries of each algorithm
+    vector<const HashAlgorithm *> algorithms;
+    vector<vector<size_t>> groups;
+    for (size_t i = 0; i < entries.size(); i++) {
+        size_t group = 0;
+        while (group < algorithms.size() && algorithms[group] != entries[i].algorithm) {
+            group++;
+        }
+        if (group == algorithms.size()) {
+            algorithms.push_back(entries[i].algorithm);
+            groups.emplace_back();
+        }
+        groups[group].push_back(i);
+    }
+
+    BatchOptions orderedOptions = options;
+    orderedOptions.keepOrder = true;
+    bool isStopped = false;
+    for (size_t group = 0; group < groups.size() && !isStopped; group++) {
+        vector<string> filePaths;
+        filePaths.reserve(groups[group].size());
+        for (size_t index : groups[group]) {
+            filePaths.emplace_back(entries[index].filePath);
+        }
+
+        size_t next = 0;
+        hashFilesInParallel({ algorithms[group] }, filePaths, {}, orderedOptions, [&](const BatchResult &result) {
+            const ChecksumEntry &entry = entries[groups[group][next++]];
+            ChecksumStatus status = ChecksumStatus::Unreadable;
+            if (result.error.empty()) {
+                uchar expected[HashDigest::MAX_SIZE];
+                decodeChecksumDigest(entry.digest, entry.algorithm->digestSize, expected);
+                status = result.digests[0] == HashDigest(expected, entry.algorithm->digestSize) ? ChecksumStatus::Ok : ChecksumStatus::Failed;
+            }
+            isStopped = !handler(entry, status, result.error);
+            return !isStopped;
+        });
+    }
+}
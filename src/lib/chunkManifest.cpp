@@ -0,0 +1,335 @@
+#include "../include/lib/chunkManifest.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+
+#include "../include/utils/hexadecimal.hpp"
+#include "../include/utils/inputReader.hpp"
+
+namespace {
+
+    const size_t DIGEST_SIZE = sha2::Sha256Hasher::DIGEST_SIZE_IN_BYTES;
+    const size_t BINARY_HEADER_SIZE = 4 + 4 * 4 + 8 * 2;
+    const size_t BINARY_CHUNK_SIZE = 4 + DIGEST_SIZE;
+
+    void appendUint32(string &output, uint32 value) {
+        for (uchar i = 0; i < 4; i++) {
+            output += char(value >> (i * 8));
+        }
+    }
+
+    void appendUint64(string &output, uint64 value) {
+        for (uchar i = 0; i < 8; i++) {
+            output += char(value >> (i * 8));
+        }
+    }
+
+    uint32 readUint32(const uchar *data) {
+        return uint32(data[0]) | (uint32(data[1]) << 8) | (uint32(data[2]) << 16) | (uint32(data[3]) << 24);
+    }
+
+    uint64 readUint64(const uchar *data) {
+        return uint64(readUint32(data)) | (uint64(readUint32(data + 4)) << 32);
+    }
+
+    void writeBinaryManifest(const ChunkManifest &manifest, ostream &output) {
+        string header(CHUNK_MANIFEST_MAGIC, sizeof(CHUNK_MANIFEST_MAGIC));
+        appendUint32(header, CHUNK_MANIFEST_VERSION);
+        appendUint32(header, manifest.parameters.minSize);
+        appendUint32(header, manifest.parameters.averageSize);
+        appendUint32(header, manifest.parameters.maxSize);
+        appendUint64(header, manifest.totalSize);
+        appendUint64(header, manifest.chunks.size());
+        output.write(header.data(), header.size());
+
+        string chunks;
+        chunks.reserve(manifest.chunks.size() * BINARY_CHUNK_SIZE);
+        for (const Chunk &chunk : manifest.chunks) {
+            appendUint32(chunks, chunk.size);
+            chunks.append((const char *)chunk.digest.data(), DIGEST_SIZE);
+        }
+        output.write(chunks.data(), chunks.size());
+    }
+
+    void writeJsonManifest(const ChunkManifest &manifest, ostream &output) {
+        output << "{\"version\":" << CHUNK_MANIFEST_VERSION << ",\"algorithm\":\"sha256\""
+            << ",\"minSize\":" << manifest.parameters.minSize
+            << ",\"averageSize\":" << manifest.parameters.averageSize
+            << ",\"maxSize\":" << manifest.parameters.maxSize
+            << ",\"size\":" << manifest.totalSize << ",\"chunks\":[";
+        char hex[DIGEST_SIZE * 2];
+        for (size_t i = 0; i < manifest.chunks.size(); i++) {
+            const Chunk &chunk = manifest.chunks[i];
+            encodeHex(chunk.digest.data(), DIGEST_SIZE, hex);
+            output << (i == 0 ? "\n" : ",\n") << "{\"offset\":" << chunk.offset << ",\"size\":" << chunk.size << ",\"digest\":\"";
+            output.write(hex, sizeof(hex)) << "\"}";
+        }
+        output << "\n]}\n";
+    }
+
+    void checkChunks(const ChunkManifest &manifest) {
+        uint64 offset = 0;
+        for (const Chunk &chunk : manifest.chunks) {
+            if (chunk.offset != offset || chunk.size == 0) {
+                throw invalid_argument("Malformed manifest: the chunks don't follow each other");
+            }
+            offset += chunk.size;
+        }
+        if (offset != manifest.totalSize) {
+            throw invalid_argument("Malformed manifest: the chunks don't cover the whole file");
+        }
+    }
+
+    ChunkManifest readBinaryManifest(const string &content) {
+        const uchar *data = (const uchar *)content.data();
+        if (content.size() < BINARY_HEADER_SIZE || readUint32(data + 4) != CHUNK_MANIFEST_VERSION) {
+            throw invalid_argument("Unsupported version of the binary manifest");
+        }
+
+        ChunkManifest manifest;
+        manifest.parameters.minSize = readUint32(data + 8);
+        manifest.parameters.averageSize = readUint32(data + 12);
+        manifest.parameters.maxSize = readUint32(data + 16);
+        manifest.totalSize = readUint64(data + 20);
+        uint64 chunksCount = readUint64(data + 28);
+        if (chunksCount != (content.size() - BINARY_HEADER_SIZE) / BINARY_CHUNK_SIZE
+            || (content.size() - BINARY_HEADER_SIZE) % BINARY_CHUNK_SIZE != 0) {
+            throw invalid_argument("Malformed manifest: the count of chunks doesn't match the size");
+        }
+
+        manifest.chunks.resize(chunksCount);
+        uint64 offset = 0;
+        const uchar *chunkData = data + BINARY_HEADER_SIZE;
+        for (Chunk &chunk : manifest.chunks) {
+            chunk.offset = offset;
+            chunk.size = readUint32(chunkData);
+            memcpy(chunk.digest.data(), chunkData + 4, DIGEST_SIZE);
+            offset += chunk.size;
+            chunkData += BINARY_CHUNK_SIZE;
+        }
+        checkChunks(manifest);
+        return manifest;
+    }
+
+    // Reads the JSON in the shape written by `writeJsonManifest` (the whitespace and the order of keys may differ)
+    class JsonManifestParser {
+    public:
+        explicit JsonManifestParser(const string &content) : content(content), position(0) {}
+
+        ChunkManifest parse() {
+            ChunkManifest manifest;
+            parseObject([&](const string &key) {
+                if (key == "version") {
+                    if (readNumber() != CHUNK_MANIFEST_VERSION) {
+                        throw invalid_argument("Unsupported version of the JSON manifest");
+                    }
+                } else if (key == "algorithm") {
+                    if (readString() != "sha256") {
+                        throw invalid_argument("Unsupported algorithm of the JSON manifest");
+                    }
+                } else if (key == "minSize") {
+                    manifest.parameters.minSize = readNumber();
+                } else if (key == "averageSize") {
+                    manifest.parameters.averageSize = readNumber();
+                } else if (key == "maxSize") {
+                    manifest.parameters.maxSize = readNumber();
+                } else if (key == "size") {
+                    manifest.totalSize = readNumber();
+                } else if (key == "chunks") {
+                    parseChunks(manifest.chunks);
+                } else {
+                    fail();
+                }
+            });
+            skipSpaces();
+            if (position != content.size()) {
+                fail();
+            }
+            checkChunks(manifest);
+            return manifest;
+        }
+
+    private:
+        const string &content;
+        size_t position;
+
+        [[noreturn]] void fail() {
+            throw invalid_argument("Malformed manifest at the position " + to_string(position));
+        }
+
+        void skipSpaces() {
+            while (position < content.size() && isspace((uchar)content[position])) {
+                position++;
+            }
+        }
+
+        bool consume(char character) {
+            skipSpaces();
+            if (position < content.size() && content[position] == character) {
+                position++;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char character) {
+            if (!consume(character)) {
+                fail();
+            }
+        }
+
+        uint64 readNumber() {
+            skipSpaces();
+            size_t start = position;
+            uint64 value = 0;
+            while (position < content.size() && isdigit((uchar)content[position])) {
+                value = value * 10 + (content[position++] - '0');
+            }
+            if (position == start || position - start > 19) {
+                fail();
+            }
+            return value;
+        }
+
+        // The manifest has no escaped characters
+        string readString() {
+            expect('"');
+            size_t end = content.find('"', position);
+            if (end == string::npos || content.find('\\', position) < end) {
+                fail();
+            }
+            string value = content.substr(position, end - position);
+            position = end + 1;
+            return value;
+        }
+
+        template <typename KeyHandler>
+        void parseObject(KeyHandler handleKey) {
+            expect('{');
+            if (consume('}')) {
+                return;
+            }
+            do {
+                string key = readString();
+                expect(':');
+                handleKey(key);
+            } while (consume(','));
+            expect('}');
+        }
+
+        void parseChunks(vector<Chunk> &chunks) {
+            expect('[');
+            if (consume(']')) {
+                return;
+            }
+            do {
+                Chunk chunk {};
+                parseObject([&](const string &key) {
+                    if (key == "offset") {
+                        chunk.offset = readNumber();
+                    } else if (key == "size") {
+                        chunk.size = readNumber();
+                    } else if (key == "digest") {
+                        parseDigest(readString(), chunk.digest.data());
+                    } else {
+                        fail();
+                    }
+                });
+                chunks.push_back(chunk);
+            } while (consume(','));
+            expect(']');
+        }
+
+        void parseDigest(const string &hex, uchar *digest) {
+            if (hex.size() != DIGEST_SIZE * 2) {
+                fail();
+            }
+            for (size_t i = 0; i < DIGEST_SIZE; i++) {
+                int high = hexDigitValue(hex[i * 2]);
+                int low = hexDigitValue(hex[i * 2 + 1]);
+                if (high < 0 || low < 0) {
+                    fail();
+                }
+                digest[i] = (high << 4) | low;
+            }
+        }
+
+        static int hexDigitValue(char digit) {
+            if (digit >= '0' && digit <= '9') {
+                return digit - '0';
+            }
+            if (digit >= 'a' && digit <= 'f') {
+                return digit - 'a' + 10;
+            }
+            if (digit >= 'A' && digit <= 'F') {
+                return digit - 'A' + 10;
+            }
+            return -1;
+        }
+    };
+
+    // The digests are uniformly distributed, so their first bytes are the perfect hash
+    struct DigestHash {
+        size_t operator()(const string_view &digest) const {
+            uint64 value;
+            memcpy(&value, digest.data(), sizeof(value));
+            return value;
+        }
+    };
+
+}
+
+void writeManifest(const ChunkManifest &manifest, ManifestFormat format, ostream &output) {
+    if (format == ManifestFormat::Binary) {
+        writeBinaryManifest(manifest, output);
+    } else {
+        writeJsonManifest(manifest, output);
+    }
+}
+
+ChunkManifest readManifest(const string &filePath) {
+    string content;
+    {
+        InputReader reader(filePath);
+        const uchar *data;
+        size_t size;
+        while (reader.next(data, size)) {
+            content.append((const char *)data, size);
+        }
+    }
+
+    if (content.compare(0, sizeof(CHUNK_MANIFEST_MAGIC), CHUNK_MANIFEST_MAGIC, sizeof(CHUNK_MANIFEST_MAGIC)) == 0) {
+        return readBinaryManifest(content);
+    }
+    return JsonManifestParser(content).parse();
+}
+
+ManifestDiff diffManifests(const ChunkManifest &oldManifest, const ChunkManifest &newManifest) {
+    const ChunkingParameters &oldParameters = oldManifest.parameters;
+    const ChunkingParameters &newParameters = newManifest.parameters;
+    if (oldParameters.minSize != newParameters.minSize || oldParameters.averageSize != newParameters.averageSize
+        || oldParameters.maxSize != newParameters.maxSize) {
+        throw invalid_argument("The manifests are chunked with different parameters");
+    }
+
+    unordered_set<string_view, DigestHash> oldDigests;
+    oldDigests.reserve(oldManifest.chunks.size());
+    for (const Chunk &chunk : oldManifest.chunks) {
+        oldDigests.emplace((const char *)chunk.digest.data(), DIGEST_SIZE);
+    }
+
+    ManifestDiff diff;
+    for (size_t i = 0; i < newManifest.chunks.size(); i++) {
+        const Chunk &chunk = newManifest.chunks[i];
+        if (oldDigests.count(string_view((const char *)chunk.digest.data(), DIGEST_SIZE)) != 0) {
+            diff.reusedSize += chunk.size;
+        } else {
+            diff.changedChunks.push_back(i);
+            diff.changedSize += chunk.size;
+        }
+    }
+    return diff;
+}
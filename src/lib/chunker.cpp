@@ -0,0 +1,238 @@
+#include "../include/lib/chunker.hpp"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+
+#include "../include/utils/threadPool.hpp"
+
+namespace _cdc {
+
+    // The random values of the gear hash, one per byte value (generated by SplitMix64 at compile time).
+    // The boundaries of chunks depend on them, so any change of the table invalidates all the existing manifests
+    constexpr array<uint64, 256> generateGearTable() {
+        array<uint64, 256> table {};
+        uint64 seed = 0x5A17C0DEC0FFEEULL;
+        for (uint64 &value : table) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            uint64 mixed = seed;
+            mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+            value = mixed ^ (mixed >> 31);
+        }
+        return table;
+    }
+
+    constexpr array<uint64, 256> GEAR = generateGearTable();
+
+    // The minimum size is skipped without hashing, but the hash has to "see" at least its full width (64 bytes) of the chunk
+    const uint32 MIN_CHUNK_SIZE = 64;
+    const uint32 MIN_AVERAGE_CHUNK_SIZE = 256;
+
+    // The normalization level: the masks have this many bits more (before the average size) and less (after it)
+    const uchar NORMALIZATION_LEVEL = 2;
+
+    // The highest bits of the gear hash depend on the most of the last 64 bytes, so the mask selects them
+    inline uint64 highBitsMask(uchar bitsCount) {
+        return ~0ULL << (64 - bitsCount);
+    }
+
+    struct ChunkBatch {
+        // Points either into the memory mapping or to the `copy`
+        const uchar *data = nullptr;
+        vector<uchar> copy;
+        uint64 offset;
+        vector<Chunk> chunks;
+    };
+
+    void hashBatch(ChunkBatch &batch) {
+        sha2::Sha256Hasher hasher;
+        for (Chunk &chunk : batch.chunks) {
+            hasher.update(batch.data + (chunk.offset - batch.offset), chunk.size);
+            chunk.digest = hasher.final();
+        }
+        // The copy isn't needed anymore, the chunks are kept until all the batches are hashed
+        vector<uchar>().swap(batch.copy);
+    }
+
+    // Limits the count of batches in the pool, so the copies of the stream input don't pile up when the reading is faster than hashing
+    class BatchesLimiter {
+    public:
+        explicit BatchesLimiter(size_t maxBatchesCount) : maxBatchesCount(maxBatchesCount), batchesCount(0) {}
+
+        void acquire() {
+            unique_lock<mutex> guard(lock);
+            isReleased.wait(guard, [this] { return batchesCount < maxBatchesCount; });
+            batchesCount++;
+        }
+
+        void release() {
+            {
+                lock_guard<mutex> guard(lock);
+                batchesCount--;
+            }
+            isReleased.notify_one();
+        }
+
+    private:
+        size_t maxBatchesCount;
+        size_t batchesCount;
+        mutex lock;
+        condition_variable isReleased;
+    };
+
+}
+
+void validateChunkingParameters(const ChunkingParameters &parameters) {
+    if (parameters.minSize < _cdc::MIN_CHUNK_SIZE) {
+        throw invalid_argument("The minimum chunk size must be at least " + to_string(_cdc::MIN_CHUNK_SIZE) + " bytes");
+    }
+    if (parameters.averageSize < _cdc::MIN_AVERAGE_CHUNK_SIZE || (parameters.averageSize & (parameters.averageSize - 1)) != 0) {
+        throw invalid_argument("The average chunk size must be a power of two not less than " + to_string(_cdc::MIN_AVERAGE_CHUNK_SIZE));
+    }
+    if (parameters.minSize > parameters.averageSize || parameters.averageSize > parameters.maxSize) {
+        throw invalid_argument("The chunk sizes must satisfy: min <= average <= max");
+    }
+}
+
+ChunkBoundaryFinder::ChunkBoundaryFinder(const ChunkingParameters &parameters)
+    : parameters(parameters), chunkSize(0), hash(0) {
+    validateChunkingParameters(parameters);
+
+    uchar averageBitsCount = 0;
+    while ((1u << averageBitsCount) < parameters.averageSize) {
+        averageBitsCount++;
+    }
+    smallChunkMask = _cdc::highBitsMask(averageBitsCount + _cdc::NORMALIZATION_LEVEL);
+    largeChunkMask = _cdc::highBitsMask(averageBitsCount - _cdc::NORMALIZATION_LEVEL);
+}
+
+size_t ChunkBoundaryFinder::find(const uchar *data, size_t size, bool &isEnd) {
+    // The bytes before the minimum size can't end the chunk, so they aren't hashed at all
+    size_t i = 0;
+    if (chunkSize < parameters.minSize) {
+        i = min((uint64)size, parameters.minSize - chunkSize);
+    }
+
+    uint64 currentHash = hash;
+    isEnd = false;
+
+    // The bytes before the average size are checked against the stricter mask
+    uint64 position = chunkSize + i;
+    size_t end = position < parameters.averageSize ? i + min((uint64)(size - i), parameters.averageSize - position) : i;
+    for (; i < end; i++) {
+        currentHash = (currentHash << 1) + _cdc::GEAR[data[i]];
+        if ((currentHash & smallChunkMask) == 0) {
+            isEnd = true;
+            i++;
+            break;
+        }
+    }
+
+    if (!isEnd) {
+        position = chunkSize + i;
+        end = i + min((uint64)(size - i), parameters.maxSize - position);
+        for (; i < end; i++) {
+            currentHash = (currentHash << 1) + _cdc::GEAR[data[i]];
+            if ((currentHash & largeChunkMask) == 0) {
+                isEnd = true;
+                i++;
+                break;
+            }
+        }
+        isEnd = isEnd || chunkSize + i == parameters.maxSize;
+    }
+
+    if (isEnd) {
+        chunkSize = 0;
+        hash = 0;
+    } else {
+        chunkSize += i;
+        hash = currentHash;
+    }
+    return i;
+}
+
+ChunkManifest chunkFile(const string &filePath, const ChunkingOptions &options) {
+    ChunkManifest manifest;
+    manifest.parameters = options.parameters;
+    ChunkBoundaryFinder finder(options.parameters);
+
+    InputReader reader(filePath, options.inputOptions);
+    // The portions of the mapped input follow each other in memory, so the batches point right into the mapping.
+    // The stream input is copied, since the buffer of the reader is reused
+    bool isMapped = reader.isMapped();
+
+    vector<unique_ptr<_cdc::ChunkBatch>> batches;
+    {
+        ThreadPool pool(options.threadsCount);
+        _cdc::BatchesLimiter limiter(pool.getThreadsCount() * 2);
+
+        auto startBatch = [&](uint64 offset) {
+            batches.emplace_back(new _cdc::ChunkBatch());
+            batches.back()->offset = offset;
+            if (!isMapped) {
+                batches.back()->copy.reserve(CHUNK_BATCH_SIZE + options.parameters.maxSize);
+            }
+        };
+        auto submitBatch = [&]() {
+            _cdc::ChunkBatch *batch = batches.back().get();
+            if (!isMapped) {
+                batch->data = batch->copy.data();
+            }
+            limiter.acquire();
+            pool.submit([batch, &limiter] {
+                _cdc::hashBatch(*batch);
+                limiter.release();
+            });
+        };
+
+        startBatch(0);
+        uint64 offset = 0;
+        uint64 chunkOffset = 0;
+        const uchar *data;
+        size_t size;
+        while (reader.next(data, size)) {
+            for (size_t position = 0; position < size;) {
+                bool isEnd;
+                size_t scannedSize = finder.find(data + position, size - position, isEnd);
+
+                _cdc::ChunkBatch &batch = *batches.back();
+                if (!isMapped) {
+                    batch.copy.insert(batch.copy.end(), data + position, data + position + scannedSize);
+                } else if (batch.data == nullptr) {
+                    batch.data = data + position;
+                }
+                position += scannedSize;
+                offset += scannedSize;
+
+                if (isEnd) {
+                    batch.chunks.push_back(Chunk { chunkOffset, uint32(offset - chunkOffset), {} });
+                    chunkOffset = offset;
+                    if (offset - batch.offset >= CHUNK_BATCH_SIZE) {
+                        submitBatch();
+                        startBatch(offset);
+                    }
+                }
+            }
+        }
+
+        // The rest of input is the last chunk, even if it's smaller than the minimum size
+        if (offset > chunkOffset) {
+            batches.back()->chunks.push_back(Chunk { chunkOffset, uint32(offset - chunkOffset), {} });
+        }
+        if (!batches.back()->chunks.empty()) {
+            submitBatch();
+        }
+        manifest.totalSize = offset;
+
+        // The pool waits for all the tasks on destruction
+    }
+
+    for (const unique_ptr<_cdc::ChunkBatch> &batch : batches) {
+        manifest.chunks.insert(manifest.chunks.end(), batch->chunks.begin(), batch->chunks.end());
+    }
+    return manifest;
+}
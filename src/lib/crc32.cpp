@@ -0,0 +1,200 @@
+#include "../include/lib/crc32.hpp"
+
+#include <array>
+
+#include "../include/utils/cpuFeatures.hpp"
+#include "../include/utils/fileValidator.hpp"
+
+namespace crc32 {
+
+    namespace _crc32 {
+        typedef array<array<uint32, 256>, 8> SliceTables;
+
+        // The table k gives the CRC of the byte followed by k zero bytes, so 8 bytes are processed by 8 independent lookups
+        constexpr SliceTables generateSliceTables(uint32 polynomial) {
+            SliceTables tables {};
+            for (uint32 byte = 0; byte < 256; byte++) {
+                uint32 crc = byte;
+                for (uchar bit = 0; bit < 8; bit++) {
+                    crc = crc & 1 ? (crc >> 1) ^ polynomial : crc >> 1;
+                }
+                tables[0][byte] = crc;
+            }
+            for (uint32 byte = 0; byte < 256; byte++) {
+                for (size_t k = 1; k < 8; k++) {
+                    tables[k][byte] = (tables[k - 1][byte] >> 8) ^ tables[0][tables[k - 1][byte] & 0xFF];
+                }
+            }
+            return tables;
+        }
+
+        constexpr SliceTables SLICE_TABLES = generateSliceTables(POLYNOMIAL);
+        constexpr SliceTables CASTAGNOLI_SLICE_TABLES = generateSliceTables(CASTAGNOLI_POLYNOMIAL);
+
+        inline uint32 updateSliced(const SliceTables &tables, uint32 crc, const uchar *data, size_t size) {
+            for (; size >= 8; data += 8, size -= 8) {
+                uint32 low = crc ^ (data[0] | data[1] << 8 | data[2] << 16 | (uint32)data[3] << 24);
+                crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF]
+                    ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24]
+                    ^ tables[3][data[4]] ^ tables[2][data[5]]
+                    ^ tables[1][data[6]] ^ tables[0][data[7]];
+            }
+            for (; size != 0; data++, size--) {
+                crc = (crc >> 8) ^ tables[0][(crc ^ *data) & 0xFF];
+            }
+            return crc;
+        }
+
+        uint32 updateScalar(uint32 crc, const uchar *data, size_t size) {
+            return updateSliced(SLICE_TABLES, crc, data, size);
+        }
+
+        uint32 updateCastagnoliScalar(uint32 crc, const uchar *data, size_t size) {
+            return updateSliced(CASTAGNOLI_SLICE_TABLES, crc, data, size);
+        }
+
+        // x^(2^k) modulo the polynomial. The order of x is 2^32 - 1, so they repeat after 32
+        constexpr array<uint32, 32> generatePowersTable() {
+            array<uint32, 32> table {};
+            uint32 power = 1u << 30;
+            for (uint32 &value : table) {
+                value = power;
+                power = multiplyModulo(power, power, POLYNOMIAL);
+            }
+            return table;
+        }
+
+        constexpr array<uint32, 32> POWERS = generatePowersTable();
+
+        // x^(8 * size) modulo the polynomial: appending `size` zero bytes multiplies the CRC by it
+        uint32 zeroBytesOperator(uint64 size) {
+            uint32 result = 1u << 31;
+            for (size_t k = 3; size != 0; size >>= 1, k++) {
+                if (size & 1) {
+                    result = multiplyModulo(POWERS[k & 31], result, POLYNOMIAL);
+                }
+            }
+            return result;
+        }
+
+        UpdateFunction *selectUpdateFunction() {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            bool isPclmulSupported = features.pclmul && features.sse41;
+            bool isAvx512Supported = isPclmulSupported && features.avx512f && features.vpclmulqdq;
+            switch (implementation) {
+                case Implementation::Auto:
+                    if (isAvx512Supported) {
+                        return updateAvx512;
+                    }
+                    return isPclmulSupported ? updatePclmul : updateScalar;
+                case Implementation::Avx512:
+                    ensureImplementationSupported(implementation, isAvx512Supported);
+                    return updateAvx512;
+                case Implementation::Pclmul:
+                    ensureImplementationSupported(implementation, isPclmulSupported);
+                    return updatePclmul;
+                default:
+                    return updateScalar;
+            }
+        }
+
+        UpdateFunction *selectCastagnoliUpdateFunction() {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            switch (implementation) {
+                case Implementation::Auto:
+                    return features.sse42 ? updateCastagnoliSse42 : updateCastagnoliScalar;
+                case Implementation::Sse42:
+                    ensureImplementationSupported(implementation, features.sse42);
+                    return updateCastagnoliSse42;
+                default:
+                    return updateCastagnoliScalar;
+            }
+        }
+
+        template <typename Variant>
+        Crc32Digest hashReader(InputReader &reader) {
+            CrcHasher<Variant> hasher;
+            const uchar *data;
+            size_t size;
+
+            // Feed the hasher until the end of input: its size doesn't have to be known up front
+            while (reader.next(data, size)) {
+                hasher.update(data, size);
+            }
+            return hasher.final();
+        }
+    }
+
+    uint32 update(uint32 crc, const uchar *data, size_t size) {
+        return ~_crc32::selectUpdateFunction()(~crc, data, size);
+    }
+
+    uint32 combine(uint32 firstCrc, uint32 secondCrc, uint64 secondSize) {
+        return _crc32::multiplyModulo(_crc32::zeroBytesOperator(secondSize), firstCrc, _crc32::POLYNOMIAL) ^ secondCrc;
+    }
+
+    uint32 updateCastagnoli(uint32 crc, const uchar *data, size_t size) {
+        return ~_crc32::selectCastagnoliUpdateFunction()(~crc, data, size);
+    }
+
+    template <typename Variant>
+    CrcHasher<Variant>::CrcHasher() : crc(~0u), updateFunction(Variant::selectUpdateFunction()) {}
+
+    template <typename Variant>
+    void CrcHasher<Variant>::reset() {
+        crc = ~0u;
+    }
+
+    template <typename Variant>
+    void CrcHasher<Variant>::update(const uchar *data, size_t size) {
+        crc = updateFunction(crc, data, size);
+    }
+
+    template <typename Variant>
+    Crc32Digest CrcHasher<Variant>::final() {
+        uint32 checksum = ~crc;
+        reset();
+        return { uchar(checksum >> 24), uchar(checksum >> 16), uchar(checksum >> 8), uchar(checksum) };
+    }
+
+    template <typename Variant>
+    Crc32Digest hashFile(const string &filePath, const InputOptions &options) {
+        return validateFileForHashFunction(filePath, _crc32::hashReader<Variant>, options);
+    }
+
+    template <typename Variant>
+    vector<Crc32Digest> hashFiles(const vector<string> &filePaths, const InputOptions &options) {
+        vector<Crc32Digest> digests;
+        for (const string &filePath : filePaths) {
+            digests.push_back(hashFile<Variant>(filePath, options));
+        }
+        return digests;
+    }
+
+    template <typename Variant>
+    vector<Crc32Digest> hashBuffers(const vector<ByteView> &messages) {
+        CrcHasher<Variant> hasher;
+        vector<Crc32Digest> digests;
+        for (const ByteView &message : messages) {
+            hasher.update(message.data, message.size);
+            digests.push_back(hasher.final());
+        }
+        return digests;
+    }
+
+#define INSTANTIATE_CRC_VARIANT(Variant) \
+    template class CrcHasher<Variant>; \
+    template Crc32Digest hashFile<Variant>(const string &filePath, const InputOptions &options); \
+    template vector<Crc32Digest> hashFiles<Variant>(const vector<string> &filePaths, const InputOptions &options); \
+    template vector<Crc32Digest> hashBuffers<Variant>(const vector<ByteView> &messages);
+
+    INSTANTIATE_CRC_VARIANT(Crc32Variant)
+    INSTANTIATE_CRC_VARIANT(Crc32cVariant)
+
+#undef INSTANTIATE_CRC_VARIANT
+
+}
@@ -0,0 +1,1051 @@
+#include "../include/lib/deflate.hpp"
+
+#include <array>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace deflate {
+
+    namespace _deflate {
+        const uint32 MIN_MATCH = 3;
+        const uint32 MAX_MATCH = 258;
+        // The shortest matches this far back take more bits than their literals (TOO_FAR of zlib)
+        const uint32 MAX_SHORT_MATCH_DISTANCE = 4096;
+
+        const uint32 HASH_BITS = 15;
+        const uint32 HASH_SIZE = 1 << HASH_BITS;
+
+        // The Huffman codes are rebuilt for each block, so they follow the changes of the content
+        const size_t MAX_BLOCK_SYMBOLS = 16 * 1024;
+        const uint32 MAX_STORED_BLOCK_SIZE = 65535;
+
+        // 0-255 are the literals, 256 ends the block, 257-285 are the lengths of the matches
+        const uint32 LITERALS_COUNT = 286;
+        const uint32 END_OF_BLOCK = 256;
+        const uint32 DISTANCES_COUNT = 30;
+        const uint32 CODE_LENGTHS_COUNT = 19;
+        const uchar MAX_CODE_LENGTH = 15;
+        const uchar MAX_CODE_LENGTH_CODE_LENGTH = 7;
+
+        const uchar BLOCK_STORED = 0;
+        const uchar BLOCK_FIXED = 1;
+        const uchar BLOCK_DYNAMIC = 2;
+
+        constexpr uint16 LENGTH_BASES[29] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+        };
+        constexpr uchar LENGTH_EXTRA_BITS[29] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+        };
+        constexpr uint16 DISTANCE_BASES[30] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+            1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+        };
+        constexpr uchar DISTANCE_EXTRA_BITS[30] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+        };
+        // The lengths of the code length codes are stored in this order, so the unused ones at the end may be omitted
+        const uchar CODE_LENGTH_ORDER[CODE_LENGTHS_COUNT] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        // The length code (0-28) of each match length
+        constexpr array<uchar, MAX_MATCH + 1> generateLengthCodes() {
+            array<uchar, MAX_MATCH + 1> codes {};
+            for (uchar code = 0; code < 29; code++) {
+                for (uint32 length = LENGTH_BASES[code]; length < LENGTH_BASES[code] + (1u << LENGTH_EXTRA_BITS[code]) && length <= MAX_MATCH; length++) {
+                    codes[length] = code;
+                }
+            }
+            return codes;
+        }
+
+        // The distance code of (distance - 1) below 256, and of 256 + ((distance - 1) >> 7) for the farther ones
+        // (their ranges are the multiples of 128)
+        constexpr array<uchar, 512> generateDistanceCodes() {
+            array<uchar, 512> codes {};
+            for (uchar code = 0; code < DISTANCES_COUNT; code++) {
+                for (uint32 distance = DISTANCE_BASES[code] - 1; distance < DISTANCE_BASES[code] - 1 + (1u << DISTANCE_EXTRA_BITS[code]); distance++) {
+                    codes[distance < 256 ? distance : 256 + (distance >> 7)] = code;
+                }
+            }
+            return codes;
+        }
+
+        constexpr array<uchar, MAX_MATCH + 1> LENGTH_CODES = generateLengthCodes();
+        constexpr array<uchar, 512> DISTANCE_CODES = generateDistanceCodes();
+
+        inline uchar getDistanceCode(uint32 distance) {
+            distance--;
+            return DISTANCE_CODES[distance < 256 ? distance : 256 + (distance >> 7)];
+        }
+
+        // The parameters of the levels are the ones of zlib: the matches of the `goodLength` shorten the search
+        // of the next one 4 times, the ones of the `maxLazy` aren't followed by the search at the next position
+        // (with the greedy matching, the longer matches aren't inserted into the hash chains),
+        // the matches of the `niceLength` stop the search, which follows up to `maxChain` previous positions
+        struct LevelParameters {
+            uint16 goodLength;
+            uint16 maxLazy;
+            uint16 niceLength;
+            uint16 maxChain;
+        };
+
+        const LevelParameters LEVELS[MAX_LEVEL + 1] = {
+            { 0, 0, 0, 0 },
+            { 4, 4, 8, 4 },
+            { 4, 5, 16, 8 },
+            { 4, 6, 32, 32 },
+            { 4, 4, 16, 16 },
+            { 8, 16, 32, 32 },
+            { 8, 16, 128, 128 },
+            { 8, 32, 128, 256 },
+            { 32, 128, 258, 1024 },
+            { 32, 258, 258, 4096 }
+        };
+        const int MIN_LAZY_LEVEL = 4;
+
+        inline uint32 reverseBits(uint32 code, uchar length) {
+            uint32 reversed = 0;
+            for (uchar i = 0; i < length; i++) {
+                reversed = (reversed << 1) | (code & 1);
+                code >>= 1;
+            }
+            return reversed;
+        }
+
+        // The count of equal bytes at the start of both sequences, up to the `maxLength`.
+        // The bytes are compared 16 at a time, the first mismatch is the lowest zero bit of the comparison mask
+#ifdef __SSE2__
+        inline uint32 getMatchLength(const uchar *first, const uchar *second, uint32 maxLength) {
+            uint32 length = 0;
+            for (; length + 16 <= maxLength; length += 16) {
+                __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(first + length)), _mm_loadu_si128((const __m128i *)(second + length)));
+                uint32 mismatches = ~(uint32)_mm_movemask_epi8(equal) & 0xFFFF;
+                if (mismatches != 0) {
+                    return length + __builtin_ctz(mismatches);
+                }
+            }
+            while (length < maxLength && first[length] == second[length]) {
+                length++;
+            }
+            return length;
+        }
+#else
+        inline uint32 getMatchLength(const uchar *first, const uchar *second, uint32 maxLength) {
+            uint32 length = 0;
+            for (; length + 8 <= maxLength; length += 8) {
+                uint64 firstWord;
+                uint64 secondWord;
+                memcpy(&firstWord, first + length, 8);
+                memcpy(&secondWord, second + length, 8);
+                if (firstWord != secondWord) {
+                    break;
+                }
+            }
+            while (length < maxLength && first[length] == second[length]) {
+                length++;
+            }
+            return length;
+        }
+#endif
+
+        // Packs the bits into the bytes starting from the least significant one
+        class BitWriter {
+        public:
+            explicit BitWriter(vector<uchar> &output) : output(output), bits(0), bitsCount(0) {}
+
+            // Up to 32 bits, the `value` must not have the higher bits set
+            void write(uint32 value, uchar count) {
+                bits |= (uint64)value << bitsCount;
+                bitsCount += count;
+                if (bitsCount >= 32) {
+                    uchar bytes[4] = { uchar(bits), uchar(bits >> 8), uchar(bits >> 16), uchar(bits >> 24) };
+                    output.insert(output.end(), bytes, bytes + 4);
+                    bits >>= 32;
+                    bitsCount -= 32;
+                }
+            }
+
+            void alignToByte() {
+                for (; bitsCount > 0; bitsCount = bitsCount > 8 ? bitsCount - 8 : 0) {
+                    output.push_back(uchar(bits));
+                    bits >>= 8;
+                }
+                bits = 0;
+            }
+
+            // Byte-aligned
+            void writeBytes(const uchar *data, size_t size) {
+                alignToByte();
+                output.insert(output.end(), data, data + size);
+            }
+
+        private:
+            vector<uchar> &output;
+            uint64 bits;
+            uchar bitsCount;
+        };
+
+        // The lengths of the optimal prefix code (unused symbols get 0) limited to the `maxLength`.
+        // At least two symbols get the codes: a single code would take 0 bits, which not all the decoders accept
+        void buildCodeLengths(const uint32 *frequencies, size_t count, uchar maxLength, uchar *lengths) {
+            fill(lengths, lengths + count, 0);
+            vector<uint32> symbols;
+            for (uint32 symbol = 0; symbol < count; symbol++) {
+                if (frequencies[symbol] != 0) {
+                    symbols.push_back(symbol);
+                }
+            }
+            for (uint32 symbol = 0; symbols.size() < 2; symbol++) {
+                if (frequencies[symbol] == 0) {
+                    symbols.push_back(symbol);
+                }
+            }
+            auto getWeight = [frequencies](uint32 symbol) { return max(frequencies[symbol], 1u); };
+            stable_sort(symbols.begin(), symbols.end(), [&](uint32 first, uint32 second) { return getWeight(first) < getWeight(second); });
+
+            // The Huffman tree by the two-queue method: the sorted leaves and the internal nodes, which are created in the order of weights
+            size_t leavesCount = symbols.size();
+            size_t nodesCount = 2 * leavesCount - 1;
+            vector<uint64> weights(nodesCount);
+            vector<uint32> parents(nodesCount);
+            for (size_t i = 0; i < leavesCount; i++) {
+                weights[i] = getWeight(symbols[i]);
+            }
+            size_t nextLeaf = 0;
+            size_t nextNode = leavesCount;
+            auto takeLightest = [&](size_t node) {
+                size_t lightest = nextLeaf < leavesCount && (nextNode >= node || weights[nextLeaf] <= weights[nextNode]) ? nextLeaf++ : nextNode++;
+                parents[lightest] = node;
+                return weights[lightest];
+            };
+            for (size_t node = leavesCount; node < nodesCount; node++) {
+                uint64 weight = takeLightest(node);
+                weights[node] = weight + takeLightest(node);
+            }
+
+            // The depths of the leaves, the ones beyond the `maxLength` are cut to it.
+            // Then the Kraft sum is restored: a code of the maximum length is dropped and a shorter one is split into two longer ones
+            vector<uchar> depths(nodesCount);
+            depths[nodesCount - 1] = 0;
+            array<uint32, MAX_CODE_LENGTH + 1> lengthCounts {};
+            for (size_t node = nodesCount - 1; node-- > 0;) {
+                depths[node] = depths[parents[node]] + 1;
+                if (node < leavesCount) {
+                    lengthCounts[min(depths[node], maxLength)]++;
+                }
+            }
+            uint32 kraftSum = 0;
+            for (uchar length = 1; length <= maxLength; length++) {
+                kraftSum += lengthCounts[length] << (maxLength - length);
+            }
+            for (; kraftSum > (1u << maxLength); kraftSum--) {
+                lengthCounts[maxLength]--;
+                for (uchar length = maxLength - 1; length > 0; length--) {
+                    if (lengthCounts[length] != 0) {
+                        lengthCounts[length]--;
+                        lengthCounts[length + 1] += 2;
+                        break;
+                    }
+                }
+            }
+
+            // The least frequent symbols get the longest codes
+            size_t leaf = 0;
+            for (uchar length = maxLength; length > 0; length--) {
+                for (uint32 i = 0; i < lengthCounts[length]; i++) {
+                    lengths[symbols[leaf++]] = length;
+                }
+            }
+        }
+
+        // The canonical codes of the lengths, bit-reversed for the BitWriter
+        void buildCodes(const uchar *lengths, size_t count, uint16 *codes) {
+            array<uint32, MAX_CODE_LENGTH + 1> lengthCounts {};
+            for (size_t i = 0; i < count; i++) {
+                lengthCounts[lengths[i]]++;
+            }
+            lengthCounts[0] = 0;
+            array<uint32, MAX_CODE_LENGTH + 1> nextCodes {};
+            uint32 code = 0;
+            for (uchar length = 1; length <= MAX_CODE_LENGTH; length++) {
+                code = (code + lengthCounts[length - 1]) << 1;
+                nextCodes[length] = code;
+            }
+            for (size_t i = 0; i < count; i++) {
+                codes[i] = lengths[i] != 0 ? reverseBits(nextCodes[lengths[i]]++, lengths[i]) : 0;
+            }
+        }
+
+        void getFixedLiteralLengths(uchar *lengths) {
+            fill(lengths, lengths + 144, 8);
+            fill(lengths + 144, lengths + 256, 9);
+            fill(lengths + 256, lengths + 280, 7);
+            fill(lengths + 280, lengths + 288, 8);
+        }
+
+        // The fixed code has the codes of 288 literals and 32 distances, the last ones of both are never used
+        const uint32 FIXED_LITERALS_COUNT = 288;
+        const uint32 FIXED_DISTANCES_COUNT = 32;
+
+        struct HuffmanCode {
+            uchar lengths[FIXED_LITERALS_COUNT];
+            uint16 codes[FIXED_LITERALS_COUNT];
+        };
+
+        struct FixedCodes {
+            HuffmanCode literals;
+            HuffmanCode distances;
+
+            FixedCodes() {
+                getFixedLiteralLengths(literals.lengths);
+                buildCodes(literals.lengths, FIXED_LITERALS_COUNT, literals.codes);
+                fill(distances.lengths, distances.lengths + FIXED_DISTANCES_COUNT, 5);
+                buildCodes(distances.lengths, FIXED_DISTANCES_COUNT, distances.codes);
+            }
+        };
+
+        const FixedCodes &getFixedCodes() {
+            static const FixedCodes codes;
+            return codes;
+        }
+
+        // A literal if the `distance` is 0, otherwise the match of the `literalOrLength` bytes
+        struct Symbol {
+            uint16 literalOrLength;
+            uint16 distance;
+        };
+
+        // The code lengths of the dynamic block, run-length encoded by the symbols 16-18
+        struct CodeLengthSymbol {
+            uchar symbol;
+            uchar extra;
+        };
+
+        const uchar CODE_LENGTH_EXTRA_BITS[CODE_LENGTHS_COUNT] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 7 };
+
+        void encodeCodeLengths(const uchar *lengths, size_t count, vector<CodeLengthSymbol> &symbols) {
+            for (size_t i = 0; i < count;) {
+                uchar length = lengths[i];
+                size_t runLength = 1;
+                while (i + runLength < count && lengths[i + runLength] == length) {
+                    runLength++;
+                }
+                i += runLength;
+
+                if (length == 0) {
+                    for (; runLength >= 11; runLength -= min(runLength, (size_t)138)) {
+                        symbols.push_back({ 18, uchar(min(runLength, (size_t)138) - 11) });
+                    }
+                    if (runLength >= 3) {
+                        symbols.push_back({ 17, uchar(runLength - 3) });
+                        runLength = 0;
+                    }
+                } else {
+                    symbols.push_back({ length, 0 });
+                    runLength--;
+                    for (; runLength >= 3; runLength -= min(runLength, (size_t)6)) {
+                        symbols.push_back({ 16, uchar(min(runLength, (size_t)6) - 3) });
+                    }
+                }
+                for (; runLength > 0; runLength--) {
+                    symbols.push_back({ length, 0 });
+                }
+            }
+        }
+
+        void writeStoredBlocks(BitWriter &writer, const uchar *data, size_t size, bool isFinal) {
+            do {
+                uint32 blockSize = min(size, (size_t)MAX_STORED_BLOCK_SIZE);
+                size -= blockSize;
+                writer.write(isFinal && size == 0, 1);
+                writer.write(BLOCK_STORED, 2);
+                writer.alignToByte();
+                writer.write(blockSize, 16);
+                writer.write(~blockSize & 0xFFFF, 16);
+                writer.writeBytes(data, blockSize);
+                data += blockSize;
+            } while (size > 0);
+        }
+
+        void writeSymbols(BitWriter &writer, const Symbol *symbols, size_t count, const HuffmanCode &literals, const HuffmanCode &distances) {
+            for (const Symbol *symbol = symbols; symbol != symbols + count; symbol++) {
+                if (symbol->distance == 0) {
+                    writer.write(literals.codes[symbol->literalOrLength], literals.lengths[symbol->literalOrLength]);
+                    continue;
+                }
+                uchar lengthCode = LENGTH_CODES[symbol->literalOrLength];
+                writer.write(literals.codes[257 + lengthCode], literals.lengths[257 + lengthCode]);
+                writer.write(symbol->literalOrLength - LENGTH_BASES[lengthCode], LENGTH_EXTRA_BITS[lengthCode]);
+                uchar distanceCode = getDistanceCode(symbol->distance);
+                writer.write(distances.codes[distanceCode], distances.lengths[distanceCode]);
+                writer.write(symbol->distance - DISTANCE_BASES[distanceCode], DISTANCE_EXTRA_BITS[distanceCode]);
+            }
+            writer.write(literals.codes[END_OF_BLOCK], literals.lengths[END_OF_BLOCK]);
+        }
+
+        void writeEmptyFinalBlock(BitWriter &writer) {
+            writer.write(1, 1);
+            writer.write(BLOCK_FIXED, 2);
+            writer.write(getFixedCodes().literals.codes[END_OF_BLOCK], getFixedCodes().literals.lengths[END_OF_BLOCK]);
+        }
+
+        // Writes the symbols as the dynamic, fixed or stored block, whichever is the smallest.
+        // The `data` is the input the symbols stand for
+        void writeBlock(BitWriter &writer, const Symbol *symbols, size_t count, const uchar *data, size_t size, bool isFinal) {
+            array<uint32, LITERALS_COUNT> literalFrequencies {};
+            array<uint32, DISTANCES_COUNT> distanceFrequencies {};
+            for (const Symbol *symbol = symbols; symbol != symbols + count; symbol++) {
+                if (symbol->distance == 0) {
+                    literalFrequencies[symbol->literalOrLength]++;
+                } else {
+                    literalFrequencies[257 + LENGTH_CODES[symbol->literalOrLength]]++;
+                    distanceFrequencies[getDistanceCode(symbol->distance)]++;
+                }
+            }
+            literalFrequencies[END_OF_BLOCK] = 1;
+
+            uint64 extraBits = 0;
+            for (uchar code = 0; code < 29; code++) {
+                extraBits += (uint64)literalFrequencies[257 + code] * LENGTH_EXTRA_BITS[code];
+            }
+            for (uchar code = 0; code < DISTANCES_COUNT; code++) {
+                extraBits += (uint64)distanceFrequencies[code] * DISTANCE_EXTRA_BITS[code];
+            }
+            auto getCodesBits = [&](const HuffmanCode &literals, const HuffmanCode &distances) {
+                uint64 bits = extraBits;
+                for (uint32 i = 0; i < LITERALS_COUNT; i++) {
+                    bits += (uint64)literalFrequencies[i] * literals.lengths[i];
+                }
+                for (uint32 i = 0; i < DISTANCES_COUNT; i++) {
+                    bits += (uint64)distanceFrequencies[i] * distances.lengths[i];
+                }
+                return bits;
+            };
+
+            HuffmanCode literals;
+            HuffmanCode distances;
+            buildCodeLengths(literalFrequencies.data(), LITERALS_COUNT, MAX_CODE_LENGTH, literals.lengths);
+            buildCodeLengths(distanceFrequencies.data(), DISTANCES_COUNT, MAX_CODE_LENGTH, distances.lengths);
+            uint32 literalsCount = LITERALS_COUNT;
+            while (literalsCount > 257 && literals.lengths[literalsCount - 1] == 0) {
+                literalsCount--;
+            }
+            uint32 distancesCount = DISTANCES_COUNT;
+            while (distancesCount > 1 && distances.lengths[distancesCount - 1] == 0) {
+                distancesCount--;
+            }
+
+            // The lengths of both codes are encoded as a single sequence, so the runs may cross from one to another
+            uchar allLengths[LITERALS_COUNT + DISTANCES_COUNT];
+            copy(literals.lengths, literals.lengths + literalsCount, allLengths);
+            copy(distances.lengths, distances.lengths + distancesCount, allLengths + literalsCount);
+            vector<CodeLengthSymbol> lengthSymbols;
+            encodeCodeLengths(allLengths, literalsCount + distancesCount, lengthSymbols);
+            array<uint32, CODE_LENGTHS_COUNT> lengthFrequencies {};
+            for (const CodeLengthSymbol &symbol : lengthSymbols) {
+                lengthFrequencies[symbol.symbol]++;
+            }
+            uchar lengthLengths[CODE_LENGTHS_COUNT];
+            uint16 lengthCodes[CODE_LENGTHS_COUNT];
+            buildCodeLengths(lengthFrequencies.data(), CODE_LENGTHS_COUNT, MAX_CODE_LENGTH_CODE_LENGTH, lengthLengths);
+            buildCodes(lengthLengths, CODE_LENGTHS_COUNT, lengthCodes);
+            uint32 lengthLengthsCount = CODE_LENGTHS_COUNT;
+            while (lengthLengthsCount > 4 && lengthLengths[CODE_LENGTH_ORDER[lengthLengthsCount - 1]] == 0) {
+                lengthLengthsCount--;
+            }
+
+            uint64 dynamicBits = 3 + 5 + 5 + 4 + 3 * lengthLengthsCount + getCodesBits(literals, distances);
+            for (uchar symbol = 0; symbol < CODE_LENGTHS_COUNT; symbol++) {
+                dynamicBits += (uint64)lengthFrequencies[symbol] * (lengthLengths[symbol] + CODE_LENGTH_EXTRA_BITS[symbol]);
+            }
+            const FixedCodes &fixedCodes = getFixedCodes();
+            uint64 fixedBits = 3 + getCodesBits(fixedCodes.literals, fixedCodes.distances);
+            // The header and the worst-case alignment of each stored block
+            uint64 storedBits = 8 * (uint64)size + (3 + 7 + 32) * max((size + MAX_STORED_BLOCK_SIZE - 1) / MAX_STORED_BLOCK_SIZE, (size_t)1);
+
+            if (storedBits <= min(dynamicBits, fixedBits)) {
+                writeStoredBlocks(writer, data, size, isFinal);
+            } else if (fixedBits <= dynamicBits) {
+                writer.write(isFinal, 1);
+                writer.write(BLOCK_FIXED, 2);
+                writeSymbols(writer, symbols, count, fixedCodes.literals, fixedCodes.distances);
+            } else {
+                buildCodes(literals.lengths, LITERALS_COUNT, literals.codes);
+                buildCodes(distances.lengths, DISTANCES_COUNT, distances.codes);
+                writer.write(isFinal, 1);
+                writer.write(BLOCK_DYNAMIC, 2);
+                writer.write(literalsCount - 257, 5);
+                writer.write(distancesCount - 1, 5);
+                writer.write(lengthLengthsCount - 4, 4);
+                for (uint32 i = 0; i < lengthLengthsCount; i++) {
+                    writer.write(lengthLengths[CODE_LENGTH_ORDER[i]], 3);
+                }
+                for (const CodeLengthSymbol &symbol : lengthSymbols) {
+                    writer.write(lengthCodes[symbol.symbol], lengthLengths[symbol.symbol]);
+                    writer.write(symbol.extra, CODE_LENGTH_EXTRA_BITS[symbol.symbol]);
+                }
+                writeSymbols(writer, symbols, count, literals, distances);
+            }
+        }
+
+        // Finds the matches via the hash chains of the 3-byte prefixes: the `heads` keep the last position of each hash
+        // and the `previous` link each position to the previous one of the same hash.
+        // The positions are the offsets from the start of the dictionary, so the dictionary is searched as the rest of the input
+        class MatchFinder {
+        public:
+            void reset(const uchar *window, size_t windowSize) {
+                this->window = window;
+                this->windowSize = windowSize;
+                heads.assign(HASH_SIZE, -1);
+                previous.resize(windowSize);
+            }
+
+            void insert(size_t position) {
+                if (position + MIN_MATCH <= windowSize) {
+                    const uchar *bytes = window + position;
+                    uint32 hash = ((bytes[0] | bytes[1] << 8 | bytes[2] << 16) * 0x9E3779B1u) >> (32 - HASH_BITS);
+                    previous[position] = heads[hash];
+                    heads[hash] = position;
+                }
+            }
+
+            // The match at the inserted `position` longer than the `minLength`, 0 if there is none
+            uint32 find(size_t position, uint32 minLength, uint32 maxChain, uint32 niceLength, uint32 &distance) const {
+                uint32 maxLength = min((size_t)MAX_MATCH, windowSize - position);
+                uint32 bestLength = max(minLength, MIN_MATCH - 1);
+                if (bestLength >= maxLength) {
+                    return 0;
+                }
+                const uchar *current = window + position;
+                int limit = position > WINDOW_SIZE ? int(position - WINDOW_SIZE) : 0;
+                uint32 bestDistance = 0;
+                for (int candidate = previous[position]; candidate >= limit && maxChain-- > 0; candidate = previous[candidate]) {
+                    const uchar *bytes = window + candidate;
+                    // The candidate can't be longer unless it matches at the end of the best match
+                    if (bytes[bestLength] != current[bestLength] || bytes[0] != current[0] || bytes[1] != current[1]) {
+                        continue;
+                    }
+                    uint32 length = getMatchLength(bytes, current, maxLength);
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = position - candidate;
+                        if (length >= niceLength || length == maxLength) {
+                            break;
+                        }
+                    }
+                }
+                if (bestDistance == 0 || (bestLength == MIN_MATCH && bestDistance > MAX_SHORT_MATCH_DISTANCE)) {
+                    return 0;
+                }
+                distance = bestDistance;
+                return bestLength;
+            }
+
+        private:
+            const uchar *window;
+            size_t windowSize;
+            vector<int> heads;
+            vector<int> previous;
+        };
+
+        // Collects the symbols of the portion into the blocks
+        class BlockBuilder {
+        public:
+            BlockBuilder(BitWriter &writer, const uchar *window, size_t start) : writer(writer), window(window), blockStart(start), blockEnd(start) {
+                symbols.reserve(MAX_BLOCK_SYMBOLS);
+            }
+
+            void addLiteral(uchar literal) {
+                symbols.push_back({ literal, 0 });
+                blockEnd++;
+                flushIfFull();
+            }
+
+            void addMatch(uint32 length, uint32 distance) {
+                symbols.push_back({ uint16(length), uint16(distance) });
+                blockEnd += length;
+                flushIfFull();
+            }
+
+            // The last portion ends with the final block (the empty one if all the symbols have been written already)
+            void finish(bool isLast) {
+                if (!symbols.empty()) {
+                    writeBlock(writer, symbols.data(), symbols.size(), window + blockStart, blockEnd - blockStart, isLast);
+                } else if (isLast) {
+                    writeEmptyFinalBlock(writer);
+                }
+            }
+
+        private:
+            BitWriter &writer;
+            const uchar *window;
+            vector<Symbol> symbols;
+            size_t blockStart;
+            size_t blockEnd;
+
+            void flushIfFull() {
+                if (symbols.size() == MAX_BLOCK_SYMBOLS) {
+                    writeBlock(writer, symbols.data(), symbols.size(), window + blockStart, blockEnd - blockStart, false);
+                    symbols.clear();
+                    blockStart = blockEnd;
+                }
+            }
+        };
+
+        // Takes the longest match at each position
+        void compressGreedy(MatchFinder &finder, BlockBuilder &builder, const uchar *window, size_t start, size_t end, const LevelParameters &parameters) {
+            for (size_t position = start; position < end;) {
+                finder.insert(position);
+                uint32 distance;
+                uint32 length = finder.find(position, 0, parameters.maxChain, parameters.niceLength, distance);
+                if (length == 0) {
+                    builder.addLiteral(window[position++]);
+                    continue;
+                }
+                builder.addMatch(length, distance);
+                if (length <= parameters.maxLazy) {
+                    for (size_t i = position + 1; i < position + length; i++) {
+                        finder.insert(i);
+                    }
+                }
+                position += length;
+            }
+        }
+
+        // Takes the match found at the position only if the next position has no longer one
+        void compressLazy(MatchFinder &finder, BlockBuilder &builder, const uchar *window, size_t start, size_t end, const LevelParameters &parameters) {
+            // The match at the previous position, which hasn't been taken yet
+            bool hasPrevious = false;
+            uint32 previousLength = 0;
+            uint32 previousDistance = 0;
+            for (size_t position = start; position < end;) {
+                finder.insert(position);
+                uint32 length = 0;
+                uint32 distance = 0;
+                if (previousLength < parameters.maxLazy) {
+                    uint32 maxChain = previousLength >= parameters.goodLength ? parameters.maxChain >> 2 : parameters.maxChain;
+                    length = finder.find(position, previousLength, maxChain, parameters.niceLength, distance);
+                }
+
+                if (previousLength >= MIN_MATCH && length == 0) {
+                    builder.addMatch(previousLength, previousDistance);
+                    size_t matchEnd = position - 1 + previousLength;
+                    for (size_t i = position + 1; i < matchEnd; i++) {
+                        finder.insert(i);
+                    }
+                    position = matchEnd;
+                    hasPrevious = false;
+                    previousLength = 0;
+                    continue;
+                }
+
+                if (hasPrevious) {
+                    builder.addLiteral(window[position - 1]);
+                }
+                hasPrevious = true;
+                previousLength = length;
+                previousDistance = distance;
+                position++;
+            }
+            if (hasPrevious) {
+                builder.addLiteral(window[end - 1]);
+            }
+        }
+    }
+
+    void compressPortion(const uchar *data, size_t size, size_t dictionarySize, int level, bool isLast, vector<uchar> &output) {
+        using namespace _deflate;
+        if (level < MIN_LEVEL || level > MAX_LEVEL) {
+            throw invalid_argument("The compression level must be from " + to_string(MIN_LEVEL) + " to " + to_string(MAX_LEVEL));
+        }
+        BitWriter writer(output);
+
+        if (level == 0) {
+            if (size > 0) {
+                writeStoredBlocks(writer, data, size, isLast);
+            } else if (isLast) {
+                writeEmptyFinalBlock(writer);
+            }
+        } else {
+            dictionarySize = min(dictionarySize, (size_t)WINDOW_SIZE);
+            const uchar *window = data - dictionarySize;
+            size_t windowSize = dictionarySize + size;
+
+            // The tables are reused by the portions compressed on the same thread
+            thread_local MatchFinder finder;
+            finder.reset(window, windowSize);
+            for (size_t position = 0; position < dictionarySize; position++) {
+                finder.insert(position);
+            }
+
+            BlockBuilder builder(writer, window, dictionarySize);
+            const LevelParameters &parameters = LEVELS[level];
+            if (level < MIN_LAZY_LEVEL) {
+                compressGreedy(finder, builder, window, dictionarySize, windowSize, parameters);
+            } else {
+                compressLazy(finder, builder, window, dictionarySize, windowSize, parameters);
+            }
+            builder.finish(isLast);
+        }
+
+        if (!isLast) {
+            writeStoredBlocks(writer, nullptr, 0, false);
+        }
+        writer.alignToByte();
+    }
+
+    BitReader::BitReader(InputReader &reader) : reader(reader), data(nullptr), size(0), inputSize(0), bits(0), bitsCount(0) {}
+
+    bool BitReader::nextPortion() {
+        while (reader.next(data, size)) {
+            inputSize += size;
+            if (size != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void BitReader::refill() {
+        if (size >= 8) {
+            // Loads 8 bytes at once and takes as many of them as fit, the rest is loaded again the next time
+            uint64 word = 0;
+            for (uchar i = 0; i < 8; i++) {
+                word |= (uint64)data[i] << (8 * i);
+            }
+            bits |= word << bitsCount;
+            size_t bytesCount = (63 - bitsCount) >> 3;
+            data += bytesCount;
+            size -= bytesCount;
+            bitsCount |= 56;
+            return;
+        }
+        while (bitsCount <= 56 && (size != 0 || nextPortion())) {
+            bits |= (uint64)*data++ << bitsCount;
+            size--;
+            bitsCount += 8;
+        }
+    }
+
+    void BitReader::consume(uchar count) {
+        if (count > bitsCount) {
+            throw invalid_argument("Unexpected end of the compressed data");
+        }
+        bits >>= count;
+        bitsCount -= count;
+    }
+
+    uint32 BitReader::readBits(uchar count) {
+        if (bitsCount < count) {
+            refill();
+        }
+        uint32 value = bits & ((1ull << count) - 1);
+        consume(count);
+        return value;
+    }
+
+    void BitReader::alignToByte() {
+        consume(bitsCount & 7);
+    }
+
+    void BitReader::readBytes(uchar *target, size_t size) {
+        for (; size > 0 && bitsCount >= 8; size--) {
+            *target++ = uchar(bits);
+            consume(8);
+        }
+        if (size == 0) {
+            return;
+        }
+        // The bit buffer is empty, the copies of the next bytes in it are dropped since the bytes are taken directly
+        bits = 0;
+        while (size > 0) {
+            if (this->size == 0 && !nextPortion()) {
+                throw invalid_argument("Unexpected end of the compressed data");
+            }
+            size_t portionSize = min(size, this->size);
+            memcpy(target, data, portionSize);
+            target += portionSize;
+            size -= portionSize;
+            data += portionSize;
+            this->size -= portionSize;
+        }
+    }
+
+    bool BitReader::isEnd() {
+        if (bitsCount == 0) {
+            refill();
+        }
+        return bitsCount == 0;
+    }
+
+    uint64 BitReader::getInputSize() const {
+        return inputSize;
+    }
+
+    namespace _deflate {
+        // The output is kept in the buffer until it's full, then it's passed to the sink except for the last window,
+        // which the next matches may refer to
+        const size_t OUTPUT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+        // Decodes the Huffman codes by the lookup of the next PRIMARY_BITS of the input.
+        // The longer codes share the entry of their first bits, which points to the subtable of the rest of the bits
+        class HuffmanTable {
+        public:
+            static const uchar PRIMARY_BITS = 10;
+            // The entry: the symbol (or the offset of the subtable) in the high 16 bits, the length of the code
+            // (or of the subtable's index) in the low 8 bits. The zero entry is the invalid code
+            static const uint32 SUBTABLE_FLAG = 0x100;
+
+            // Throws `invalid_argument` if the lengths describe more codes than fit (the incomplete codes are allowed,
+            // their missing codes are invalid)
+            void build(const uchar *lengths, size_t count) {
+                array<uint32, MAX_CODE_LENGTH + 1> lengthCounts {};
+                for (size_t i = 0; i < count; i++) {
+                    lengthCounts[lengths[i]]++;
+                }
+                lengthCounts[0] = 0;
+                int unusedCodes = 1;
+                uchar maxLength = 0;
+                for (uchar length = 1; length <= MAX_CODE_LENGTH; length++) {
+                    unusedCodes = (unusedCodes << 1) - lengthCounts[length];
+                    if (unusedCodes < 0) {
+                        throw invalid_argument("Invalid Huffman code lengths in the compressed data");
+                    }
+                    maxLength = lengthCounts[length] != 0 ? length : maxLength;
+                }
+                array<uint32, MAX_CODE_LENGTH + 1> nextCodes {};
+                uint32 code = 0;
+                for (uchar length = 1; length <= MAX_CODE_LENGTH; length++) {
+                    code = (code + lengthCounts[length - 1]) << 1;
+                    nextCodes[length] = code;
+                }
+
+                entries.assign(1 << PRIMARY_BITS, 0);
+                uchar subtableBits = maxLength > PRIMARY_BITS ? maxLength - PRIMARY_BITS : 0;
+                for (uint32 symbol = 0; symbol < count; symbol++) {
+                    uchar length = lengths[symbol];
+                    if (length == 0) {
+                        continue;
+                    }
+                    uint32 reversed = reverseBits(nextCodes[length]++, length);
+                    uint32 entry = symbol << 16 | length;
+                    if (length <= PRIMARY_BITS) {
+                        for (uint32 i = reversed; i < (1u << PRIMARY_BITS); i += 1 << length) {
+                            entries[i] = entry;
+                        }
+                        continue;
+                    }
+                    uint32 prefix = reversed & ((1 << PRIMARY_BITS) - 1);
+                    if (entries[prefix] == 0) {
+                        entries[prefix] = uint32(entries.size()) << 16 | SUBTABLE_FLAG | subtableBits;
+                        entries.resize(entries.size() + (1 << subtableBits), 0);
+                    }
+                    uint32 subtable = entries[prefix] >> 16;
+                    for (uint32 i = reversed >> PRIMARY_BITS; i < (1u << subtableBits); i += 1 << (length - PRIMARY_BITS)) {
+                        entries[subtable + i] = entry;
+                    }
+                }
+            }
+
+            // The `bits` are the next bits of the input (the missing ones are zeros)
+            uint32 lookup(uint64 bits) const {
+                uint32 entry = entries[bits & ((1 << PRIMARY_BITS) - 1)];
+                if (entry & SUBTABLE_FLAG) {
+                    entry = entries[(entry >> 16) + ((bits >> PRIMARY_BITS) & ((1 << (entry & 0xFF)) - 1))];
+                }
+                return entry;
+            }
+
+        private:
+            vector<uint32> entries;
+        };
+    }
+
+    // The state of the single `inflate` call: the output buffer and the tables of the current block
+    class Inflater {
+    public:
+        Inflater(BitReader &reader, const function<void (const uchar *data, size_t size)> &sink)
+            : reader(reader), sink(sink), buffer(_deflate::OUTPUT_BUFFER_SIZE), position(0), flushedPosition(0) {}
+
+        void run() {
+            using namespace _deflate;
+            bool isFinal = false;
+            while (!isFinal) {
+                isFinal = reader.readBits(1);
+                uchar type = reader.readBits(2);
+                if (type == BLOCK_STORED) {
+                    inflateStored();
+                } else if (type == BLOCK_FIXED) {
+                    static const pair<HuffmanTable, HuffmanTable> fixedTables = buildFixedTables();
+                    inflateCodes(fixedTables.first, fixedTables.second);
+                } else if (type == BLOCK_DYNAMIC) {
+                    readDynamicTables();
+                    inflateCodes(literals, distances);
+                } else {
+                    throw invalid_argument("Invalid block type in the compressed data");
+                }
+            }
+            sink(buffer.data() + flushedPosition, position - flushedPosition);
+        }
+
+    private:
+        BitReader &reader;
+        const function<void (const uchar *data, size_t size)> &sink;
+        vector<uchar> buffer;
+        size_t position;
+        // The output before it has been passed to the sink already (it's kept as the window)
+        size_t flushedPosition;
+        _deflate::HuffmanTable literals;
+        _deflate::HuffmanTable distances;
+
+        static pair<_deflate::HuffmanTable, _deflate::HuffmanTable> buildFixedTables() {
+            using namespace _deflate;
+            pair<HuffmanTable, HuffmanTable> tables;
+            uchar lengths[FIXED_LITERALS_COUNT];
+            getFixedLiteralLengths(lengths);
+            tables.first.build(lengths, FIXED_LITERALS_COUNT);
+            fill(lengths, lengths + FIXED_DISTANCES_COUNT, 5);
+            tables.second.build(lengths, FIXED_DISTANCES_COUNT);
+            return tables;
+        }
+
+        // Makes room for the `size` bytes of the output
+        void reserve(size_t size) {
+            if (position + size <= buffer.size()) {
+                return;
+            }
+            sink(buffer.data() + flushedPosition, position - flushedPosition);
+            size_t windowSize = min(position, (size_t)WINDOW_SIZE);
+            memmove(buffer.data(), buffer.data() + position - windowSize, windowSize);
+            position = windowSize;
+            flushedPosition = windowSize;
+        }
+
+        uint32 decode(const _deflate::HuffmanTable &table) {
+            uint32 entry = table.lookup(reader.bits);
+            uchar length = entry & 0xFF;
+            if (length == 0) {
+                throw invalid_argument("Invalid Huffman code in the compressed data");
+            }
+            reader.consume(length);
+            return entry >> 16;
+        }
+
+        // The bits have to be refilled already
+        uint32 takeBits(uchar count) {
+            uint32 value = reader.bits & ((1ull << count) - 1);
+            reader.consume(count);
+            return value;
+        }
+
+        void inflateStored() {
+            reader.alignToByte();
+            uint32 size = reader.readBits(16);
+            if ((reader.readBits(16) ^ 0xFFFF) != size) {
+                throw invalid_argument("Invalid stored block length in the compressed data");
+            }
+            while (size > 0) {
+                reserve(1);
+                size_t portionSize = min((size_t)size, buffer.size() - position);
+                reader.readBytes(buffer.data() + position, portionSize);
+                position += portionSize;
+                size -= portionSize;
+            }
+        }
+
+        void readDynamicTables() {
+            using namespace _deflate;
+            uint32 literalsCount = reader.readBits(5) + 257;
+            uint32 distancesCount = reader.readBits(5) + 1;
+            uint32 lengthLengthsCount = reader.readBits(4) + 4;
+            if (literalsCount > LITERALS_COUNT || distancesCount > DISTANCES_COUNT) {
+                throw invalid_argument("Invalid count of codes in the compressed data");
+            }
+            uchar lengthLengths[CODE_LENGTHS_COUNT] = {};
+            for (uint32 i = 0; i < lengthLengthsCount; i++) {
+                lengthLengths[CODE_LENGTH_ORDER[i]] = reader.readBits(3);
+            }
+            HuffmanTable lengthsTable;
+            lengthsTable.build(lengthLengths, CODE_LENGTHS_COUNT);
+
+            uchar lengths[LITERALS_COUNT + DISTANCES_COUNT];
+            for (uint32 i = 0; i < literalsCount + distancesCount;) {
+                reader.refill();
+                uint32 symbol = decode(lengthsTable);
+                if (symbol < 16) {
+                    lengths[i++] = symbol;
+                    continue;
+                }
+                if (symbol == 16 && i == 0) {
+                    throw invalid_argument("Invalid code lengths in the compressed data");
+                }
+                uchar length = symbol == 16 ? lengths[i - 1] : 0;
+                uint32 repeatsCount = symbol == 16 ? 3 + takeBits(2) : symbol == 17 ? 3 + takeBits(3) : 11 + takeBits(7);
+                if (i + repeatsCount > literalsCount + distancesCount) {
+                    throw invalid_argument("Invalid code lengths in the compressed data");
+                }
+                fill(lengths + i, lengths + i + repeatsCount, length);
+                i += repeatsCount;
+            }
+            if (lengths[END_OF_BLOCK] == 0) {
+                throw invalid_argument("Missing end of block code in the compressed data");
+            }
+            literals.build(lengths, literalsCount);
+            distances.build(lengths + literalsCount, distancesCount);
+        }
+
+        void inflateCodes(const _deflate::HuffmanTable &literalsTable, const _deflate::HuffmanTable &distancesTable) {
+            using namespace _deflate;
+            uchar *output = buffer.data();
+            while (true) {
+                // The longest symbol takes 48 bits: the length code with its extra bits and the distance code with its ones
+                reader.refill();
+                uint32 symbol = decode(literalsTable);
+                if (symbol < 256) {
+                    reserve(1);
+                    output[position++] = symbol;
+                    continue;
+                }
+                if (symbol == END_OF_BLOCK) {
+                    return;
+                }
+                symbol -= 257;
+                if (symbol >= 29) {
+                    throw invalid_argument("Invalid length code in the compressed data");
+                }
+                uint32 length = LENGTH_BASES[symbol] + takeBits(LENGTH_EXTRA_BITS[symbol]);
+                uint32 distanceCode = decode(distancesTable);
+                if (distanceCode >= DISTANCES_COUNT) {
+                    throw invalid_argument("Invalid distance code in the compressed data");
+                }
+                uint32 distance = DISTANCE_BASES[distanceCode] + takeBits(DISTANCE_EXTRA_BITS[distanceCode]);
+
+                reserve(length);
+                if (distance > position) {
+                    throw invalid_argument("Invalid distance too far back in the compressed data");
+                }
+                const uchar *source = output + position - distance;
+                uchar *target = output + position;
+                if (distance >= length) {
+                    memcpy(target, source, length);
+                } else {
+                    // The match overlaps its own output: the repeated pattern
+                    for (uint32 i = 0; i < length; i++) {
+                        target[i] = source[i];
+                    }
+                }
+                position += length;
+            }
+        }
+    };
+
+    void inflate(BitReader &reader, const function<void (const uchar *data, size_t size)> &sink) {
+        Inflater(reader, sink).run();
+    }
+
+}
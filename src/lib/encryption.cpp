@@ -0,0 +1,348 @@
+#include "../include/lib/encryption.hpp"
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+
+#include <sys/random.h>
+
+#include "../include/lib/blake3.hpp"
+#include "../include/utils/hexadecimal.hpp"
+#include "../include/utils/threadPool.hpp"
+#include "../include/utils/stats.hpp"
+
+namespace _encryption {
+    const uchar MAGIC[4] = { 'Z', 'P', 'Y', 'E' };
+    const uchar VERSION = 1;
+    const uchar SALT_SIZE = 24;
+    const uchar SALT_OFFSET = ENCRYPTION_HEADER_SIZE - SALT_SIZE;
+
+    // The BLAKE3 context of the key derivation: hardcoded and globally unique
+    const char KEY_DERIVATION_CONTEXT[] = "zippy 2026-10-18 segmented file encryption key";
+
+    // The segments are passed to the threads in the groups of about this size
+    const size_t JOB_SIZE = 1024 * 1024;
+
+    void writeOutput(ostream &output, const uchar *data, size_t size) {
+        StageTimer timer(Stage::Format);
+        output.write((const char *)data, size);
+        if (!output) {
+            throw invalid_argument("Can't write the output");
+        }
+    }
+
+    void generateRandomBytes(uchar *output, size_t size) {
+        while (size > 0) {
+            ssize_t count = getrandom(output, size, 0);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw invalid_argument("Can't generate the random salt");
+            }
+            output += count;
+            size -= count;
+        }
+    }
+
+    uchar getSizeLog(uint32 size) {
+        uchar sizeLog = 0;
+        while ((uint32(1) << sizeLog) < size) {
+            sizeLog++;
+        }
+        return sizeLog;
+    }
+
+    unique_ptr<aead::Cipher> createFileCipher(const uchar *header, const aead::Key &key) {
+        aead::Key fileKey;
+        blake3::Blake3Hasher hasher(KEY_DERIVATION_CONTEXT);
+        hasher.update(key.data(), key.size());
+        hasher.update(header + SALT_OFFSET, SALT_SIZE);
+        hasher.final(fileKey.data(), fileKey.size());
+        unique_ptr<aead::Cipher> cipher = aead::createCipher(aead::Algorithm(header[5]), fileKey);
+        fill(fileKey.begin(), fileKey.end(), 0);
+        return cipher;
+    }
+
+    // The header must have been read completely
+    void checkHeader(const uchar *header, size_t size) {
+        if (size < ENCRYPTION_HEADER_SIZE || !equal(MAGIC, MAGIC + 4, header)) {
+            throw invalid_argument("Not an encrypted file");
+        }
+        if (header[4] != VERSION) {
+            throw invalid_argument("Unknown version of the encrypted file: " + to_string(header[4]));
+        }
+        aead::Algorithm algorithm = aead::Algorithm(header[5]);
+        if (aead::algorithmName(algorithm) == "unknown") {
+            throw invalid_argument("Unknown encryption algorithm: " + to_string(header[5]));
+        }
+        uchar sizeLog = header[6];
+        if (sizeLog < getSizeLog(MIN_SEGMENT_SIZE) || sizeLog > getSizeLog(MAX_SEGMENT_SIZE) || header[7] != 0) {
+            throw invalid_argument("Invalid header of the encrypted file");
+        }
+    }
+
+    void makeNonce(uint64 segment, bool isLast, uchar *nonce) {
+        memset(nonce, 0, aead::NONCE_SIZE);
+        for (uchar i = 0; i < 8; i++) {
+            nonce[10 - i] = uchar(segment >> (8 * i));
+        }
+        nonce[11] = isLast ? 1 : 0;
+    }
+
+    // The group of consecutive segments. The segments are stored `stride` bytes apart (their size and the tag),
+    // so they are encrypted and decrypted in place and the ciphertext is written at once
+    struct SegmentsJob {
+        vector<uchar> data;
+        // The bytes of the input in the `data`
+        size_t size = 0;
+        uint64 firstSegment = 0;
+        size_t segmentsCount = 0;
+        // The size of the last segment without the tag
+        size_t lastSegmentSize = 0;
+        bool isLast = false;
+
+        // Decryption only: the count of the authenticated segments, less than the `segmentsCount` if any of them isn't
+        size_t authenticatedCount = 0;
+
+        mutex lock;
+        condition_variable isCompleted;
+        // Guarded by the `lock`
+        bool isDone = false;
+
+        size_t getOutputSize(size_t stride, bool isEncrypting) const {
+            size_t lastSize = lastSegmentSize + (isEncrypting ? aead::TAG_SIZE : 0);
+            return segmentsCount == 0 ? 0 : (segmentsCount - 1) * stride + lastSize;
+        }
+
+        void run(const aead::Cipher &cipher, const uchar *header, size_t segmentSize, bool isEncrypting) {
+            {
+                StageTimer timer(Stage::Encrypt);
+                size_t stride = segmentSize + aead::TAG_SIZE;
+                uchar nonce[aead::NONCE_SIZE];
+                for (size_t i = 0; i < segmentsCount; i++) {
+                    bool isLastSegment = isLast && i + 1 == segmentsCount;
+                    size_t size = i + 1 == segmentsCount ? lastSegmentSize : segmentSize;
+                    uchar *segment = data.data() + i * stride;
+                    makeNonce(firstSegment + i, isLastSegment, nonce);
+                    if (isEncrypting) {
+                        cipher.seal(nonce, header, ENCRYPTION_HEADER_SIZE, segment, size, segment, segment + size);
+                    } else if (cipher.open(nonce, header, ENCRYPTION_HEADER_SIZE, segment, size, segment, segment + size)) {
+                        authenticatedCount++;
+                    } else {
+                        break;
+                    }
+                }
+            }
+            {
+                lock_guard<mutex> guard(lock);
+                isDone = true;
+            }
+            isCompleted.notify_one();
+        }
+
+        void wait() {
+            unique_lock<mutex> guard(lock);
+            isCompleted.wait(guard, [this] { return isDone; });
+        }
+
+        bool checkDone() {
+            lock_guard<mutex> guard(lock);
+            return isDone;
+        }
+    };
+
+    // Reads the next group of segments of the plaintext: each of them is read into its place before its tag
+    unique_ptr<SegmentsJob> readPlaintextJob(InputReader &reader, uint64 firstSegment, size_t segmentSize, size_t segmentsPerJob) {
+        unique_ptr<SegmentsJob> job(new SegmentsJob());
+        job->firstSegment = firstSegment;
+        size_t stride = segmentSize + aead::TAG_SIZE;
+        job->data.resize(segmentsPerJob * stride);
+        while (job->segmentsCount < segmentsPerJob) {
+            size_t size = reader.read(job->data.data() + job->segmentsCount * stride, segmentSize);
+            if (size == 0) {
+                break;
+            }
+            job->size += size;
+            job->lastSegmentSize = size;
+            job->segmentsCount++;
+            if (size < segmentSize) {
+                break;
+            }
+        }
+        return job;
+    }
+
+    // Reads the next group of segments of the ciphertext as they are, the incomplete segment is the last one
+    unique_ptr<SegmentsJob> readCiphertextJob(InputReader &reader, uint64 firstSegment, size_t segmentSize, size_t segmentsPerJob) {
+        unique_ptr<SegmentsJob> job(new SegmentsJob());
+        job->firstSegment = firstSegment;
+        size_t stride = segmentSize + aead::TAG_SIZE;
+        job->data.resize(segmentsPerJob * stride);
+        job->size = reader.read(job->data.data(), job->data.size());
+        job->segmentsCount = (job->size + stride - 1) / stride;
+        size_t lastSize = job->size - (job->segmentsCount == 0 ? 0 : (job->segmentsCount - 1) * stride);
+        if (job->segmentsCount != 0 && lastSize < aead::TAG_SIZE) {
+            throw invalid_argument("The encrypted file is truncated");
+        }
+        job->lastSegmentSize = job->segmentsCount == 0 ? 0 : lastSize - aead::TAG_SIZE;
+        return job;
+    }
+
+    // Runs the jobs on the pool and writes their output in order, the next job is read ahead to tell the last segment
+    template <typename ReadJob>
+    void processJobs(
+        ReadJob readJob, const aead::Cipher &cipher, const uchar *header, size_t segmentSize, bool isEncrypting,
+        uint32 threadsCount, ostream &output, EncryptionResult &result
+    ) {
+        size_t stride = segmentSize + aead::TAG_SIZE;
+        size_t capacity = (isEncrypting ? segmentSize : stride);
+
+        // The jobs outlive the pool, which waits for their tasks
+        deque<unique_ptr<SegmentsJob>> jobs;
+        {
+            ThreadPool pool(threadsCount);
+            // The reading stays this many jobs ahead of the writing, so the memory doesn't grow when the encryption is slower
+            size_t maxJobsCount = pool.getThreadsCount() * 2;
+
+            auto writeFirstJob = [&]() {
+                SegmentsJob &job = *jobs.front();
+                job.wait();
+                if (isEncrypting) {
+                    size_t size = job.getOutputSize(stride, true);
+                    writeOutput(output, job.data.data(), size);
+                    result.ciphertextSize += size;
+                    result.plaintextSize += job.size;
+                } else {
+                    for (size_t i = 0; i < job.authenticatedCount; i++) {
+                        size_t size = i + 1 == job.segmentsCount ? job.lastSegmentSize : segmentSize;
+                        writeOutput(output, job.data.data() + i * stride, size);
+                        result.plaintextSize += size;
+                    }
+                    if (job.authenticatedCount != job.segmentsCount) {
+                        throw invalid_argument("The segment " + to_string(job.firstSegment + job.authenticatedCount)
+                            + " can't be authenticated: the key is wrong or the file is corrupted");
+                    }
+                    result.ciphertextSize += job.size;
+                }
+                jobs.pop_front();
+            };
+
+            // The job is the last one if the input ends within it or right after it.
+            // The empty plaintext is encrypted into a single empty segment
+            unique_ptr<SegmentsJob> job = readJob(0);
+            if (job->segmentsCount == 0) {
+                if (!isEncrypting) {
+                    throw invalid_argument("The encrypted file is truncated");
+                }
+                job->segmentsCount = 1;
+            }
+            while (job) {
+                unique_ptr<SegmentsJob> nextJob;
+                if (job->size == job->data.size() / stride * capacity) {
+                    nextJob = readJob(job->firstSegment + job->segmentsCount);
+                    if (nextJob->segmentsCount == 0) {
+                        nextJob.reset();
+                    }
+                }
+                job->isLast = !nextJob;
+
+                SegmentsJob *submittedJob = job.get();
+                const aead::Cipher *submittedCipher = &cipher;
+                pool.submit([submittedJob, submittedCipher, header, segmentSize, isEncrypting] {
+                    submittedJob->run(*submittedCipher, header, segmentSize, isEncrypting);
+                });
+                jobs.push_back(move(job));
+
+                while (jobs.size() >= maxJobsCount || (!jobs.empty() && jobs.front()->checkDone())) {
+                    writeFirstJob();
+                }
+                job = move(nextJob);
+            }
+            while (!jobs.empty()) {
+                writeFirstJob();
+            }
+        }
+    }
+}
+
+EncryptionResult encryptFile(const string &filePath, ostream &output, const aead::Key &key, const EncryptionOptions &options) {
+    using namespace _encryption;
+    uint32 segmentSize = options.segmentSize;
+    if (segmentSize < MIN_SEGMENT_SIZE || segmentSize > MAX_SEGMENT_SIZE || (segmentSize & (segmentSize - 1)) != 0) {
+        throw invalid_argument("The segment size must be a power of two from " + to_string(MIN_SEGMENT_SIZE)
+            + " to " + to_string(MAX_SEGMENT_SIZE) + " bytes");
+    }
+    if (aead::algorithmName(options.algorithm) == "unknown") {
+        throw invalid_argument("Unknown encryption algorithm");
+    }
+
+    InputReader reader(filePath, options.inputOptions);
+    EncryptionResult result;
+    result.algorithm = options.algorithm;
+    result.segmentSize = segmentSize;
+
+    uchar header[ENCRYPTION_HEADER_SIZE] = { MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3], VERSION, uchar(options.algorithm), getSizeLog(segmentSize), 0 };
+    generateRandomBytes(header + SALT_OFFSET, SALT_SIZE);
+    unique_ptr<aead::Cipher> cipher = createFileCipher(header, key);
+    writeOutput(output, header, ENCRYPTION_HEADER_SIZE);
+
+    size_t segmentsPerJob = max(JOB_SIZE / segmentSize, size_t(1));
+    auto readJob = [&](uint64 firstSegment) {
+        return readPlaintextJob(reader, firstSegment, segmentSize, segmentsPerJob);
+    };
+    processJobs(readJob, *cipher, header, segmentSize, true, options.threadsCount, output, result);
+    output.flush();
+    result.ciphertextSize += ENCRYPTION_HEADER_SIZE;
+    return result;
+}
+
+EncryptionResult decryptFile(const string &filePath, ostream &output, const aead::Key &key, const DecryptionOptions &options) {
+    using namespace _encryption;
+    InputReader reader(filePath, options.inputOptions);
+    uchar header[ENCRYPTION_HEADER_SIZE];
+    checkHeader(header, reader.read(header, ENCRYPTION_HEADER_SIZE));
+
+    EncryptionResult result;
+    result.algorithm = aead::Algorithm(header[5]);
+    result.segmentSize = uint32(1) << header[6];
+    unique_ptr<aead::Cipher> cipher = createFileCipher(header, key);
+
+    size_t segmentsPerJob = max(JOB_SIZE / result.segmentSize, size_t(1));
+    auto readJob = [&](uint64 firstSegment) {
+        return readCiphertextJob(reader, firstSegment, result.segmentSize, segmentsPerJob);
+    };
+    processJobs(readJob, *cipher, header, result.segmentSize, false, options.threadsCount, output, result);
+    output.flush();
+    result.ciphertextSize += ENCRYPTION_HEADER_SIZE;
+    return result;
+}
+
+aead::Key readKeyFile(const string &filePath) {
+    ifstream file(filePath, ios::in | ios::binary);
+    if (!file) {
+        throw invalid_argument("Can't open the key file: " + filePath);
+    }
+    string content((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    aead::Key key;
+    if (content.size() == key.size()) {
+        copy(content.begin(), content.end(), key.begin());
+        return key;
+    }
+    while (!content.empty() && (content.back() == '\n' || content.back() == '\r')) {
+        content.pop_back();
+    }
+    if (content.size() != key.size() * 2 || !decodeHex(content.data(), key.size(), key.data())) {
+        throw invalid_argument("The key file must hold 32 bytes or 64 hexadecimal digits: " + filePath);
+    }
+    return key;
+}
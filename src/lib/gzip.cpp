@@ -0,0 +1,290 @@
+#include "../include/lib/gzip.hpp"
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../include/lib/crc32.hpp"
+#include "../include/utils/threadPool.hpp"
+#include "../include/utils/stats.hpp"
+
+namespace _gzip {
+    const uchar MAGIC[2] = { 0x1F, 0x8B };
+    const uchar METHOD_DEFLATE = 8;
+
+    const uchar FLAG_HEADER_CRC = 0x02;
+    const uchar FLAG_EXTRA = 0x04;
+    const uchar FLAG_NAME = 0x08;
+    const uchar FLAG_COMMENT = 0x10;
+    const uchar RESERVED_FLAGS = 0xE0;
+
+    // The extra flags tell the slowest and the fastest compression
+    const uchar EXTRA_FLAGS_BEST = 2;
+    const uchar EXTRA_FLAGS_FASTEST = 4;
+    const uchar OS_UNIX = 3;
+
+    const size_t HEADER_SIZE = 10;
+    const size_t TRAILER_SIZE = 8;
+
+    inline void packUint32(uint32 value, uchar *target) {
+        // Little endian
+        for (uchar i = 0; i < 4; i++) {
+            target[i] = uchar(value >> (8 * i));
+        }
+    }
+
+    inline uint32 unpackUint32(const uchar *source) {
+        return source[0] | source[1] << 8 | source[2] << 16 | (uint32)source[3] << 24;
+    }
+
+    void writeOutput(ostream &output, const uchar *data, size_t size) {
+        StageTimer timer(Stage::Format);
+        output.write((const char *)data, size);
+        if (!output) {
+            throw invalid_argument("Can't write the output");
+        }
+    }
+
+    // The modification time and the name aren't stored, so the same input is always compressed into the same output
+    void writeHeader(ostream &output, int level) {
+        uchar header[HEADER_SIZE] = { MAGIC[0], MAGIC[1], METHOD_DEFLATE, 0, 0, 0, 0, 0, 0, OS_UNIX };
+        header[8] = level == deflate::MAX_LEVEL ? EXTRA_FLAGS_BEST : level == 1 ? EXTRA_FLAGS_FASTEST : 0;
+        writeOutput(output, header, HEADER_SIZE);
+    }
+
+    void skipZeroTerminated(deflate::BitReader &reader) {
+        uchar character;
+        do {
+            reader.readBytes(&character, 1);
+        } while (character != 0);
+    }
+
+    // The optional fields (the extra field, the name, the comment and the header's CRC) are skipped
+    void readHeader(deflate::BitReader &reader, bool isFirstMember) {
+        uchar header[HEADER_SIZE];
+        reader.readBytes(header, HEADER_SIZE);
+        if (header[0] != MAGIC[0] || header[1] != MAGIC[1]) {
+            throw invalid_argument(isFirstMember ? "Not in the gzip format" : "Trailing garbage after the compressed data");
+        }
+        if (header[2] != METHOD_DEFLATE) {
+            throw invalid_argument("Unknown compression method: " + to_string(header[2]));
+        }
+        uchar flags = header[3];
+        if (flags & RESERVED_FLAGS) {
+            throw invalid_argument("Unknown gzip flags: " + to_string(flags));
+        }
+        if (flags & FLAG_EXTRA) {
+            uchar sizeBytes[2];
+            reader.readBytes(sizeBytes, 2);
+            vector<uchar> extra(sizeBytes[0] | sizeBytes[1] << 8);
+            reader.readBytes(extra.data(), extra.size());
+        }
+        if (flags & FLAG_NAME) {
+            skipZeroTerminated(reader);
+        }
+        if (flags & FLAG_COMMENT) {
+            skipZeroTerminated(reader);
+        }
+        if (flags & FLAG_HEADER_CRC) {
+            uchar headerCrc[2];
+            reader.readBytes(headerCrc, 2);
+        }
+    }
+
+    struct CompressionJob {
+        // The dictionary (the end of the previous block) followed by the block, released once the block is compressed
+        vector<uchar> data;
+        size_t dictionarySize = 0;
+        size_t size = 0;
+        bool isLast = false;
+
+        vector<uchar> output;
+        uint32 crc = 0;
+
+        mutex lock;
+        condition_variable isCompleted;
+        // Guarded by the `lock`
+        bool isDone = false;
+
+        const uchar *getBlock() const {
+            return data.data() + dictionarySize;
+        }
+
+        void run(int level) {
+            {
+                StageTimer timer(Stage::Compress);
+                output.reserve(size / 2 + 64);
+                deflate::compressPortion(getBlock(), size, dictionarySize, level, isLast, output);
+            }
+            {
+                StageTimer timer(Stage::Hash);
+                crc = crc32::update(0, getBlock(), size);
+            }
+            vector<uchar>().swap(data);
+            {
+                lock_guard<mutex> guard(lock);
+                isDone = true;
+            }
+            isCompleted.notify_one();
+        }
+
+        bool checkDone() {
+            lock_guard<mutex> guard(lock);
+            return isDone;
+        }
+
+        void wait() {
+            unique_lock<mutex> guard(lock);
+            isCompleted.wait(guard, [this] { return isDone; });
+        }
+    };
+
+    // Reads the next block with the end of the previous one as the dictionary
+    unique_ptr<CompressionJob> readJob(InputReader &reader, const CompressionJob *previous, uint32 blockSize) {
+        unique_ptr<CompressionJob> job(new CompressionJob());
+        if (previous != nullptr) {
+            job->dictionarySize = min(previous->size, (size_t)deflate::WINDOW_SIZE);
+        }
+        job->data.resize(job->dictionarySize + blockSize);
+        if (previous != nullptr) {
+            const uchar *dictionary = previous->getBlock() + previous->size - job->dictionarySize;
+            copy(dictionary, dictionary + job->dictionarySize, job->data.begin());
+        }
+        job->size = reader.read(job->data.data() + job->dictionarySize, blockSize);
+        job->data.resize(job->dictionarySize + job->size);
+        return job;
+    }
+}
+
+CompressionResult compressFile(const string &filePath, ostream &output, const CompressionOptions &options) {
+    using namespace _gzip;
+    if (options.level < deflate::MIN_LEVEL || options.level > deflate::MAX_LEVEL) {
+        throw invalid_argument("The compression level must be from " + to_string(deflate::MIN_LEVEL) + " to " + to_string(deflate::MAX_LEVEL));
+    }
+    if (options.blockSize < MIN_COMPRESSION_BLOCK_SIZE) {
+        throw invalid_argument("The block size must be at least " + to_string(MIN_COMPRESSION_BLOCK_SIZE) + " bytes");
+    }
+
+    InputReader reader(filePath, options.inputOptions);
+    CompressionResult result;
+    sha2::Sha256Hasher hasher;
+    uint32 crc = 0;
+
+    writeHeader(output, options.level);
+    result.compressedSize = HEADER_SIZE;
+
+    // The jobs outlive the pool, which waits for their tasks
+    deque<unique_ptr<CompressionJob>> jobs;
+    {
+        ThreadPool pool(options.threadsCount);
+        // The reading stays this many blocks ahead of the writing, so the memory doesn't grow when the compression is slower
+        size_t maxJobsCount = pool.getThreadsCount() * 2;
+
+        auto writeFirstJob = [&]() {
+            CompressionJob &job = *jobs.front();
+            job.wait();
+            writeOutput(output, job.output.data(), job.output.size());
+            result.compressedSize += job.output.size();
+            crc = crc32::combine(crc, job.crc, job.size);
+            jobs.pop_front();
+        };
+
+        // The next block is read before the current one is submitted: the last block ends the stream with the final DEFLATE block
+        unique_ptr<CompressionJob> job = readJob(reader, nullptr, options.blockSize);
+        while (job) {
+            unique_ptr<CompressionJob> nextJob;
+            if (job->size == options.blockSize) {
+                nextJob = readJob(reader, job.get(), options.blockSize);
+                if (nextJob->size == 0) {
+                    nextJob.reset();
+                }
+            }
+            job->isLast = !nextJob;
+
+            if (options.computeSha256) {
+                StageTimer timer(Stage::Hash);
+                hasher.update(job->getBlock(), job->size);
+            }
+            result.uncompressedSize += job->size;
+
+            CompressionJob *submittedJob = job.get();
+            int level = options.level;
+            pool.submit([submittedJob, level] { submittedJob->run(level); });
+            jobs.push_back(move(job));
+
+            while (jobs.size() >= maxJobsCount || (!jobs.empty() && jobs.front()->checkDone())) {
+                writeFirstJob();
+            }
+            job = move(nextJob);
+        }
+        while (!jobs.empty()) {
+            writeFirstJob();
+        }
+    }
+
+    uchar trailer[TRAILER_SIZE];
+    packUint32(crc, trailer);
+    packUint32(uint32(result.uncompressedSize), trailer + 4);
+    writeOutput(output, trailer, TRAILER_SIZE);
+    output.flush();
+    result.compressedSize += TRAILER_SIZE;
+
+    if (options.computeSha256) {
+        result.sha256 = hasher.final();
+    }
+    return result;
+}
+
+CompressionResult decompressFile(const string &filePath, ostream &output, const DecompressionOptions &options) {
+    using namespace _gzip;
+    InputReader reader(filePath, options.inputOptions);
+    deflate::BitReader bitReader(reader);
+    // The time of decoding is the rest after the reading, the checksums and the writing
+    FileStatsScope statsScope(Stage::Compress);
+    CompressionResult result;
+    sha2::Sha256Hasher hasher;
+
+    if (bitReader.isEnd()) {
+        throw invalid_argument("Not in the gzip format: the input is empty");
+    }
+    for (bool isFirstMember = true; isFirstMember || !bitReader.isEnd(); isFirstMember = false) {
+        readHeader(bitReader, isFirstMember);
+
+        uint32 crc = 0;
+        uint64 size = 0;
+        deflate::inflate(bitReader, [&](const uchar *data, size_t portionSize) {
+            {
+                StageTimer timer(Stage::Hash);
+                crc = crc32::update(crc, data, portionSize);
+                if (options.computeSha256) {
+                    hasher.update(data, portionSize);
+                }
+            }
+            writeOutput(output, data, portionSize);
+            size += portionSize;
+        });
+
+        bitReader.alignToByte();
+        uchar trailer[TRAILER_SIZE];
+        bitReader.readBytes(trailer, TRAILER_SIZE);
+        if (unpackUint32(trailer) != crc) {
+            throw invalid_argument("The CRC-32 of the decompressed data doesn't match: the data is corrupted");
+        }
+        if (unpackUint32(trailer + 4) != uint32(size)) {
+            throw invalid_argument("The size of the decompressed data doesn't match: the data is corrupted");
+        }
+        result.uncompressedSize += size;
+    }
+    output.flush();
+    result.compressedSize = bitReader.getInputSize();
+    statsScope.finish();
+
+    if (options.computeSha256) {
+        result.sha256 = hasher.final();
+    }
+    return result;
+}
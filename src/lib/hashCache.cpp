@@ -0,0 +1,357 @@
+#include "../include/lib/hashCache.hpp"
+
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <tuple>
+#include <algorithm>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct HashCache::Entry {
+    uint64 device;
+    uint64 inode;
+    uint64 size;
+    uint64 modificationTimeNs;
+    // In seconds since the epoch, the oldest entries are dropped first
+    uint64 storedTime;
+    uint32 algorithmId;
+    uchar digestSize;
+    uchar reserved[3];
+    uchar digest[HashDigest::MAX_SIZE];
+};
+
+namespace {
+
+    typedef HashCache::Entry Entry;
+
+    static_assert(sizeof(Entry) == 112, "The entries are stored as is");
+
+    const size_t HEADER_SIZE = sizeof(HASH_CACHE_MAGIC) + sizeof(uint32) + sizeof(uint64);
+
+    // The algorithms are identified by the FNV-1a hash of their names, so the identifiers don't depend on the order of the registry
+    uint32 getAlgorithmId(const HashAlgorithm *algorithm) {
+        uint32 hash = 0x811C9DC5;
+        for (char character : algorithm->name) {
+            hash = (hash ^ uchar(character)) * 0x01000193;
+        }
+        return hash;
+    }
+
+    inline bool isKeyLess(const Entry &first, const Entry &second) {
+        return tie(first.device, first.inode, first.algorithmId) < tie(second.device, second.inode, second.algorithmId);
+    }
+
+    inline bool isSameKey(const Entry &first, const Entry &second) {
+        return first.device == second.device && first.inode == second.inode && first.algorithmId == second.algorithmId;
+    }
+
+    inline bool isSameContent(const Entry &entry, const FileIdentity &identity) {
+        return entry.size == identity.size && entry.modificationTimeNs == identity.modificationTimeNs && entry.digestSize != 0;
+    }
+
+    uint64 getCurrentTimeNs() {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // Returns nullptr if the file doesn't exist or is empty
+    const uchar *mapCacheFile(const string &filePath, uint64 &size) {
+        size = 0;
+#ifdef _WIN32
+        return nullptr;
+#else
+        int fd = open(filePath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (errno == ENOENT) {
+                return nullptr;
+            }
+            throw invalid_argument("Can't open the hash cache: " + filePath);
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+            close(fd);
+            throw invalid_argument("Not a valid hash cache: " + filePath);
+        }
+        if (fileStat.st_size == 0) {
+            close(fd);
+            return nullptr;
+        }
+
+        void *address = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED) {
+            throw invalid_argument("Can't map the hash cache: " + filePath);
+        }
+        size = fileStat.st_size;
+        return (const uchar *)address;
+#endif
+    }
+
+    void unmapCacheFile(const uchar *mapping, uint64 size) {
+#ifndef _WIN32
+        if (mapping != nullptr) {
+            munmap((void *)mapping, size);
+        }
+#endif
+    }
+
+    // Checks the header and points the `entries` right into the mapping
+    void parseCacheFile(const string &filePath, const uchar *mapping, uint64 size, const Entry *&entries, uint64 &entriesCount) {
+        entries = nullptr;
+        entriesCount = 0;
+        if (mapping == nullptr) {
+            return;
+        }
+
+        uint32 version;
+        if (size >= HEADER_SIZE) {
+            memcpy(&version, mapping + sizeof(HASH_CACHE_MAGIC), sizeof(version));
+            memcpy(&entriesCount, mapping + sizeof(HASH_CACHE_MAGIC) + sizeof(version), sizeof(entriesCount));
+        }
+        if (size < HEADER_SIZE || memcmp(mapping, HASH_CACHE_MAGIC, sizeof(HASH_CACHE_MAGIC)) != 0
+            || version != HASH_CACHE_VERSION || entriesCount != (size - HEADER_SIZE) / sizeof(Entry)
+            || (size - HEADER_SIZE) % sizeof(Entry) != 0) {
+            throw invalid_argument("Not a valid hash cache: " + filePath);
+        }
+        entries = (const Entry *)(mapping + HEADER_SIZE);
+    }
+
+    // The new entries replace the old ones with the same keys. Both ranges are sorted by the keys
+    vector<Entry> mergeEntries(const Entry *oldEntries, uint64 oldEntriesCount, const vector<Entry> &newEntries) {
+        vector<Entry> merged;
+        merged.reserve(oldEntriesCount + newEntries.size());
+        uint64 i = 0;
+        for (const Entry &entry : newEntries) {
+            for (; i < oldEntriesCount && isKeyLess(oldEntries[i], entry); i++) {
+                merged.push_back(oldEntries[i]);
+            }
+            if (i < oldEntriesCount && isSameKey(oldEntries[i], entry)) {
+                i++;
+            }
+            merged.push_back(entry);
+        }
+        merged.insert(merged.end(), oldEntries + i, oldEntries + oldEntriesCount);
+
+        if (merged.size() > HASH_CACHE_MAX_ENTRIES_COUNT) {
+            nth_element(merged.begin(), merged.begin() + HASH_CACHE_MAX_ENTRIES_COUNT, merged.end(), [](const Entry &first, const Entry &second) {
+                return first.storedTime > second.storedTime;
+            });
+            merged.resize(HASH_CACHE_MAX_ENTRIES_COUNT);
+            sort(merged.begin(), merged.end(), isKeyLess);
+        }
+        return merged;
+    }
+
+#ifndef _WIN32
+    void writeAll(int fd, const void *data, size_t size) {
+        const uchar *bytes = (const uchar *)data;
+        while (size > 0) {
+            ssize_t written = write(fd, bytes, size);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                throw invalid_argument("Can't write the hash cache");
+            }
+            bytes += written;
+            size -= written;
+        }
+    }
+
+    // Writes the complete file aside and renames it over the cache, so the readers never see the partial one
+    void replaceCacheFile(const string &filePath, const vector<Entry> &entries) {
+        string temporaryPath = filePath + ".tmp";
+        int fd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw invalid_argument("Can't write the hash cache: " + temporaryPath);
+        }
+
+        try {
+            uchar header[HEADER_SIZE];
+            uint64 entriesCount = entries.size();
+            memcpy(header, HASH_CACHE_MAGIC, sizeof(HASH_CACHE_MAGIC));
+            memcpy(header + sizeof(HASH_CACHE_MAGIC), &HASH_CACHE_VERSION, sizeof(HASH_CACHE_VERSION));
+            memcpy(header + sizeof(HASH_CACHE_MAGIC) + sizeof(HASH_CACHE_VERSION), &entriesCount, sizeof(entriesCount));
+            writeAll(fd, header, sizeof(header));
+            writeAll(fd, entries.data(), entries.size() * sizeof(Entry));
+            // The content has to reach the disk before the rename does, otherwise the crash may leave the empty cache
+            if (fsync(fd) != 0) {
+                throw invalid_argument("Can't write the hash cache: " + temporaryPath);
+            }
+        } catch (...) {
+            close(fd);
+            unlink(temporaryPath.c_str());
+            throw;
+        }
+        close(fd);
+
+        if (rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+            unlink(temporaryPath.c_str());
+            throw invalid_argument("Can't replace the hash cache: " + filePath);
+        }
+    }
+#endif
+
+}
+
+bool getFileIdentity(const string &filePath, FileIdentity &identity) {
+#ifdef _WIN32
+    return false;
+#else
+    struct stat fileStat;
+    if (filePath == "-" || stat(filePath.c_str(), &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+        return false;
+    }
+#ifdef __APPLE__
+    const struct timespec &modificationTime = fileStat.st_mtimespec;
+#else
+    const struct timespec &modificationTime = fileStat.st_mtim;
+#endif
+    identity.device = fileStat.st_dev;
+    identity.inode = fileStat.st_ino;
+    identity.size = fileStat.st_size;
+    identity.modificationTimeNs = uint64(modificationTime.tv_sec) * 1000000000 + modificationTime.tv_nsec;
+    return true;
+#endif
+}
+
+HashCache::HashCache(const string &filePath, bool verify)
+    : filePath(filePath), verify(verify), mapping(nullptr), mappingSize(0), entries(nullptr), entriesCount(0) {
+    mapping = mapCacheFile(filePath, mappingSize);
+    try {
+        parseCacheFile(filePath, mapping, mappingSize, entries, entriesCount);
+    } catch (...) {
+        unmapCacheFile(mapping, mappingSize);
+        throw;
+    }
+}
+
+HashCache::~HashCache() {
+    unmapCacheFile(mapping, mappingSize);
+}
+
+const HashCache::Entry *HashCache::findEntry(const FileIdentity &identity, uint32 algorithmId) const {
+    Entry key {};
+    key.device = identity.device;
+    key.inode = identity.inode;
+    key.algorithmId = algorithmId;
+    const Entry *entry = lower_bound(entries, entries + entriesCount, key, isKeyLess);
+    return entry != entries + entriesCount && isSameKey(*entry, key) ? entry : nullptr;
+}
+
+bool HashCache::find(const FileIdentity &identity, const vector<const HashAlgorithm *> &algorithms, HashDigest *digests) const {
+    if (verify) {
+        return false;
+    }
+    for (size_t i = 0; i < algorithms.size(); i++) {
+        const Entry *entry = findEntry(identity, getAlgorithmId(algorithms[i]));
+        if (entry == nullptr || !isSameContent(*entry, identity)) {
+            return false;
+        }
+        digests[i] = HashDigest(entry->digest, entry->digestSize);
+    }
+    return true;
+}
+
+void HashCache::store(const string &filePath, const FileIdentity &identity, const vector<const HashAlgorithm *> &algorithms, const HashDigest *digests) {
+    // The file may have been modified while it was hashed
+    FileIdentity currentIdentity;
+    if (!getFileIdentity(filePath, currentIdentity) || !(currentIdentity == identity)) {
+        return;
+    }
+
+    string mismatchedAlgorithms;
+    vector<Entry> newEntries(algorithms.size());
+    uint64 currentTimeNs = getCurrentTimeNs();
+    for (size_t i = 0; i < algorithms.size(); i++) {
+        Entry &entry = newEntries[i];
+        entry = Entry {};
+        entry.device = identity.device;
+        entry.inode = identity.inode;
+        entry.size = identity.size;
+        entry.modificationTimeNs = identity.modificationTimeNs;
+        entry.storedTime = currentTimeNs / 1000000000;
+        entry.algorithmId = getAlgorithmId(algorithms[i]);
+        entry.digestSize = digests[i].getSize();
+        memcpy(entry.digest, digests[i].data(), entry.digestSize);
+
+        if (verify) {
+            const Entry *cachedEntry = findEntry(identity, entry.algorithmId);
+            if (cachedEntry != nullptr && isSameContent(*cachedEntry, identity)
+                && HashDigest(cachedEntry->digest, cachedEntry->digestSize) != digests[i]) {
+                mismatchedAlgorithms += (mismatchedAlgorithms.empty() ? "" : ", ") + algorithms[i]->name;
+            }
+        }
+    }
+
+    if (identity.modificationTimeNs + HASH_CACHE_MIN_FILE_AGE_NS <= currentTimeNs) {
+        lock_guard<mutex> guard(lock);
+        storedEntries.insert(storedEntries.end(), newEntries.begin(), newEntries.end());
+    }
+    if (!mismatchedAlgorithms.empty()) {
+        throw invalid_argument("The cached digest (" + mismatchedAlgorithms + ") doesn't match the content");
+    }
+}
+
+void HashCache::save() {
+    vector<Entry> newEntries;
+    {
+        lock_guard<mutex> guard(lock);
+        newEntries.swap(storedEntries);
+    }
+    if (newEntries.empty()) {
+        return;
+    }
+
+    // The same file may have been stored several times: the last digests win
+    stable_sort(newEntries.begin(), newEntries.end(), isKeyLess);
+    vector<Entry> uniqueEntries;
+    uniqueEntries.reserve(newEntries.size());
+    for (const Entry &entry : newEntries) {
+        if (!uniqueEntries.empty() && isSameKey(uniqueEntries.back(), entry)) {
+            uniqueEntries.back() = entry;
+        } else {
+            uniqueEntries.push_back(entry);
+        }
+    }
+
+#ifndef _WIN32
+    // The lock file is never removed: otherwise the processes could lock the different files of the same name
+    int lockFd = open((filePath + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (lockFd < 0) {
+        throw invalid_argument("Can't lock the hash cache: " + filePath);
+    }
+    while (flock(lockFd, LOCK_EX) != 0) {
+        if (errno != EINTR) {
+            close(lockFd);
+            throw invalid_argument("Can't lock the hash cache: " + filePath);
+        }
+    }
+
+    // The cache may have been updated by another process since it was mapped, so the current file is merged
+    const uchar *currentMapping = nullptr;
+    uint64 currentMappingSize = 0;
+    try {
+        const Entry *currentEntries;
+        uint64 currentEntriesCount;
+        currentMapping = mapCacheFile(filePath, currentMappingSize);
+        parseCacheFile(filePath, currentMapping, currentMappingSize, currentEntries, currentEntriesCount);
+        replaceCacheFile(filePath, mergeEntries(currentEntries, currentEntriesCount, uniqueEntries));
+    } catch (...) {
+        unmapCacheFile(currentMapping, currentMappingSize);
+        close(lockFd);
+        throw;
+    }
+    unmapCacheFile(currentMapping, currentMappingSize);
+    // Closing the descriptor releases the lock
+    close(lockFd);
+#endif
+}
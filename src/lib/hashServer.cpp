@@ -0,0 +1,667 @@
+#include "../include/lib/hashServer.hpp"
+
+#include <cstring>
+#include <cerrno>
+#include <deque>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+#include "../include/lib/algorithms.hpp"
+#include "../include/lib/batch.hpp"
+#include "../include/lib/multiDigest.hpp"
+#include "../include/utils/stats.hpp"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+#ifndef _WIN32
+
+namespace {
+
+    // The most descriptors the kernel passes by a single message (SCM_MAX_FD)
+    const size_t MAX_DESCRIPTORS_PER_MESSAGE = 253;
+
+    void appendUint16(vector<uchar> &output, uint16 value) {
+        output.push_back(uchar(value));
+        output.push_back(uchar(value >> 8));
+    }
+
+    void appendUint32(vector<uchar> &output, uint32 value) {
+        for (uchar i = 0; i < 4; i++) {
+            output.push_back(uchar(value >> (i * 8)));
+        }
+    }
+
+    void appendUint64(vector<uchar> &output, uint64 value) {
+        for (uchar i = 0; i < 8; i++) {
+            output.push_back(uchar(value >> (i * 8)));
+        }
+    }
+
+    uint32 readUint32(const uchar *data) {
+        return uint32(data[0]) | (uint32(data[1]) << 8) | (uint32(data[2]) << 16) | (uint32(data[3]) << 24);
+    }
+
+    uint64 readUint64(const uchar *data) {
+        return uint64(readUint32(data)) | (uint64(readUint32(data + 4)) << 32);
+    }
+
+    // Reads the fields of the request frame one after another.
+    // Throws `invalid_argument` if the frame ends before the field
+    class FrameReader {
+    public:
+        FrameReader(const uchar *data, size_t size) : data(data), size(size), offset(0) {}
+
+        const uchar *readBytes(size_t count) {
+            if (count > size - offset) {
+                throw invalid_argument("Malformed frame: it ends in the middle of a request");
+            }
+            const uchar *bytes = data + offset;
+            offset += count;
+            return bytes;
+        }
+
+        uchar readUint8() {
+            return *readBytes(1);
+        }
+
+        uint32 readUint32() {
+            return ::readUint32(readBytes(4));
+        }
+
+        uint64 readUint64() {
+            return ::readUint64(readBytes(8));
+        }
+
+        bool isEnd() const {
+            return offset == size;
+        }
+
+    private:
+        const uchar *data;
+        size_t size;
+        size_t offset;
+    };
+
+    // The frame starts with its size, which is known once the frame is complete
+    vector<uchar> startResponse(uint64 id, uchar status) {
+        vector<uchar> response;
+        appendUint32(response, 0);
+        appendUint64(response, id);
+        response.push_back(status);
+        return response;
+    }
+
+    vector<uchar> finishResponse(vector<uchar> &&response) {
+        uint32 size = response.size() - 4;
+        for (uchar i = 0; i < 4; i++) {
+            response[i] = uchar(size >> (i * 8));
+        }
+        return move(response);
+    }
+
+    vector<uchar> encodeDigests(uint64 id, const HashDigest *digests, size_t count) {
+        vector<uchar> response = startResponse(id, SERVE_STATUS_OK);
+        response.push_back(uchar(count));
+        for (size_t i = 0; i < count; i++) {
+            response.push_back(digests[i].getSize());
+            response.insert(response.end(), digests[i].data(), digests[i].data() + digests[i].getSize());
+        }
+        return finishResponse(move(response));
+    }
+
+    vector<uchar> encodeError(uint64 id, uchar status, const string &message) {
+        vector<uchar> response = startResponse(id, status);
+        uint16 size = min(message.size(), size_t(UINT16_MAX));
+        appendUint16(response, size);
+        response.insert(response.end(), message.begin(), message.begin() + size);
+        return finishResponse(move(response));
+    }
+
+    void closeDescriptor(int fd) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+}
+
+struct HashServer::Request {
+    uint64 id = 0;
+    uchar source = SERVE_SOURCE_INLINE;
+    vector<const HashAlgorithm *> algorithms;
+    // The path or the message, points into the frame
+    ByteView data {};
+    // The descriptor of the SERVE_SOURCE_DESCRIPTOR request, closed once it's hashed
+    int fd = -1;
+    // The request is answered with the error right away unless the status is OK
+    uchar status = SERVE_STATUS_OK;
+    string error;
+};
+
+// The reader thread receives the frames and hands their requests to the pool, the writer thread sends the responses.
+// The connection is destroyed by its reader once all the admitted requests are answered, so the tasks may refer to it
+class HashServer::Connection {
+public:
+    Connection(int fd, uint32 maxRequestsCount)
+        : fd(fd), maxRequestsCount(maxRequestsCount), pendingRequestsCount(0), isReadingFinished(false), isBroken(false) {}
+
+    ~Connection() {
+        for (int descriptor : descriptors) {
+            close(descriptor);
+        }
+        close(fd);
+    }
+
+    Connection(const Connection &) = delete;
+    Connection &operator=(const Connection &) = delete;
+
+    // Returns nullptr at the end of the input. Throws `invalid_argument` if the frame is larger than `maxFrameSize`
+    shared_ptr<vector<uchar>> receiveFrame(uint32 maxFrameSize) {
+        uchar header[4];
+        if (!receive(header, sizeof(header))) {
+            return nullptr;
+        }
+        uint32 size = readUint32(header);
+        if (size > maxFrameSize) {
+            throw invalid_argument("The frame of " + to_string(size) + " bytes exceeds the limit of " + to_string(maxFrameSize) + " bytes");
+        }
+
+        shared_ptr<vector<uchar>> frame = make_shared<vector<uchar>>(size);
+        return receive(frame->data(), size) ? frame : nullptr;
+    }
+
+    // Returns -1 if no descriptor has been passed for the request
+    int takeDescriptor() {
+        if (descriptors.empty()) {
+            return -1;
+        }
+        int descriptor = descriptors.front();
+        descriptors.pop_front();
+        return descriptor;
+    }
+
+    // Takes a place for the request's response, returns false instead of waiting for it
+    bool tryReserve() {
+        lock_guard<mutex> guard(lock);
+        if (pendingRequestsCount >= maxRequestsCount) {
+            return false;
+        }
+        pendingRequestsCount++;
+        return true;
+    }
+
+    // Waits until the writer sends some of the responses if all the places are taken
+    void reserve() {
+        unique_lock<mutex> guard(lock);
+        isResponseSent.wait(guard, [this] { return pendingRequestsCount < maxRequestsCount; });
+        pendingRequestsCount++;
+    }
+
+    // The connection may be destroyed as soon as the last response is passed, so the writer is notified under the lock
+    void respond(vector<uchar> &&response) {
+        lock_guard<mutex> guard(lock);
+        responses.push_back(move(response));
+        hasResponses.notify_one();
+    }
+
+    // Sends the responses until the reading is finished and all the admitted requests are answered
+    void writeResponses() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            hasResponses.wait(guard, [this] { return !responses.empty() || (isReadingFinished && pendingRequestsCount == 0); });
+            if (responses.empty()) {
+                return;
+            }
+
+            // All the ready responses are sent at once
+            deque<vector<uchar>> ready;
+            ready.swap(responses);
+            guard.unlock();
+            vector<uchar> output;
+            for (const vector<uchar> &response : ready) {
+                output.insert(output.end(), response.begin(), response.end());
+            }
+            if (!isBroken) {
+                isBroken = !send(output.data(), output.size());
+            }
+            guard.lock();
+
+            pendingRequestsCount -= ready.size();
+            isResponseSent.notify_all();
+        }
+    }
+
+    // Lets the writer finish once the responses to all the admitted requests are sent
+    void finishReading() {
+        lock_guard<mutex> guard(lock);
+        isReadingFinished = true;
+        hasResponses.notify_one();
+    }
+
+    // Wakes up the reader blocked on the socket
+    void shutdownReading() {
+        shutdown(fd, SHUT_RD);
+    }
+
+private:
+    int fd;
+    uint32 maxRequestsCount;
+    // The descriptors received along with the frames, in order. Accessed by the reader thread only
+    deque<int> descriptors;
+
+    mutex lock;
+    condition_variable hasResponses;
+    condition_variable isResponseSent;
+    // Guarded by the `lock`
+    deque<vector<uchar>> responses;
+    uint32 pendingRequestsCount;
+    bool isReadingFinished;
+    // Accessed by the writer thread only: the client has gone, the rest of the responses are dropped
+    bool isBroken;
+
+    // Returns false if the connection has been closed before the `size` bytes are received
+    bool receive(uchar *target, size_t size) {
+        for (size_t offset = 0; offset < size;) {
+            iovec portion { target + offset, size - offset };
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_DESCRIPTORS_PER_MESSAGE)];
+            msghdr message {};
+            message.msg_iov = &portion;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            ssize_t received = recvmsg(fd, &message, MSG_CMSG_CLOEXEC);
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received <= 0) {
+                return false;
+            }
+            for (cmsghdr *header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+                if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+                    size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                    for (size_t i = 0; i < count; i++) {
+                        int descriptor;
+                        memcpy(&descriptor, CMSG_DATA(header) + i * sizeof(int), sizeof(int));
+                        acceptDescriptor(descriptor);
+                    }
+                }
+            }
+            offset += received;
+        }
+        return true;
+    }
+
+    // The client can't make the server keep more descriptors than the requests it may have in progress
+    void acceptDescriptor(int descriptor) {
+        if (descriptors.size() >= maxRequestsCount) {
+            close(descriptor);
+        } else {
+            descriptors.push_back(descriptor);
+        }
+    }
+
+    bool send(const uchar *data, size_t size) {
+        for (size_t offset = 0; offset < size;) {
+            ssize_t sent = ::send(fd, data + offset, size - offset, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if (sent <= 0) {
+                return false;
+            }
+            offset += sent;
+        }
+        return true;
+    }
+};
+
+HashServer::HashServer(const ServeOptions &options)
+    : options(options), listenFd(-1), stopPipe { -1, -1 }, pool(options.threadsCount), queuedRequestsCount(0) {
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.empty() || options.socketPath.size() >= sizeof(address.sun_path)) {
+        throw invalid_argument("The socket path is empty or too long: " + options.socketPath);
+    }
+    memcpy(address.sun_path, options.socketPath.data(), options.socketPath.size());
+
+    // The socket file left by the server that hasn't exited properly is replaced, the one of the running server is kept
+    struct stat status;
+    if (stat(options.socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        int probeFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool isListened = probeFd >= 0 && connect(probeFd, (const sockaddr *)&address, sizeof(address)) == 0;
+        closeDescriptor(probeFd);
+        if (isListened) {
+            throw invalid_argument("Another server listens on " + options.socketPath);
+        }
+        unlink(options.socketPath.c_str());
+    }
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    // Only the owner may connect: the server reads any file it has access to on behalf of the clients
+    mode_t mask = umask(0177);
+    bool isBound = listenFd >= 0 && ::bind(listenFd, (const sockaddr *)&address, sizeof(address)) == 0;
+    umask(mask);
+    if (!isBound || listen(listenFd, SOMAXCONN) != 0 || pipe2(stopPipe, O_CLOEXEC) != 0) {
+        string error = strerror(errno);
+        if (isBound) {
+            unlink(options.socketPath.c_str());
+        }
+        closeDescriptor(listenFd);
+        closeDescriptor(stopPipe[0]);
+        closeDescriptor(stopPipe[1]);
+        throw invalid_argument("Can't listen on " + options.socketPath + ": " + error);
+    }
+}
+
+HashServer::~HashServer() {
+    unlink(options.socketPath.c_str());
+    close(listenFd);
+    close(stopPipe[0]);
+    close(stopPipe[1]);
+}
+
+void HashServer::run() {
+    pollfd events[2] = { { listenFd, POLLIN, 0 }, { stopPipe[0], POLLIN, 0 } };
+    string error;
+    while (true) {
+        joinFinishedThreads();
+        if (poll(events, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // The admitted connections are still drained, their threads must not outlive the server
+            error = string("Can't wait for the connections: ") + strerror(errno);
+            break;
+        }
+        if (events[1].revents != 0) {
+            break;
+        }
+        if ((events[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            // Out of descriptors: the pending connections wait until some of the current ones are closed
+            if (errno == EMFILE || errno == ENFILE) {
+                reportError(string("Can't accept the connection: ") + strerror(errno));
+                this_thread::sleep_for(chrono::milliseconds(100));
+            }
+            continue;
+        }
+
+        // The connection is registered before its thread starts, so `stop` can't miss it
+        lock_guard<mutex> guard(lock);
+        if (connections.size() >= options.maxConnections) {
+            close(fd);
+            continue;
+        }
+        Connection *connection = new Connection(fd, options.maxConnectionRequests);
+        connections.emplace(connection, thread(&HashServer::serveConnection, this, connection));
+    }
+
+    {
+        unique_lock<mutex> guard(lock);
+        for (auto &entry : connections) {
+            entry.first->shutdownReading();
+        }
+        isConnectionClosed.wait(guard, [this] { return connections.empty(); });
+    }
+    joinFinishedThreads();
+    if (!error.empty()) {
+        throw invalid_argument(error);
+    }
+}
+
+// The threads are joined outside of the lock: each of them takes it on its way out
+void HashServer::joinFinishedThreads() {
+    vector<thread> threads;
+    {
+        lock_guard<mutex> guard(lock);
+        threads.swap(finishedThreads);
+    }
+    for (thread &finishedThread : threads) {
+        finishedThread.join();
+    }
+}
+
+void HashServer::stop() {
+    // The only async-signal-safe action, the rest is done by `run`
+    uchar signal = 0;
+    ssize_t written = write(stopPipe[1], &signal, 1);
+    (void)written;
+}
+
+void HashServer::serveConnection(Connection *connection) {
+    thread writer(&Connection::writeResponses, connection);
+    try {
+        while (shared_ptr<vector<uchar>> frame = connection->receiveFrame(options.maxFrameSize)) {
+            handleFrame(*connection, frame);
+        }
+    } catch (const exception &error) {
+        reportError(error.what());
+    }
+    connection->finishReading();
+    writer.join();
+
+    lock_guard<mutex> guard(lock);
+    auto entry = connections.find(connection);
+    finishedThreads.push_back(move(entry->second));
+    connections.erase(entry);
+    delete connection;
+    isConnectionClosed.notify_all();
+}
+
+void HashServer::handleFrame(Connection &connection, const shared_ptr<vector<uchar>> &frame) {
+    // The whole frame is parsed first, so the malformed one is rejected before any of its requests is started
+    FrameReader reader(frame->data(), frame->size());
+    uint32 requestsCount = reader.readUint32();
+    vector<Request> requests;
+    for (uint32 i = 0; i < requestsCount; i++) {
+        Request request;
+        request.id = reader.readUint64();
+        request.source = reader.readUint8();
+        uchar algorithmsCount = reader.readUint8();
+        for (uchar j = 0; j < algorithmsCount; j++) {
+            uchar nameSize = reader.readUint8();
+            string name((const char *)reader.readBytes(nameSize), nameSize);
+            const HashAlgorithm *algorithm = findHashAlgorithm(name);
+            if (algorithm == nullptr && request.status == SERVE_STATUS_OK) {
+                request.status = SERVE_STATUS_UNKNOWN_ALGORITHM;
+                request.error = "Unknown algorithm: " + name;
+            }
+            request.algorithms.push_back(algorithm);
+        }
+        uint32 dataSize = reader.readUint32();
+        request.data = { reader.readBytes(dataSize), dataSize };
+
+        if (request.source == SERVE_SOURCE_DESCRIPTOR) {
+            request.fd = connection.takeDescriptor();
+        }
+        if (request.status != SERVE_STATUS_OK) {
+            // The unknown algorithm is reported first
+        } else if (request.source > SERVE_SOURCE_INLINE) {
+            request.status = SERVE_STATUS_INVALID_REQUEST;
+            request.error = "Unknown source: " + to_string(request.source);
+        } else if (request.algorithms.empty()) {
+            request.status = SERVE_STATUS_INVALID_REQUEST;
+            request.error = "No algorithms";
+        } else if (request.source == SERVE_SOURCE_DESCRIPTOR && request.fd < 0) {
+            request.status = SERVE_STATUS_INVALID_REQUEST;
+            request.error = "No descriptor has been passed";
+        } else if (request.source == SERVE_SOURCE_PATH && (dataSize == 0 || memchr(request.data.data, 0, dataSize) != nullptr)) {
+            request.status = SERVE_STATUS_INVALID_REQUEST;
+            request.error = "Invalid path";
+        }
+        requests.push_back(move(request));
+    }
+    if (!reader.isEnd()) {
+        for (Request &request : requests) {
+            closeDescriptor(request.fd);
+        }
+        throw invalid_argument("Malformed frame: there are bytes after the last request");
+    }
+
+    // The small inline messages of the same algorithm are hashed together by the multi-buffer cores
+    map<const HashAlgorithm *, vector<Request>> groups;
+    auto submitGroups = [&]() {
+        for (auto &group : groups) {
+            if (!group.second.empty()) {
+                submitGroup(connection, frame, move(group.second));
+            }
+        }
+        groups.clear();
+    };
+
+    for (Request &request : requests) {
+        // The requests already grouped have to be started before waiting for the writer, they hold the places too
+        if (!connection.tryReserve()) {
+            submitGroups();
+            connection.reserve();
+        }
+
+        if (request.status == SERVE_STATUS_OK && !admitRequest()) {
+            request.status = SERVE_STATUS_BUSY;
+            request.error = "Too many requests in progress";
+        }
+        if (request.status != SERVE_STATUS_OK) {
+            closeDescriptor(request.fd);
+            connection.respond(encodeError(request.id, request.status, request.error));
+            continue;
+        }
+
+        if (request.source == SERVE_SOURCE_INLINE && request.algorithms.size() == 1 && request.data.size <= SERVE_GROUP_MAX_MESSAGE_SIZE) {
+            vector<Request> &group = groups[request.algorithms[0]];
+            group.push_back(move(request));
+            if (group.size() == SERVE_GROUP_MAX_REQUESTS_COUNT) {
+                submitGroup(connection, frame, move(group));
+                group.clear();
+            }
+        } else {
+            submitRequest(connection, frame, move(request));
+        }
+    }
+    submitGroups();
+}
+
+void HashServer::submitRequest(Connection &connection, const shared_ptr<vector<uchar>> &frame, Request &&request) {
+    // The large inputs and the ones of unknown size (pipes, sockets) are the long tasks
+    bool isLong;
+    struct stat status;
+    if (request.source == SERVE_SOURCE_PATH) {
+        string path((const char *)request.data.data, request.data.size);
+        isLong = stat(path.c_str(), &status) == 0 && uint64(status.st_size) > BATCH_LARGE_FILE_SIZE;
+    } else if (request.source == SERVE_SOURCE_DESCRIPTOR) {
+        isLong = fstat(request.fd, &status) != 0 || !S_ISREG(status.st_mode) || uint64(status.st_size) > BATCH_LARGE_FILE_SIZE;
+    } else {
+        isLong = request.data.size > BATCH_LARGE_FILE_SIZE;
+    }
+
+    pool.submit([this, &connection, frame, request = move(request)]() {
+        vector<uchar> response;
+        try {
+            vector<HashDigest> digests;
+            if (request.source == SERVE_SOURCE_INLINE) {
+                for (const HashAlgorithm *algorithm : request.algorithms) {
+                    unique_ptr<StreamingHasher> hasher = algorithm->createHasher();
+                    hasher->update(request.data.data, request.data.size);
+                    digests.push_back(hasher->final());
+                }
+            } else {
+                // The files and the descriptors are counted by the stats of the process
+                FileStatsScope statsScope;
+                if (request.source == SERVE_SOURCE_DESCRIPTOR) {
+                    digests = hashDescriptorWithAlgorithms(request.fd, request.algorithms);
+                } else if (request.algorithms.size() == 1) {
+                    string path((const char *)request.data.data, request.data.size);
+                    digests.push_back(request.algorithms[0]->hashFile(path, options.inputOptions));
+                } else {
+                    string path((const char *)request.data.data, request.data.size);
+                    MultiDigestOptions multiDigestOptions;
+                    multiDigestOptions.inputOptions = options.inputOptions;
+                    digests = hashWithAlgorithms(path, request.algorithms, multiDigestOptions);
+                }
+                statsScope.finish();
+            }
+            response = encodeDigests(request.id, digests.data(), digests.size());
+        } catch (const invalid_argument &error) {
+            response = encodeError(request.id, SERVE_STATUS_IO_ERROR, error.what());
+        } catch (const exception &error) {
+            response = encodeError(request.id, SERVE_STATUS_INTERNAL_ERROR, error.what());
+        }
+        closeDescriptor(request.fd);
+        completeRequests(1);
+        connection.respond(move(response));
+    }, isLong);
+}
+
+void HashServer::submitGroup(Connection &connection, const shared_ptr<vector<uchar>> &frame, vector<Request> &&group) {
+    pool.submit([this, &connection, frame, group = move(group)]() {
+        vector<ByteView> messages;
+        for (const Request &request : group) {
+            messages.push_back(request.data);
+        }
+
+        vector<vector<uchar>> responses;
+        try {
+            vector<HashDigest> digests = group[0].algorithms[0]->hashBuffers(messages);
+            for (size_t i = 0; i < group.size(); i++) {
+                responses.push_back(encodeDigests(group[i].id, &digests[i], 1));
+            }
+        } catch (const exception &error) {
+            responses.clear();
+            for (const Request &request : group) {
+                responses.push_back(encodeError(request.id, SERVE_STATUS_INTERNAL_ERROR, error.what()));
+            }
+        }
+
+        completeRequests(group.size());
+        for (vector<uchar> &response : responses) {
+            connection.respond(move(response));
+        }
+    });
+}
+
+bool HashServer::admitRequest() {
+    lock_guard<mutex> guard(lock);
+    if (queuedRequestsCount >= options.maxQueuedRequests) {
+        return false;
+    }
+    queuedRequestsCount++;
+    return true;
+}
+
+void HashServer::completeRequests(uint32 count) {
+    lock_guard<mutex> guard(lock);
+    queuedRequestsCount -= count;
+}
+
+void HashServer::reportError(const string &message) {
+    if (options.errorHandler) {
+        options.errorHandler(message);
+    }
+}
+
+#else
+
+HashServer::HashServer(const ServeOptions &options) : options(options), listenFd(-1), stopPipe { -1, -1 }, pool(1), queuedRequestsCount(0) {
+    throw invalid_argument("The server isn't supported on this platform");
+}
+
+HashServer::~HashServer() {}
+
+void HashServer::run() {}
+
+void HashServer::stop() {}
+
+#endif
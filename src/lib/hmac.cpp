@@ -0,0 +1,470 @@
+#include "../include/lib/hmac.hpp"
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../include/lib/kernels/sha256Kernels.hpp"
+#include "../include/lib/kernels/sha512Kernels.hpp"
+#include "../include/lib/multiBuffer.hpp"
+
+namespace sha2 {
+
+    namespace _hmac {
+        const uchar INNER_PAD = 0x36;
+        const uchar OUTER_PAD = 0x5C;
+
+        // HKDF expands into 255 digests at most
+        const uint32 MAX_HKDF_BLOCKS_COUNT = 255;
+
+        // The cores of the family: the single stream one for the midstates and the iterations of a single output block,
+        // the multi-buffer one for the batches
+        template <typename Word>
+        struct Core;
+
+        template <>
+        struct Core<uint32> {
+            typedef _sha256::BlocksFunction BlocksFunction;
+            typedef _sha256::MultiBufferBlocksFunction MultiBufferBlocksFunction;
+
+            static BlocksFunction *selectBlocksFunction() {
+                return _sha256::selectBlocksFunction();
+            }
+
+            static MultiBufferBlocksFunction *selectMultiBufferFunction(uchar &lanesCount) {
+                return _sha256::selectMultiBufferFunction(lanesCount);
+            }
+        };
+
+        template <>
+        struct Core<uint64> {
+            typedef _sha512::BlocksFunction BlocksFunction;
+            typedef _sha512::MultiBufferBlocksFunction MultiBufferBlocksFunction;
+
+            static BlocksFunction *selectBlocksFunction() {
+                return _sha512::selectBlocksFunction();
+            }
+
+            static MultiBufferBlocksFunction *selectMultiBufferFunction(uchar &lanesCount) {
+                return _sha512::selectMultiBufferFunction(lanesCount);
+            }
+        };
+
+        // The digest is the big-endian words of the state truncated to the size of the variant
+        // (SHA-512/224 ends in the middle of a word)
+        template <typename Variant>
+        inline void storeDigest(const typename Variant::Word *state, uchar *output) {
+            typedef typename Variant::Word Word;
+            constexpr uchar wordsCount = Variant::DIGEST_SIZE_IN_BYTES / sizeof(Word);
+            for (uchar i = 0; i < wordsCount; i++) {
+                for (uchar j = 0; j < sizeof(Word); j++) {
+                    output[i * sizeof(Word) + j] = uchar(state[i] >> ((sizeof(Word) - 1 - j) * 8));
+                }
+            }
+            for (uchar i = wordsCount * sizeof(Word); i < Variant::DIGEST_SIZE_IN_BYTES; i++) {
+                output[i] = uchar(state[wordsCount] >> ((sizeof(Word) - 1 - i % sizeof(Word)) * 8));
+            }
+        }
+
+        template <typename Variant>
+        typename HmacHasher<Variant>::Digest toDigest(const typename Variant::Word *state) {
+            typename HmacHasher<Variant>::Digest digest;
+            storeDigest<Variant>(state, digest.data());
+            return digest;
+        }
+
+        // The states after the first block of the inner and the outer hashes: the key XORed with the pads
+        template <typename Variant>
+        void computeMidstates(const uchar *key, size_t keySize, typename Variant::Word *innerState, typename Variant::Word *outerState) {
+            typedef typename Variant::Word Word;
+            const uchar blockSize = Sha2Family<Word>::BLOCK_SIZE_IN_BYTES;
+
+            uchar block[blockSize] = {};
+            if (keySize > blockSize) {
+                Sha2Hasher<Variant> keyHasher;
+                keyHasher.update(key, keySize);
+                typename Sha2Hasher<Variant>::Digest digest = keyHasher.final();
+                memcpy(block, digest.data(), digest.size());
+            } else if (keySize > 0) {
+                memcpy(block, key, keySize);
+            }
+
+            typename Core<Word>::BlocksFunction *processBlocks = Core<Word>::selectBlocksFunction();
+            for (uchar i = 0; i < blockSize; i++) {
+                block[i] ^= INNER_PAD;
+            }
+            memcpy(innerState, Variant::INITIAL_STATE, 8 * sizeof(Word));
+            processBlocks(innerState, block, 1);
+
+            for (uchar i = 0; i < blockSize; i++) {
+                block[i] ^= INNER_PAD ^ OUTER_PAD;
+            }
+            memcpy(outerState, Variant::INITIAL_STATE, 8 * sizeof(Word));
+            processBlocks(outerState, block, 1);
+
+            fill(block, block + blockSize, 0);
+        }
+
+        // The MAC of the two parts of the message from the midstates
+        template <typename Variant>
+        void mac(
+            Sha2Hasher<Variant> &hasher, const typename Variant::Word *innerState, const typename Variant::Word *outerState,
+            const uchar *first, size_t firstSize, const uchar *second, size_t secondSize, uchar *output
+        ) {
+            const uchar blockSize = Sha2Family<typename Variant::Word>::BLOCK_SIZE_IN_BYTES;
+            hasher.resume(innerState, blockSize);
+            hasher.update(first, firstSize);
+            hasher.update(second, secondSize);
+            typename Sha2Hasher<Variant>::Digest digest = hasher.final();
+            hasher.resume(outerState, blockSize);
+            hasher.update(digest.data(), digest.size());
+            digest = hasher.final();
+            memcpy(output, digest.data(), digest.size());
+        }
+
+        // The single block the PBKDF2 iterations hash after the midstates: the digest, the padding
+        // and the length of the key block with the digest. The digest is replaced in place by each hash
+        template <typename Variant>
+        void prepareDigestBlock(uchar *block) {
+            typedef Sha2Family<typename Variant::Word> Family;
+            const uchar digestSize = Variant::DIGEST_SIZE_IN_BYTES;
+            memset(block + digestSize, 0, Family::BLOCK_SIZE_IN_BYTES - digestSize);
+            block[digestSize] = 0x80;
+            uint64 sizeInBits = uint64(Family::BLOCK_SIZE_IN_BYTES + digestSize) * 8;
+            for (uchar i = 0; i < 8; i++) {
+                block[Family::BLOCK_SIZE_IN_BYTES - 1 - i] = uchar(sizeInBits >> (i * 8));
+            }
+        }
+
+        // The output block of PBKDF2: its first iteration (U1) is already in the `block`
+        // and in the `result`, the rest of them are XORed into the `result`
+        template <typename Variant>
+        struct Pbkdf2Job {
+            const typename Variant::Word *innerState;
+            const typename Variant::Word *outerState;
+            uchar block[Sha2Family<typename Variant::Word>::BLOCK_SIZE_IN_BYTES];
+            uchar result[Variant::DIGEST_SIZE_IN_BYTES];
+            // The last output block may be truncated
+            uchar *output;
+            uchar outputSize;
+        };
+
+        template <typename Variant>
+        void iterateJob(typename Core<typename Variant::Word>::BlocksFunction *processBlocks, Pbkdf2Job<Variant> &job, uint32 iterations) {
+            typedef typename Variant::Word Word;
+            Word state[8];
+            for (uint32 iteration = 1; iteration < iterations; iteration++) {
+                memcpy(state, job.innerState, sizeof(state));
+                processBlocks(state, job.block, 1);
+                storeDigest<Variant>(state, job.block);
+
+                memcpy(state, job.outerState, sizeof(state));
+                processBlocks(state, job.block, 1);
+                storeDigest<Variant>(state, job.block);
+
+                for (uchar i = 0; i < Variant::DIGEST_SIZE_IN_BYTES; i++) {
+                    job.result[i] ^= job.block[i];
+                }
+            }
+        }
+
+        // The jobs of the same count of iterations run in lock-step, one per lane.
+        // The idle lanes of the last group repeat its last job, their results are just ignored
+        template <typename Variant>
+        void iterateJobsInLanes(
+            typename Core<typename Variant::Word>::MultiBufferBlocksFunction *processBlocks, uchar lanesCount,
+            Pbkdf2Job<Variant> *jobs, size_t jobsCount, uint32 iterations
+        ) {
+            typedef typename Variant::Word Word;
+            const uchar maxLanesCount = MultiBufferEngine<Word>::MAX_LANES;
+            // The midstates are transposed once, each pass starts from their copy
+            Word midstates[2][8 * maxLanesCount];
+            Word states[8 * maxLanesCount];
+            const uchar *pointers[maxLanesCount];
+            Word state[8];
+            // The lanes carrying the jobs, the rest repeat the last one
+            size_t activeLanesCount = min<size_t>(jobsCount, lanesCount);
+
+            for (size_t lane = 0; lane < lanesCount; lane++) {
+                const Pbkdf2Job<Variant> &job = jobs[min(lane, jobsCount - 1)];
+                pointers[lane] = job.block;
+                for (uchar word = 0; word < 8; word++) {
+                    midstates[0][word * lanesCount + lane] = job.innerState[word];
+                    midstates[1][word * lanesCount + lane] = job.outerState[word];
+                }
+            }
+            for (uint32 iteration = 1; iteration < iterations; iteration++) {
+                for (uchar pass = 0; pass < 2; pass++) {
+                    memcpy(states, midstates[pass], 8 * lanesCount * sizeof(Word));
+                    processBlocks(states, pointers, 1);
+
+                    for (size_t lane = 0; lane < activeLanesCount; lane++) {
+                        for (uchar word = 0; word < 8; word++) {
+                            state[word] = states[word * lanesCount + lane];
+                        }
+                        storeDigest<Variant>(state, jobs[lane].block);
+                    }
+                }
+                for (size_t lane = 0; lane < activeLanesCount; lane++) {
+                    for (uchar i = 0; i < Variant::DIGEST_SIZE_IN_BYTES; i++) {
+                        jobs[lane].result[i] ^= jobs[lane].block[i];
+                    }
+                }
+            }
+        }
+
+        // The groups of jobs fill all the lanes. The remainder fills at least a half of them or is iterated
+        // by the single stream core: the multi-buffer call costs more than a single stream block (7 times for SHA-NI)
+        template <typename Variant>
+        void runPbkdf2Jobs(vector<Pbkdf2Job<Variant>> &jobs, uint32 iterations) {
+            typedef typename Variant::Word Word;
+            uchar lanesCount = 0;
+            typename Core<Word>::MultiBufferBlocksFunction *processLanes = Core<Word>::selectMultiBufferFunction(lanesCount);
+            typename Core<Word>::BlocksFunction *processBlocks = Core<Word>::selectBlocksFunction();
+
+            size_t next = 0;
+            if (processLanes != nullptr) {
+                size_t groupSize = lanesCount;
+                for (; jobs.size() - next >= groupSize; next += groupSize) {
+                    iterateJobsInLanes<Variant>(processLanes, lanesCount, jobs.data() + next, groupSize, iterations);
+                }
+                if (jobs.size() - next >= max<size_t>(groupSize / 2, 1)) {
+                    iterateJobsInLanes<Variant>(processLanes, lanesCount, jobs.data() + next, jobs.size() - next, iterations);
+                    next = jobs.size();
+                }
+            }
+            for (; next < jobs.size(); next++) {
+                iterateJob<Variant>(processBlocks, jobs[next], iterations);
+            }
+
+            for (Pbkdf2Job<Variant> &job : jobs) {
+                memcpy(job.output, job.result, job.outputSize);
+                fill(job.result, job.result + Variant::DIGEST_SIZE_IN_BYTES, 0);
+                fill(job.block, job.block + sizeof(job.block), 0);
+            }
+        }
+
+        template <typename Variant>
+        struct Midstates {
+            typename Variant::Word inner[8];
+            typename Variant::Word outer[8];
+        };
+
+        // Adds the jobs of all the output blocks of the password: their first iterations are computed right away
+        template <typename Variant>
+        void addPbkdf2Jobs(
+            Sha2Hasher<Variant> &hasher, const Midstates<Variant> &midstates, const ByteView &salt,
+            uchar *output, size_t size, vector<Pbkdf2Job<Variant>> &jobs
+        ) {
+            const uchar digestSize = Variant::DIGEST_SIZE_IN_BYTES;
+            for (uint64 offset = 0, index = 1; offset < size; offset += digestSize, index++) {
+                Pbkdf2Job<Variant> job;
+                job.innerState = midstates.inner;
+                job.outerState = midstates.outer;
+                job.output = output + offset;
+                job.outputSize = uchar(min(size - offset, size_t(digestSize)));
+
+                const uchar indexBytes[4] = { uchar(index >> 24), uchar(index >> 16), uchar(index >> 8), uchar(index) };
+                mac<Variant>(hasher, midstates.inner, midstates.outer, salt.data, salt.size, indexBytes, 4, job.block);
+                prepareDigestBlock<Variant>(job.block);
+                memcpy(job.result, job.block, digestSize);
+                jobs.push_back(job);
+            }
+        }
+
+        template <typename Variant>
+        void checkPbkdf2Arguments(uint32 iterations, size_t size) {
+            if (iterations == 0) {
+                throw invalid_argument("The count of PBKDF2 iterations must be positive");
+            }
+            if (size == 0 || (size - 1) / Variant::DIGEST_SIZE_IN_BYTES >= 0xFFFFFFFF) {
+                throw invalid_argument("The size of the PBKDF2 output must be from 1 to 2^32 - 1 digests");
+            }
+        }
+    }
+
+    template <typename Variant>
+    HmacHasher<Variant>::HmacHasher(const uchar *key, size_t keySize) {
+        _hmac::computeMidstates<Variant>(key, keySize, innerState, outerState);
+        reset();
+    }
+
+    template <typename Variant>
+    HmacHasher<Variant>::~HmacHasher() {
+        fill(innerState, innerState + 8, 0);
+        fill(outerState, outerState + 8, 0);
+    }
+
+    template <typename Variant>
+    void HmacHasher<Variant>::reset() {
+        hasher.resume(innerState, BLOCK_SIZE_IN_BYTES);
+    }
+
+    template <typename Variant>
+    void HmacHasher<Variant>::update(const uchar *data, size_t size) {
+        hasher.update(data, size);
+    }
+
+    template <typename Variant>
+    typename HmacHasher<Variant>::Digest HmacHasher<Variant>::final() {
+        Digest innerDigest = hasher.final();
+        hasher.resume(outerState, BLOCK_SIZE_IN_BYTES);
+        hasher.update(innerDigest.data(), innerDigest.size());
+        Digest result = hasher.final();
+        reset();
+
+        return result;
+    }
+
+    template <typename Variant>
+    const typename HmacHasher<Variant>::Word *HmacHasher<Variant>::getInnerState() const {
+        return innerState;
+    }
+
+    template <typename Variant>
+    const typename HmacHasher<Variant>::Word *HmacHasher<Variant>::getOuterState() const {
+        return outerState;
+    }
+
+    template <typename Variant>
+    vector<typename HmacHasher<Variant>::Digest> macBuffers(const uchar *key, size_t keySize, const vector<ByteView> &messages) {
+        typedef typename Variant::Word Word;
+        typedef typename HmacHasher<Variant>::Digest Digest;
+        typedef Sha2Family<Word> Family;
+
+        HmacHasher<Variant> hmacHasher(key, keySize);
+        uchar lanesCount;
+        typename _hmac::Core<Word>::MultiBufferBlocksFunction *processBlocks = _hmac::Core<Word>::selectMultiBufferFunction(lanesCount);
+
+        if (processBlocks == nullptr || messages.size() < MULTI_BUFFER_MIN_BATCH_SIZE) {
+            vector<Digest> macs;
+            for (const ByteView &message : messages) {
+                hmacHasher.update(message.data, message.size);
+                macs.push_back(hmacHasher.final());
+            }
+            return macs;
+        }
+
+        // Both passes start from the midstates, so the key block is counted by the length of the messages
+        Sha2Hasher<Variant> hasher;
+        auto hashFrom = [&hasher](const Word *midstate) {
+            return [&hasher, midstate](const ByteView &message) {
+                hasher.resume(midstate, Family::BLOCK_SIZE_IN_BYTES);
+                hasher.update(message.data, message.size);
+                return hasher.final();
+            };
+        };
+        typename MultiBufferEngine<Word>::Algorithm algorithm { Family::BLOCK_SIZE_IN_BYTES, 8, hmacHasher.getInnerState(), Family::LENGTH_FIELD_SIZE, true };
+        algorithm.prefixSize = Family::BLOCK_SIZE_IN_BYTES;
+
+        MultiBufferEngine<Word> innerEngine(algorithm, processBlocks, lanesCount);
+        vector<Digest> innerDigests = hashBuffersWithMultiBuffer<Word, Digest>(
+            messages, innerEngine, _hmac::toDigest<Variant>, hashFrom(hmacHasher.getInnerState())
+        );
+
+        vector<ByteView> innerMessages;
+        for (const Digest &digest : innerDigests) {
+            innerMessages.push_back({ digest.data(), digest.size() });
+        }
+        algorithm.initialState = hmacHasher.getOuterState();
+        MultiBufferEngine<Word> outerEngine(algorithm, processBlocks, lanesCount);
+        return hashBuffersWithMultiBuffer<Word, Digest>(
+            innerMessages, outerEngine, _hmac::toDigest<Variant>, hashFrom(hmacHasher.getOuterState())
+        );
+    }
+
+    template <typename Variant>
+    typename HmacHasher<Variant>::Digest hkdfExtract(const uchar *salt, size_t saltSize, const uchar *keyMaterial, size_t keyMaterialSize) {
+        // The empty salt is the zeroes of the digest size, which are the same key as no key at all
+        HmacHasher<Variant> hasher(salt, saltSize);
+        hasher.update(keyMaterial, keyMaterialSize);
+        return hasher.final();
+    }
+
+    template <typename Variant>
+    void hkdfExpand(const uchar *key, size_t keySize, const uchar *info, size_t infoSize, uchar *output, size_t size) {
+        const uchar digestSize = Variant::DIGEST_SIZE_IN_BYTES;
+        if (size > _hmac::MAX_HKDF_BLOCKS_COUNT * digestSize) {
+            throw invalid_argument("The size of the HKDF output must be at most " + to_string(_hmac::MAX_HKDF_BLOCKS_COUNT * digestSize) + " bytes");
+        }
+
+        // T(i) = HMAC(key, T(i - 1) || info || i), T(0) is empty
+        HmacHasher<Variant> hasher(key, keySize);
+        typename HmacHasher<Variant>::Digest block;
+        for (uint32 offset = 0, index = 1; offset < size; offset += digestSize, index++) {
+            if (index > 1) {
+                hasher.update(block.data(), block.size());
+            }
+            hasher.update(info, infoSize);
+            const uchar indexByte = uchar(index);
+            hasher.update(&indexByte, 1);
+            block = hasher.final();
+            memcpy(output + offset, block.data(), min(size_t(digestSize), size - offset));
+        }
+        fill(block.begin(), block.end(), 0);
+    }
+
+    template <typename Variant>
+    void hkdf(
+        const uchar *salt, size_t saltSize, const uchar *keyMaterial, size_t keyMaterialSize,
+        const uchar *info, size_t infoSize, uchar *output, size_t size
+    ) {
+        typename HmacHasher<Variant>::Digest key = hkdfExtract<Variant>(salt, saltSize, keyMaterial, keyMaterialSize);
+        hkdfExpand<Variant>(key.data(), key.size(), info, infoSize, output, size);
+        fill(key.begin(), key.end(), 0);
+    }
+
+    template <typename Variant>
+    void pbkdf2(const uchar *password, size_t passwordSize, const uchar *salt, size_t saltSize, uint32 iterations, uchar *output, size_t size) {
+        pbkdf2Batch<Variant>({ { password, passwordSize } }, { { salt, saltSize } }, iterations, output, size);
+    }
+
+    template <typename Variant>
+    void pbkdf2Batch(const vector<ByteView> &passwords, const vector<ByteView> &salts, uint32 iterations, uchar *outputs, size_t size) {
+        _hmac::checkPbkdf2Arguments<Variant>(iterations, size);
+        if (salts.size() != passwords.size()) {
+            throw invalid_argument("Each password must have its own salt");
+        }
+
+        vector<_hmac::Midstates<Variant>> midstates(passwords.size());
+        vector<_hmac::Pbkdf2Job<Variant>> jobs;
+        Sha2Hasher<Variant> hasher;
+        for (size_t i = 0; i < passwords.size(); i++) {
+            _hmac::computeMidstates<Variant>(passwords[i].data, passwords[i].size, midstates[i].inner, midstates[i].outer);
+            _hmac::addPbkdf2Jobs<Variant>(hasher, midstates[i], salts[i], outputs + i * size, size, jobs);
+        }
+        _hmac::runPbkdf2Jobs<Variant>(jobs, iterations);
+
+        for (_hmac::Midstates<Variant> &state : midstates) {
+            fill(state.inner, state.inner + 8, 0);
+            fill(state.outer, state.outer + 8, 0);
+        }
+    }
+
+    // All the variants are compiled here, so the cores stay private to this module
+#define INSTANTIATE_HMAC_VARIANT(Variant) \
+    template class HmacHasher<Variant>; \
+    template vector<HmacHasher<Variant>::Digest> macBuffers<Variant>(const uchar *key, size_t keySize, const vector<ByteView> &messages); \
+    template HmacHasher<Variant>::Digest hkdfExtract<Variant>(const uchar *salt, size_t saltSize, const uchar *keyMaterial, size_t keyMaterialSize); \
+    template void hkdfExpand<Variant>(const uchar *key, size_t keySize, const uchar *info, size_t infoSize, uchar *output, size_t size); \
+    template void hkdf<Variant>( \
+        const uchar *salt, size_t saltSize, const uchar *keyMaterial, size_t keyMaterialSize, \
+        const uchar *info, size_t infoSize, uchar *output, size_t size \
+    ); \
+    template void pbkdf2<Variant>( \
+        const uchar *password, size_t passwordSize, const uchar *salt, size_t saltSize, uint32 iterations, uchar *output, size_t size \
+    ); \
+    template void pbkdf2Batch<Variant>( \
+        const vector<ByteView> &passwords, const vector<ByteView> &salts, uint32 iterations, uchar *outputs, size_t size \
+    );
+
+    INSTANTIATE_HMAC_VARIANT(Sha224Variant)
+    INSTANTIATE_HMAC_VARIANT(Sha256Variant)
+    INSTANTIATE_HMAC_VARIANT(Sha384Variant)
+    INSTANTIATE_HMAC_VARIANT(Sha512Variant)
+    INSTANTIATE_HMAC_VARIANT(Sha512_224Variant)
+    INSTANTIATE_HMAC_VARIANT(Sha512_256Variant)
+
+#undef INSTANTIATE_HMAC_VARIANT
+
+}
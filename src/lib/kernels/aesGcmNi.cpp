@@ -0,0 +1,204 @@
+#include "../../include/lib/kernels/aesGcmKernels.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#include "../../include/utils/cpuFeatures.hpp"
+
+#if ZIPPY_X86
+#include <immintrin.h>
+
+using namespace std;
+
+ZIPPY_BEGIN_TARGET_REGION("aes,pclmul,sse4.1")
+
+namespace {
+
+    using namespace aes::_aes;
+
+    // GHASH treats the blocks as the big endian numbers with the reflected bits: the bytes are reversed,
+    // and the reflection of the bits is compensated by the shift of the product in `reduce`
+    inline __m128i reverseBytes(__m128i x) {
+        return _mm_shuffle_epi8(x, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    }
+
+    // Adds the 256-bit carry-less product of `a` and `b` to [high:low]
+    inline void multiplyAccumulate(__m128i a, __m128i b, __m128i &low, __m128i &high) {
+        __m128i middle = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+        low = _mm_xor_si128(low, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x00), _mm_slli_si128(middle, 8)));
+        high = _mm_xor_si128(high, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x11), _mm_srli_si128(middle, 8)));
+    }
+
+    // Shifts [high:low] left by one bit and reduces it modulo x^128 + x^7 + x^2 + x + 1 (the Intel's white paper
+    // "Carry-Less Multiplication and Its Usage for Computing the GCM Mode"). It's linear, so the sum of the products
+    // of several blocks is reduced once
+    inline __m128i reduce(__m128i low, __m128i high) {
+        __m128i lowCarries = _mm_srli_epi32(low, 31);
+        __m128i highCarries = _mm_srli_epi32(high, 31);
+        low = _mm_slli_epi32(low, 1);
+        high = _mm_slli_epi32(high, 1);
+        high = _mm_or_si128(high, _mm_srli_si128(lowCarries, 12));
+        high = _mm_or_si128(high, _mm_slli_si128(highCarries, 4));
+        low = _mm_or_si128(low, _mm_slli_si128(lowCarries, 4));
+
+        __m128i first = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(low, 31), _mm_slli_epi32(low, 30)), _mm_slli_epi32(low, 25));
+        __m128i rest = _mm_srli_si128(first, 4);
+        low = _mm_xor_si128(low, _mm_slli_si128(first, 12));
+        __m128i second = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(low, 1), _mm_srli_epi32(low, 2)), _mm_srli_epi32(low, 7));
+        second = _mm_xor_si128(second, rest);
+        return _mm_xor_si128(high, _mm_xor_si128(low, second));
+    }
+
+    inline __m128i multiply(__m128i a, __m128i b) {
+        __m128i low = _mm_setzero_si128(), high = _mm_setzero_si128();
+        multiplyAccumulate(a, b, low, high);
+        return reduce(low, high);
+    }
+
+    inline __m128i loadHashKeyPower(const uchar *hashKeyPowers, uchar exponent) {
+        return _mm_loadu_si128((const __m128i *)(hashKeyPowers + (exponent - 1) * BLOCK_SIZE_IN_BYTES));
+    }
+
+    // Absorbs the 8 (reversed) blocks: ((x ^ b0) * H^8) ^ (b1 * H^7) ^ ... ^ (b7 * H)
+    inline __m128i absorbBlocks8(const uchar *hashKeyPowers, __m128i x, const __m128i *blocks) {
+        __m128i low = _mm_setzero_si128(), high = _mm_setzero_si128();
+        multiplyAccumulate(_mm_xor_si128(x, blocks[0]), loadHashKeyPower(hashKeyPowers, 8), low, high);
+        for (uchar i = 1; i < 8; i++) {
+            multiplyAccumulate(blocks[i], loadHashKeyPower(hashKeyPowers, 8 - i), low, high);
+        }
+        return reduce(low, high);
+    }
+
+    struct RoundKeys {
+        __m128i keys[ROUNDS_COUNT + 1];
+
+        explicit RoundKeys(const uchar *roundKeys) {
+            for (uchar i = 0; i <= ROUNDS_COUNT; i++) {
+                keys[i] = _mm_loadu_si128((const __m128i *)(roundKeys + i * BLOCK_SIZE_IN_BYTES));
+            }
+        }
+
+        inline __m128i encrypt(__m128i block) const {
+            block = _mm_xor_si128(block, keys[0]);
+            for (uchar round = 1; round < ROUNDS_COUNT; round++) {
+                block = _mm_aesenc_si128(block, keys[round]);
+            }
+            return _mm_aesenclast_si128(block, keys[ROUNDS_COUNT]);
+        }
+    };
+
+    inline __m128i makeCounterBlock(__m128i counterBlock, uint32 counter) {
+        return _mm_insert_epi32(counterBlock, int(__builtin_bswap32(counter)), 3);
+    }
+
+}
+
+namespace aes {
+    namespace _aes {
+        void initializeHashKeyPowersPclmul(const uchar *hashKey, uchar *hashKeyPowers) {
+            __m128i h = reverseBytes(_mm_loadu_si128((const __m128i *)hashKey));
+            __m128i power = h;
+            for (uchar i = 0; i < HASH_KEY_POWERS_COUNT; i++) {
+                _mm_storeu_si128((__m128i *)(hashKeyPowers + i * BLOCK_SIZE_IN_BYTES), power);
+                power = multiply(power, h);
+            }
+        }
+
+        void ghashBlocksPclmul(const uchar *hashKeyPowers, uchar *state, const uchar *data, size_t blocksCount) {
+            __m128i x = reverseBytes(_mm_loadu_si128((const __m128i *)state));
+            for (; blocksCount >= 8; blocksCount -= 8, data += 8 * BLOCK_SIZE_IN_BYTES) {
+                __m128i blocks[8];
+                for (uchar i = 0; i < 8; i++) {
+                    blocks[i] = reverseBytes(_mm_loadu_si128((const __m128i *)(data + i * BLOCK_SIZE_IN_BYTES)));
+                }
+                x = absorbBlocks8(hashKeyPowers, x, blocks);
+            }
+            __m128i h = loadHashKeyPower(hashKeyPowers, 1);
+            for (; blocksCount > 0; blocksCount--, data += BLOCK_SIZE_IN_BYTES) {
+                x = multiply(_mm_xor_si128(x, reverseBytes(_mm_loadu_si128((const __m128i *)data))), h);
+            }
+            _mm_storeu_si128((__m128i *)state, reverseBytes(x));
+        }
+
+        // The 8 blocks are encrypted at once, so the latency of the AES rounds is hidden,
+        // and the multiplications of GHASH are independent of them
+        void cryptAesNi(
+            const uchar *roundKeys, const uchar *hashKeyPowers, const uchar *counterBlock,
+            const uchar *input, uchar *output, size_t size, bool isEncrypting, uchar *state
+        ) {
+            RoundKeys keys(roundKeys);
+            __m128i counterTemplate = _mm_loadu_si128((const __m128i *)counterBlock);
+            uint32 counter = __builtin_bswap32(uint32(_mm_extract_epi32(counterTemplate, 3)));
+            __m128i x = reverseBytes(_mm_loadu_si128((const __m128i *)state));
+
+            for (; size >= 8 * BLOCK_SIZE_IN_BYTES; size -= 8 * BLOCK_SIZE_IN_BYTES) {
+                __m128i blocks[8];
+                for (uchar i = 0; i < 8; i++) {
+                    blocks[i] = _mm_xor_si128(makeCounterBlock(counterTemplate, counter + i), keys.keys[0]);
+                }
+                counter += 8;
+                for (uchar round = 1; round < ROUNDS_COUNT; round++) {
+                    for (uchar i = 0; i < 8; i++) {
+                        blocks[i] = _mm_aesenc_si128(blocks[i], keys.keys[round]);
+                    }
+                }
+
+                __m128i ciphertexts[8];
+                for (uchar i = 0; i < 8; i++) {
+                    __m128i in = _mm_loadu_si128((const __m128i *)input);
+                    __m128i out = _mm_xor_si128(in, _mm_aesenclast_si128(blocks[i], keys.keys[ROUNDS_COUNT]));
+                    _mm_storeu_si128((__m128i *)output, out);
+                    ciphertexts[i] = reverseBytes(isEncrypting ? out : in);
+                    input += BLOCK_SIZE_IN_BYTES;
+                    output += BLOCK_SIZE_IN_BYTES;
+                }
+                x = absorbBlocks8(hashKeyPowers, x, ciphertexts);
+            }
+
+            __m128i h = loadHashKeyPower(hashKeyPowers, 1);
+            for (; size != 0; size -= min(size, size_t(BLOCK_SIZE_IN_BYTES))) {
+                __m128i keyStream = keys.encrypt(makeCounterBlock(counterTemplate, counter++));
+                __m128i in, out;
+                if (size >= BLOCK_SIZE_IN_BYTES) {
+                    in = _mm_loadu_si128((const __m128i *)input);
+                    out = _mm_xor_si128(in, keyStream);
+                    _mm_storeu_si128((__m128i *)output, out);
+                } else {
+                    // The incomplete last block: the bytes beyond the input are zeroes in the input and the output
+                    alignas(16) uchar block[BLOCK_SIZE_IN_BYTES] = {};
+                    memcpy(block, input, size);
+                    in = _mm_load_si128((const __m128i *)block);
+                    _mm_store_si128((__m128i *)block, _mm_xor_si128(in, keyStream));
+                    memcpy(output, block, size);
+                    memset(block + size, 0, BLOCK_SIZE_IN_BYTES - size);
+                    out = _mm_load_si128((const __m128i *)block);
+                }
+                x = multiply(_mm_xor_si128(x, reverseBytes(isEncrypting ? out : in)), h);
+                input += BLOCK_SIZE_IN_BYTES;
+                output += BLOCK_SIZE_IN_BYTES;
+            }
+            _mm_storeu_si128((__m128i *)state, reverseBytes(x));
+        }
+
+        void encryptBlockAesNi(const uchar *roundKeys, const uchar *input, uchar *output) {
+            RoundKeys keys(roundKeys);
+            _mm_storeu_si128((__m128i *)output, keys.encrypt(_mm_loadu_si128((const __m128i *)input)));
+        }
+    }
+}
+
+ZIPPY_END_TARGET_REGION()
+
+#else
+
+// The kernels are never selected on the other platforms
+namespace aes {
+    namespace _aes {
+        void initializeHashKeyPowersPclmul(const uchar *, uchar *) {}
+        void ghashBlocksPclmul(const uchar *, uchar *, const uchar *, size_t) {}
+        void cryptAesNi(const uchar *, const uchar *, const uchar *, const uchar *, uchar *, size_t, bool, uchar *) {}
+        void encryptBlockAesNi(const uchar *, const uchar *, uchar *) {}
+    }
+}
+
+#endif
@@ -0,0 +1,227 @@
+#include "../../include/lib/kernels/crc32Kernels.hpp"
+
+#include <cstring>
+
+#include "../../include/utils/cpuFeatures.hpp"
+
+#if ZIPPY_X86
+#include <immintrin.h>
+#endif
+
+namespace crc32 {
+
+    namespace _crc32 {
+
+#if ZIPPY_X86
+        // Folding the 128 bits of the register over `distance` bits: the low 64 bits are multiplied by x^(distance + 32)
+        // and the high ones by x^(distance - 32) modulo the polynomial (in the reflected order, shifted left by one bit:
+        // the products of the reflected polynomials are one bit short). The constants of Intel's white paper
+        // "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction"
+        constexpr uint64 foldConstant(uint32 exponent) {
+            return uint64(powerModulo(exponent, POLYNOMIAL)) << 1;
+        }
+
+        // The reflected polynomial (33 bits) and the reflected quotient x^64 / P of the Barrett reduction
+        const uint64 BARRETT_POLYNOMIAL = 0x1DB710641;
+        const uint64 BARRETT_QUOTIENT = 0x1F7011641;
+
+        ZIPPY_BEGIN_TARGET_REGION("pclmul,sse4.1")
+
+        namespace {
+            // The constants of a single distance: the low one in the low half, the high one in the high half
+            template <uint32 distance>
+            inline __m128i loadFoldConstants() {
+                constexpr uint64 low = foldConstant(distance + 32), high = foldConstant(distance - 32);
+                return _mm_set_epi64x(high, low);
+            }
+
+            inline __m128i fold(__m128i x, __m128i constants, __m128i next) {
+                __m128i low = _mm_clmulepi64_si128(x, constants, 0x00);
+                __m128i high = _mm_clmulepi64_si128(x, constants, 0x11);
+                return _mm_xor_si128(_mm_xor_si128(low, high), next);
+            }
+
+            // Folds the rest of the whole 16-byte blocks into the accumulator, reduces it to the register
+            // and leaves the tail to the scalar core
+            uint32 finishFolding(__m128i x, const uchar *data, size_t size) {
+                __m128i constants = loadFoldConstants<128>();
+                for (; size >= 16; data += 16, size -= 16) {
+                    x = fold(x, constants, _mm_loadu_si128((const __m128i *)data));
+                }
+
+                // 128 bits to 64: the low half is multiplied by x^96 and added to the high one
+                x = _mm_xor_si128(_mm_clmulepi64_si128(x, constants, 0x10), _mm_srli_si128(x, 8));
+                // 64 bits to 32 (the products are 32 bits longer than the folded part)
+                __m128i mask = _mm_setr_epi32(-1, 0, 0, 0);
+                constexpr uint64 reductionConstant = foldConstant(64);
+                __m128i product = _mm_clmulepi64_si128(_mm_and_si128(x, mask), _mm_cvtsi64_si128(reductionConstant), 0x00);
+                x = _mm_xor_si128(product, _mm_srli_si128(x, 4));
+                // The Barrett reduction: the quotient is estimated by the multiplication, its product with the polynomial is subtracted
+                __m128i barrett = _mm_set_epi64x(BARRETT_QUOTIENT, BARRETT_POLYNOMIAL);
+                __m128i quotient = _mm_clmulepi64_si128(_mm_and_si128(x, mask), barrett, 0x10);
+                __m128i remainder = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(quotient, mask), barrett, 0x00), x);
+                uint32 crc = _mm_extract_epi32(remainder, 1);
+
+                return updateScalar(crc, data, size);
+            }
+        }
+
+        uint32 updatePclmul(uint32 crc, const uchar *data, size_t size) {
+            if (size < 64) {
+                return updateScalar(crc, data, size);
+            }
+
+            __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)data), _mm_cvtsi32_si128(crc));
+            __m128i x1 = _mm_loadu_si128((const __m128i *)(data + 16));
+            __m128i x2 = _mm_loadu_si128((const __m128i *)(data + 32));
+            __m128i x3 = _mm_loadu_si128((const __m128i *)(data + 48));
+            data += 64;
+            size -= 64;
+
+            // Four independent chains hide the latency of the multiplication
+            __m128i constants = loadFoldConstants<512>();
+            for (; size >= 64; data += 64, size -= 64) {
+                x0 = fold(x0, constants, _mm_loadu_si128((const __m128i *)data));
+                x1 = fold(x1, constants, _mm_loadu_si128((const __m128i *)(data + 16)));
+                x2 = fold(x2, constants, _mm_loadu_si128((const __m128i *)(data + 32)));
+                x3 = fold(x3, constants, _mm_loadu_si128((const __m128i *)(data + 48)));
+            }
+
+            constants = loadFoldConstants<128>();
+            __m128i x = fold(x0, constants, x1);
+            x = fold(x, constants, x2);
+            x = fold(x, constants, x3);
+            return finishFolding(x, data, size);
+        }
+
+        ZIPPY_END_TARGET_REGION()
+
+        ZIPPY_BEGIN_TARGET_REGION("avx512f,vpclmulqdq,pclmul,sse4.1")
+
+        namespace {
+            inline __m512i fold512(__m512i x, __m512i constants, __m512i next) {
+                __m512i low = _mm512_clmulepi64_epi128(x, constants, 0x00);
+                __m512i high = _mm512_clmulepi64_epi128(x, constants, 0x11);
+                return _mm512_ternarylogic_epi64(low, high, next, 0x96);
+            }
+
+            template <uint32 distance>
+            inline __m512i broadcastFoldConstants() {
+                constexpr uint64 low = foldConstant(distance + 32), high = foldConstant(distance - 32);
+                return _mm512_broadcast_i32x4(_mm_set_epi64x(high, low));
+            }
+
+            // The lanes 0, 1 and 2 are 48, 32 and 16 bytes before the lane 3: they are folded onto it at once
+            alignas(64) constexpr uint64 LANES_FOLD_CONSTANTS[8] = {
+                foldConstant(416), foldConstant(352), foldConstant(288), foldConstant(224), foldConstant(160), foldConstant(96), 0, 0
+            };
+        }
+
+        uint32 updateAvx512(uint32 crc, const uchar *data, size_t size) {
+            if (size < 256) {
+                return updatePclmul(crc, data, size);
+            }
+
+            __m512i x0 = _mm512_xor_si512(_mm512_loadu_si512(data), _mm512_zextsi128_si512(_mm_cvtsi32_si128(crc)));
+            __m512i x1 = _mm512_loadu_si512(data + 64);
+            __m512i x2 = _mm512_loadu_si512(data + 128);
+            __m512i x3 = _mm512_loadu_si512(data + 192);
+            data += 256;
+            size -= 256;
+
+            __m512i constants = broadcastFoldConstants<2048>();
+            for (; size >= 256; data += 256, size -= 256) {
+                x0 = fold512(x0, constants, _mm512_loadu_si512(data));
+                x1 = fold512(x1, constants, _mm512_loadu_si512(data + 64));
+                x2 = fold512(x2, constants, _mm512_loadu_si512(data + 128));
+                x3 = fold512(x3, constants, _mm512_loadu_si512(data + 192));
+            }
+
+            constants = broadcastFoldConstants<512>();
+            __m512i x = fold512(x0, constants, x1);
+            x = fold512(x, constants, x2);
+            x = fold512(x, constants, x3);
+            for (; size >= 64; data += 64, size -= 64) {
+                x = fold512(x, constants, _mm512_loadu_si512(data));
+            }
+
+            __m512i laneConstants = _mm512_load_si512(LANES_FOLD_CONSTANTS);
+            __m512i products = _mm512_xor_si512(
+                _mm512_clmulepi64_epi128(x, laneConstants, 0x00), _mm512_clmulepi64_epi128(x, laneConstants, 0x11)
+            );
+            __m128i folded = _mm_xor_si128(
+                _mm_xor_si128(_mm512_castsi512_si128(products), _mm512_extracti32x4_epi32(products, 1)),
+                _mm_xor_si128(_mm512_extracti32x4_epi32(products, 2), _mm512_extracti32x4_epi32(x, 3))
+            );
+            return finishFolding(folded, data, size);
+        }
+
+        ZIPPY_END_TARGET_REGION()
+
+        // The streams are long enough for the shifts of their registers to be negligible, and the short ones
+        // take the rest of the data up to the single stream
+        const size_t LONG_STREAM_SIZE = 8192;
+        const size_t SHORT_STREAM_SIZE = 256;
+
+        constexpr ShiftTables LONG_STREAM_SHIFT = generateShiftTables(LONG_STREAM_SIZE, CASTAGNOLI_POLYNOMIAL);
+        constexpr ShiftTables SHORT_STREAM_SHIFT = generateShiftTables(SHORT_STREAM_SIZE, CASTAGNOLI_POLYNOMIAL);
+
+        ZIPPY_BEGIN_TARGET_REGION("sse4.2")
+
+        namespace {
+            inline uint64 load64(const uchar *data) {
+                uint64 word;
+                memcpy(&word, data, sizeof(word));
+                return word;
+            }
+
+            // The registers of three consecutive streams of `streamSize` bytes are computed at once and merged
+            inline const uchar *updateStreams(uint32 &crc, const uchar *data, size_t &size, size_t streamSize, const ShiftTables &shift) {
+                for (; size >= 3 * streamSize; data += 3 * streamSize, size -= 3 * streamSize) {
+                    uint64 crc0 = crc, crc1 = 0, crc2 = 0;
+                    for (const uchar *stream = data, *end = data + streamSize; stream < end; stream += 8) {
+                        crc0 = _mm_crc32_u64(crc0, load64(stream));
+                        crc1 = _mm_crc32_u64(crc1, load64(stream + streamSize));
+                        crc2 = _mm_crc32_u64(crc2, load64(stream + 2 * streamSize));
+                    }
+                    crc = shiftRegister(shift, uint32(crc0)) ^ uint32(crc1);
+                    crc = shiftRegister(shift, crc) ^ uint32(crc2);
+                }
+                return data;
+            }
+        }
+
+        uint32 updateCastagnoliSse42(uint32 crc, const uchar *data, size_t size) {
+#if defined(__x86_64__)
+            data = updateStreams(crc, data, size, LONG_STREAM_SIZE, LONG_STREAM_SHIFT);
+            data = updateStreams(crc, data, size, SHORT_STREAM_SIZE, SHORT_STREAM_SHIFT);
+            uint64 crc64 = crc;
+            for (; size >= 8; data += 8, size -= 8) {
+                crc64 = _mm_crc32_u64(crc64, load64(data));
+            }
+            crc = uint32(crc64);
+#endif
+            for (; size != 0; data++, size--) {
+                crc = _mm_crc32_u8(crc, *data);
+            }
+            return crc;
+        }
+
+        ZIPPY_END_TARGET_REGION()
+#else
+        uint32 updatePclmul(uint32 crc, const uchar *data, size_t size) {
+            return updateScalar(crc, data, size);
+        }
+
+        uint32 updateAvx512(uint32 crc, const uchar *data, size_t size) {
+            return updateScalar(crc, data, size);
+        }
+
+        uint32 updateCastagnoliSse42(uint32 crc, const uchar *data, size_t size) {
+            return updateCastagnoliScalar(crc, data, size);
+        }
+#endif
+
+    }
+
+}
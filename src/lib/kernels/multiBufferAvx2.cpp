@@ -0,0 +1,276 @@
+#include "../../include/lib/kernels/md5Kernels.hpp"
+#include "../../include/lib/kernels/sha256Kernels.hpp"
+#include "../../include/lib/kernels/sha512Kernels.hpp"
+#include "../../include/lib/kernels/keccakKernels.hpp"
+#include "../../include/lib/kernels/blake3Kernels.hpp"
+#include "../../include/lib/kernels/chacha20Kernels.hpp"
+#include "../../include/lib/kernels/xxh3Kernels.hpp"
+
+#include <utility>
+#include <cstring>
+
+#include "../../include/utils/cpuFeatures.hpp"
+
+#if ZIPPY_X86
+#include <immintrin.h>
+
+using namespace std;
+
+ZIPPY_BEGIN_TARGET_REGION("avx2")
+
+namespace {
+
+    // 8 lanes of 32-bit words
+    struct Avx2Ops {
+        typedef __m256i Vector;
+        static const uchar LANES = 8;
+
+        static inline Vector load(const uint32 *source) { return _mm256_loadu_si256((const __m256i *)source); }
+        static inline void store(uint32 *destination, Vector x) { _mm256_storeu_si256((__m256i *)destination, x); }
+        static inline Vector set1(uint32 x) { return _mm256_set1_epi32(x); }
+        static inline Vector add(Vector x, Vector y) { return _mm256_add_epi32(x, y); }
+        static inline Vector bitXor(Vector x, Vector y) { return _mm256_xor_si256(x, y); }
+        static inline Vector bitAnd(Vector x, Vector y) { return _mm256_and_si256(x, y); }
+        static inline Vector bitOr(Vector x, Vector y) { return _mm256_or_si256(x, y); }
+        // (x & y) | (~x & z)
+        static inline Vector choose(Vector x, Vector y, Vector z) { return _mm256_xor_si256(_mm256_and_si256(x, _mm256_xor_si256(y, z)), z); }
+        // (x & y) | (x & z) | (y & z)
+        static inline Vector majority(Vector x, Vector y, Vector z) { return _mm256_or_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_or_si256(x, y))); }
+
+        // The rotations by whole bytes are the shuffles of bytes
+        template <int shift>
+        static inline Vector rotateLeft(Vector x) {
+            if constexpr (shift == 8 || shift == 16) {
+                return rotateRight<32 - shift>(x);
+            } else {
+                return _mm256_or_si256(_mm256_slli_epi32(x, shift), _mm256_srli_epi32(x, 32 - shift));
+            }
+        }
+        template <int shift>
+        static inline Vector rotateRight(Vector x) {
+            if constexpr (shift == 16) {
+                return _mm256_shuffle_epi8(x, _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13));
+            } else if constexpr (shift == 8) {
+                return _mm256_shuffle_epi8(x, _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12, 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12));
+            } else {
+                return _mm256_or_si256(_mm256_srli_epi32(x, shift), _mm256_slli_epi32(x, 32 - shift));
+            }
+        }
+        template <int shift>
+        static inline Vector shiftRight(Vector x) { return _mm256_srli_epi32(x, shift); }
+
+        static inline void loadWords(const uchar *const *data, uint64 offset, Vector *words, bool byteSwap);
+
+        static inline void xorBlocks(const Vector *words, const uchar *input, uchar *output);
+    };
+
+    // 4 lanes of 64-bit words
+    struct Avx2Ops64 {
+        typedef __m256i Vector;
+        static const uchar LANES = 4;
+
+        static inline Vector load(const uint64 *source) { return _mm256_loadu_si256((const __m256i *)source); }
+        static inline void store(uint64 *destination, Vector x) { _mm256_storeu_si256((__m256i *)destination, x); }
+        static inline Vector set1(uint64 x) { return _mm256_set1_epi64x(x); }
+        static inline Vector add(Vector x, Vector y) { return _mm256_add_epi64(x, y); }
+        static inline Vector bitXor(Vector x, Vector y) { return _mm256_xor_si256(x, y); }
+        static inline Vector bitAnd(Vector x, Vector y) { return _mm256_and_si256(x, y); }
+        static inline Vector bitOr(Vector x, Vector y) { return _mm256_or_si256(x, y); }
+        static inline Vector choose(Vector x, Vector y, Vector z) { return Avx2Ops::choose(x, y, z); }
+        static inline Vector majority(Vector x, Vector y, Vector z) { return Avx2Ops::majority(x, y, z); }
+        static inline Vector bitXor3(Vector x, Vector y, Vector z) { return _mm256_xor_si256(_mm256_xor_si256(x, y), z); }
+        static inline Vector bitNot(Vector x) { return _mm256_xor_si256(x, _mm256_set1_epi64x(-1)); }
+        // x ^ (~y & z): the and-not instruction makes the lane complementing of Keccak useless
+        static inline Vector chi(Vector x, Vector y, Vector z) { return _mm256_xor_si256(x, _mm256_andnot_si256(y, z)); }
+        static constexpr bool LANE_COMPLEMENTING = false;
+
+        template <int shift>
+        static inline Vector rotateLeft(Vector x) { return _mm256_or_si256(_mm256_slli_epi64(x, shift), _mm256_srli_epi64(x, 64 - shift)); }
+        template <int shift>
+        static inline Vector rotateRight(Vector x) { return _mm256_or_si256(_mm256_srli_epi64(x, shift), _mm256_slli_epi64(x, 64 - shift)); }
+        template <int shift>
+        static inline Vector shiftRight(Vector x) { return _mm256_srli_epi64(x, shift); }
+
+        // The SHA-512 words are always big endian
+        static inline void loadWords(const uchar *const *data, uint64 offset, Vector *words, bool byteSwap);
+
+        // The little-endian Keccak word at the `offset` of each lane
+        static inline Vector gatherWord(const uchar *const *data, uint64 offset) {
+            uint64 words[LANES];
+            for (uchar lane = 0; lane < LANES; lane++) {
+                memcpy(&words[lane], data[lane] + offset, 8);
+            }
+            return _mm256_loadu_si256((const __m256i *)words);
+        }
+    };
+
+    // The 8 accumulators of XXH3 in 2 registers
+    struct Xxh3Avx2Ops {
+        typedef __m256i Vector;
+        static const uchar VECTORS_COUNT = 2;
+
+        static inline Vector load(const uint64 *source) { return _mm256_loadu_si256((const __m256i *)source); }
+        static inline void store(uint64 *destination, Vector x) { _mm256_storeu_si256((__m256i *)destination, x); }
+
+        static inline void accumulate(Vector *x, const uchar *data, const uchar *secret) {
+            for (uchar i = 0; i < VECTORS_COUNT; i++) {
+                Vector input = _mm256_loadu_si256((const __m256i *)(data + 32 * i));
+                Vector key = _mm256_xor_si256(input, _mm256_loadu_si256((const __m256i *)(secret + 32 * i)));
+                Vector product = _mm256_mul_epu32(key, _mm256_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+                Vector swapped = _mm256_shuffle_epi32(input, _MM_SHUFFLE(1, 0, 3, 2));
+                x[i] = _mm256_add_epi64(x[i], _mm256_add_epi64(product, swapped));
+            }
+        }
+
+        static inline void scramble(Vector *x, const uchar *secret) {
+            Vector prime = _mm256_set1_epi32(xxhash::_xxh3::PRIME32_1);
+            for (uchar i = 0; i < VECTORS_COUNT; i++) {
+                Vector key = _mm256_xor_si256(_mm256_xor_si256(x[i], _mm256_srli_epi64(x[i], 47)), _mm256_loadu_si256((const __m256i *)(secret + 32 * i)));
+                Vector low = _mm256_mul_epu32(key, prime);
+                Vector high = _mm256_mul_epu32(_mm256_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+                x[i] = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+            }
+        }
+    };
+
+}
+
+#include "../../include/lib/kernels/multiBufferRounds.hpp"
+#include "../../include/lib/kernels/keccakRounds.hpp"
+#include "../../include/lib/kernels/blake3Rounds.hpp"
+#include "../../include/lib/kernels/chacha20Rounds.hpp"
+#include "../../include/lib/kernels/xxh3Stripes.hpp"
+
+namespace {
+
+    inline void Avx2Ops::loadWords(const uchar *const *data, uint64 offset, Vector *words, bool byteSwap) {
+        loadTransposedWords8(data, offset, 0, 0, words, byteSwap);
+        loadTransposedWords8(data, offset, 0, 8, words + 8, byteSwap);
+    }
+
+    // The transposition is its own inverse: the words 0..7 and 8..15 of the lanes become the halves of the blocks
+    inline void Avx2Ops::xorBlocks(const Vector *words, const uchar *input, uchar *output) {
+        for (uchar half = 0; half < 2; half++) {
+            Vector rows[8];
+            for (uchar i = 0; i < 8; i++) {
+                rows[i] = words[half * 8 + i];
+            }
+            transpose8x8(rows);
+            for (uchar lane = 0; lane < 8; lane++) {
+                size_t offset = lane * 64 + half * 32;
+                _mm256_storeu_si256((__m256i *)(output + offset), _mm256_xor_si256(rows[lane], _mm256_loadu_si256((const __m256i *)(input + offset))));
+            }
+        }
+    }
+
+    inline void Avx2Ops64::loadWords(const uchar *const *data, uint64 offset, Vector *words, bool) {
+        for (uchar firstWord = 0; firstWord < 16; firstWord += 4) {
+            loadTransposedWords4x64(data, offset, 0, firstWord, words + firstWord);
+        }
+    }
+
+}
+
+namespace md {
+    namespace _md5 {
+        void processBlocksX8Avx2(uint32 *states, const uchar *const *data, uint64 blocksCount) {
+            md5MultiBufferBlocks<Avx2Ops>(states, data, blocksCount);
+        }
+    }
+}
+
+namespace sha2 {
+    namespace _sha256 {
+        void processBlocksX8Avx2(uint32 *states, const uchar *const *data, uint64 blocksCount) {
+            sha256MultiBufferBlocks<Avx2Ops>(states, data, blocksCount);
+        }
+    }
+
+    namespace _sha512 {
+        void processBlocksX4Avx2(uint64 *states, const uchar *const *data, uint64 blocksCount) {
+            sha512MultiBufferBlocks<Avx2Ops64>(states, data, blocksCount);
+        }
+    }
+}
+
+namespace sha3 {
+    namespace _keccak {
+        void absorbBlocksX4Avx2(uint64 *states, const uchar *const *data, uint64 blocksCount, uchar rate) {
+            keccakMultiBufferBlocks<Avx2Ops64>(states, data, blocksCount, rate);
+        }
+    }
+}
+
+namespace blake3 {
+    namespace _blake3 {
+        void hashLanesX8Avx2(
+            const uchar *const *inputs, uchar blocksCount, const uint32 *key, uint64 counter, bool incrementCounter,
+            uchar flags, uchar startFlags, uchar endFlags, uchar *output
+        ) {
+            blake3HashLanes<Avx2Ops>(inputs, blocksCount, key, counter, incrementCounter, flags, startFlags, endFlags, output);
+        }
+    }
+}
+
+namespace chacha20 {
+    namespace _chacha20 {
+        void xorBlocksX8Avx2(const uint32 *state, const uchar *input, uchar *output, size_t groupsCount) {
+            chacha20XorBlocks<Avx2Ops>(state, input, output, groupsCount);
+        }
+    }
+}
+
+namespace xxhash {
+    namespace _xxh3 {
+        void accumulateStripesAvx2(uint64 *accumulators, const uchar *data, size_t stripesCount, uchar &stripeIndex) {
+            xxh3AccumulateStripes<Xxh3Avx2Ops>(accumulators, data, stripesCount, stripeIndex);
+        }
+    }
+}
+
+ZIPPY_END_TARGET_REGION()
+
+#else
+
+// The multi-buffer cores are never selected on the other platforms
+namespace md {
+    namespace _md5 {
+        void processBlocksX8Avx2(uint32 *, const uchar *const *, uint64) {}
+    }
+}
+
+namespace sha2 {
+    namespace _sha256 {
+        void processBlocksX8Avx2(uint32 *, const uchar *const *, uint64) {}
+    }
+
+    namespace _sha512 {
+        void processBlocksX4Avx2(uint64 *, const uchar *const *, uint64) {}
+    }
+}
+
+namespace sha3 {
+    namespace _keccak {
+        void absorbBlocksX4Avx2(uint64 *, const uchar *const *, uint64, uchar) {}
+    }
+}
+
+namespace blake3 {
+    namespace _blake3 {
+        void hashLanesX8Avx2(const uchar *const *, uchar, const uint32 *, uint64, bool, uchar, uchar, uchar, uchar *) {}
+    }
+}
+
+namespace chacha20 {
+    namespace _chacha20 {
+        void xorBlocksX8Avx2(const uint32 *, const uchar *, uchar *, size_t) {}
+    }
+}
+
+namespace xxhash {
+    namespace _xxh3 {
+        void accumulateStripesAvx2(uint64 *, const uchar *, size_t, uchar &) {}
+    }
+}
+
+#endif
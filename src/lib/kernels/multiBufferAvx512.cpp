@@ -0,0 +1,236 @@
+#include "../../include/lib/kernels/md5Kernels.hpp"
+#include "../../include/lib/kernels/sha256Kernels.hpp"
+#include "../../include/lib/kernels/sha512Kernels.hpp"
+#include "../../include/lib/kernels/keccakKernels.hpp"
+#include "../../include/lib/kernels/blake3Kernels.hpp"
+#include "../../include/lib/kernels/xxh3Kernels.hpp"
+
+#include <utility>
+#include <cstring>
+
+#include "../../include/utils/cpuFeatures.hpp"
+
+#if ZIPPY_X86
+#include <immintrin.h>
+
+using namespace std;
+
+ZIPPY_BEGIN_TARGET_REGION("avx512f,avx2")
+
+namespace {
+
+    // 16 lanes of 32-bit words
+    struct Avx512Ops {
+        typedef __m512i Vector;
+        static const uchar LANES = 16;
+
+        static inline Vector load(const uint32 *source) { return _mm512_loadu_si512((const void *)source); }
+        static inline void store(uint32 *destination, Vector x) { _mm512_storeu_si512((void *)destination, x); }
+        static inline Vector set1(uint32 x) { return _mm512_set1_epi32(x); }
+        static inline Vector add(Vector x, Vector y) { return _mm512_add_epi32(x, y); }
+        static inline Vector bitXor(Vector x, Vector y) { return _mm512_xor_si512(x, y); }
+        static inline Vector bitAnd(Vector x, Vector y) { return _mm512_and_si512(x, y); }
+        static inline Vector bitOr(Vector x, Vector y) { return _mm512_or_si512(x, y); }
+        // The ternary logic instruction evaluates any function of three arguments given by its truth table
+        static inline Vector choose(Vector x, Vector y, Vector z) { return _mm512_ternarylogic_epi32(x, y, z, 0xCA); }
+        static inline Vector majority(Vector x, Vector y, Vector z) { return _mm512_ternarylogic_epi32(x, y, z, 0xE8); }
+
+        template <int shift>
+        static inline Vector rotateLeft(Vector x) { return _mm512_rol_epi32(x, shift); }
+        template <int shift>
+        static inline Vector rotateRight(Vector x) { return _mm512_ror_epi32(x, shift); }
+        template <int shift>
+        static inline Vector shiftRight(Vector x) { return _mm512_srli_epi32(x, shift); }
+
+        static inline void loadWords(const uchar *const *data, uint64 offset, Vector *words, bool byteSwap);
+    };
+
+    // 8 lanes of 64-bit words
+    struct Avx512Ops64 {
+        typedef __m512i Vector;
+        static const uchar LANES = 8;
+
+        static inline Vector load(const uint64 *source) { return _mm512_loadu_si512((const void *)source); }
+        static inline void store(uint64 *destination, Vector x) { _mm512_storeu_si512((void *)destination, x); }
+        static inline Vector set1(uint64 x) { return _mm512_set1_epi64(x); }
+        static inline Vector add(Vector x, Vector y) { return _mm512_add_epi64(x, y); }
+        static inline Vector bitXor(Vector x, Vector y) { return _mm512_xor_si512(x, y); }
+        static inline Vector bitAnd(Vector x, Vector y) { return _mm512_and_si512(x, y); }
+        static inline Vector bitOr(Vector x, Vector y) { return _mm512_or_si512(x, y); }
+        static inline Vector choose(Vector x, Vector y, Vector z) { return _mm512_ternarylogic_epi64(x, y, z, 0xCA); }
+        static inline Vector majority(Vector x, Vector y, Vector z) { return _mm512_ternarylogic_epi64(x, y, z, 0xE8); }
+        static inline Vector bitXor3(Vector x, Vector y, Vector z) { return _mm512_ternarylogic_epi64(x, y, z, 0x96); }
+        static inline Vector bitNot(Vector x) { return _mm512_ternarylogic_epi64(x, x, x, 0x55); }
+        // x ^ (~y & z) by a single instruction, so there is nothing to gain from the lane complementing
+        static inline Vector chi(Vector x, Vector y, Vector z) { return _mm512_ternarylogic_epi64(x, y, z, 0xD2); }
+        static constexpr bool LANE_COMPLEMENTING = false;
+
+        template <int shift>
+        static inline Vector rotateLeft(Vector x) { return _mm512_rol_epi64(x, shift); }
+        template <int shift>
+        static inline Vector rotateRight(Vector x) { return _mm512_ror_epi64(x, shift); }
+        template <int shift>
+        static inline Vector shiftRight(Vector x) { return _mm512_srli_epi64(x, shift); }
+
+        // The SHA-512 words are always big endian
+        static inline void loadWords(const uchar *const *data, uint64 offset, Vector *words, bool byteSwap);
+
+        // The little-endian Keccak word at the `offset` of each lane
+        static inline Vector gatherWord(const uchar *const *data, uint64 offset) {
+            uint64 words[LANES];
+            for (uchar lane = 0; lane < LANES; lane++) {
+                memcpy(&words[lane], data[lane] + offset, 8);
+            }
+            return _mm512_loadu_si512((const void *)words);
+        }
+    };
+
+    // All the 8 accumulators of XXH3 in a single register
+    struct Xxh3Avx512Ops {
+        typedef __m512i Vector;
+        static const uchar VECTORS_COUNT = 1;
+
+        static inline Vector load(const uint64 *source) { return _mm512_loadu_si512((const void *)source); }
+        static inline void store(uint64 *destination, Vector x) { _mm512_storeu_si512((void *)destination, x); }
+
+        static inline void accumulate(Vector *x, const uchar *data, const uchar *secret) {
+            Vector input = _mm512_loadu_si512((const void *)data);
+            Vector key = _mm512_xor_si512(input, _mm512_loadu_si512((const void *)secret));
+            Vector product = _mm512_mul_epu32(key, _mm512_shuffle_epi32(key, (_MM_PERM_ENUM)_MM_SHUFFLE(0, 3, 0, 1)));
+            Vector swapped = _mm512_shuffle_epi32(input, (_MM_PERM_ENUM)_MM_SHUFFLE(1, 0, 3, 2));
+            x[0] = _mm512_add_epi64(x[0], _mm512_add_epi64(product, swapped));
+        }
+
+        // The three-way XOR by a single ternary logic instruction
+        static inline void scramble(Vector *x, const uchar *secret) {
+            Vector prime = _mm512_set1_epi32(xxhash::_xxh3::PRIME32_1);
+            Vector key = _mm512_ternarylogic_epi64(x[0], _mm512_srli_epi64(x[0], 47), _mm512_loadu_si512((const void *)secret), 0x96);
+            Vector low = _mm512_mul_epu32(key, prime);
+            Vector high = _mm512_mul_epu32(_mm512_shuffle_epi32(key, (_MM_PERM_ENUM)_MM_SHUFFLE(0, 3, 0, 1)), prime);
+            x[0] = _mm512_add_epi64(low, _mm512_slli_epi64(high, 32));
+        }
+    };
+
+}
+
+#include "../../include/lib/kernels/multiBufferRounds.hpp"
+#include "../../include/lib/kernels/keccakRounds.hpp"
+#include "../../include/lib/kernels/blake3Rounds.hpp"
+#include "../../include/lib/kernels/xxh3Stripes.hpp"
+
+namespace {
+
+    // The lanes are transposed by the groups of 8 with AVX2 and then the halves are combined
+    inline void Avx512Ops::loadWords(const uchar *const *data, uint64 offset, Vector *words, bool byteSwap) {
+        for (uchar firstWord = 0; firstWord < 16; firstWord += 8) {
+            __m256i low[8], high[8];
+            loadTransposedWords8(data, offset, 0, firstWord, low, byteSwap);
+            loadTransposedWords8(data, offset, 8, firstWord, high, byteSwap);
+            for (uchar i = 0; i < 8; i++) {
+                words[firstWord + i] = _mm512_inserti64x4(_mm512_castsi256_si512(low[i]), high[i], 1);
+            }
+        }
+    }
+
+    inline void Avx512Ops64::loadWords(const uchar *const *data, uint64 offset, Vector *words, bool) {
+        for (uchar firstWord = 0; firstWord < 16; firstWord += 4) {
+            __m256i low[4], high[4];
+            loadTransposedWords4x64(data, offset, 0, firstWord, low);
+            loadTransposedWords4x64(data, offset, 4, firstWord, high);
+            for (uchar i = 0; i < 4; i++) {
+                words[firstWord + i] = _mm512_inserti64x4(_mm512_castsi256_si512(low[i]), high[i], 1);
+            }
+        }
+    }
+
+}
+
+namespace md {
+    namespace _md5 {
+        void processBlocksX16Avx512(uint32 *states, const uchar *const *data, uint64 blocksCount) {
+            md5MultiBufferBlocks<Avx512Ops>(states, data, blocksCount);
+        }
+    }
+}
+
+namespace sha2 {
+    namespace _sha256 {
+        void processBlocksX16Avx512(uint32 *states, const uchar *const *data, uint64 blocksCount) {
+            sha256MultiBufferBlocks<Avx512Ops>(states, data, blocksCount);
+        }
+    }
+
+    namespace _sha512 {
+        void processBlocksX8Avx512(uint64 *states, const uchar *const *data, uint64 blocksCount) {
+            sha512MultiBufferBlocks<Avx512Ops64>(states, data, blocksCount);
+        }
+    }
+}
+
+namespace sha3 {
+    namespace _keccak {
+        void absorbBlocksX8Avx512(uint64 *states, const uchar *const *data, uint64 blocksCount, uchar rate) {
+            keccakMultiBufferBlocks<Avx512Ops64>(states, data, blocksCount, rate);
+        }
+    }
+}
+
+namespace blake3 {
+    namespace _blake3 {
+        void hashLanesX16Avx512(
+            const uchar *const *inputs, uchar blocksCount, const uint32 *key, uint64 counter, bool incrementCounter,
+            uchar flags, uchar startFlags, uchar endFlags, uchar *output
+        ) {
+            blake3HashLanes<Avx512Ops>(inputs, blocksCount, key, counter, incrementCounter, flags, startFlags, endFlags, output);
+        }
+    }
+}
+
+namespace xxhash {
+    namespace _xxh3 {
+        void accumulateStripesAvx512(uint64 *accumulators, const uchar *data, size_t stripesCount, uchar &stripeIndex) {
+            xxh3AccumulateStripes<Xxh3Avx512Ops>(accumulators, data, stripesCount, stripeIndex);
+        }
+    }
+}
+
+ZIPPY_END_TARGET_REGION()
+
+#else
+
+// The multi-buffer cores are never selected on the other platforms
+namespace md {
+    namespace _md5 {
+        void processBlocksX16Avx512(uint32 *, const uchar *const *, uint64) {}
+    }
+}
+
+namespace sha2 {
+    namespace _sha256 {
+        void processBlocksX16Avx512(uint32 *, const uchar *const *, uint64) {}
+    }
+
+    namespace _sha512 {
+        void processBlocksX8Avx512(uint64 *, const uchar *const *, uint64) {}
+    }
+}
+
+namespace sha3 {
+    namespace _keccak {
+        void absorbBlocksX8Avx512(uint64 *, const uchar *const *, uint64, uchar) {}
+    }
+}
+
+namespace blake3 {
+    namespace _blake3 {
+        void hashLanesX16Avx512(const uchar *const *, uchar, const uint32 *, uint64, bool, uchar, uchar, uchar, uchar *) {}
+    }
+}
+
+namespace xxhash {
+    namespace _xxh3 {
+        void accumulateStripesAvx512(uint64 *, const uchar *, size_t, uchar &) {}
+    }
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include "../../include/lib/kernels/blake3Kernels.hpp"
+#include "../../include/lib/kernels/chacha20Kernels.hpp"
+#include "../../include/lib/kernels/xxh3Kernels.hpp"
+
+#include <utility>
+
+#include "../../include/utils/cpuFeatures.hpp"
+
+#if ZIPPY_X86
+#include <immintrin.h>
+
+using namespace std;
+
+ZIPPY_BEGIN_TARGET_REGION("ssse3")
+
+namespace {
+
+    // 4 lanes of 32-bit words
+    struct Ssse3Ops {
+        typedef __m128i Vector;
+        static const uchar LANES = 4;
+
+        static inline Vector load(const uint32 *source) { return _mm_loadu_si128((const __m128i *)source); }
+        static inline void store(uint32 *destination, Vector x) { _mm_storeu_si128((__m128i *)destination, x); }
+        static inline Vector set1(uint32 x) { return _mm_set1_epi32(x); }
+        static inline Vector add(Vector x, Vector y) { return _mm_add_epi32(x, y); }
+        static inline Vector bitXor(Vector x, Vector y) { return _mm_xor_si128(x, y); }
+
+        // The rotations by whole bytes are the shuffles of bytes
+        template <int shift>
+        static inline Vector rotateRight(Vector x) {
+            if constexpr (shift == 16) {
+                return _mm_shuffle_epi8(x, _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13));
+            } else if constexpr (shift == 8) {
+                return _mm_shuffle_epi8(x, _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12));
+            } else {
+                return _mm_or_si128(_mm_srli_epi32(x, shift), _mm_slli_epi32(x, 32 - shift));
+            }
+        }
+        template <int shift>
+        static inline Vector rotateLeft(Vector x) {
+            if constexpr (shift == 8 || shift == 16) {
+                return rotateRight<32 - shift>(x);
+            } else {
+                return _mm_or_si128(_mm_slli_epi32(x, shift), _mm_srli_epi32(x, 32 - shift));
+            }
+        }
+
+        // The blocks of 4 x 4 words are transposed by the unpacking. The words are always little endian
+        static inline void loadWords(const uchar *const *data, uint64 offset, Vector *words, bool) {
+            for (uchar firstWord = 0; firstWord < 16; firstWord += 4) {
+                Vector rows[4];
+                for (uchar lane = 0; lane < 4; lane++) {
+                    rows[lane] = _mm_loadu_si128((const __m128i *)(data[lane] + offset + firstWord * 4));
+                }
+                Vector low01 = _mm_unpacklo_epi32(rows[0], rows[1]), high01 = _mm_unpackhi_epi32(rows[0], rows[1]);
+                Vector low23 = _mm_unpacklo_epi32(rows[2], rows[3]), high23 = _mm_unpackhi_epi32(rows[2], rows[3]);
+                words[firstWord] = _mm_unpacklo_epi64(low01, low23);
+                words[firstWord + 1] = _mm_unpackhi_epi64(low01, low23);
+                words[firstWord + 2] = _mm_unpacklo_epi64(high01, high23);
+                words[firstWord + 3] = _mm_unpackhi_epi64(high01, high23);
+            }
+        }
+
+        // The same transposition backwards: each group of 4 words gives 16 bytes of each of the 4 blocks
+        static inline void xorBlocks(const Vector *words, const uchar *input, uchar *output) {
+            for (uchar firstWord = 0; firstWord < 16; firstWord += 4) {
+                const Vector *w = words + firstWord;
+                Vector low01 = _mm_unpacklo_epi32(w[0], w[1]), high01 = _mm_unpackhi_epi32(w[0], w[1]);
+                Vector low23 = _mm_unpacklo_epi32(w[2], w[3]), high23 = _mm_unpackhi_epi32(w[2], w[3]);
+                Vector rows[4] = {
+                    _mm_unpacklo_epi64(low01, low23), _mm_unpackhi_epi64(low01, low23),
+                    _mm_unpacklo_epi64(high01, high23), _mm_unpackhi_epi64(high01, high23)
+                };
+                for (uchar lane = 0; lane < 4; lane++) {
+                    size_t offset = lane * 64 + firstWord * 4;
+                    _mm_storeu_si128((__m128i *)(output + offset), _mm_xor_si128(rows[lane], _mm_loadu_si128((const __m128i *)(input + offset))));
+                }
+            }
+        }
+    };
+
+    // The 8 accumulators of XXH3 in 4 registers, only the SSE2 instructions are needed
+    struct Xxh3Ssse3Ops {
+        typedef __m128i Vector;
+        static const uchar VECTORS_COUNT = 4;
+
+        static inline Vector load(const uint64 *source) { return _mm_loadu_si128((const __m128i *)source); }
+        static inline void store(uint64 *destination, Vector x) { _mm_storeu_si128((__m128i *)destination, x); }
+
+        // Each lane gets the product of the 32-bit halves of its keyed input and the raw input of the neighbouring lane
+        static inline void accumulate(Vector *x, const uchar *data, const uchar *secret) {
+            for (uchar i = 0; i < VECTORS_COUNT; i++) {
+                Vector input = _mm_loadu_si128((const __m128i *)(data + 16 * i));
+                Vector key = _mm_xor_si128(input, _mm_loadu_si128((const __m128i *)(secret + 16 * i)));
+                Vector product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+                Vector swapped = _mm_shuffle_epi32(input, _MM_SHUFFLE(1, 0, 3, 2));
+                x[i] = _mm_add_epi64(x[i], _mm_add_epi64(product, swapped));
+            }
+        }
+
+        // The 64-bit product by the 32-bit prime from the products of the halves
+        static inline void scramble(Vector *x, const uchar *secret) {
+            Vector prime = _mm_set1_epi32(xxhash::_xxh3::PRIME32_1);
+            for (uchar i = 0; i < VECTORS_COUNT; i++) {
+                Vector key = _mm_xor_si128(_mm_xor_si128(x[i], _mm_srli_epi64(x[i], 47)), _mm_loadu_si128((const __m128i *)(secret + 16 * i)));
+                Vector low = _mm_mul_epu32(key, prime);
+                Vector high = _mm_mul_epu32(_mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+                x[i] = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+            }
+        }
+    };
+
+}
+
+#include "../../include/lib/kernels/blake3Rounds.hpp"
+#include "../../include/lib/kernels/chacha20Rounds.hpp"
+#include "../../include/lib/kernels/xxh3Stripes.hpp"
+
+namespace blake3 {
+    namespace _blake3 {
+        void hashLanesX4Ssse3(
+            const uchar *const *inputs, uchar blocksCount, const uint32 *key, uint64 counter, bool incrementCounter,
+            uchar flags, uchar startFlags, uchar endFlags, uchar *output
+        ) {
+            blake3HashLanes<Ssse3Ops>(inputs, blocksCount, key, counter, incrementCounter, flags, startFlags, endFlags, output);
+        }
+    }
+}
+
+namespace chacha20 {
+    namespace _chacha20 {
+        void xorBlocksX4Ssse3(const uint32 *state, const uchar *input, uchar *output, size_t groupsCount) {
+            chacha20XorBlocks<Ssse3Ops>(state, input, output, groupsCount);
+        }
+    }
+}
+
+namespace xxhash {
+    namespace _xxh3 {
+        void accumulateStripesSsse3(uint64 *accumulators, const uchar *data, size_t stripesCount, uchar &stripeIndex) {
+            xxh3AccumulateStripes<Xxh3Ssse3Ops>(accumulators, data, stripesCount, stripeIndex);
+        }
+    }
+}
+
+ZIPPY_END_TARGET_REGION()
+
+#else
+
+// The multi-lane cores are never selected on the other platforms
+namespace blake3 {
+    namespace _blake3 {
+        void hashLanesX4Ssse3(const uchar *const *, uchar, const uint32 *, uint64, bool, uchar, uchar, uchar, uchar *) {}
+    }
+}
+
+namespace chacha20 {
+    namespace _chacha20 {
+        void xorBlocksX4Ssse3(const uint32 *, const uchar *, uchar *, size_t) {}
+    }
+}
+
+namespace xxhash {
+    namespace _xxh3 {
+        void accumulateStripesSsse3(uint64 *, const uchar *, size_t, uchar &) {}
+    }
+}
+
+#endif
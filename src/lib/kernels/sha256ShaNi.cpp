@@ -0,0 +1,86 @@
+#include "../../include/lib/kernels/sha256Kernels.hpp"
+
+#include "../../include/utils/cpuFeatures.hpp"
+
+#if ZIPPY_X86
+#include <immintrin.h>
+#endif
+
+namespace sha2 {
+
+    namespace _sha256 {
+
+#if ZIPPY_X86
+        // Performs four rounds starting from `round` (the message words `current` are already expanded).
+        // The sha256rnds2 instruction performs two rounds, so the upper half of the words is moved down for the second call.
+        // Meanwhile the schedule of the next words is expanded: `next` gets the words `round + 4`..`round + 7`
+        // and `previous` is prepared for the words `round + 12`..`round + 15`
+        #define SHA256_NI_ROUNDS(round, current, previous, next, expandNext, prepareFurther) \
+            message = _mm_add_epi32(current, _mm_load_si128((const __m128i *)(k + round))); \
+            state1 = _mm_sha256rnds2_epu32(state1, state0, message); \
+            if (expandNext) { \
+                next = _mm_add_epi32(next, _mm_alignr_epi8(current, previous, 4)); \
+                next = _mm_sha256msg2_epu32(next, current); \
+            } \
+            message = _mm_shuffle_epi32(message, 0x0E); \
+            state0 = _mm_sha256rnds2_epu32(state0, state1, message); \
+            if (prepareFurther) { \
+                previous = _mm_sha256msg1_epu32(previous, current); \
+            }
+
+        ZIPPY_TARGET("sha,sse4.1")
+        void processBlocksShaNi(uint32 *state, const uchar *data, uint64 blocksCount) {
+            const __m128i byteSwapMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+            // The instructions expect the state to be split into ABEF and CDGH words
+            __m128i temp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0xB1); // CDAB
+            __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(state + 4)), 0x1B); // EFGH
+            __m128i state0 = _mm_alignr_epi8(temp, state1, 8); // ABEF
+            state1 = _mm_blend_epi16(state1, temp, 0xF0); // CDGH
+
+            for (; blocksCount > 0; blocksCount--, data += 64) {
+                __m128i savedState0 = state0, savedState1 = state1;
+                __m128i message;
+                __m128i m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data), byteSwapMask);
+                __m128i m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)), byteSwapMask);
+                __m128i m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)), byteSwapMask);
+                __m128i m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)), byteSwapMask);
+
+                SHA256_NI_ROUNDS(0, m0, m3, m1, false, false);
+                SHA256_NI_ROUNDS(4, m1, m0, m2, false, true);
+                SHA256_NI_ROUNDS(8, m2, m1, m3, false, true);
+                SHA256_NI_ROUNDS(12, m3, m2, m0, true, true);
+                SHA256_NI_ROUNDS(16, m0, m3, m1, true, true);
+                SHA256_NI_ROUNDS(20, m1, m0, m2, true, true);
+                SHA256_NI_ROUNDS(24, m2, m1, m3, true, true);
+                SHA256_NI_ROUNDS(28, m3, m2, m0, true, true);
+                SHA256_NI_ROUNDS(32, m0, m3, m1, true, true);
+                SHA256_NI_ROUNDS(36, m1, m0, m2, true, true);
+                SHA256_NI_ROUNDS(40, m2, m1, m3, true, true);
+                SHA256_NI_ROUNDS(44, m3, m2, m0, true, true);
+                SHA256_NI_ROUNDS(48, m0, m3, m1, true, true);
+                SHA256_NI_ROUNDS(52, m1, m0, m2, true, false);
+                SHA256_NI_ROUNDS(56, m2, m1, m3, true, false);
+                SHA256_NI_ROUNDS(60, m3, m2, m0, false, false);
+
+                state0 = _mm_add_epi32(state0, savedState0);
+                state1 = _mm_add_epi32(state1, savedState1);
+            }
+
+            // Convert the state back to the ABCD and EFGH words
+            temp = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+            state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+            _mm_storeu_si128((__m128i *)state, _mm_blend_epi16(temp, state1, 0xF0)); // DCBA
+            _mm_storeu_si128((__m128i *)(state + 4), _mm_alignr_epi8(state1, temp, 8)); // HGFE
+        }
+
+        #undef SHA256_NI_ROUNDS
+#else
+        void processBlocksShaNi(uint32 *state, const uchar *data, uint64 blocksCount) {
+            processBlocksScalar(state, data, blocksCount);
+        }
+#endif
+
+    }
+
+}
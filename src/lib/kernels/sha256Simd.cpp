@@ -0,0 +1,138 @@
+#include "../../include/lib/kernels/sha256Kernels.hpp"
+
+#include "../../include/utils/cpuFeatures.hpp"
+
+#if ZIPPY_X86
+#include <immintrin.h>
+#endif
+
+namespace sha2 {
+
+    namespace _sha256 {
+
+#if ZIPPY_X86
+        // The shuffle mask that converts four big endian 32-bit words into the native (little endian) ones
+        #define SHA256_BYTE_SWAP_MASK 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL
+
+        ZIPPY_TARGET("ssse3")
+        inline __m128i rightRotate128(__m128i x, int shift) {
+            return _mm_or_si128(_mm_srli_epi32(x, shift), _mm_slli_epi32(x, 32 - shift));
+        }
+
+        // Evaluates the next four words of the schedule: `x0`..`x3` hold the previous sixteen words
+        ZIPPY_TARGET("ssse3")
+        inline __m128i expandSchedule128(__m128i x0, __m128i x1, __m128i x2, __m128i x3) {
+            __m128i w15 = _mm_alignr_epi8(x1, x0, 4); // w[i - 15]
+            __m128i w7 = _mm_alignr_epi8(x3, x2, 4); // w[i - 7]
+            __m128i s0 = _mm_xor_si128(_mm_xor_si128(rightRotate128(w15, 7), rightRotate128(w15, 18)), _mm_srli_epi32(w15, 3));
+            __m128i sum = _mm_add_epi32(_mm_add_epi32(x0, w7), s0);
+
+            // The s1 value depends on w[i - 2], so the words i and i + 1 are evaluated first
+            // and then they are used for the words i + 2 and i + 3
+            __m128i w2 = _mm_shuffle_epi32(x3, 0xFE);
+            __m128i s1 = _mm_xor_si128(_mm_xor_si128(rightRotate128(w2, 17), rightRotate128(w2, 19)), _mm_srli_epi32(w2, 10));
+            sum = _mm_add_epi32(sum, _mm_move_epi64(s1));
+
+            w2 = _mm_shuffle_epi32(sum, 0x40);
+            s1 = _mm_xor_si128(_mm_xor_si128(rightRotate128(w2, 17), rightRotate128(w2, 19)), _mm_srli_epi32(w2, 10));
+            return _mm_add_epi32(sum, _mm_slli_si128(_mm_srli_si128(s1, 8), 8));
+        }
+
+        ZIPPY_TARGET("ssse3")
+        void processBlocksSsse3(uint32 *state, const uchar *data, uint64 blocksCount) {
+            const __m128i byteSwapMask = _mm_set_epi64x(SHA256_BYTE_SWAP_MASK);
+            alignas(16) uint32 wk[64];
+
+            for (; blocksCount > 0; blocksCount--, data += 64) {
+                __m128i x[4];
+                for (uchar i = 0; i < 4; i++) {
+                    x[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + i * 16)), byteSwapMask);
+                    _mm_store_si128((__m128i *)(wk + i * 4), _mm_add_epi32(x[i], _mm_load_si128((const __m128i *)(k + i * 4))));
+                }
+                for (uchar i = 16; i < 64; i += 4) {
+                    __m128i next = expandSchedule128(x[0], x[1], x[2], x[3]);
+                    x[0] = x[1]; x[1] = x[2]; x[2] = x[3]; x[3] = next;
+                    _mm_store_si128((__m128i *)(wk + i), _mm_add_epi32(next, _mm_load_si128((const __m128i *)(k + i))));
+                }
+
+                compressScheduledBlock(state, wk);
+            }
+        }
+
+        ZIPPY_TARGET("avx2")
+        inline __m256i rightRotate256(__m256i x, int shift) {
+            return _mm256_or_si256(_mm256_srli_epi32(x, shift), _mm256_slli_epi32(x, 32 - shift));
+        }
+
+        // The same as `expandSchedule128`, but each 128-bit lane holds the schedule of its own block
+        ZIPPY_TARGET("avx2")
+        inline __m256i expandSchedule256(__m256i x0, __m256i x1, __m256i x2, __m256i x3) {
+            __m256i w15 = _mm256_alignr_epi8(x1, x0, 4);
+            __m256i w7 = _mm256_alignr_epi8(x3, x2, 4);
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rightRotate256(w15, 7), rightRotate256(w15, 18)), _mm256_srli_epi32(w15, 3));
+            __m256i sum = _mm256_add_epi32(_mm256_add_epi32(x0, w7), s0);
+
+            const __m256i lowHalfMask = _mm256_set_epi32(0, 0, -1, -1, 0, 0, -1, -1);
+            __m256i w2 = _mm256_shuffle_epi32(x3, 0xFE);
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rightRotate256(w2, 17), rightRotate256(w2, 19)), _mm256_srli_epi32(w2, 10));
+            sum = _mm256_add_epi32(sum, _mm256_and_si256(s1, lowHalfMask));
+
+            w2 = _mm256_shuffle_epi32(sum, 0x40);
+            s1 = _mm256_xor_si256(_mm256_xor_si256(rightRotate256(w2, 17), rightRotate256(w2, 19)), _mm256_srli_epi32(w2, 10));
+            return _mm256_add_epi32(sum, _mm256_andnot_si256(lowHalfMask, s1));
+        }
+
+        // Adds the round constants to the words `i`..`i + 3` of both schedules and splits them by blocks
+        ZIPPY_TARGET("avx2")
+        inline void storeScheduledWords256(uint32 (*wk)[64], uchar i, __m256i words) {
+            __m256i sum = _mm256_add_epi32(words, _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)(k + i))));
+            _mm_store_si128((__m128i *)(wk[0] + i), _mm256_castsi256_si128(sum));
+            _mm_store_si128((__m128i *)(wk[1] + i), _mm256_extracti128_si256(sum, 1));
+        }
+
+        ZIPPY_TARGET("avx2")
+        void processBlocksAvx2(uint32 *state, const uchar *data, uint64 blocksCount) {
+            const __m256i byteSwapMask = _mm256_set_epi64x(SHA256_BYTE_SWAP_MASK, SHA256_BYTE_SWAP_MASK);
+            alignas(32) uint32 wk[2][64];
+
+            for (; blocksCount >= 2; blocksCount -= 2, data += 128) {
+                __m256i x[4];
+                for (uchar i = 0; i < 4; i++) {
+                    // The low lane takes the words of the first block and the high lane takes the words of the second one
+                    __m256i words = _mm256_inserti128_si256(
+                        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(data + i * 16))),
+                        _mm_loadu_si128((const __m128i *)(data + 64 + i * 16)), 1
+                    );
+                    x[i] = _mm256_shuffle_epi8(words, byteSwapMask);
+                    storeScheduledWords256(wk, i * 4, x[i]);
+                }
+                for (uchar i = 16; i < 64; i += 4) {
+                    __m256i next = expandSchedule256(x[0], x[1], x[2], x[3]);
+                    x[0] = x[1]; x[1] = x[2]; x[2] = x[3]; x[3] = next;
+                    storeScheduledWords256(wk, i, next);
+                }
+
+                compressScheduledBlock(state, wk[0]);
+                compressScheduledBlock(state, wk[1]);
+            }
+
+            // The odd block left
+            if (blocksCount > 0) {
+                processBlocksSsse3(state, data, blocksCount);
+            }
+        }
+
+        #undef SHA256_BYTE_SWAP_MASK
+#else
+        void processBlocksSsse3(uint32 *state, const uchar *data, uint64 blocksCount) {
+            processBlocksScalar(state, data, blocksCount);
+        }
+
+        void processBlocksAvx2(uint32 *state, const uchar *data, uint64 blocksCount) {
+            processBlocksScalar(state, data, blocksCount);
+        }
+#endif
+
+    }
+
+}
@@ -0,0 +1,190 @@
+#include "../../include/lib/kernels/sha512Kernels.hpp"
+
+#include "../../include/utils/cpuFeatures.hpp"
+
+#if ZIPPY_X86
+#include <immintrin.h>
+#endif
+
+namespace sha2 {
+
+    namespace _sha512 {
+
+#if ZIPPY_X86
+        // The shuffle mask that converts two big endian 64-bit words into the native (little endian) ones
+        #define SHA512_BYTE_SWAP_MASK 0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL
+
+        ZIPPY_TARGET("ssse3")
+        inline __m128i rightRotate128(__m128i x, int shift) {
+            return _mm_or_si128(_mm_srli_epi64(x, shift), _mm_slli_epi64(x, 64 - shift));
+        }
+
+        // Evaluates the next two words of the schedule: `x` holds the previous sixteen words, two per vector.
+        // Unlike SHA-256, the words i and i + 1 don't depend on each other: both depend on the words i - 2 and i - 1 from `x[7]`
+        ZIPPY_TARGET("ssse3")
+        inline __m128i expandSchedule128(const __m128i *x) {
+            __m128i w15 = _mm_alignr_epi8(x[1], x[0], 8); // w[i - 15]
+            __m128i w7 = _mm_alignr_epi8(x[5], x[4], 8); // w[i - 7]
+            __m128i s0 = _mm_xor_si128(_mm_xor_si128(rightRotate128(w15, 1), rightRotate128(w15, 8)), _mm_srli_epi64(w15, 7));
+            __m128i s1 = _mm_xor_si128(_mm_xor_si128(rightRotate128(x[7], 19), rightRotate128(x[7], 61)), _mm_srli_epi64(x[7], 6));
+            return _mm_add_epi64(_mm_add_epi64(x[0], s0), _mm_add_epi64(w7, s1));
+        }
+
+        ZIPPY_TARGET("ssse3")
+        void processBlocksSsse3(uint64 *state, const uchar *data, uint64 blocksCount) {
+            const __m128i byteSwapMask = _mm_set_epi64x(SHA512_BYTE_SWAP_MASK);
+            alignas(16) uint64 wk[80];
+
+            for (; blocksCount > 0; blocksCount--, data += 128) {
+                __m128i x[8];
+                for (uchar i = 0; i < 8; i++) {
+                    x[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + i * 16)), byteSwapMask);
+                    _mm_store_si128((__m128i *)(wk + i * 2), _mm_add_epi64(x[i], _mm_load_si128((const __m128i *)(k + i * 2))));
+                }
+                for (uchar i = 16; i < 80; i += 2) {
+                    __m128i next = expandSchedule128(x);
+                    for (uchar j = 0; j < 7; j++) {
+                        x[j] = x[j + 1];
+                    }
+                    x[7] = next;
+                    _mm_store_si128((__m128i *)(wk + i), _mm_add_epi64(next, _mm_load_si128((const __m128i *)(k + i))));
+                }
+
+                compressScheduledBlock(state, wk);
+            }
+        }
+
+        ZIPPY_TARGET("avx2")
+        inline __m256i rightRotate256(__m256i x, int shift) {
+            return _mm256_or_si256(_mm256_srli_epi64(x, shift), _mm256_slli_epi64(x, 64 - shift));
+        }
+
+        // The same as `expandSchedule128`, but each 128-bit lane holds the schedule of its own block
+        ZIPPY_TARGET("avx2")
+        inline __m256i expandSchedule256(const __m256i *x) {
+            __m256i w15 = _mm256_alignr_epi8(x[1], x[0], 8);
+            __m256i w7 = _mm256_alignr_epi8(x[5], x[4], 8);
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rightRotate256(w15, 1), rightRotate256(w15, 8)), _mm256_srli_epi64(w15, 7));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rightRotate256(x[7], 19), rightRotate256(x[7], 61)), _mm256_srli_epi64(x[7], 6));
+            return _mm256_add_epi64(_mm256_add_epi64(x[0], s0), _mm256_add_epi64(w7, s1));
+        }
+
+        // Adds the round constants to the words `i` and `i + 1` of both schedules and splits them by blocks
+        ZIPPY_TARGET("avx2")
+        inline void storeScheduledWords256(uint64 (*wk)[80], uchar i, __m256i words) {
+            __m256i sum = _mm256_add_epi64(words, _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)(k + i))));
+            _mm_store_si128((__m128i *)(wk[0] + i), _mm256_castsi256_si128(sum));
+            _mm_store_si128((__m128i *)(wk[1] + i), _mm256_extracti128_si256(sum, 1));
+        }
+
+        // The rounds are compiled with BMI2, so the rotations don't need the extra moves (rorx)
+        ZIPPY_TARGET("avx2,bmi2")
+        void processBlocksAvx2(uint64 *state, const uchar *data, uint64 blocksCount) {
+            const __m256i byteSwapMask = _mm256_set_epi64x(SHA512_BYTE_SWAP_MASK, SHA512_BYTE_SWAP_MASK);
+            alignas(32) uint64 wk[2][80];
+
+            for (; blocksCount >= 2; blocksCount -= 2, data += 256) {
+                __m256i x[8];
+                for (uchar i = 0; i < 8; i++) {
+                    // The low lane takes the words of the first block and the high lane takes the words of the second one
+                    __m256i words = _mm256_inserti128_si256(
+                        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(data + i * 16))),
+                        _mm_loadu_si128((const __m128i *)(data + 128 + i * 16)), 1
+                    );
+                    x[i] = _mm256_shuffle_epi8(words, byteSwapMask);
+                    storeScheduledWords256(wk, i * 2, x[i]);
+                }
+                for (uchar i = 16; i < 80; i += 2) {
+                    __m256i next = expandSchedule256(x);
+                    for (uchar j = 0; j < 7; j++) {
+                        x[j] = x[j + 1];
+                    }
+                    x[7] = next;
+                    storeScheduledWords256(wk, i, next);
+                }
+
+                compressScheduledBlock(state, wk[0]);
+                compressScheduledBlock(state, wk[1]);
+            }
+
+            // The odd block left
+            if (blocksCount > 0) {
+                processBlocksSsse3(state, data, blocksCount);
+            }
+        }
+
+        // AVX-512 has the native rotations, and the three-way XOR is a single ternary logic instruction
+        ZIPPY_TARGET("avx512f,avx512bw")
+        inline __m512i expandSchedule512(const __m512i *x) {
+            __m512i w15 = _mm512_alignr_epi8(x[1], x[0], 8);
+            __m512i w7 = _mm512_alignr_epi8(x[5], x[4], 8);
+            __m512i s0 = _mm512_ternarylogic_epi64(_mm512_ror_epi64(w15, 1), _mm512_ror_epi64(w15, 8), _mm512_srli_epi64(w15, 7), 0x96);
+            __m512i s1 = _mm512_ternarylogic_epi64(_mm512_ror_epi64(x[7], 19), _mm512_ror_epi64(x[7], 61), _mm512_srli_epi64(x[7], 6), 0x96);
+            return _mm512_add_epi64(_mm512_add_epi64(x[0], s0), _mm512_add_epi64(w7, s1));
+        }
+
+        ZIPPY_TARGET("avx512f,avx512bw")
+        inline void storeScheduledWords512(uint64 (*wk)[80], uchar i, __m512i words) {
+            __m512i sum = _mm512_add_epi64(words, _mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)(k + i))));
+            _mm_store_si128((__m128i *)(wk[0] + i), _mm512_castsi512_si128(sum));
+            _mm_store_si128((__m128i *)(wk[1] + i), _mm512_extracti32x4_epi32(sum, 1));
+            _mm_store_si128((__m128i *)(wk[2] + i), _mm512_extracti32x4_epi32(sum, 2));
+            _mm_store_si128((__m128i *)(wk[3] + i), _mm512_extracti32x4_epi32(sum, 3));
+        }
+
+        ZIPPY_TARGET("avx512f,avx512bw,avx2,bmi2")
+        void processBlocksAvx512(uint64 *state, const uchar *data, uint64 blocksCount) {
+            const __m512i byteSwapMask = _mm512_set_epi64(
+                SHA512_BYTE_SWAP_MASK, SHA512_BYTE_SWAP_MASK, SHA512_BYTE_SWAP_MASK, SHA512_BYTE_SWAP_MASK
+            );
+            alignas(64) uint64 wk[4][80];
+
+            for (; blocksCount >= 4; blocksCount -= 4, data += 512) {
+                __m512i x[8];
+                for (uchar i = 0; i < 8; i++) {
+                    // The quarter j of the register takes the words of the block j
+                    __m512i words = _mm512_castsi128_si512(_mm_loadu_si128((const __m128i *)(data + i * 16)));
+                    words = _mm512_inserti32x4(words, _mm_loadu_si128((const __m128i *)(data + 128 + i * 16)), 1);
+                    words = _mm512_inserti32x4(words, _mm_loadu_si128((const __m128i *)(data + 256 + i * 16)), 2);
+                    words = _mm512_inserti32x4(words, _mm_loadu_si128((const __m128i *)(data + 384 + i * 16)), 3);
+                    x[i] = _mm512_shuffle_epi8(words, byteSwapMask);
+                    storeScheduledWords512(wk, i * 2, x[i]);
+                }
+                for (uchar i = 16; i < 80; i += 2) {
+                    __m512i next = expandSchedule512(x);
+                    for (uchar j = 0; j < 7; j++) {
+                        x[j] = x[j + 1];
+                    }
+                    x[7] = next;
+                    storeScheduledWords512(wk, i, next);
+                }
+
+                for (uchar j = 0; j < 4; j++) {
+                    compressScheduledBlock(state, wk[j]);
+                }
+            }
+
+            // Up to three blocks left
+            if (blocksCount > 0) {
+                processBlocksAvx2(state, data, blocksCount);
+            }
+        }
+
+        #undef SHA512_BYTE_SWAP_MASK
+#else
+        void processBlocksSsse3(uint64 *state, const uchar *data, uint64 blocksCount) {
+            processBlocksScalar(state, data, blocksCount);
+        }
+
+        void processBlocksAvx2(uint64 *state, const uchar *data, uint64 blocksCount) {
+            processBlocksScalar(state, data, blocksCount);
+        }
+
+        void processBlocksAvx512(uint64 *state, const uchar *data, uint64 blocksCount) {
+            processBlocksScalar(state, data, blocksCount);
+        }
+#endif
+
+    }
+
+}
@@ -1,19 +1,22 @@
 #include "../include/lib/md5.hpp"
 
 #include <vector>
-#include <istream>
+#include <cstring>
+#include <algorithm>
+#include <utility>
 
-#include "../include/utils/hexadecimal.hpp"
 #include "../include/utils/fileValidator.hpp"
+#include "../include/utils/cpuFeatures.hpp"
+#include "../include/lib/kernels/md5Kernels.hpp"
+#include "../include/lib/multiBuffer.hpp"
 
 namespace md {
 
     namespace _md5 {
-        const uchar CHUNK_SIZE_IN_BYTES = 64;
-        // 0 means that the MD5 algorithm does not have any limitations around the size of the input message.
-        // However this program can't handle the message longer than 2 ^ 64 - 1 bytes
-        // due to the istream interface and the file systems limitations.
-        const uint64 MAX_MESSAGE_SIZE = 0;
+        const uchar CHUNK_SIZE_IN_BYTES = Md5Hasher::BLOCK_SIZE_IN_BYTES;
+        const uint32 INITIAL_STATE[] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476 };
+        // The MD5 algorithm does not have any limitations around the size of the input message:
+        // only the lowest 64 bits of the message length (in bits) are appended during the padding.
 
         // Use with care: don't pass the number higher than 31 as the `shift` value.
         // This function don't perform any edge-case checks
@@ -21,7 +24,7 @@ namespace md {
             return (original << shift) | (original >> (32 - shift));
         }
 
-        inline void packBlocksFromChunks(uchar *chunk, uint32* blocks) {
+        inline void packBlocksFromChunks(const uchar *chunk, uint32* blocks) {
             // Little endian
             for (uchar i = 0; i < 16; i++) {
                 blocks[i] = chunk[i * 4 + 3] << 24 | chunk[i * 4 + 2] << 16 | chunk[i * 4 + 1] << 8 | chunk[i * 4];
@@ -40,85 +43,138 @@ namespace md {
             outputBuffer[0] = (arg << 56) >> 56; // left shift for 56 bits | then right shift for 56 bits
         }
 
-        inline void fillChunk(uchar *chunk, istream &stream) {
-            stream.read((char *)chunk, CHUNK_SIZE_IN_BYTES);
+        // The round `i` is generated at compile time: the round function, the message index, the constant and the shift
+        // are all known, so the rounds compile into the straight-line code.
+        // The variables aren't moved between the rounds: the round `i` uses them shifted by `i`,
+        // so they are back in their places after 64 rounds
+        template <size_t i>
+        inline void round(uint32 *v, const uint32 *M) {
+            uint32 &a = v[(64 - i) % 4], &b = v[(65 - i) % 4], &c = v[(66 - i) % 4], &d = v[(67 - i) % 4];
+            uint32 F;
+            if constexpr (i < 16) {
+                F = d ^ (b & (c ^ d)); // Round 1: (b & c) | (~b & d)
+            } else if constexpr (i < 32) {
+                F = c ^ (d & (b ^ c)); // Round 2: (d & b) | (~d & c)
+            } else if constexpr (i < 48) {
+                F = b ^ c ^ d; // Round 3
+            } else {
+                F = c ^ (b | ~d); // Round 4
+            }
+            a = b + leftRotate(a + F + K[i] + M[messageIndex(i)], s[i]);
+        }
+
+        template <size_t... rounds>
+        inline void compressBlock(uint32 *v, const uint32 *M, index_sequence<rounds...>) {
+            (round<rounds>(v, M), ...);
         }
 
-        inline void processChunk(uchar *chunk, uint32 &A, uint32 &B, uint32 &C, uint32 &D) {
-            // Those values indicates the shift values for each operation
-            uchar s[] = {
-                7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
-                5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
-                4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
-                6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
-            };
-
-            uint32 K[] = {
-                0xD76AA478, 0xE8C7B756, 0x242070DB, 0xC1BDCEEE, 0xF57C0FAF, 0x4787C62A, 0xA8304613, 0xFD469501,
-                0x698098D8, 0x8B44F7AF, 0xFFFF5BB1, 0x895CD7BE, 0x6B901122, 0xFD987193, 0xA679438E, 0x49B40821,
-                0xF61E2562, 0xC040B340, 0x265E5A51, 0xE9B6C7AA, 0xD62F105D, 0x02441453, 0xD8A1E681, 0xE7D3FBC8,
-                0x21E1CDE6, 0xC33707D6, 0xF4D50D87, 0x455A14ED, 0xA9E3E905, 0xFCEFA3F8, 0x676F02D9, 0x8D2A4C8A,
-                0xFFFA3942, 0x8771F681, 0x6D9D6122, 0xFDE5380C, 0xA4BEEA44, 0x4BDECFA9, 0xF6BB4B60, 0xBEBFBC70,
-                0x289B7EC6, 0xEAA127FA, 0xD4EF3085, 0x04881D05, 0xD9D4D039, 0xE6DB99E5, 0x1FA27CF8, 0xC4AC5665,
-                0xF4292244, 0x432AFF97, 0xAB9423A7, 0xFC93A039, 0x655B59C3, 0x8F0CCC92, 0xFFEFF47D, 0x85845DD1,
-                0x6FA87E4F, 0xFE2CE6E0, 0xA3014314, 0x4E0811A1, 0xF7537E82, 0xBD3AF235, 0x2AD7D2BB, 0xEB86D391
-            };
-
-            uint32 M[16];
-            packBlocksFromChunks(chunk, M); // Break chunk into sixteen 32-bit words
-
-            // Initialize variables for the current chunk
-            uint32 a0 = A, b0 = B, c0 = C, d0 = D;
-
-            // Rounds
-            for (uchar i = 0; i < 64; i++) {
-                uint32 F, g;
-                if (i < 16) {
-                    F = (b0 & c0) | (~b0 & d0); g = i; // Round 1
-                } else if (i < 32) {
-                    F = (d0 & b0) | (~d0 & c0); g = (5 * i + 1) % 16; // Round 2
-                } else if (i < 48) {
-                    F = b0 ^ c0 ^ d0; g = (3 * i + 5) % 16; // Round 3
-                } else {
-                    F = c0 ^ (b0 | ~d0); g = (7 * i) % 16; // Round 4
-                }
-
-                F += a0 + K[i] + M[g]; a0 = d0; d0 = c0; c0 = b0; // Update intermediate buffers
-                b0 = b0 + leftRotate(F, s[i]); // Perform shift
+        // Processes `blocksCount` consecutive 64-bytes blocks of `data`.
+        // The intermediate hash values stay in the local variables for the whole run,
+        // they are loaded from and stored to the `state` only once
+        inline void processBlocks(uint32 *state, const uchar *data, uint64 blocksCount) {
+            uint32 A = state[0], B = state[1], C = state[2], D = state[3];
+
+            for (; blocksCount > 0; blocksCount--, data += CHUNK_SIZE_IN_BYTES) {
+                uint32 M[16];
+                packBlocksFromChunks(data, M); // Break chunk into sixteen 32-bit words
+
+                uint32 v[4] = { A, B, C, D };
+                compressBlock(v, M, make_index_sequence<64>());
+
+                // Update hash buffers
+                A += v[0]; B += v[1]; C += v[2]; D += v[3];
             }
-            // Update hash buffers
-            A += a0; B += b0; C += c0; D += d0;
+
+            state[0] = A; state[1] = B; state[2] = C; state[3] = D;
+        }
+
+        MultiBufferBlocksFunction *selectMultiBufferFunction(uchar &lanesCount) {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx512) && features.avx512f && features.avx2) {
+                lanesCount = 16;
+                return processBlocksX16Avx512;
+            }
+            if (implementation == Implementation::Avx512) {
+                ensureImplementationSupported(implementation, false);
+            }
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx2) && features.avx2) {
+                lanesCount = 8;
+                return processBlocksX8Avx2;
+            }
+            if (implementation == Implementation::Avx2) {
+                ensureImplementationSupported(implementation, false);
+            }
+            return nullptr;
+        }
+
+        // The words of the state are stored in the little-endian order
+        inline Md5Digest toDigest(const uint32 *state) {
+            Md5Digest digest;
+            for (uchar i = 0; i < 4; i++) {
+                digest[i * 4] = state[i];
+                digest[i * 4 + 1] = state[i] >> 8;
+                digest[i * 4 + 2] = state[i] >> 16;
+                digest[i * 4 + 3] = state[i] >> 24;
+            }
+            return digest;
         }
     }
 
-    inline string md5FromStream(istream &stream, uint64 messageSize) {
-        uint64 iterations = messageSize >> 6; // Evaluate the count of iterations (2 ^ 6 == 64 (bits))
-        uint64 messageSizeInBits = messageSize << 3;
+    Md5Hasher::Md5Hasher() {
+        reset();
+    }
+
+    void Md5Hasher::reset() {
+        memcpy(state, _md5::INITIAL_STATE, sizeof(state));
+        bufferSize = 0;
+        messageSize = 0;
+    }
 
-        uint32 A = 0x67452301;
-        uint32 B = 0xEFCDAB89;
-        uint32 C = 0x98BADCFE;
-        uint32 D = 0x10325476;
+    void Md5Hasher::update(const uchar *data, size_t size) {
+        messageSize += size;
 
-        uchar chunk[_md5::CHUNK_SIZE_IN_BYTES];
+        // Complete the block that has been left incomplete by the previous portion of data
+        if (bufferSize > 0) {
+            size_t bytesToCopy = min(size, size_t(_md5::CHUNK_SIZE_IN_BYTES - bufferSize));
+            memcpy(buffer + bufferSize, data, bytesToCopy);
+            bufferSize += bytesToCopy;
+            data += bytesToCopy;
+            size -= bytesToCopy;
 
-        // Iterate through the main part of message body
-        for (; iterations > 0; iterations--) {
-            _md5::fillChunk(chunk, stream);
-            _md5::processChunk(chunk, A, B, C, D);
+            if (bufferSize < _md5::CHUNK_SIZE_IN_BYTES) {
+                return;
+            }
+            _md5::processBlocks(state, buffer, 1);
+            bufferSize = 0;
         }
 
+        // The complete blocks are processed right from the passed data without any copying
+        uint64 blocksCount = size / _md5::CHUNK_SIZE_IN_BYTES;
+        _md5::processBlocks(state, data, blocksCount);
+        data += blocksCount * _md5::CHUNK_SIZE_IN_BYTES;
+        size -= blocksCount * _md5::CHUNK_SIZE_IN_BYTES;
+
+        // Keep the rest of data until the next portion (or the final call)
+        memcpy(buffer, data, size);
+        bufferSize = size;
+    }
+
+    Md5Digest Md5Hasher::final() {
+        uint64 messageSizeInBits = messageSize << 3;
+        uchar *chunk = buffer;
+
         // Process the final chunk(s) of data
-        uchar bytesLeft = messageSize % _md5::CHUNK_SIZE_IN_BYTES;
-        stream.read((char *)chunk, bytesLeft);
+        uchar bytesLeft = bufferSize;
 
         // 1 set bit and 7 unset bits
         chunk[bytesLeft] = 0x80; // == 128, == 0b1000000
 
-        // // We have to determine do we have enough space in the final chunk to fill it
-        // // with at least one set (1) bit and 64 bits that contains the length of the original message
-        // // The normal chunk size is 64 bytes. We need at least 9 of them (1 for a set bit and 8 for the length)
-        // // So the `bytesLeft` value shouldn't exceed 64 - 9 = 55
+        // We have to determine do we have enough space in the final chunk to fill it
+        // with at least one set (1) bit and 64 bits that contains the length of the original message
+        // The normal chunk size is 64 bytes. We need at least 9 of them (1 for a set bit and 8 for the length)
+        // So the `bytesLeft` value shouldn't exceed 64 - 9 = 55
         uchar i = bytesLeft + 1;
         if (bytesLeft < 56) {
             // Fill the rest part of chunk with the zeroes
@@ -132,7 +188,7 @@ namespace md {
             }
 
             // Process pre-final chunk
-            _md5::processChunk(chunk, A, B, C, D);
+            _md5::processBlocks(state, chunk, 1);
 
             // Fill the final chunk
             for (i = 0; i < 56; i++) {
@@ -143,13 +199,69 @@ namespace md {
         // Add the 64 bits at the end of the message that is represents the length of input message in bits
         _md5::unpackUint64(messageSizeInBits, chunk + 56);
 
-        _md5::processChunk(chunk, A, B, C, D);
+        _md5::processBlocks(state, chunk, 1);
+
+        Md5Digest result = _md5::toDigest(state);
+        reset();
+
+        return result;
+    }
+
+    Md5Digest md5FromReader(InputReader &reader) {
+        Md5Hasher hasher;
+        const uchar *data;
+        size_t size;
+
+        // Feed the hasher until the end of input: its size doesn't have to be known up front
+        while (reader.next(data, size)) {
+            hasher.update(data, size);
+        }
+
+        return hasher.final();
+    }
 
-        return toHex(vector<uint32> { A, B, C, D }, true, false);
+    Md5Digest md5(const string &filePath, const InputOptions &options) {
+        return validateFileForHashFunction(filePath, md5FromReader, options);
     }
 
-    string md5(string filePath) {
-        return validateFileForHashFunction(filePath, _md5::MAX_MESSAGE_SIZE, md5FromStream);
+    vector<Md5Digest> md5Batch(const vector<string> &filePaths, const InputOptions &options) {
+        uchar lanesCount;
+        _md5::MultiBufferBlocksFunction *processBlocks = _md5::selectMultiBufferFunction(lanesCount);
+
+        if (processBlocks == nullptr || filePaths.size() < MULTI_BUFFER_MIN_BATCH_SIZE) {
+            vector<Md5Digest> digests;
+            for (const string &filePath : filePaths) {
+                digests.push_back(md5(filePath, options));
+            }
+            return digests;
+        }
+
+        MultiBufferEngine<uint32> engine({ _md5::CHUNK_SIZE_IN_BYTES, 4, _md5::INITIAL_STATE, 8, false }, processBlocks, lanesCount);
+        return hashFilesWithMultiBuffer<uint32, Md5Digest>(
+            filePaths, options, engine, _md5::toDigest, [&](const string &filePath) { return md5(filePath, options); }
+        );
+    }
+
+    vector<Md5Digest> md5BatchBuffers(const vector<ByteView> &messages) {
+        auto hashBuffer = [](const ByteView &message) {
+            Md5Hasher hasher;
+            hasher.update(message.data, message.size);
+            return hasher.final();
+        };
+
+        uchar lanesCount;
+        _md5::MultiBufferBlocksFunction *processBlocks = _md5::selectMultiBufferFunction(lanesCount);
+
+        if (processBlocks == nullptr || messages.size() < MULTI_BUFFER_MIN_BATCH_SIZE) {
+            vector<Md5Digest> digests;
+            for (const ByteView &message : messages) {
+                digests.push_back(hashBuffer(message));
+            }
+            return digests;
+        }
+
+        MultiBufferEngine<uint32> engine({ _md5::CHUNK_SIZE_IN_BYTES, 4, _md5::INITIAL_STATE, 8, false }, processBlocks, lanesCount);
+        return hashBuffersWithMultiBuffer<uint32, Md5Digest>(messages, engine, _md5::toDigest, hashBuffer);
     }
 
 }
@@ -0,0 +1,262 @@
+#include "../include/lib/multiDigest.hpp"
+#include "../include/utils/stats.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <new>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+    // The single producer publishes the portions of the input into the slots in turn, and every consumer takes all of them in order.
+    // A slot is reused once all the consumers have released it, so the buffers are never written while they are being hashed
+    class BufferRing {
+    public:
+        // The buffers are needed only for the stream input: the portions of the mapped input point right into the mapping
+        BufferRing(size_t consumersCount, bool allocateBuffers)
+            : consumersCount(consumersCount), publishedCount(0), isClosed(false), slots(MULTI_DIGEST_RING_SLOTS_COUNT) {
+            if (allocateBuffers) {
+                for (Slot &slot : slots) {
+                    slot.buffer = (uchar *)::operator new[](MULTI_DIGEST_RING_SLOT_SIZE, align_val_t(READ_BUFFER_ALIGNMENT));
+                }
+            }
+        }
+
+        ~BufferRing() {
+            for (Slot &slot : slots) {
+                if (slot.buffer != nullptr) {
+                    ::operator delete[](slot.buffer, align_val_t(READ_BUFFER_ALIGNMENT));
+                }
+            }
+        }
+
+        BufferRing(const BufferRing &) = delete;
+        BufferRing &operator=(const BufferRing &) = delete;
+
+        // Waits until the next slot is released by all the consumers and returns its buffer (nullptr if there are no buffers)
+        uchar *acquire() {
+            unique_lock<mutex> guard(lock);
+            Slot &slot = slots[publishedCount % slots.size()];
+            isReleased.wait(guard, [&slot] { return slot.pendingConsumersCount == 0; });
+            return slot.buffer;
+        }
+
+        // Publishes the portion into the acquired slot. The data may be either in the slot's buffer or in the memory mapping
+        void publish(const uchar *data, size_t size) {
+            {
+                lock_guard<mutex> guard(lock);
+                Slot &slot = slots[publishedCount % slots.size()];
+                slot.data = data;
+                slot.size = size;
+                slot.pendingConsumersCount = consumersCount;
+                publishedCount++;
+            }
+            isPublished.notify_all();
+        }
+
+        // Marks the end of input
+        void close() {
+            {
+                lock_guard<mutex> guard(lock);
+                isClosed = true;
+            }
+            isPublished.notify_all();
+        }
+
+        // Waits for the portion with the `index`. Returns false if the input has ended before it
+        bool take(size_t index, const uchar *&data, size_t &size) {
+            unique_lock<mutex> guard(lock);
+            isPublished.wait(guard, [this, index] { return index < publishedCount || isClosed; });
+            if (index >= publishedCount) {
+                return false;
+            }
+            const Slot &slot = slots[index % slots.size()];
+            data = slot.data;
+            size = slot.size;
+            return true;
+        }
+
+        void release(size_t index) {
+            bool isFree;
+            {
+                lock_guard<mutex> guard(lock);
+                isFree = --slots[index % slots.size()].pendingConsumersCount == 0;
+            }
+            if (isFree) {
+                isReleased.notify_one();
+            }
+        }
+
+    private:
+        struct Slot {
+            uchar *buffer = nullptr;
+            const uchar *data = nullptr;
+            size_t size = 0;
+            size_t pendingConsumersCount = 0;
+        };
+
+        size_t consumersCount;
+        // Guarded by the `lock` as well as the slots
+        size_t publishedCount;
+        bool isClosed;
+        vector<Slot> slots;
+
+        mutex lock;
+        condition_variable isPublished;
+        condition_variable isReleased;
+    };
+
+    void hashInSlices(InputReader &reader, const vector<unique_ptr<StreamingHasher>> &hashers) {
+        const uchar *data;
+        size_t size;
+        while (reader.next(data, size)) {
+            for (size_t offset = 0; offset < size; offset += MULTI_DIGEST_SLICE_SIZE) {
+                size_t sliceSize = min(MULTI_DIGEST_SLICE_SIZE, size - offset);
+                for (const unique_ptr<StreamingHasher> &hasher : hashers) {
+                    hasher->update(data + offset, sliceSize);
+                }
+            }
+        }
+    }
+
+    void readIntoRing(InputReader &reader, BufferRing &ring) {
+        if (reader.isMapped()) {
+            const uchar *data;
+            size_t size;
+            while (reader.next(data, size)) {
+                for (size_t offset = 0; offset < size; offset += MULTI_DIGEST_RING_SLOT_SIZE) {
+                    ring.acquire();
+                    ring.publish(data + offset, min(MULTI_DIGEST_RING_SLOT_SIZE, size - offset));
+                }
+            }
+            return;
+        }
+
+        while (true) {
+            uchar *buffer = ring.acquire();
+            size_t size = reader.read(buffer, MULTI_DIGEST_RING_SLOT_SIZE);
+            if (size == 0) {
+                return;
+            }
+            ring.publish(buffer, size);
+        }
+    }
+
+    // The consumer keeps releasing the portions after a failure, so the reader is never blocked by it
+    void hashFromRing(BufferRing &ring, StreamingHasher &hasher, exception_ptr &error) {
+        const uchar *data;
+        size_t size;
+        for (size_t index = 0; ring.take(index, data, size); index++) {
+            if (!error) {
+                try {
+                    hasher.update(data, size);
+                } catch (...) {
+                    error = current_exception();
+                }
+            }
+            ring.release(index);
+        }
+    }
+
+    void hashOnThreads(InputReader &reader, const vector<unique_ptr<StreamingHasher>> &hashers) {
+        BufferRing ring(hashers.size(), !reader.isMapped());
+        vector<exception_ptr> errors(hashers.size());
+        vector<thread> threads;
+        for (size_t i = 0; i < hashers.size(); i++) {
+            threads.emplace_back(hashFromRing, ref(ring), ref(*hashers[i]), ref(errors[i]));
+        }
+
+        exception_ptr readError;
+        try {
+            readIntoRing(reader, ring);
+        } catch (...) {
+            readError = current_exception();
+        }
+        ring.close();
+        for (thread &worker : threads) {
+            worker.join();
+        }
+
+        if (readError) {
+            rethrow_exception(readError);
+        }
+        for (const exception_ptr &error : errors) {
+            if (error) {
+                rethrow_exception(error);
+            }
+        }
+    }
+
+    vector<unique_ptr<StreamingHasher>> createHashers(const vector<const HashAlgorithm *> &algorithms) {
+        vector<unique_ptr<StreamingHasher>> hashers;
+        for (const HashAlgorithm *algorithm : algorithms) {
+            hashers.push_back(algorithm->createHasher());
+        }
+        return hashers;
+    }
+
+    vector<HashDigest> getDigests(const vector<unique_ptr<StreamingHasher>> &hashers) {
+        vector<HashDigest> digests;
+        for (const unique_ptr<StreamingHasher> &hasher : hashers) {
+            digests.push_back(hasher->final());
+        }
+        return digests;
+    }
+
+}
+
+vector<HashDigest> hashWithAlgorithms(
+    const string &filePath, const vector<const HashAlgorithm *> &algorithms, const MultiDigestOptions &options
+) {
+    vector<unique_ptr<StreamingHasher>> hashers = createHashers(algorithms);
+
+    InputReader reader(filePath, options.inputOptions);
+    if (options.threadPerAlgorithm && hashers.size() > 1) {
+        hashOnThreads(reader, hashers);
+    } else {
+        hashInSlices(reader, hashers);
+    }
+    return getDigests(hashers);
+}
+
+vector<HashDigest> hashDescriptorWithAlgorithms(int fd, const vector<const HashAlgorithm *> &algorithms) {
+#ifdef _WIN32
+    throw invalid_argument("The descriptors aren't supported on this platform");
+#else
+    vector<unique_ptr<StreamingHasher>> hashers = createHashers(algorithms);
+
+    unique_ptr<uchar[]> buffer(new uchar[DEFAULT_READ_BUFFER_SIZE]);
+    while (true) {
+        ssize_t size;
+        {
+            StageTimer timer(Stage::Read);
+            size = read(fd, buffer.get(), DEFAULT_READ_BUFFER_SIZE);
+        }
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size < 0) {
+            throw invalid_argument(string("Can't read the descriptor: ") + strerror(errno));
+        }
+        if (size == 0) {
+            break;
+        }
+        addReadBytes(size);
+        for (size_t offset = 0; offset < (size_t)size; offset += MULTI_DIGEST_SLICE_SIZE) {
+            size_t sliceSize = min(MULTI_DIGEST_SLICE_SIZE, (size_t)size - offset);
+            for (const unique_ptr<StreamingHasher> &hasher : hashers) {
+                hasher->update(buffer.get() + offset, sliceSize);
+            }
+        }
+    }
+    return getDigests(hashers);
+#endif
+}
@@ -0,0 +1,436 @@
+#include "../include/lib/sha2.hpp"
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../include/lib/kernels/sha256Kernels.hpp"
+#include "../include/lib/kernels/sha512Kernels.hpp"
+#include "../include/lib/multiBuffer.hpp"
+#include "../include/utils/cpuFeatures.hpp"
+#include "../include/utils/fileValidator.hpp"
+
+namespace sha2 {
+
+    // Compiler may mix up the functions defined inside a different module with the equal names and signatures.
+    // Thus, we have to move all those functions and variables in the algorithm-specific inner namespace
+    namespace _sha2 {
+        // Binds the family to its cores: the compression rounds, the schedule functions and the accelerated kernels
+        template <typename Word>
+        struct Core;
+
+        template <>
+        struct Core<uint32> {
+            typedef _sha256::BlocksFunction BlocksFunction;
+            typedef _sha256::MultiBufferBlocksFunction MultiBufferBlocksFunction;
+
+            static uint32 smallSigma0(uint32 w) {
+                return _sha256::rightRotate(w, 7) ^ _sha256::rightRotate(w, 18) ^ (w >> 3);
+            }
+
+            static uint32 smallSigma1(uint32 w) {
+                return _sha256::rightRotate(w, 17) ^ _sha256::rightRotate(w, 19) ^ (w >> 10);
+            }
+
+            template <size_t i>
+            static void compressRound(uint32 *v, uint32 w) {
+                _sha256::compressRound<i>(v, _sha256::k[i] + w);
+            }
+
+            static BlocksFunction *selectBlocksFunction() {
+                return _sha256::selectBlocksFunction();
+            }
+
+            static MultiBufferBlocksFunction *selectMultiBufferFunction(uchar &lanesCount) {
+                return _sha256::selectMultiBufferFunction(lanesCount);
+            }
+        };
+
+        template <>
+        struct Core<uint64> {
+            typedef _sha512::BlocksFunction BlocksFunction;
+            typedef _sha512::MultiBufferBlocksFunction MultiBufferBlocksFunction;
+
+            static uint64 smallSigma0(uint64 w) {
+                return _sha512::rightRotate(w, 1) ^ _sha512::rightRotate(w, 8) ^ (w >> 7);
+            }
+
+            static uint64 smallSigma1(uint64 w) {
+                return _sha512::rightRotate(w, 19) ^ _sha512::rightRotate(w, 61) ^ (w >> 6);
+            }
+
+            template <size_t i>
+            static void compressRound(uint64 *v, uint64 w) {
+                _sha512::compressRound<i>(v, _sha512::k[i] + w);
+            }
+
+            static BlocksFunction *selectBlocksFunction() {
+                return _sha512::selectBlocksFunction();
+            }
+
+            static MultiBufferBlocksFunction *selectMultiBufferFunction(uchar &lanesCount) {
+                return _sha512::selectMultiBufferFunction(lanesCount);
+            }
+        };
+
+        template <typename Word>
+        inline Word loadBigEndian(const uchar *data) {
+            Word word = 0;
+            for (uchar i = 0; i < sizeof(Word); i++) {
+                word = word << 8 | data[i];
+            }
+            return word;
+        }
+
+        template <typename Word>
+        inline void storeBigEndian(Word word, uchar *output) {
+            for (uchar i = 0; i < sizeof(Word); i++) {
+                output[i] = uchar(word >> ((sizeof(Word) - 1 - i) * 8));
+            }
+        }
+
+        // The schedule is expanded within the rounds into the ring of the last sixteen words
+        template <typename Word, size_t i>
+        inline void expandAndCompressRound(Word *v, Word *w) {
+            if constexpr (i >= 16) {
+                w[i % 16] += Core<Word>::smallSigma0(w[(i - 15) % 16]) + w[(i - 7) % 16] + Core<Word>::smallSigma1(w[(i - 2) % 16]);
+            }
+            Core<Word>::template compressRound<i>(v, w[i % 16]);
+        }
+
+        template <typename Word, size_t... rounds>
+        inline void expandAndCompressRounds(Word *v, Word *w, index_sequence<rounds...>) {
+            (expandAndCompressRound<Word, rounds>(v, w), ...);
+        }
+
+        // Processes `blocksCount` consecutive blocks of `data`
+        template <typename Word>
+        void processBlocksScalar(Word *h, const uchar *data, uint64 blocksCount) {
+            for (; blocksCount > 0; blocksCount--, data += Sha2Family<Word>::BLOCK_SIZE_IN_BYTES) {
+                // The first sixteen words of the schedule are the message itself
+                Word w[16];
+                for (uchar i = 0; i < 16; i++) {
+                    w[i] = loadBigEndian<Word>(data + i * sizeof(Word));
+                }
+
+                Word v[8] = { h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7] };
+                expandAndCompressRounds(v, w, make_index_sequence<Sha2Family<Word>::ROUNDS_COUNT>());
+
+                // Recalculate hash values for this particular chunk of data
+                for (uchar i = 0; i < 8; i++) {
+                    h[i] += v[i];
+                }
+            }
+        }
+
+        // The words of the state are stored in the big-endian order, the variants truncate them
+        template <typename Variant>
+        inline typename Sha2Hasher<Variant>::Digest toDigest(const typename Variant::Word *state) {
+            uchar bytes[sizeof(typename Variant::Word) * 8];
+            for (uchar i = 0; i < 8; i++) {
+                storeBigEndian(state[i], bytes + i * sizeof(typename Variant::Word));
+            }
+            typename Sha2Hasher<Variant>::Digest digest;
+            memcpy(digest.data(), bytes, digest.size());
+            return digest;
+        }
+
+        template <typename Variant>
+        typename Sha2Hasher<Variant>::Digest hashReader(InputReader &reader) {
+            Sha2Hasher<Variant> hasher;
+            const uchar *data;
+            size_t size;
+
+            // Feed the hasher until the end of input: its size doesn't have to be known up front
+            while (reader.next(data, size)) {
+                hasher.update(data, size);
+            }
+
+            return hasher.final();
+        }
+    }
+
+    namespace _sha256 {
+        void processBlocksScalar(uint32 *state, const uchar *data, uint64 blocksCount) {
+            _sha2::processBlocksScalar(state, data, blocksCount);
+        }
+
+        BlocksFunction *selectBlocksFunction() {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            switch (implementation) {
+                case Implementation::Auto:
+                    if (features.sha && features.sse41) {
+                        return processBlocksShaNi;
+                    }
+                    if (features.avx2) {
+                        return processBlocksAvx2;
+                    }
+                    if (features.ssse3) {
+                        return processBlocksSsse3;
+                    }
+                    return processBlocksScalar;
+                case Implementation::ShaNi:
+                    ensureImplementationSupported(implementation, features.sha && features.sse41);
+                    return processBlocksShaNi;
+                case Implementation::Avx512:
+                case Implementation::Avx2:
+                    // There is no AVX-512 variant of the single stream core: it's served by the AVX2 one
+                    ensureImplementationSupported(implementation, features.avx2);
+                    return processBlocksAvx2;
+                case Implementation::Ssse3:
+                    ensureImplementationSupported(implementation, features.ssse3);
+                    return processBlocksSsse3;
+                default:
+                    return processBlocksScalar;
+            }
+        }
+
+        MultiBufferBlocksFunction *selectMultiBufferFunction(uchar &lanesCount) {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx512) && features.avx512f && features.avx2) {
+                lanesCount = 16;
+                return processBlocksX16Avx512;
+            }
+            if (implementation == Implementation::Avx512) {
+                ensureImplementationSupported(implementation, false);
+            }
+            // The 8 lanes of AVX2 are slower than the SHA extensions processing the messages one by one
+            bool preferShaNi = implementation == Implementation::Auto && features.sha && features.sse41;
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx2) && features.avx2 && !preferShaNi) {
+                lanesCount = 8;
+                return processBlocksX8Avx2;
+            }
+            if (implementation == Implementation::Avx2) {
+                ensureImplementationSupported(implementation, false);
+            }
+            return nullptr;
+        }
+    }
+
+    namespace _sha512 {
+        void processBlocksScalar(uint64 *state, const uchar *data, uint64 blocksCount) {
+            _sha2::processBlocksScalar(state, data, blocksCount);
+        }
+
+        BlocksFunction *selectBlocksFunction() {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            // The AVX2 and AVX-512 cores leave the odd blocks to the narrower ones, so they require those as well
+            bool isAvx2Supported = features.avx2 && features.bmi2 && features.ssse3;
+            bool isAvx512Supported = features.avx512f && features.avx512bw && isAvx2Supported;
+            switch (implementation) {
+                case Implementation::Auto:
+                    if (isAvx512Supported) {
+                        return processBlocksAvx512;
+                    }
+                    if (isAvx2Supported) {
+                        return processBlocksAvx2;
+                    }
+                    if (features.ssse3) {
+                        return processBlocksSsse3;
+                    }
+                    return processBlocksScalar;
+                case Implementation::Avx512:
+                    ensureImplementationSupported(implementation, isAvx512Supported);
+                    return processBlocksAvx512;
+                case Implementation::Avx2:
+                    ensureImplementationSupported(implementation, isAvx2Supported);
+                    return processBlocksAvx2;
+                case Implementation::Ssse3:
+                    ensureImplementationSupported(implementation, features.ssse3);
+                    return processBlocksSsse3;
+                default:
+                    // There are no SHA-512 extensions on the supported CPUs: the forced SHA-NI uses the scalar core
+                    return processBlocksScalar;
+            }
+        }
+
+        MultiBufferBlocksFunction *selectMultiBufferFunction(uchar &lanesCount) {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx512) && features.avx512f && features.avx2) {
+                lanesCount = 8;
+                return processBlocksX8Avx512;
+            }
+            if (implementation == Implementation::Avx512) {
+                ensureImplementationSupported(implementation, false);
+            }
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx2) && features.avx2) {
+                lanesCount = 4;
+                return processBlocksX4Avx2;
+            }
+            if (implementation == Implementation::Avx2) {
+                ensureImplementationSupported(implementation, false);
+            }
+            return nullptr;
+        }
+    }
+
+    template <typename Variant>
+    Sha2Hasher<Variant>::Sha2Hasher() {
+        processBlocks = _sha2::Core<Word>::selectBlocksFunction();
+        reset();
+    }
+
+    template <typename Variant>
+    void Sha2Hasher<Variant>::reset() {
+        memcpy(state, Variant::INITIAL_STATE, sizeof(state));
+        bufferSize = 0;
+        messageSize = 0;
+    }
+
+    template <typename Variant>
+    void Sha2Hasher<Variant>::resume(const Word *midstate, uint64 processedSize) {
+        memcpy(state, midstate, sizeof(state));
+        bufferSize = 0;
+        messageSize = processedSize;
+    }
+
+    template <typename Variant>
+    void Sha2Hasher<Variant>::update(const uchar *data, size_t size) {
+        if (size > Family::MAX_MESSAGE_SIZE - messageSize) {
+            throw invalid_argument("The message exceeds maximum allowed size of SHA-2: " + to_string(Family::MAX_MESSAGE_SIZE) + " bytes");
+        }
+        messageSize += size;
+
+        // Complete the block that has been left incomplete by the previous portion of data
+        if (bufferSize > 0) {
+            size_t bytesToCopy = min(size, size_t(BLOCK_SIZE_IN_BYTES - bufferSize));
+            memcpy(buffer + bufferSize, data, bytesToCopy);
+            bufferSize += bytesToCopy;
+            data += bytesToCopy;
+            size -= bytesToCopy;
+
+            if (bufferSize < BLOCK_SIZE_IN_BYTES) {
+                return;
+            }
+            processBlocks(state, buffer, 1);
+            bufferSize = 0;
+        }
+
+        // The complete blocks are processed right from the passed data without any copying
+        uint64 blocksCount = size / BLOCK_SIZE_IN_BYTES;
+        processBlocks(state, data, blocksCount);
+        data += blocksCount * BLOCK_SIZE_IN_BYTES;
+        size -= blocksCount * BLOCK_SIZE_IN_BYTES;
+
+        // Keep the rest of data until the next portion (or the final call)
+        memcpy(buffer, data, size);
+        bufferSize = size;
+    }
+
+    template <typename Variant>
+    void Sha2Hasher<Variant>::processFinalBlocks() {
+        // The set bit follows the message, then the zeroes up to the length field at the end of the block.
+        // If there is no room for the length, it goes to the extra block
+        const uchar lengthOffset = BLOCK_SIZE_IN_BYTES - Family::LENGTH_FIELD_SIZE;
+        buffer[bufferSize] = 0x80;
+        if (bufferSize < lengthOffset) {
+            memset(buffer + bufferSize + 1, 0, lengthOffset - bufferSize - 1);
+        } else {
+            memset(buffer + bufferSize + 1, 0, BLOCK_SIZE_IN_BYTES - bufferSize - 1);
+            processBlocks(state, buffer, 1);
+            memset(buffer, 0, lengthOffset);
+        }
+
+        // The big-endian size of the message in bits: the 128-bit field gets the 3 high bits into its upper half
+        if constexpr (Family::LENGTH_FIELD_SIZE == 16) {
+            _sha2::storeBigEndian<uint64>(messageSize >> 61, buffer + lengthOffset);
+        }
+        _sha2::storeBigEndian<uint64>(messageSize << 3, buffer + BLOCK_SIZE_IN_BYTES - 8);
+
+        processBlocks(state, buffer, 1);
+    }
+
+    template <typename Variant>
+    typename Sha2Hasher<Variant>::Digest Sha2Hasher<Variant>::final() {
+        processFinalBlocks();
+        Digest result = _sha2::toDigest<Variant>(state);
+        reset();
+
+        return result;
+    }
+
+    template <typename Variant>
+    typename Sha2Hasher<Variant>::Digest hashFile(const string &filePath, const InputOptions &options) {
+        return validateFileForHashFunction(filePath, _sha2::hashReader<Variant>, options);
+    }
+
+    template <typename Variant>
+    vector<typename Sha2Hasher<Variant>::Digest> hashFiles(const vector<string> &filePaths, const InputOptions &options) {
+        typedef typename Variant::Word Word;
+        typedef typename Sha2Hasher<Variant>::Digest Digest;
+        typedef Sha2Family<Word> Family;
+
+        uchar lanesCount;
+        typename _sha2::Core<Word>::MultiBufferBlocksFunction *processBlocks = _sha2::Core<Word>::selectMultiBufferFunction(lanesCount);
+
+        if (processBlocks == nullptr || filePaths.size() < MULTI_BUFFER_MIN_BATCH_SIZE) {
+            vector<Digest> digests;
+            for (const string &filePath : filePaths) {
+                digests.push_back(hashFile<Variant>(filePath, options));
+            }
+            return digests;
+        }
+
+        MultiBufferEngine<Word> engine(
+            { Family::BLOCK_SIZE_IN_BYTES, 8, Variant::INITIAL_STATE, Family::LENGTH_FIELD_SIZE, true }, processBlocks, lanesCount
+        );
+        return hashFilesWithMultiBuffer<Word, Digest>(
+            filePaths, options, engine, _sha2::toDigest<Variant>, [&](const string &filePath) { return hashFile<Variant>(filePath, options); }
+        );
+    }
+
+    template <typename Variant>
+    vector<typename Sha2Hasher<Variant>::Digest> hashBuffers(const vector<ByteView> &messages) {
+        typedef typename Variant::Word Word;
+        typedef typename Sha2Hasher<Variant>::Digest Digest;
+        typedef Sha2Family<Word> Family;
+
+        auto hashBuffer = [](const ByteView &message) {
+            Sha2Hasher<Variant> hasher;
+            hasher.update(message.data, message.size);
+            return hasher.final();
+        };
+
+        uchar lanesCount;
+        typename _sha2::Core<Word>::MultiBufferBlocksFunction *processBlocks = _sha2::Core<Word>::selectMultiBufferFunction(lanesCount);
+
+        if (processBlocks == nullptr || messages.size() < MULTI_BUFFER_MIN_BATCH_SIZE) {
+            vector<Digest> digests;
+            for (const ByteView &message : messages) {
+                digests.push_back(hashBuffer(message));
+            }
+            return digests;
+        }
+
+        MultiBufferEngine<Word> engine(
+            { Family::BLOCK_SIZE_IN_BYTES, 8, Variant::INITIAL_STATE, Family::LENGTH_FIELD_SIZE, true }, processBlocks, lanesCount
+        );
+        return hashBuffersWithMultiBuffer<Word, Digest>(messages, engine, _sha2::toDigest<Variant>, hashBuffer);
+    }
+
+    // All the variants are compiled here, so the cores stay private to this module
+#define INSTANTIATE_SHA2_VARIANT(Variant) \
+    template class Sha2Hasher<Variant>; \
+    template Sha2Hasher<Variant>::Digest hashFile<Variant>(const string &filePath, const InputOptions &options); \
+    template vector<Sha2Hasher<Variant>::Digest> hashFiles<Variant>(const vector<string> &filePaths, const InputOptions &options); \
+    template vector<Sha2Hasher<Variant>::Digest> hashBuffers<Variant>(const vector<ByteView> &messages);
+
+    INSTANTIATE_SHA2_VARIANT(Sha224Variant)
+    INSTANTIATE_SHA2_VARIANT(Sha256Variant)
+    INSTANTIATE_SHA2_VARIANT(Sha384Variant)
+    INSTANTIATE_SHA2_VARIANT(Sha512Variant)
+    INSTANTIATE_SHA2_VARIANT(Sha512_224Variant)
+    INSTANTIATE_SHA2_VARIANT(Sha512_256Variant)
+
+#undef INSTANTIATE_SHA2_VARIANT
+
+}
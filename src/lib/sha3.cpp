@@ -0,0 +1,272 @@
+#include "../include/lib/sha3.hpp"
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "../include/lib/kernels/keccakKernels.hpp"
+#include "../include/lib/multiBuffer.hpp"
+#include "../include/utils/cpuFeatures.hpp"
+#include "../include/utils/fileValidator.hpp"
+
+namespace {
+
+    // The lanes of the single stream core are the general purpose registers
+    struct ScalarOps {
+        typedef uint64 Vector;
+        // Without the and-not instruction of BMI1 (not assumed by the generic build) the chi step costs a NOT per lane
+        static constexpr bool LANE_COMPLEMENTING = true;
+
+        static inline Vector set1(uint64 x) { return x; }
+        static inline Vector bitXor(Vector x, Vector y) { return x ^ y; }
+        static inline Vector bitXor3(Vector x, Vector y, Vector z) { return x ^ y ^ z; }
+        static inline Vector bitAnd(Vector x, Vector y) { return x & y; }
+        static inline Vector bitOr(Vector x, Vector y) { return x | y; }
+        static inline Vector bitNot(Vector x) { return ~x; }
+        static inline Vector chi(Vector x, Vector y, Vector z) { return x ^ (~y & z); }
+
+        template <int shift>
+        static inline Vector rotateLeft(Vector x) { return (x << shift) | (x >> (64 - shift)); }
+    };
+
+}
+
+#include "../include/lib/kernels/keccakRounds.hpp"
+
+namespace sha3 {
+
+    // Compiler may mix up the functions defined inside a different module with the equal names and signatures.
+    // Thus, we have to move all those functions and variables in the algorithm-specific inner namespace
+    namespace _sha3 {
+        // The sponge starts from the zero state: the complemented lanes are all ones
+        const uint64 INITIAL_STATE[_keccak::STATE_WORDS] = {};
+
+        inline uint64 loadLittleEndian(const uchar *data) {
+            uint64 word = 0;
+            for (uchar i = 0; i < 8; i++) {
+                word |= uint64(data[i]) << (i * 8);
+            }
+            return word;
+        }
+
+        inline uint64 complementMask(uchar lane) {
+            return isLaneComplemented(lane) ? UINT64_MAX : 0;
+        }
+
+        // The batch path runs the multi-buffer cores only, each is bound to the rate of the variant
+        template <uchar rate>
+        void absorbBlocksX4(uint64 *states, const uchar *const *data, uint64 blocksCount) {
+            _keccak::absorbBlocksX4Avx2(states, data, blocksCount, rate);
+        }
+
+        template <uchar rate>
+        void absorbBlocksX8(uint64 *states, const uchar *const *data, uint64 blocksCount) {
+            _keccak::absorbBlocksX8Avx512(states, data, blocksCount, rate);
+        }
+
+        template <uchar rate>
+        MultiBufferEngine<uint64>::BlocksFunction *selectMultiBufferFunction(uchar &lanesCount) {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx512) && features.avx512f && features.avx2) {
+                lanesCount = 8;
+                return absorbBlocksX8<rate>;
+            }
+            if (implementation == Implementation::Avx512) {
+                ensureImplementationSupported(implementation, false);
+            }
+            if ((implementation == Implementation::Auto || implementation == Implementation::Avx2) && features.avx2) {
+                lanesCount = 4;
+                return absorbBlocksX4<rate>;
+            }
+            if (implementation == Implementation::Avx2) {
+                ensureImplementationSupported(implementation, false);
+            }
+            return nullptr;
+        }
+
+        // The multi-buffer cores keep the plain lanes: the digest is the beginning of the first block of the output
+        template <typename Variant>
+        inline typename Sha3Hasher<Variant>::Digest toDigest(const uint64 *state) {
+            typename Sha3Hasher<Variant>::Digest digest;
+            for (uchar i = 0; i < digest.size(); i++) {
+                digest[i] = uchar(state[i / 8] >> (i % 8 * 8));
+            }
+            return digest;
+        }
+
+        template <typename Variant>
+        typename Sha3Hasher<Variant>::Digest hashReader(InputReader &reader) {
+            Sha3Hasher<Variant> hasher;
+            const uchar *data;
+            size_t size;
+
+            // Feed the hasher until the end of input: its size doesn't have to be known up front
+            while (reader.next(data, size)) {
+                hasher.update(data, size);
+            }
+
+            return hasher.final();
+        }
+    }
+
+    template <typename Variant>
+    Sha3Hasher<Variant>::Sha3Hasher() {
+        reset();
+    }
+
+    template <typename Variant>
+    void Sha3Hasher<Variant>::reset() {
+        for (uchar i = 0; i < _keccak::STATE_WORDS; i++) {
+            state[i] = _sha3::complementMask(i);
+        }
+        bufferSize = 0;
+        isSqueezing = false;
+        squeezedSize = 0;
+    }
+
+    template <typename Variant>
+    void Sha3Hasher<Variant>::absorbBlock(const uchar *block) {
+        for (uchar i = 0; i < BLOCK_SIZE_IN_BYTES / 8; i++) {
+            state[i] ^= _sha3::loadLittleEndian(block + i * 8);
+        }
+        keccakPermute<ScalarOps>(state);
+    }
+
+    template <typename Variant>
+    void Sha3Hasher<Variant>::update(const uchar *data, size_t size) {
+        if (isSqueezing) {
+            throw invalid_argument("The message can't be extended after the output of the sponge has been squeezed");
+        }
+
+        // Complete the block that has been left incomplete by the previous portion of data
+        if (bufferSize > 0) {
+            size_t bytesToCopy = min(size, size_t(BLOCK_SIZE_IN_BYTES - bufferSize));
+            memcpy(buffer + bufferSize, data, bytesToCopy);
+            bufferSize += bytesToCopy;
+            data += bytesToCopy;
+            size -= bytesToCopy;
+
+            if (bufferSize < BLOCK_SIZE_IN_BYTES) {
+                return;
+            }
+            absorbBlock(buffer);
+            bufferSize = 0;
+        }
+
+        // The complete blocks are absorbed right from the passed data without any copying
+        for (; size >= BLOCK_SIZE_IN_BYTES; data += BLOCK_SIZE_IN_BYTES, size -= BLOCK_SIZE_IN_BYTES) {
+            absorbBlock(data);
+        }
+
+        // Keep the rest of data until the next portion (or the final call)
+        memcpy(buffer, data, size);
+        bufferSize = size;
+    }
+
+    template <typename Variant>
+    void Sha3Hasher<Variant>::squeeze(uchar *output, size_t size) {
+        if (!isSqueezing) {
+            // The domain separation bits and the first bit of the pad10*1 rule, then the zeroes up to the last bit of the block
+            buffer[bufferSize] = Variant::SUFFIX;
+            memset(buffer + bufferSize + 1, 0, BLOCK_SIZE_IN_BYTES - bufferSize - 1);
+            buffer[BLOCK_SIZE_IN_BYTES - 1] |= 0x80;
+            absorbBlock(buffer);
+            isSqueezing = true;
+        }
+
+        for (; size > 0; size--, squeezedSize++) {
+            if (squeezedSize == BLOCK_SIZE_IN_BYTES) {
+                keccakPermute<ScalarOps>(state);
+                squeezedSize = 0;
+            }
+            uchar lane = squeezedSize / 8;
+            *output++ = uchar((state[lane] ^ _sha3::complementMask(lane)) >> (squeezedSize % 8 * 8));
+        }
+    }
+
+    template <typename Variant>
+    typename Sha3Hasher<Variant>::Digest Sha3Hasher<Variant>::final() {
+        Digest result;
+        squeeze(result.data(), result.size());
+        reset();
+
+        return result;
+    }
+
+    template <typename Variant>
+    typename Sha3Hasher<Variant>::Digest hashFile(const string &filePath, const InputOptions &options) {
+        return validateFileForHashFunction(filePath, _sha3::hashReader<Variant>, options);
+    }
+
+    template <typename Variant>
+    vector<typename Sha3Hasher<Variant>::Digest> hashFiles(const vector<string> &filePaths, const InputOptions &options) {
+        typedef typename Sha3Hasher<Variant>::Digest Digest;
+
+        uchar lanesCount;
+        MultiBufferEngine<uint64>::BlocksFunction *absorbBlocks = _sha3::selectMultiBufferFunction<Variant::RATE_IN_BYTES>(lanesCount);
+
+        if (absorbBlocks == nullptr || filePaths.size() < MULTI_BUFFER_MIN_BATCH_SIZE) {
+            vector<Digest> digests;
+            for (const string &filePath : filePaths) {
+                digests.push_back(hashFile<Variant>(filePath, options));
+            }
+            return digests;
+        }
+
+        // The sponge pads with the suffix and the last set bit of the block, there is no length field
+        MultiBufferEngine<uint64> engine(
+            { Variant::RATE_IN_BYTES, _keccak::STATE_WORDS, _sha3::INITIAL_STATE, 0, false, Variant::SUFFIX, true }, absorbBlocks, lanesCount
+        );
+        return hashFilesWithMultiBuffer<uint64, Digest>(
+            filePaths, options, engine, _sha3::toDigest<Variant>, [&](const string &filePath) { return hashFile<Variant>(filePath, options); }
+        );
+    }
+
+    template <typename Variant>
+    vector<typename Sha3Hasher<Variant>::Digest> hashBuffers(const vector<ByteView> &messages) {
+        typedef typename Sha3Hasher<Variant>::Digest Digest;
+
+        auto hashBuffer = [](const ByteView &message) {
+            Sha3Hasher<Variant> hasher;
+            hasher.update(message.data, message.size);
+            return hasher.final();
+        };
+
+        uchar lanesCount;
+        MultiBufferEngine<uint64>::BlocksFunction *absorbBlocks = _sha3::selectMultiBufferFunction<Variant::RATE_IN_BYTES>(lanesCount);
+
+        if (absorbBlocks == nullptr || messages.size() < MULTI_BUFFER_MIN_BATCH_SIZE) {
+            vector<Digest> digests;
+            for (const ByteView &message : messages) {
+                digests.push_back(hashBuffer(message));
+            }
+            return digests;
+        }
+
+        MultiBufferEngine<uint64> engine(
+            { Variant::RATE_IN_BYTES, _keccak::STATE_WORDS, _sha3::INITIAL_STATE, 0, false, Variant::SUFFIX, true }, absorbBlocks, lanesCount
+        );
+        return hashBuffersWithMultiBuffer<uint64, Digest>(messages, engine, _sha3::toDigest<Variant>, hashBuffer);
+    }
+
+    // All the variants are compiled here, so the cores stay private to this module
+#define INSTANTIATE_SHA3_VARIANT(Variant) \
+    template class Sha3Hasher<Variant>; \
+    template Sha3Hasher<Variant>::Digest hashFile<Variant>(const string &filePath, const InputOptions &options); \
+    template vector<Sha3Hasher<Variant>::Digest> hashFiles<Variant>(const vector<string> &filePaths, const InputOptions &options); \
+    template vector<Sha3Hasher<Variant>::Digest> hashBuffers<Variant>(const vector<ByteView> &messages);
+
+    INSTANTIATE_SHA3_VARIANT(Sha3_224Variant)
+    INSTANTIATE_SHA3_VARIANT(Sha3_256Variant)
+    INSTANTIATE_SHA3_VARIANT(Sha3_384Variant)
+    INSTANTIATE_SHA3_VARIANT(Sha3_512Variant)
+    INSTANTIATE_SHA3_VARIANT(Shake128Variant)
+    INSTANTIATE_SHA3_VARIANT(Shake256Variant)
+
+#undef INSTANTIATE_SHA3_VARIANT
+
+}
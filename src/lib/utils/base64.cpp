@@ -0,0 +1,90 @@
+#include "../../include/utils/base64.hpp"
+
+#include <array>
+
+namespace {
+
+    const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    // The value of each character of the alphabet, INVALID_CHARACTER for the other ones (including the padding)
+    const uchar INVALID_CHARACTER = 0xff;
+
+    constexpr array<uchar, 256> generateValuesTable() {
+        array<uchar, 256> table {};
+        for (size_t i = 0; i < 256; i++) {
+            table[i] = INVALID_CHARACTER;
+        }
+        for (uchar i = 0; i < 64; i++) {
+            table[uchar(ALPHABET[i])] = i;
+        }
+        return table;
+    }
+
+    constexpr array<uchar, 256> VALUES = generateValuesTable();
+
+    // Returns false if any of the characters isn't in the alphabet
+    bool decodeGroup(const char *text, size_t count, uint32 &group) {
+        group = 0;
+        for (size_t i = 0; i < count; i++) {
+            uchar value = VALUES[uchar(text[i])];
+            if (value == INVALID_CHARACTER) {
+                return false;
+            }
+            group |= uint32(value) << (18 - i * 6);
+        }
+        return true;
+    }
+
+}
+
+char *encodeBase64(const uchar *data, size_t size, char *output) {
+    // Each 3 bytes are encoded into 4 characters
+    for (; size >= 3; size -= 3, data += 3, output += 4) {
+        uint32 group = uint32(data[0]) << 16 | uint32(data[1]) << 8 | data[2];
+        output[0] = ALPHABET[group >> 18];
+        output[1] = ALPHABET[(group >> 12) & 0x3f];
+        output[2] = ALPHABET[(group >> 6) & 0x3f];
+        output[3] = ALPHABET[group & 0x3f];
+    }
+
+    // The incomplete group is padded with '='
+    if (size > 0) {
+        uint32 group = uint32(data[0]) << 16 | (size == 2 ? uint32(data[1]) << 8 : 0);
+        output[0] = ALPHABET[group >> 18];
+        output[1] = ALPHABET[(group >> 12) & 0x3f];
+        output[2] = size == 2 ? ALPHABET[(group >> 6) & 0x3f] : '=';
+        output[3] = '=';
+        output += 4;
+    }
+    return output;
+}
+
+string toBase64(const uchar *data, size_t size) {
+    string result(base64EncodedSize(size), '\0');
+    encodeBase64(data, size, &result[0]);
+    return result;
+}
+
+bool decodeBase64(const char *text, size_t size, uchar *output) {
+    uint32 group;
+    for (; size >= 3; size -= 3, text += 4, output += 3) {
+        if (!decodeGroup(text, 4, group)) {
+            return false;
+        }
+        output[0] = group >> 16;
+        output[1] = group >> 8;
+        output[2] = group;
+    }
+
+    // The incomplete group: 2 or 3 characters followed by the padding
+    if (size > 0) {
+        if (!decodeGroup(text, size + 1, group) || (size == 1 && text[2] != '=') || text[3] != '=') {
+            return false;
+        }
+        output[0] = group >> 16;
+        if (size == 2) {
+            output[1] = group >> 8;
+        }
+    }
+    return true;
+}
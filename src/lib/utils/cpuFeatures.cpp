@@ -0,0 +1,103 @@
+#include "../../include/utils/cpuFeatures.hpp"
+
+#include <stdexcept>
+
+#if ZIPPY_X86
+#include <cpuid.h>
+#endif
+
+namespace {
+    Implementation forcedImplementation = Implementation::Auto;
+
+#if ZIPPY_X86
+    // Returns the value of extended control register XCR0 (the set of registers preserved by the OS)
+    uint64 readXcr0() {
+        uint32 eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (uint64(edx) << 32) | eax;
+    }
+#endif
+
+    CpuFeatures detectCpuFeatures() {
+        CpuFeatures features;
+#if ZIPPY_X86
+        uint32 eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            return features;
+        }
+        features.ssse3 = ecx & (1 << 9);
+        features.sse41 = ecx & (1 << 19);
+        features.sse42 = ecx & (1 << 20);
+        features.pclmul = ecx & (1 << 1);
+        features.aesni = ecx & (1 << 25);
+
+        // XMM and YMM registers (bits 1 and 2), opmask and ZMM registers (bits 5, 6 and 7)
+        bool osSupportsAvx = false;
+        bool osSupportsAvx512 = false;
+        if (ecx & (1 << 27)) {
+            uint64 xcr0 = readXcr0();
+            osSupportsAvx = (xcr0 & 0x06) == 0x06;
+            osSupportsAvx512 = (xcr0 & 0xE6) == 0xE6;
+        }
+
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            features.avx2 = osSupportsAvx && (ebx & (1 << 5));
+            features.bmi2 = ebx & (1 << 8);
+            features.avx512f = osSupportsAvx512 && (ebx & (1 << 16));
+            features.avx512bw = osSupportsAvx512 && (ebx & (1 << 30));
+            features.avx512vl = osSupportsAvx512 && (ebx & (1u << 31));
+            features.vpclmulqdq = osSupportsAvx512 && (ecx & (1 << 10));
+            features.sha = ebx & (1 << 29);
+        }
+#endif
+        return features;
+    }
+}
+
+const CpuFeatures &getCpuFeatures() {
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+void forceImplementation(Implementation implementation) {
+    forcedImplementation = implementation;
+}
+
+Implementation getForcedImplementation() {
+    return forcedImplementation;
+}
+
+bool parseImplementation(const string &name, Implementation &implementation) {
+    for (Implementation candidate : {
+        Implementation::Auto, Implementation::Scalar, Implementation::Ssse3,
+        Implementation::Avx2, Implementation::Avx512, Implementation::ShaNi, Implementation::AesNi,
+        Implementation::Sse42, Implementation::Pclmul
+    }) {
+        if (implementationName(candidate) == name) {
+            implementation = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+string implementationName(Implementation implementation) {
+    switch (implementation) {
+        case Implementation::Auto: return "auto";
+        case Implementation::Scalar: return "scalar";
+        case Implementation::Ssse3: return "ssse3";
+        case Implementation::Avx2: return "avx2";
+        case Implementation::Avx512: return "avx512";
+        case Implementation::ShaNi: return "shani";
+        case Implementation::AesNi: return "aesni";
+        case Implementation::Sse42: return "sse42";
+        case Implementation::Pclmul: return "pclmul";
+    }
+    return "unknown";
+}
+
+void ensureImplementationSupported(Implementation implementation, bool isSupported) {
+    if (!isSupported) {
+        throw invalid_argument("The " + implementationName(implementation) + " implementation isn't supported by this CPU");
+    }
+}
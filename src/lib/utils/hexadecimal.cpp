@@ -1,71 +1,100 @@
 #include "../../include/utils/hexadecimal.hpp"
 
-#include <sstream>
-#include <iomanip>
-
-string toHex(vector<uint32> data, bool useLittleEndian, bool useColonDelimeter) {
-    vector<uchar> buffer;
-    buffer.reserve(data.size() * sizeof(uint32));
-    for (int i = 0; i < data.size(); i++) {
-        if (useLittleEndian) {
-            buffer.push_back((data[i] << 24) >> 24);
-            buffer.push_back((data[i] << 16) >> 24);
-            buffer.push_back((data[i] << 8) >> 24);
-            buffer.push_back(data[i] >> 24);
-        } else {
-            buffer.push_back(data[i] >> 24);
-            buffer.push_back((data[i] << 8) >> 24);
-            buffer.push_back((data[i] << 16) >> 24);
-            buffer.push_back((data[i] << 24) >> 24);
+#include <array>
+
+#include "../../include/utils/cpuFeatures.hpp"
+
+#if ZIPPY_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+    const char DIGITS[] = "0123456789abcdef";
+
+    // The two characters of each byte value, so a byte is encoded by a single lookup
+    constexpr array<char, 512> generatePairsTable() {
+        array<char, 512> table {};
+        for (size_t i = 0; i < 256; i++) {
+            table[i * 2] = DIGITS[i >> 4];
+            table[i * 2 + 1] = DIGITS[i & 0x0f];
         }
+        return table;
     }
 
-    return toHex(buffer, useColonDelimeter);
-}
+    constexpr array<char, 512> PAIRS = generatePairsTable();
+
+    // The value of each hexadecimal digit (of both cases), INVALID_DIGIT for the other characters
+    const uchar INVALID_DIGIT = 0xff;
+
+    constexpr array<uchar, 256> generateDigitValuesTable() {
+        array<uchar, 256> table {};
+        for (size_t i = 0; i < 256; i++) {
+            table[i] = INVALID_DIGIT;
+        }
+        for (uchar i = 0; i < 16; i++) {
+            table[uchar(DIGITS[i])] = i;
+            if (i >= 10) {
+                table[uchar('A' + i - 10)] = i;
+            }
+        }
+        return table;
+    }
+
+    constexpr array<uchar, 256> DIGIT_VALUES = generateDigitValuesTable();
 
-string toHex(vector<uint64> data, bool useLittleEndian, bool useColonDelimeter) {
-    vector<uchar> buffer;
-    buffer.reserve(data.size() * sizeof(uint64));
-    for (int i = 0; i < data.size(); i++) {
-        if (useLittleEndian) {
-            buffer.push_back((data[i] << 56) >> 56);
-            buffer.push_back((data[i] << 48) >> 56);
-            buffer.push_back((data[i] << 40) >> 56);
-            buffer.push_back((data[i] << 32) >> 56);
-            buffer.push_back((data[i] << 24) >> 56);
-            buffer.push_back((data[i] << 16) >> 56);
-            buffer.push_back((data[i] << 8) >> 56);
-            buffer.push_back(data[i] >> 56);
-        } else {
-            buffer.push_back(data[i] >> 56);
-            buffer.push_back((data[i] << 8) >> 56);
-            buffer.push_back((data[i] << 16) >> 56);
-            buffer.push_back((data[i] << 24) >> 56);
-            buffer.push_back((data[i] << 32) >> 56);
-            buffer.push_back((data[i] << 40) >> 56);
-            buffer.push_back((data[i] << 48) >> 56);
-            buffer.push_back((data[i] << 56) >> 56);
+    char *encodeHexScalar(const uchar *data, size_t size, char *output) {
+        for (size_t i = 0; i < size; i++, output += 2) {
+            output[0] = PAIRS[data[i] * 2];
+            output[1] = PAIRS[data[i] * 2 + 1];
         }
+        return output;
     }
 
-    return toHex(buffer, useColonDelimeter);
+#if ZIPPY_X86
+    // Encodes 16 bytes at a time: the nibbles are looked up in the digits by the byte shuffle
+    // and interleaved back into the order of the characters
+    ZIPPY_TARGET("ssse3")
+    char *encodeHexSsse3(const uchar *data, size_t size, char *output) {
+        const __m128i digits = _mm_loadu_si128((const __m128i *)DIGITS);
+        const __m128i lowNibbleMask = _mm_set1_epi8(0x0f);
+        for (; size >= 16; size -= 16, data += 16, output += 32) {
+            __m128i bytes = _mm_loadu_si128((const __m128i *)data);
+            __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), lowNibbleMask));
+            __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, lowNibbleMask));
+            _mm_storeu_si128((__m128i *)output, _mm_unpacklo_epi8(high, low));
+            _mm_storeu_si128((__m128i *)(output + 16), _mm_unpackhi_epi8(high, low));
+        }
+        return encodeHexScalar(data, size, output);
+    }
+#endif
+
 }
 
-string toHex(vector<uchar> data, bool useColonDelimeter) {
-    if (data.size() == 0) {
-        return "";
+char *encodeHex(const uchar *data, size_t size, char *output) {
+#if ZIPPY_X86
+    // The forced scalar implementation disables the SIMD encoder as well, so both of them can be tested
+    if (size >= 16 && getCpuFeatures().ssse3 && getForcedImplementation() != Implementation::Scalar) {
+        return encodeHexSsse3(data, size, output);
     }
+#endif
+    return encodeHexScalar(data, size, output);
+}
 
-    stringstream stringBuilder;
-    stringBuilder << std::hex;
+string toHex(const uchar *data, size_t size) {
+    string result(size * 2, '\0');
+    encodeHex(data, size, &result[0]);
+    return result;
+}
 
-    stringBuilder << std::setw(2) << std::setfill('0') << (uint32)data[0];
-    for(int i = 1; i < data.size(); i++) {
-        if (useColonDelimeter) {
-            stringBuilder << ":";
+bool decodeHex(const char *text, size_t size, uchar *output) {
+    for (size_t i = 0; i < size; i++, text += 2) {
+        uchar high = DIGIT_VALUES[uchar(text[0])];
+        uchar low = DIGIT_VALUES[uchar(text[1])];
+        if (high == INVALID_DIGIT || low == INVALID_DIGIT) {
+            return false;
         }
-        stringBuilder << std::setw(2) << std::setfill('0') << (uint32)data[i];
+        output[i] = high << 4 | low;
     }
-
-    return stringBuilder.str();
+    return true;
 }
@@ -0,0 +1,196 @@
+#include "../../include/utils/inputReader.hpp"
+#include "../../include/utils/readPipeline.hpp"
+#include "../../include/utils/stats.hpp"
+
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+InputReader::InputReader(const string &filePath, const InputOptions &options)
+    : mapping(nullptr), mappingSize(0), mappingOffset(0), stream(nullptr), buffer(nullptr), bufferSize(0),
+      pendingData(nullptr), pendingSize(0) {
+    StageTimer timer(Stage::Open);
+    if (filePath == "-") {
+        stream = &cin;
+    } else if (options.ioDepth > 0 && tryOpenPipeline(filePath, options)) {
+        // The portions are read into the pipeline's buffers
+    } else if (options.ioDepth > 0 || !options.allowMapping || !tryMapFile(filePath)) {
+        fileStream.open(filePath, ios::in | ios::binary);
+        if (!fileStream.is_open()) {
+            throw invalid_argument("File not found: " + filePath);
+        }
+        stream = &fileStream;
+    }
+
+    if (stream != nullptr) {
+        // The size is rounded up to the multiple of alignment (and of any block size)
+        bufferSize = max(options.readBufferSize, READ_BUFFER_ALIGNMENT);
+        bufferSize = (bufferSize + READ_BUFFER_ALIGNMENT - 1) / READ_BUFFER_ALIGNMENT * READ_BUFFER_ALIGNMENT;
+        buffer = (uchar *)::operator new[](bufferSize, align_val_t(READ_BUFFER_ALIGNMENT));
+    }
+}
+
+InputReader::~InputReader() {
+    if (buffer != nullptr) {
+        ::operator delete[](buffer, align_val_t(READ_BUFFER_ALIGNMENT));
+    }
+#ifndef _WIN32
+    if (mapping != nullptr) {
+        munmap((void *)mapping, mappingSize);
+    }
+#endif
+}
+
+bool InputReader::next(const uchar *&data, size_t &size) {
+    if (mapping != nullptr) {
+        if (mappingOffset == mappingSize) {
+            return false;
+        }
+        data = mapping + mappingOffset;
+        size = min(MAPPED_PORTION_SIZE, mappingSize - mappingOffset);
+        mappingOffset += size;
+        addReadBytes(size);
+        return true;
+    }
+
+    StageTimer timer(Stage::Read);
+    if (pipeline) {
+        if (!pipeline->next(data, size)) {
+            return false;
+        }
+        addReadBytes(size);
+        return true;
+    }
+
+    stream->read((char *)buffer, bufferSize);
+    if (stream->gcount() == 0) {
+        return false;
+    }
+    data = buffer;
+    size = stream->gcount();
+    addReadBytes(size);
+    return true;
+}
+
+size_t InputReader::read(uchar *target, size_t capacity) {
+    StageTimer timer(Stage::Read);
+    size_t size = readInto(target, capacity);
+    if (size != 0) {
+        addReadBytes(size);
+    }
+    return size;
+}
+
+size_t InputReader::readInto(uchar *target, size_t capacity) {
+    if (mapping != nullptr) {
+        size_t size = min((uint64)capacity, mappingSize - mappingOffset);
+        copy(mapping + mappingOffset, mapping + mappingOffset + size, target);
+        mappingOffset += size;
+        return size;
+    }
+
+    if (pipeline) {
+        size_t size = 0;
+        while (size < capacity && (pendingSize > 0 || pipeline->next(pendingData, pendingSize))) {
+            size_t portionSize = min(capacity - size, pendingSize);
+            copy(pendingData, pendingData + portionSize, target + size);
+            size += portionSize;
+            pendingData += portionSize;
+            pendingSize -= portionSize;
+        }
+        return size;
+    }
+
+    stream->read((char *)target, capacity);
+    return stream->gcount();
+}
+
+bool InputReader::isMapped() const {
+    return mapping != nullptr;
+}
+
+const uchar *InputReader::getMapping() const {
+    return mapping;
+}
+
+uint64 InputReader::getMappingSize() const {
+    return mappingSize;
+}
+
+const ReadPipeline *InputReader::getPipeline() const {
+    return pipeline.get();
+}
+
+bool InputReader::tryMapFile(const string &filePath) {
+#ifdef _WIN32
+    return false;
+#else
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Only the non-empty regular files can be mapped: the size of pipes and special files isn't known up front.
+    // The empty files are also excluded since the mapping of zero length isn't allowed
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void *address = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+
+    // The hashers read the file strictly from the beginning to the end,
+    // so the kernel is allowed to read ahead aggressively and to drop the pages behind
+    madvise(address, fileStat.st_size, MADV_SEQUENTIAL);
+
+    mapping = (const uchar *)address;
+    mappingSize = fileStat.st_size;
+    return true;
+#endif
+}
+
+bool InputReader::tryOpenPipeline(const string &filePath, const InputOptions &options) {
+#ifdef _WIN32
+    return false;
+#else
+    int fd = -1;
+    bool isDirect = false;
+#ifdef O_DIRECT
+    if (options.directIo) {
+        fd = open(filePath.c_str(), O_RDONLY | O_DIRECT);
+        // Some file systems (e.g. tmpfs) don't support the direct I/O, the file is read through the page cache then
+        isDirect = fd >= 0;
+    }
+#endif
+    if (fd < 0) {
+        fd = open(filePath.c_str(), O_RDONLY);
+    }
+    if (fd < 0) {
+        return false;
+    }
+
+    // The size of pipes and special files isn't known up front, they are read through the stream
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+        close(fd);
+        return false;
+    }
+
+    pipeline = createReadPipeline(fd, fileStat.st_size, isDirect, options);
+    return true;
+#endif
+}
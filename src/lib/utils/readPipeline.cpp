@@ -0,0 +1,482 @@
+#include "../../include/utils/readPipeline.hpp"
+
+#ifndef _WIN32
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <new>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+namespace {
+
+    // The portion of the file being read into its own buffer
+    struct Slot {
+        uchar *buffer = nullptr;
+        uint64 offset = 0;
+        // The count of bytes expected (less than the buffer size at the end of file) and read so far
+        size_t expectedSize = 0;
+        size_t size = 0;
+        bool isReady = false;
+        int error = 0;
+        iovec ioVector;
+    };
+
+    // The buffers of the pipelines. The direct reads need the buffers aligned to the blocks of the device
+    class Slots {
+    public:
+        Slots(uint32 count, uint32 bufferSize, bool isDirect)
+            : alignment(isDirect ? DIRECT_IO_ALIGNMENT : READ_BUFFER_ALIGNMENT), items(max(1u, count)) {
+            this->bufferSize = max(bufferSize, alignment);
+            this->bufferSize = (this->bufferSize + alignment - 1) / alignment * alignment;
+            for (Slot &slot : items) {
+                slot.buffer = (uchar *)::operator new[](this->bufferSize, align_val_t(alignment));
+            }
+        }
+
+        ~Slots() {
+            for (Slot &slot : items) {
+                ::operator delete[](slot.buffer, align_val_t(alignment));
+            }
+        }
+
+        Slots(const Slots &) = delete;
+        Slots &operator=(const Slots &) = delete;
+
+        uint32 getBufferSize() const {
+            return bufferSize;
+        }
+
+        size_t size() const {
+            return items.size();
+        }
+
+        Slot &operator[](uint64 index) {
+            return items[index % items.size()];
+        }
+
+    private:
+        uint32 alignment;
+        uint32 bufferSize;
+        vector<Slot> items;
+    };
+
+    void throwReadError(int error) {
+        throw invalid_argument(string("Can't read the file: ") + strerror(error));
+    }
+
+    // The direct read may be continued only from the block boundary: the short one that isn't a whole count
+    // of blocks has reached the end of file
+    inline bool canContinueRead(const Slot &slot, bool isDirect) {
+        return !isDirect || slot.size % DIRECT_IO_ALIGNMENT == 0;
+    }
+
+    // Reads the whole portion unless the end of file is reached. Returns the errno on failure
+    int readFully(int fd, Slot &slot, size_t requestedSize, bool isDirect) {
+        while (slot.size < slot.expectedSize) {
+            ssize_t size = pread(fd, slot.buffer + slot.size, requestedSize - slot.size, slot.offset + slot.size);
+            if (size < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno;
+            }
+            if (size == 0) {
+                break;
+            }
+            slot.size += size;
+            if (!canContinueRead(slot, isDirect)) {
+                break;
+            }
+        }
+        return 0;
+    }
+
+    // The background thread reads the portions in order into the slots released by the consumer
+    class ThreadReadPipeline : public ReadPipeline {
+    public:
+        ThreadReadPipeline(int fd, uint64 fileSize, bool isDirect, const InputOptions &options)
+            : fd(fd), fileSize(fileSize), isDirect(isDirect), slots(options.ioDepth, options.readBufferSize, isDirect),
+              publishedCount(0), consumedCount(0), isFinished(false), isStopping(false), isHandedOut(false) {
+            reader = thread(&ThreadReadPipeline::run, this);
+        }
+
+        ~ThreadReadPipeline() override {
+            {
+                lock_guard<mutex> guard(lock);
+                isStopping = true;
+            }
+            isReleased.notify_one();
+            reader.join();
+            close(fd);
+        }
+
+        bool next(const uchar *&data, size_t &size) override {
+            unique_lock<mutex> guard(lock);
+            if (isHandedOut) {
+                slots[consumedCount - 1].isReady = false;
+                isHandedOut = false;
+                isReleased.notify_one();
+            }
+
+            Slot &slot = slots[consumedCount];
+            isPublished.wait(guard, [this, &slot] { return slot.isReady || (isFinished && consumedCount == publishedCount); });
+            if (!slot.isReady) {
+                return false;
+            }
+            if (slot.error != 0) {
+                throwReadError(slot.error);
+            }
+            if (slot.size == 0) {
+                return false;
+            }
+
+            data = slot.buffer;
+            size = slot.size;
+            consumedCount++;
+            isHandedOut = true;
+            return true;
+        }
+
+        ReadBackend getBackend() const override {
+            return ReadBackend::Thread;
+        }
+
+    private:
+        int fd;
+        uint64 fileSize;
+        bool isDirect;
+        Slots slots;
+
+        // Guarded by the `lock` as well as the `isReady` flags of the slots
+        uint64 publishedCount;
+        uint64 consumedCount;
+        bool isFinished;
+        bool isStopping;
+        bool isHandedOut;
+
+        mutex lock;
+        condition_variable isPublished;
+        condition_variable isReleased;
+        thread reader;
+
+        void run() {
+            for (uint64 offset = 0; offset < fileSize; offset += slots.getBufferSize()) {
+                Slot *slot;
+                {
+                    unique_lock<mutex> guard(lock);
+                    slot = &slots[publishedCount];
+                    isReleased.wait(guard, [this, slot] { return !slot->isReady || isStopping; });
+                    if (isStopping) {
+                        break;
+                    }
+                }
+
+                // The slot belongs to the reader until it's published
+                slot->offset = offset;
+                slot->expectedSize = min(uint64(slots.getBufferSize()), fileSize - offset);
+                slot->size = 0;
+                // The direct reads must be of whole blocks, the last one is cut by the end of file
+                slot->error = readFully(fd, *slot, isDirect ? slots.getBufferSize() : slot->expectedSize, isDirect);
+
+                bool isLast = slot->error != 0 || slot->size < slot->expectedSize;
+                {
+                    lock_guard<mutex> guard(lock);
+                    slot->isReady = true;
+                    publishedCount++;
+                }
+                isPublished.notify_one();
+                if (isLast) {
+                    break;
+                }
+            }
+
+            {
+                lock_guard<mutex> guard(lock);
+                isFinished = true;
+            }
+            isPublished.notify_one();
+        }
+    };
+
+#ifdef __linux__
+
+    // The submission and completion queues shared with the kernel
+    struct Ring {
+        int fd = -1;
+        void *submissionMapping = MAP_FAILED;
+        size_t submissionMappingSize = 0;
+        void *completionMapping = MAP_FAILED;
+        size_t completionMappingSize = 0;
+        io_uring_sqe *entries = (io_uring_sqe *)MAP_FAILED;
+        size_t entriesSize = 0;
+
+        unsigned *submissionTail;
+        unsigned *submissionMask;
+        unsigned *submissionArray;
+        unsigned *completionHead;
+        unsigned *completionTail;
+        unsigned *completionMask;
+        io_uring_cqe *completions;
+    };
+
+    void destroyRing(Ring &ring) {
+        if (ring.entries != MAP_FAILED) {
+            munmap(ring.entries, ring.entriesSize);
+        }
+        if (ring.completionMapping != MAP_FAILED && ring.completionMapping != ring.submissionMapping) {
+            munmap(ring.completionMapping, ring.completionMappingSize);
+        }
+        if (ring.submissionMapping != MAP_FAILED) {
+            munmap(ring.submissionMapping, ring.submissionMappingSize);
+        }
+        if (ring.fd >= 0) {
+            close(ring.fd);
+        }
+    }
+
+    // Returns false if io_uring isn't available
+    bool setupRing(uint32 entriesCount, Ring &ring) {
+        io_uring_params parameters;
+        memset(&parameters, 0, sizeof(parameters));
+        ring.fd = syscall(__NR_io_uring_setup, entriesCount, &parameters);
+        if (ring.fd < 0) {
+            return false;
+        }
+
+        ring.submissionMappingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+        ring.completionMappingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+        bool isSingleMapping = (parameters.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (isSingleMapping) {
+            ring.submissionMappingSize = ring.completionMappingSize = max(ring.submissionMappingSize, ring.completionMappingSize);
+        }
+
+        ring.submissionMapping = mmap(nullptr, ring.submissionMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            ring.fd, IORING_OFF_SQ_RING);
+        if (ring.submissionMapping == MAP_FAILED) {
+            destroyRing(ring);
+            return false;
+        }
+        ring.completionMapping = isSingleMapping ? ring.submissionMapping
+            : mmap(nullptr, ring.completionMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+        ring.entriesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+        ring.entries = (io_uring_sqe *)mmap(nullptr, ring.entriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            ring.fd, IORING_OFF_SQES);
+        if (ring.completionMapping == MAP_FAILED || ring.entries == MAP_FAILED) {
+            destroyRing(ring);
+            return false;
+        }
+
+        uchar *submission = (uchar *)ring.submissionMapping;
+        ring.submissionTail = (unsigned *)(submission + parameters.sq_off.tail);
+        ring.submissionMask = (unsigned *)(submission + parameters.sq_off.ring_mask);
+        ring.submissionArray = (unsigned *)(submission + parameters.sq_off.array);
+        uchar *completion = (uchar *)ring.completionMapping;
+        ring.completionHead = (unsigned *)(completion + parameters.cq_off.head);
+        ring.completionTail = (unsigned *)(completion + parameters.cq_off.tail);
+        ring.completionMask = (unsigned *)(completion + parameters.cq_off.ring_mask);
+        ring.completions = (io_uring_cqe *)(completion + parameters.cq_off.cqes);
+        return true;
+    }
+
+    // The reads are queued to the kernel, and the consumer collects their completions in order.
+    // At most one read per slot is in flight, so the queues never overflow
+    class IoUringReadPipeline : public ReadPipeline {
+    public:
+        IoUringReadPipeline(int fd, uint64 fileSize, bool isDirect, const InputOptions &options, const Ring &ring)
+            : fd(fd), fileSize(fileSize), isDirect(isDirect), slots(options.ioDepth, options.readBufferSize, isDirect), ring(ring),
+              nextOffset(0), submittedCount(0), consumedCount(0), inFlightCount(0), queuedCount(0), isHandedOut(false) {
+            while (submittedCount < slots.size() && nextOffset < fileSize) {
+                submitRead();
+            }
+            enter(0);
+        }
+
+        ~IoUringReadPipeline() override {
+            // The kernel may still write into the buffers
+            try {
+                while (inFlightCount > 0) {
+                    enter(1);
+                    reapCompletions(false);
+                }
+            } catch (...) {
+            }
+            destroyRing(ring);
+            close(fd);
+        }
+
+        bool next(const uchar *&data, size_t &size) override {
+            if (isHandedOut) {
+                isHandedOut = false;
+                if (nextOffset < fileSize) {
+                    submitRead();
+                    enter(0);
+                }
+            }
+            if (consumedCount == submittedCount) {
+                return false;
+            }
+
+            Slot &slot = slots[consumedCount];
+            while (!slot.isReady) {
+                enter(1);
+                reapCompletions(true);
+            }
+            if (slot.error != 0) {
+                throwReadError(slot.error);
+            }
+            if (slot.size == 0) {
+                return false;
+            }
+
+            data = slot.buffer;
+            size = slot.size;
+            consumedCount++;
+            isHandedOut = true;
+            // The file has been cut short: the reads beyond its end are left unconsumed
+            if (slot.size < slot.expectedSize) {
+                submittedCount = consumedCount;
+                nextOffset = fileSize;
+            }
+            return true;
+        }
+
+        ReadBackend getBackend() const override {
+            return ReadBackend::IoUring;
+        }
+
+    private:
+        int fd;
+        uint64 fileSize;
+        bool isDirect;
+        Slots slots;
+        Ring ring;
+
+        uint64 nextOffset;
+        uint64 submittedCount;
+        uint64 consumedCount;
+        uint32 inFlightCount;
+        // The entries added to the submission queue but not passed to the kernel yet
+        uint32 queuedCount;
+        bool isHandedOut;
+
+        void submitRead() {
+            Slot &slot = slots[submittedCount];
+            slot.offset = nextOffset;
+            slot.expectedSize = min(uint64(slots.getBufferSize()), fileSize - nextOffset);
+            slot.size = 0;
+            slot.error = 0;
+            slot.isReady = false;
+            queueRead(submittedCount % slots.size());
+            nextOffset += slots.getBufferSize();
+            submittedCount++;
+        }
+
+        // Queues the read of the rest of the slot's portion
+        void queueRead(size_t index) {
+            Slot &slot = slots[index];
+            // The direct reads must be of whole blocks, the last one is cut by the end of file
+            size_t requestedSize = isDirect ? slots.getBufferSize() : slot.expectedSize;
+            slot.ioVector.iov_base = slot.buffer + slot.size;
+            slot.ioVector.iov_len = requestedSize - slot.size;
+
+            unsigned tail = *ring.submissionTail;
+            unsigned entryIndex = tail & *ring.submissionMask;
+            io_uring_sqe &entry = ring.entries[entryIndex];
+            memset(&entry, 0, sizeof(entry));
+            entry.opcode = IORING_OP_READV;
+            entry.fd = fd;
+            entry.off = slot.offset + slot.size;
+            entry.addr = (uint64)&slot.ioVector;
+            entry.len = 1;
+            entry.user_data = index;
+            ring.submissionArray[entryIndex] = entryIndex;
+            // The kernel must see the entry before the new tail
+            __atomic_store_n(ring.submissionTail, tail + 1, __ATOMIC_RELEASE);
+            queuedCount++;
+            inFlightCount++;
+        }
+
+        // Passes the queued entries to the kernel and waits for `minCompletions`
+        void enter(uint32 minCompletions) {
+            while (queuedCount > 0 || minCompletions > 0) {
+                int submitted = syscall(__NR_io_uring_enter, ring.fd, queuedCount, minCompletions,
+                    minCompletions > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+                if (submitted < 0) {
+                    if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                        continue;
+                    }
+                    throwReadError(errno);
+                }
+                queuedCount -= submitted;
+                minCompletions = 0;
+            }
+        }
+
+        void reapCompletions(bool resubmitPartial) {
+            unsigned head = *ring.completionHead;
+            while (head != __atomic_load_n(ring.completionTail, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe &completion = ring.completions[head & *ring.completionMask];
+                size_t index = completion.user_data;
+                int result = completion.res;
+                head++;
+                inFlightCount--;
+
+                Slot &slot = slots[index];
+                if (result == -EINTR || result == -EAGAIN) {
+                    if (resubmitPartial) {
+                        queueRead(index);
+                        continue;
+                    }
+                    result = 0;
+                }
+                if (result < 0) {
+                    slot.error = -result;
+                } else {
+                    slot.size += result;
+                    // The short read before the end of file is continued
+                    if (result > 0 && slot.size < slot.expectedSize && resubmitPartial && canContinueRead(slot, isDirect)) {
+                        queueRead(index);
+                        continue;
+                    }
+                }
+                slot.isReady = true;
+            }
+            __atomic_store_n(ring.completionHead, head, __ATOMIC_RELEASE);
+            enter(0);
+        }
+    };
+
+#endif
+
+}
+
+unique_ptr<ReadPipeline> createReadPipeline(int fd, uint64 fileSize, bool isDirect, const InputOptions &options) {
+    // The kernel is allowed to read ahead aggressively (the direct reads bypass the page cache anyway)
+    if (!isDirect) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+#ifdef __linux__
+    Ring ring;
+    if (options.allowIoUring && setupRing(max(1u, options.ioDepth), ring)) {
+        return unique_ptr<ReadPipeline>(new IoUringReadPipeline(fd, fileSize, isDirect, options, ring));
+    }
+#endif
+    return unique_ptr<ReadPipeline>(new ThreadReadPipeline(fd, fileSize, isDirect, options));
+}
+
+#endif
@@ -0,0 +1,277 @@
+#include "../../include/utils/stats.hpp"
+#include "../../include/utils/cpuFeatures.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#if ZIPPY_X86
+#include <x86intrin.h>
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+StatsCounters &StatsCounters::operator+=(const StatsCounters &other) {
+    for (size_t i = 0; i < STAGES_COUNT; i++) {
+        ticks[i] += other.ticks[i];
+    }
+    bytes += other.bytes;
+    reads += other.reads;
+    files += other.files;
+    return *this;
+}
+
+StatsCounters StatsCounters::operator-(const StatsCounters &other) const {
+    StatsCounters difference;
+    for (size_t i = 0; i < STAGES_COUNT; i++) {
+        difference.ticks[i] = ticks[i] - other.ticks[i];
+    }
+    difference.bytes = bytes - other.bytes;
+    difference.reads = reads - other.reads;
+    difference.files = files - other.files;
+    return difference;
+}
+
+StatsCounters StatsCounters::share(uint64 bytes, uint64 totalBytes) const {
+    StatsCounters part;
+    // The empty files share the time equally
+    double ratio = totalBytes != 0 ? double(bytes) / totalBytes : files != 0 ? 1.0 / files : 0;
+    for (size_t i = 0; i < STAGES_COUNT; i++) {
+        part.ticks[i] = uint64(ticks[i] * ratio);
+    }
+    part.bytes = bytes;
+    part.reads = uint64(reads * ratio);
+    part.files = 1;
+    return part;
+}
+
+#if ZIPPY_STATS
+
+namespace {
+
+    const size_t COUNTERS_COUNT = STAGES_COUNT + 3;
+    const size_t BYTES_COUNTER = STAGES_COUNT;
+    const size_t READS_COUNTER = STAGES_COUNT + 1;
+    const size_t FILES_COUNTER = STAGES_COUNT + 2;
+
+    StatsCounters toStatsCounters(const array<uint64, COUNTERS_COUNT> &values) {
+        StatsCounters counters;
+        copy(values.begin(), values.begin() + STAGES_COUNT, counters.ticks.begin());
+        counters.bytes = values[BYTES_COUNTER];
+        counters.reads = values[READS_COUNTER];
+        counters.files = values[FILES_COUNTER];
+        return counters;
+    }
+
+    class ThreadCounters;
+
+    // The counters of the running threads are summed on demand, the ones of the finished threads are kept in the `retired`
+    struct Registry {
+        mutex lock;
+        unordered_set<ThreadCounters *> threads;
+        StatsCounters retired;
+        // Subtracted from the sum by `getProcessStats`
+        StatsCounters baseline;
+    };
+
+    Registry &getRegistry() {
+        // Never destroyed: the threads may finish after the static objects are
+        static Registry *registry = new Registry();
+        return *registry;
+    }
+
+    // Only the owning thread writes the counters, so the relaxed atomics are enough to read them from the other threads
+    class ThreadCounters {
+    public:
+        ThreadCounters() {
+            for (atomic<uint64> &value : values) {
+                value.store(0, memory_order_relaxed);
+            }
+            Registry &registry = getRegistry();
+            lock_guard<mutex> guard(registry.lock);
+            registry.threads.insert(this);
+        }
+
+        ~ThreadCounters() {
+            Registry &registry = getRegistry();
+            lock_guard<mutex> guard(registry.lock);
+            registry.retired += read();
+            registry.threads.erase(this);
+        }
+
+        void add(size_t index, uint64 delta) {
+            values[index].store(values[index].load(memory_order_relaxed) + delta, memory_order_relaxed);
+        }
+
+        StatsCounters read() const {
+            array<uint64, COUNTERS_COUNT> snapshot;
+            for (size_t i = 0; i < COUNTERS_COUNT; i++) {
+                snapshot[i] = values[i].load(memory_order_relaxed);
+            }
+            return toStatsCounters(snapshot);
+        }
+
+    private:
+        array<atomic<uint64>, COUNTERS_COUNT> values;
+    };
+
+    ThreadCounters &getThreadCounters() {
+        thread_local ThreadCounters counters;
+        return counters;
+    }
+
+    StatsCounters sumCounters(Registry &registry) {
+        StatsCounters sum = registry.retired;
+        for (const ThreadCounters *counters : registry.threads) {
+            sum += counters->read();
+        }
+        return sum;
+    }
+
+    // The TSC runs at the constant rate: it's measured against the steady clock since the library has been loaded,
+    // waiting for at least `CALIBRATION_TIME` if it has been loaded just now
+    const chrono::milliseconds CALIBRATION_TIME(20);
+    const chrono::steady_clock::time_point calibrationStartTime = chrono::steady_clock::now();
+    const uint64 calibrationStartTicks = readTicks();
+
+    double measureTicksPerSecond() {
+#if ZIPPY_X86
+        this_thread::sleep_until(calibrationStartTime + CALIBRATION_TIME);
+        uint64 ticks = readTicks() - calibrationStartTicks;
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - calibrationStartTime).count();
+        return ticks / seconds;
+#else
+        return 1e9;
+#endif
+    }
+
+}
+
+uint64 readTicks() {
+#if ZIPPY_X86
+    return __rdtsc();
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+double ticksToSeconds(uint64 ticks) {
+    static const double ticksPerSecond = measureTicksPerSecond();
+    return ticks / ticksPerSecond;
+}
+
+void addStageTicks(Stage stage, uint64 ticks) {
+    getThreadCounters().add((size_t)stage, ticks);
+}
+
+void addReadBytes(uint64 bytes) {
+    ThreadCounters &counters = getThreadCounters();
+    counters.add(BYTES_COUNTER, bytes);
+    counters.add(READS_COUNTER, 1);
+}
+
+StatsCounters getThreadStats() {
+    return getThreadCounters().read();
+}
+
+StatsCounters getProcessStats() {
+    Registry &registry = getRegistry();
+    lock_guard<mutex> guard(registry.lock);
+    return sumCounters(registry) - registry.baseline;
+}
+
+void resetProcessStats() {
+    Registry &registry = getRegistry();
+    lock_guard<mutex> guard(registry.lock);
+    registry.baseline = sumCounters(registry);
+}
+
+StatsCounters FileStatsScope::finish(uint64 filesCount) {
+    uint64 elapsedTicks = readTicks() - startTicks;
+    StatsCounters counters = getThreadStats() - start;
+
+    // The nested scopes have counted their time already
+    uint64 measuredTicks = 0;
+    for (uint64 ticks : counters.ticks) {
+        measuredTicks += ticks;
+    }
+    uint64 restTicks = elapsedTicks > measuredTicks ? elapsedTicks - measuredTicks : 0;
+
+    ThreadCounters &threadCounters = getThreadCounters();
+    threadCounters.add((size_t)stage, restTicks);
+    threadCounters.add(FILES_COUNTER, filesCount);
+    counters.ticks[(size_t)stage] += restTicks;
+    counters.files += filesCount;
+    return counters;
+}
+
+#endif
+
+#ifdef __linux__
+
+namespace {
+
+    int openPerfCounter(uint64 config) {
+        perf_event_attr attributes {};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = config;
+        attributes.inherit = 1;
+        // The unprivileged processes may count the user space only
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        return syscall(SYS_perf_event_open, &attributes, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    }
+
+    uint64 readPerfCounter(int fd) {
+        uint64 value = 0;
+        return fd >= 0 && ::read(fd, &value, sizeof(value)) == sizeof(value) ? value : 0;
+    }
+
+}
+
+PerfCounters::PerfCounters()
+    : fds { openPerfCounter(PERF_COUNT_HW_CPU_CYCLES), openPerfCounter(PERF_COUNT_HW_INSTRUCTIONS), openPerfCounter(PERF_COUNT_HW_CACHE_MISSES) } {}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+bool PerfCounters::isAvailable() const {
+    return fds[0] >= 0 || fds[1] >= 0 || fds[2] >= 0;
+}
+
+PerfReadout PerfCounters::read() const {
+    PerfReadout readout;
+    readout.cycles = readPerfCounter(fds[0]);
+    readout.instructions = readPerfCounter(fds[1]);
+    readout.cacheMisses = readPerfCounter(fds[2]);
+    return readout;
+}
+
+#else
+
+PerfCounters::PerfCounters() : fds { -1, -1, -1 } {}
+
+PerfCounters::~PerfCounters() {}
+
+bool PerfCounters::isAvailable() const {
+    return false;
+}
+
+PerfReadout PerfCounters::read() const {
+    return PerfReadout();
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include "../../include/utils/threadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32 threadsCount)
+    : nextQueue(0), runningLongTasksCount(0), queuedTasksCount(0), pendingTasksCount(0), isStopping(false) {
+    if (threadsCount == 0) {
+        threadsCount = max(1u, thread::hardware_concurrency());
+    }
+    maxRunningLongTasksCount = max(1u, threadsCount - 1);
+
+    for (uint32 i = 0; i < threadsCount; i++) {
+        queues.emplace_back(new Queue());
+    }
+    for (uint32 i = 0; i < threadsCount; i++) {
+        threads.emplace_back(&ThreadPool::runWorker, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        lock_guard<mutex> guard(stateLock);
+        isStopping = true;
+    }
+    hasTasks.notify_all();
+    for (thread &worker : threads) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Task task, bool isLong) {
+    Queue &queue = isLong ? longTasks : *queues[nextQueue++ % queues.size()];
+    {
+        lock_guard<mutex> guard(queue.lock);
+        queue.tasks.push_back(move(task));
+    }
+    {
+        lock_guard<mutex> guard(stateLock);
+        queuedTasksCount++;
+        pendingTasksCount++;
+    }
+    hasTasks.notify_one();
+}
+
+void ThreadPool::wait() {
+    unique_lock<mutex> guard(stateLock);
+    isIdle.wait(guard, [this] { return pendingTasksCount == 0; });
+}
+
+uint32 ThreadPool::getThreadsCount() const {
+    return threads.size();
+}
+
+void ThreadPool::runWorker(uint32 index) {
+    while (true) {
+        Task task;
+        bool isLong;
+        if (takeTask(index, task, isLong)) {
+            task();
+            if (isLong) {
+                runningLongTasksCount--;
+            }
+
+            lock_guard<mutex> guard(stateLock);
+            if (--pendingTasksCount == 0) {
+                isIdle.notify_all();
+            }
+            continue;
+        }
+
+        unique_lock<mutex> guard(stateLock);
+        hasTasks.wait(guard, [this] { return isStopping || queuedTasksCount > 0; });
+        if (isStopping && queuedTasksCount == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::takeTask(uint32 index, Task &task, bool &isLong) {
+    // The long tasks are started first (while the limit allows): the sooner they start, the sooner the batch ends
+    isLong = takeLongTask(task, false);
+    bool isTaken = isLong || popFront(*queues[index], task);
+
+    // Steal from the other workers
+    for (uint32 i = 1; !isTaken && i < queues.size(); i++) {
+        isTaken = popBack(*queues[(index + i) % queues.size()], task);
+    }
+
+    // There are no short tasks left: the limit of long tasks doesn't matter anymore
+    if (!isTaken) {
+        isLong = isTaken = takeLongTask(task, true);
+    }
+
+    if (isTaken) {
+        lock_guard<mutex> guard(stateLock);
+        queuedTasksCount--;
+    }
+    return isTaken;
+}
+
+bool ThreadPool::takeLongTask(Task &task, bool force) {
+    uint32 running = runningLongTasksCount.load();
+    do {
+        if (!force && running >= maxRunningLongTasksCount) {
+            return false;
+        }
+    } while (!runningLongTasksCount.compare_exchange_weak(running, running + 1));
+
+    if (popFront(longTasks, task)) {
+        return true;
+    }
+    runningLongTasksCount--;
+    return false;
+}
+
+bool ThreadPool::popFront(Queue &queue, Task &task) {
+    lock_guard<mutex> guard(queue.lock);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::popBack(Queue &queue, Task &task) {
+    lock_guard<mutex> guard(queue.lock);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
@@ -0,0 +1,404 @@
+#include "../include/lib/xxhash.hpp"
+
+#include <cstring>
+
+#include "../include/utils/cpuFeatures.hpp"
+#include "../include/utils/fileValidator.hpp"
+
+namespace xxhash {
+
+    const uint64 PRIME64_1 = 0x9E3779B185EBCA87;
+    const uint64 PRIME64_2 = 0xC2B2AE3D27D4EB4F;
+    const uint64 PRIME64_3 = 0x165667B19E3779F9;
+    const uint64 PRIME64_4 = 0x85EBCA77C2B2AE63;
+    const uint64 PRIME64_5 = 0x27D4EB2F165667C5;
+
+    // The helpers shared by both hashes
+    namespace _xxhash {
+        // The byte loops are recognized by the compiler as the single loads
+        inline uint32 loadLittleEndian32(const uchar *data) {
+            return data[0] | data[1] << 8 | data[2] << 16 | uint32(data[3]) << 24;
+        }
+
+        inline uint64 loadLittleEndian64(const uchar *data) {
+            return loadLittleEndian32(data) | uint64(loadLittleEndian32(data + 4)) << 32;
+        }
+
+        inline uint64 rotateLeft(uint64 x, uchar shift) {
+            return (x << shift) | (x >> (64 - shift));
+        }
+
+        inline XxhashDigest toDigest(uint64 hash) {
+            XxhashDigest digest;
+            for (uchar i = 0; i < 8; i++) {
+                digest[i] = uchar(hash >> (56 - 8 * i));
+            }
+            return digest;
+        }
+
+        // The final mix of XXH64, also the one of the tiniest messages of XXH3
+        inline uint64 avalanche64(uint64 hash) {
+            hash ^= hash >> 33;
+            hash *= PRIME64_2;
+            hash ^= hash >> 29;
+            hash *= PRIME64_3;
+            return hash ^ (hash >> 32);
+        }
+
+        template <typename Hasher>
+        XxhashDigest hashReader(InputReader &reader) {
+            Hasher hasher;
+            const uchar *data;
+            size_t size;
+
+            // Feed the hasher until the end of input: its size doesn't have to be known up front
+            while (reader.next(data, size)) {
+                hasher.update(data, size);
+            }
+            return hasher.final();
+        }
+    }
+
+    using namespace _xxhash;
+
+    namespace _xxh64 {
+        inline uint64 round(uint64 lane, uint64 input) {
+            lane += input * PRIME64_2;
+            return rotateLeft(lane, 31) * PRIME64_1;
+        }
+
+        inline uint64 mergeRound(uint64 hash, uint64 lane) {
+            hash ^= round(0, lane);
+            return hash * PRIME64_1 + PRIME64_4;
+        }
+
+        inline const uchar *processStripes(uint64 *lanes, const uchar *data, size_t stripesCount) {
+            uint64 v1 = lanes[0], v2 = lanes[1], v3 = lanes[2], v4 = lanes[3];
+            for (; stripesCount != 0; stripesCount--, data += Xxh64Hasher::STRIPE_SIZE_IN_BYTES) {
+                v1 = round(v1, loadLittleEndian64(data));
+                v2 = round(v2, loadLittleEndian64(data + 8));
+                v3 = round(v3, loadLittleEndian64(data + 16));
+                v4 = round(v4, loadLittleEndian64(data + 24));
+            }
+            lanes[0] = v1, lanes[1] = v2, lanes[2] = v3, lanes[3] = v4;
+            return data;
+        }
+    }
+
+    Xxh64Hasher::Xxh64Hasher() {
+        reset();
+    }
+
+    void Xxh64Hasher::reset() {
+        lanes[0] = PRIME64_1 + PRIME64_2;
+        lanes[1] = PRIME64_2;
+        lanes[2] = 0;
+        lanes[3] = -PRIME64_1;
+        bufferSize = 0;
+        messageSize = 0;
+    }
+
+    void Xxh64Hasher::update(const uchar *data, size_t size) {
+        messageSize += size;
+        if (bufferSize + size < STRIPE_SIZE_IN_BYTES) {
+            memcpy(buffer + bufferSize, data, size);
+            bufferSize += size;
+            return;
+        }
+
+        if (bufferSize != 0) {
+            size_t fillSize = STRIPE_SIZE_IN_BYTES - bufferSize;
+            memcpy(buffer + bufferSize, data, fillSize);
+            _xxh64::processStripes(lanes, buffer, 1);
+            data += fillSize;
+            size -= fillSize;
+        }
+
+        data = _xxh64::processStripes(lanes, data, size / STRIPE_SIZE_IN_BYTES);
+        bufferSize = size % STRIPE_SIZE_IN_BYTES;
+        memcpy(buffer, data, bufferSize);
+    }
+
+    XxhashDigest Xxh64Hasher::final() {
+        uint64 hash;
+        if (messageSize >= STRIPE_SIZE_IN_BYTES) {
+            hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+            for (uint64 lane : lanes) {
+                hash = _xxh64::mergeRound(hash, lane);
+            }
+        } else {
+            hash = PRIME64_5;
+        }
+        hash += messageSize;
+
+        const uchar *data = buffer;
+        const uchar *end = buffer + bufferSize;
+        for (; data + 8 <= end; data += 8) {
+            hash ^= _xxh64::round(0, loadLittleEndian64(data));
+            hash = rotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+        }
+        if (data + 4 <= end) {
+            hash ^= uint64(loadLittleEndian32(data)) * PRIME64_1;
+            hash = rotateLeft(hash, 23) * PRIME64_2 + PRIME64_3;
+            data += 4;
+        }
+        for (; data < end; data++) {
+            hash ^= *data * PRIME64_5;
+            hash = rotateLeft(hash, 11) * PRIME64_1;
+        }
+
+        reset();
+        return toDigest(avalanche64(hash));
+    }
+
+    namespace _xxh3 {
+        // The 64 x 64-bit products need the 128-bit integers of GCC and Clang
+        typedef unsigned __int128 uint128;
+
+        const uint64 PRIME_MX1 = 0x165667919E3779F9;
+        const uint64 PRIME_MX2 = 0x9FB21C651E98DF25;
+
+        inline uint64 multiplyFold(uint64 x, uint64 y) {
+            uint128 product = uint128(x) * y;
+            return uint64(product) ^ uint64(product >> 64);
+        }
+
+        inline uint64 avalanche(uint64 hash) {
+            hash ^= hash >> 37;
+            hash *= PRIME_MX1;
+            return hash ^ (hash >> 32);
+        }
+
+        // The stronger mix of the messages of 4 to 8 bytes
+        inline uint64 rrmxmx(uint64 hash, uint64 size) {
+            hash ^= rotateLeft(hash, 49) ^ rotateLeft(hash, 24);
+            hash *= PRIME_MX2;
+            hash ^= (hash >> 35) + size;
+            hash *= PRIME_MX2;
+            return hash ^ (hash >> 28);
+        }
+
+        inline uint64 mix16Bytes(const uchar *data, const uchar *secret) {
+            return multiplyFold(
+                loadLittleEndian64(data) ^ loadLittleEndian64(secret), loadLittleEndian64(data + 8) ^ loadLittleEndian64(secret + 8)
+            );
+        }
+
+        // The messages up to 240 bytes are hashed at once by the paths of their size classes
+        uint64 hashShort(const uchar *data, size_t size) {
+            if (size == 0) {
+                return avalanche64(loadLittleEndian64(SECRET + 56) ^ loadLittleEndian64(SECRET + 64));
+            }
+            if (size <= 3) {
+                uint32 combined = uint32(data[0]) << 16 | uint32(data[size >> 1]) << 24 | data[size - 1] | uint32(size) << 8;
+                return avalanche64(combined ^ uint64(loadLittleEndian32(SECRET) ^ loadLittleEndian32(SECRET + 4)));
+            }
+            if (size <= 8) {
+                uint64 input = loadLittleEndian32(data + size - 4) + (uint64(loadLittleEndian32(data)) << 32);
+                return rrmxmx(input ^ (loadLittleEndian64(SECRET + 8) ^ loadLittleEndian64(SECRET + 16)), size);
+            }
+            if (size <= 16) {
+                uint64 low = loadLittleEndian64(data) ^ loadLittleEndian64(SECRET + 24) ^ loadLittleEndian64(SECRET + 32);
+                uint64 high = loadLittleEndian64(data + size - 8) ^ loadLittleEndian64(SECRET + 40) ^ loadLittleEndian64(SECRET + 48);
+                return avalanche(size + __builtin_bswap64(low) + high + multiplyFold(low, high));
+            }
+
+            uint64 hash = size * PRIME64_1;
+            if (size <= 128) {
+                // The pairs of 16 bytes from both ends towards the middle
+                uchar pairsCount = (size - 1) / 32 + 1;
+                for (uchar i = pairsCount; i-- != 0;) {
+                    hash += mix16Bytes(data + 16 * i, SECRET + 32 * i);
+                    hash += mix16Bytes(data + size - 16 * (i + 1), SECRET + 32 * i + 16);
+                }
+                return avalanche(hash);
+            }
+
+            uchar roundsCount = size / 16;
+            for (uchar i = 0; i < 8; i++) {
+                hash += mix16Bytes(data + 16 * i, SECRET + 16 * i);
+            }
+            hash = avalanche(hash);
+            for (uchar i = 8; i < roundsCount; i++) {
+                hash += mix16Bytes(data + 16 * i, SECRET + 16 * (i - 8) + 3);
+            }
+            // The last 16 bytes with the secret at the offset of the minimal custom secret (136 bytes) minus 17
+            hash += mix16Bytes(data + size - 16, SECRET + 119);
+            return avalanche(hash);
+        }
+
+        uint64 mergeAccumulators(const uint64 *accumulators, const uchar *secret, uint64 start) {
+            uint64 hash = start;
+            for (uchar i = 0; i < ACCUMULATORS_COUNT; i += 2) {
+                hash += multiplyFold(
+                    accumulators[i] ^ loadLittleEndian64(secret + 8 * i),
+                    accumulators[i + 1] ^ loadLittleEndian64(secret + 8 * i + 8)
+                );
+            }
+            return avalanche(hash);
+        }
+
+        void accumulateStripeScalar(uint64 *accumulators, const uchar *data, const uchar *secret) {
+            for (uchar i = 0; i < ACCUMULATORS_COUNT; i++) {
+                uint64 input = loadLittleEndian64(data + 8 * i);
+                uint64 key = input ^ loadLittleEndian64(secret + 8 * i);
+                accumulators[i ^ 1] += input;
+                accumulators[i] += (key & 0xFFFFFFFF) * (key >> 32);
+            }
+        }
+
+        void accumulateStripesScalar(uint64 *accumulators, const uchar *data, size_t stripesCount, uchar &stripeIndex) {
+            for (; stripesCount != 0; stripesCount--, data += STRIPE_SIZE_IN_BYTES) {
+                accumulateStripeScalar(accumulators, data, SECRET + stripeIndex * 8);
+                if (++stripeIndex == STRIPES_PER_BLOCK) {
+                    for (uchar i = 0; i < ACCUMULATORS_COUNT; i++) {
+                        uint64 accumulator = accumulators[i];
+                        accumulator ^= accumulator >> 47;
+                        accumulator ^= loadLittleEndian64(SECRET + SCRAMBLE_SECRET_OFFSET + 8 * i);
+                        accumulators[i] = accumulator * PRIME32_1;
+                    }
+                    stripeIndex = 0;
+                }
+            }
+        }
+
+        StripesFunction *selectStripesFunction() {
+            const CpuFeatures &features = getCpuFeatures();
+            Implementation implementation = getForcedImplementation();
+
+            switch (implementation) {
+                case Implementation::Auto:
+                    if (features.avx512f) {
+                        return accumulateStripesAvx512;
+                    }
+                    if (features.avx2) {
+                        return accumulateStripesAvx2;
+                    }
+                    return features.ssse3 ? accumulateStripesSsse3 : accumulateStripesScalar;
+                case Implementation::Avx512:
+                    ensureImplementationSupported(implementation, features.avx512f);
+                    return accumulateStripesAvx512;
+                case Implementation::Avx2:
+                    ensureImplementationSupported(implementation, features.avx2);
+                    return accumulateStripesAvx2;
+                case Implementation::Ssse3:
+                    ensureImplementationSupported(implementation, features.ssse3);
+                    return accumulateStripesSsse3;
+                default:
+                    return accumulateStripesScalar;
+            }
+        }
+    }
+
+    Xxh3Hasher::Xxh3Hasher() : accumulateStripes(_xxh3::selectStripesFunction()) {
+        reset();
+    }
+
+    void Xxh3Hasher::reset() {
+        const uint64 initialAccumulators[_xxh3::ACCUMULATORS_COUNT] = {
+            _xxh3::PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, _xxh3::PRIME32_2, PRIME64_5, _xxh3::PRIME32_1
+        };
+        memcpy(accumulators, initialAccumulators, sizeof(accumulators));
+        stripeIndex = 0;
+        bufferSize = 0;
+        messageSize = 0;
+    }
+
+    void Xxh3Hasher::update(const uchar *data, size_t size) {
+        using namespace _xxh3;
+
+        messageSize += size;
+        if (size <= BUFFER_SIZE_IN_BYTES - bufferSize) {
+            memcpy(buffer + bufferSize, data, size);
+            bufferSize += size;
+            return;
+        }
+
+        // At least one byte is always left for `final`, so the full buffer is accumulated only when more data follows
+        if (bufferSize != 0) {
+            size_t fillSize = BUFFER_SIZE_IN_BYTES - bufferSize;
+            memcpy(buffer + bufferSize, data, fillSize);
+            accumulateStripes(accumulators, buffer, BUFFER_SIZE_IN_BYTES / STRIPE_SIZE_IN_BYTES, stripeIndex);
+            data += fillSize;
+            size -= fillSize;
+        }
+
+        if (size > STRIPE_SIZE_IN_BYTES) {
+            size_t stripesCount = (size - 1) / STRIPE_SIZE_IN_BYTES;
+            accumulateStripes(accumulators, data, stripesCount, stripeIndex);
+            data += stripesCount * STRIPE_SIZE_IN_BYTES;
+            size -= stripesCount * STRIPE_SIZE_IN_BYTES;
+            memcpy(buffer + BUFFER_SIZE_IN_BYTES - STRIPE_SIZE_IN_BYTES, data - STRIPE_SIZE_IN_BYTES, STRIPE_SIZE_IN_BYTES);
+        }
+        memcpy(buffer, data, size);
+        bufferSize = size;
+    }
+
+    XxhashDigest Xxh3Hasher::final() {
+        using namespace _xxh3;
+
+        uint64 hash;
+        if (messageSize <= MAX_SHORT_MESSAGE_SIZE) {
+            hash = hashShort(buffer, messageSize);
+        } else {
+            // The accumulation continues on the copy, so `final` doesn't depend on the stripes left in the buffer
+            uint64 finalAccumulators[ACCUMULATORS_COUNT];
+            memcpy(finalAccumulators, accumulators, sizeof(accumulators));
+            uchar finalStripeIndex = stripeIndex;
+
+            uchar lastStripe[STRIPE_SIZE_IN_BYTES];
+            const uchar *lastStripeData;
+            if (bufferSize >= STRIPE_SIZE_IN_BYTES) {
+                accumulateStripes(finalAccumulators, buffer, (bufferSize - 1) / STRIPE_SIZE_IN_BYTES, finalStripeIndex);
+                lastStripeData = buffer + bufferSize - STRIPE_SIZE_IN_BYTES;
+            } else {
+                // The last stripe starts within the previous one, which is kept at the end of the buffer
+                size_t previousSize = STRIPE_SIZE_IN_BYTES - bufferSize;
+                memcpy(lastStripe, buffer + BUFFER_SIZE_IN_BYTES - previousSize, previousSize);
+                memcpy(lastStripe + previousSize, buffer, bufferSize);
+                lastStripeData = lastStripe;
+            }
+            accumulateStripeScalar(finalAccumulators, lastStripeData, SECRET + SECRET_SIZE_IN_BYTES - STRIPE_SIZE_IN_BYTES - 7);
+            hash = mergeAccumulators(finalAccumulators, SECRET + 11, messageSize * PRIME64_1);
+        }
+
+        reset();
+        return toDigest(hash);
+    }
+
+    template <typename Hasher>
+    XxhashDigest hashFile(const string &filePath, const InputOptions &options) {
+        return validateFileForHashFunction(filePath, _xxhash::hashReader<Hasher>, options);
+    }
+
+    template <typename Hasher>
+    vector<XxhashDigest> hashFiles(const vector<string> &filePaths, const InputOptions &options) {
+        vector<XxhashDigest> digests;
+        for (const string &filePath : filePaths) {
+            digests.push_back(hashFile<Hasher>(filePath, options));
+        }
+        return digests;
+    }
+
+    template <typename Hasher>
+    vector<XxhashDigest> hashBuffers(const vector<ByteView> &messages) {
+        Hasher hasher;
+        vector<XxhashDigest> digests;
+        for (const ByteView &message : messages) {
+            hasher.update(message.data, message.size);
+            digests.push_back(hasher.final());
+        }
+        return digests;
+    }
+
+#define INSTANTIATE_XXHASH_HASHER(Hasher) \
+    template XxhashDigest hashFile<Hasher>(const string &filePath, const InputOptions &options); \
+    template vector<XxhashDigest> hashFiles<Hasher>(const vector<string> &filePaths, const InputOptions &options); \
+    template vector<XxhashDigest> hashBuffers<Hasher>(const vector<ByteView> &messages);
+
+    INSTANTIATE_XXHASH_HASHER(Xxh64Hasher)
+    INSTANTIATE_XXHASH_HASHER(Xxh3Hasher)
+
+#undef INSTANTIATE_XXHASH_HASHER
+
+}
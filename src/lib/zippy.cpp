@@ -0,0 +1,248 @@
+#include "../include/zippy.h"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <memory>
+
+#include "../include/lib/algorithms.hpp"
+#include "../include/lib/batch.hpp"
+#include "../include/lib/multiDigest.hpp"
+#include "../include/utils/stats.hpp"
+
+// The implementation of the C interface over the registry of algorithms.
+// No exception crosses the interface: they are turned into the statuses
+namespace {
+
+    // Runs the `action` turning the exceptions into the statuses.
+    // The `invalid_argument` means the failure of the input: of the file or of the message itself
+    template <typename Action>
+    ZippyStatus guard(ZippyStatus inputStatus, Action action) {
+        try {
+            action();
+            return ZIPPY_OK;
+        } catch (const invalid_argument &) {
+            return inputStatus;
+        } catch (const bad_alloc &) {
+            return ZIPPY_OUT_OF_MEMORY;
+        } catch (...) {
+            return ZIPPY_INTERNAL_ERROR;
+        }
+    }
+
+    const HashAlgorithm *findAlgorithm(const char *name) {
+        return name != nullptr ? findHashAlgorithm(name) : nullptr;
+    }
+
+    void copyDigest(const HashDigest &digest, uint8_t *target) {
+        memcpy(target, digest.data(), digest.getSize());
+    }
+
+}
+
+struct ZippyHasher {
+    unique_ptr<StreamingHasher> hasher;
+};
+
+uint32_t zippyApiVersion(void) {
+    return ZIPPY_API_VERSION;
+}
+
+const char *zippyStatusMessage(ZippyStatus status) {
+    switch (status) {
+        case ZIPPY_OK: return "OK";
+        case ZIPPY_UNKNOWN_ALGORITHM: return "Unknown algorithm";
+        case ZIPPY_INVALID_ARGUMENT: return "Invalid argument";
+        case ZIPPY_IO_ERROR: return "Can't read the input";
+        case ZIPPY_OUT_OF_MEMORY: return "Out of memory";
+        case ZIPPY_INTERNAL_ERROR: return "Internal error";
+    }
+    return "Unknown status";
+}
+
+const char *zippyAlgorithmName(size_t index) {
+    const vector<HashAlgorithm> &algorithms = getHashAlgorithms();
+    return index < algorithms.size() ? algorithms[index].name.c_str() : nullptr;
+}
+
+size_t zippyDigestSize(const char *algorithm) {
+    const HashAlgorithm *hashAlgorithm = findAlgorithm(algorithm);
+    return hashAlgorithm != nullptr ? hashAlgorithm->digestSize : 0;
+}
+
+ZippyStatus zippyHash(const char *algorithm, const void *data, size_t size, uint8_t *digest) {
+    const HashAlgorithm *hashAlgorithm = findAlgorithm(algorithm);
+    if (hashAlgorithm == nullptr) {
+        return ZIPPY_UNKNOWN_ALGORITHM;
+    }
+    if ((data == nullptr && size != 0) || digest == nullptr) {
+        return ZIPPY_INVALID_ARGUMENT;
+    }
+
+    return guard(ZIPPY_INVALID_ARGUMENT, [&] {
+        unique_ptr<StreamingHasher> hasher = hashAlgorithm->createHasher();
+        hasher->update((const uchar *)data, size);
+        copyDigest(hasher->final(), digest);
+    });
+}
+
+ZippyStatus zippyHasherCreate(const char *algorithm, ZippyHasher **hasher) {
+    const HashAlgorithm *hashAlgorithm = findAlgorithm(algorithm);
+    if (hashAlgorithm == nullptr) {
+        return ZIPPY_UNKNOWN_ALGORITHM;
+    }
+    if (hasher == nullptr) {
+        return ZIPPY_INVALID_ARGUMENT;
+    }
+
+    return guard(ZIPPY_INVALID_ARGUMENT, [&] {
+        unique_ptr<ZippyHasher> created(new ZippyHasher { hashAlgorithm->createHasher() });
+        *hasher = created.release();
+    });
+}
+
+ZippyStatus zippyHasherUpdate(ZippyHasher *hasher, const void *data, size_t size) {
+    if (hasher == nullptr || (data == nullptr && size != 0)) {
+        return ZIPPY_INVALID_ARGUMENT;
+    }
+
+    return guard(ZIPPY_INVALID_ARGUMENT, [&] {
+        hasher->hasher->update((const uchar *)data, size);
+    });
+}
+
+ZippyStatus zippyHasherFinal(ZippyHasher *hasher, uint8_t *digest) {
+    if (hasher == nullptr || digest == nullptr) {
+        return ZIPPY_INVALID_ARGUMENT;
+    }
+
+    return guard(ZIPPY_INVALID_ARGUMENT, [&] {
+        copyDigest(hasher->hasher->final(), digest);
+    });
+}
+
+void zippyHasherDestroy(ZippyHasher *hasher) {
+    delete hasher;
+}
+
+ZippyStatus zippyHashFile(const char *algorithm, const char *filePath, uint8_t *digest) {
+    const HashAlgorithm *hashAlgorithm = findAlgorithm(algorithm);
+    if (hashAlgorithm == nullptr) {
+        return ZIPPY_UNKNOWN_ALGORITHM;
+    }
+    if (filePath == nullptr || digest == nullptr) {
+        return ZIPPY_INVALID_ARGUMENT;
+    }
+
+    return guard(ZIPPY_IO_ERROR, [&] {
+        FileStatsScope statsScope;
+        copyDigest(hashAlgorithm->hashFile(filePath, InputOptions()), digest);
+        statsScope.finish();
+    });
+}
+
+ZippyStatus zippyHashDescriptor(const char *algorithm, int fd, uint8_t *digest) {
+    const HashAlgorithm *hashAlgorithm = findAlgorithm(algorithm);
+    if (hashAlgorithm == nullptr) {
+        return ZIPPY_UNKNOWN_ALGORITHM;
+    }
+    if (fd < 0 || digest == nullptr) {
+        return ZIPPY_INVALID_ARGUMENT;
+    }
+
+    return guard(ZIPPY_IO_ERROR, [&] {
+        FileStatsScope statsScope;
+        copyDigest(hashDescriptorWithAlgorithms(fd, { hashAlgorithm })[0], digest);
+        statsScope.finish();
+    });
+}
+
+ZippyStatus zippyHashBatch(const char *algorithm, const void *const *messages, const size_t *sizes, size_t count, uint8_t *digests) {
+    const HashAlgorithm *hashAlgorithm = findAlgorithm(algorithm);
+    if (hashAlgorithm == nullptr) {
+        return ZIPPY_UNKNOWN_ALGORITHM;
+    }
+    if (count != 0 && (messages == nullptr || sizes == nullptr || digests == nullptr)) {
+        return ZIPPY_INVALID_ARGUMENT;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (messages[i] == nullptr && sizes[i] != 0) {
+            return ZIPPY_INVALID_ARGUMENT;
+        }
+    }
+
+    return guard(ZIPPY_INVALID_ARGUMENT, [&] {
+        vector<ByteView> views(count);
+        for (size_t i = 0; i < count; i++) {
+            views[i] = { (const uchar *)messages[i], sizes[i] };
+        }
+        vector<HashDigest> results = hashAlgorithm->hashBuffers(views);
+        for (size_t i = 0; i < count; i++) {
+            copyDigest(results[i], digests + i * hashAlgorithm->digestSize);
+        }
+    });
+}
+
+ZippyStatus zippyHashFiles(
+    const char *algorithm, const char *const *filePaths, size_t count, uint32_t threadsCount, uint8_t *digests, ZippyStatus *statuses
+) {
+    const HashAlgorithm *hashAlgorithm = findAlgorithm(algorithm);
+    if (hashAlgorithm == nullptr) {
+        return ZIPPY_UNKNOWN_ALGORITHM;
+    }
+    if (count != 0 && (filePaths == nullptr || digests == nullptr)) {
+        return ZIPPY_INVALID_ARGUMENT;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (filePaths[i] == nullptr) {
+            return ZIPPY_INVALID_ARGUMENT;
+        }
+    }
+
+    size_t failedCount = 0;
+    ZippyStatus status = guard(ZIPPY_INVALID_ARGUMENT, [&] {
+        vector<string> paths(filePaths, filePaths + count);
+        BatchOptions options;
+        options.threadsCount = threadsCount;
+        // The results come in the order of the files, so the handler tells their indices
+        options.keepOrder = true;
+
+        size_t index = 0;
+        failedCount = hashFilesInParallel({ hashAlgorithm }, paths, {}, options, [&](const BatchResult &result) {
+            if (result.error.empty()) {
+                copyDigest(result.digests[0], digests + index * hashAlgorithm->digestSize);
+            } else {
+                memset(digests + index * hashAlgorithm->digestSize, 0, hashAlgorithm->digestSize);
+            }
+            if (statuses != nullptr) {
+                statuses[index] = result.error.empty() ? ZIPPY_OK : ZIPPY_IO_ERROR;
+            }
+            index++;
+            return true;
+        });
+    });
+
+    return status == ZIPPY_OK && failedCount > 0 ? ZIPPY_IO_ERROR : status;
+}
+
+ZippyStatus zippyGetStats(ZippyStats *stats, size_t size) {
+    if (stats == nullptr) {
+        return ZIPPY_INVALID_ARGUMENT;
+    }
+
+    StatsCounters counters = getProcessStats();
+    ZippyStats result {};
+    result.files = counters.files;
+    result.bytes = counters.bytes;
+    result.reads = counters.reads;
+    result.openNanoseconds = uint64_t(ticksToSeconds(counters.getTicks(Stage::Open)) * 1e9);
+    result.readNanoseconds = uint64_t(ticksToSeconds(counters.getTicks(Stage::Read)) * 1e9);
+    result.hashNanoseconds = uint64_t(ticksToSeconds(counters.getTicks(Stage::Hash)) * 1e9);
+    // The older callers get the fields they know about
+    memcpy(stats, &result, min(size, sizeof(result)));
+    return ZIPPY_OK;
+}
+
+void zippyResetStats(void) {
+    resetProcessStats();
+}
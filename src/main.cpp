@@ -1,42 +1,1299 @@
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
 #include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include <cstdlib>
+#include <cerrno>
+#include <limits>
+#include <string_view>
+#include <filesystem>
+#include <csignal>
+#include <mutex>
+#include <chrono>
 
-#include "include/lib/sha256.hpp"
-#include "include/lib/sha512.hpp"
-#include "include/lib/md5.hpp"
+#include "include/lib/algorithms.hpp"
+#include "include/lib/batch.hpp"
+#include "include/lib/multiDigest.hpp"
+#include "include/lib/hashCache.hpp"
+#include "include/lib/checksumFile.hpp"
+#include "include/lib/chunker.hpp"
+#include "include/lib/chunkManifest.hpp"
+#include "include/lib/blake3.hpp"
+#include "include/lib/hashServer.hpp"
+#include "include/lib/gzip.hpp"
+#include "include/lib/encryption.hpp"
+#include "include/utils/hexadecimal.hpp"
+#include "include/utils/cpuFeatures.hpp"
+#include "include/utils/stats.hpp"
 
 using namespace std;
+namespace fs = std::filesystem;
+
+void printUsage() {
+    cout <<
+        "Usage: zippy <algorithm>[,<algorithm>...] [options] <file>... [-r <directory>]...\n"
+        "Algorithms: md5, sha224, sha256, sha384, sha512, sha512-224, sha512-256,\n"
+        "            sha3-224, sha3-256, sha3-384, sha3-512, shake128, shake256, blake3,\n"
+        "            crc32, crc32c, xxh64, xxh3 (several comma-separated ones are computed in a single pass over the input)\n"
+        "Options:\n"
+        "  -r <directory>       hash all the files of the directory (recursively)\n"
+        "  -j <threads>         count of threads used for the many files or the single BLAKE3 file (default: count of cores)\n"
+        "  --keep-order         print the hashes in the order of the inputs\n"
+        "  --no-mmap            read the files via stream instead of the memory mapping\n"
+        "  --buffer-size <n>    size of the read buffer in bytes\n"
+        "  --io-depth <n>       keep n reads in flight while hashing (io_uring or the reader thread) instead of the mapping\n"
+        "  --direct             read the files bypassing the page cache (O_DIRECT), implies --io-depth 4 unless it's set\n"
+        "  --no-io-uring        make the overlapped reads by the reader thread instead of io_uring\n"
+        "  --impl <name>        force the core: auto, scalar, ssse3, avx2, avx512, shani, aesni, sse42, pclmul\n"
+        "  --thread-per-algorithm  hash the single file by each of the several algorithms on its own thread\n"
+        "  --base64             print the digests in base64 instead of hexadecimal\n"
+        "  --stats              print the bytes, the time of the stages (open, read, hash, format) and the throughput of each file\n"
+        "                       and of all of them to the standard error, with the hardware counters where perf_event is permitted\n"
+        "  --cache <file>       take the digests of the unchanged files from the cache and store the new ones there\n"
+        "                       (the ZIPPY_CACHE environment variable sets the default cache file)\n"
+        "  --no-cache           don't use the cache\n"
+        "  --verify-cache       hash all the files and report the ones whose cached digests don't match\n"
+        "  --key <hex>          BLAKE3 only: the keyed hash with the 32-byte key (64 hexadecimal digits)\n"
+        "  --derive-key <context>  BLAKE3 only: derive the key from the key material in the files within the context\n"
+        "  --hmac <hex>         SHA-2 only: HMAC with the key of any size (hexadecimal digits)\n"
+        "Pass \"-\" as the file to hash the standard input.\n"
+        "\n"
+        "Usage: zippy [<algorithm>] -c <checksum file>... [options]\n"
+        "Verifies the files listed in the output of sha256sum, md5sum and the like (or of their --tag option).\n"
+        "The algorithm of each line is told by the tag or by the length of the digest unless it's set explicitly.\n"
+        "Options:\n"
+        "  -c, --check <file>   read the checksums from the file (\"-\" means the standard input)\n"
+        "  --quiet              don't print OK for each successfully verified file\n"
+        "  --status             don't print anything, the exit code tells the result\n"
+        "  --strict             fail on the improperly formatted lines\n"
+        "  --ignore-missing     skip the missing files instead of failing on them\n"
+        "  --fail-fast          stop at the first file that fails the verification\n"
+        "  -j <threads>, --no-mmap, --buffer-size <n>, --io-depth <n>, --direct, --no-io-uring, --impl <name>, --cache <file>, --no-cache, --verify-cache, --stats  the same as above\n"
+        "\n"
+        "Usage: zippy chunk [options] <file>\n"
+        "Splits the file into the content-defined chunks and prints the manifest of their SHA-256 digests.\n"
+        "Options:\n"
+        "  --min <n>, --avg <n>, --max <n>  sizes of chunks in bytes (default: 16384, 65536, 262144)\n"
+        "  --format <json|binary>           format of the manifest (default: json)\n"
+        "  -o <file>                        write the manifest into the file instead of the standard output\n"
+        "  -j <threads>, --no-mmap, --buffer-size <n>, --io-depth <n>, --direct, --no-io-uring, --impl <name>  the same as above\n"
+        "\n"
+        "Usage: zippy chunk diff <old manifest> <new manifest>\n"
+        "Prints the chunks of the new file that aren't found in the old one (offset, size, digest).\n"
+        "Exits with 0 if there are none of them, 1 otherwise.\n"
+        "\n"
+        "Usage: zippy serve --socket <path> [options]\n"
+        "Hashes the requests of the clients (the files, the descriptors and the messages in memory) until SIGINT or SIGTERM.\n"
+        "The binary protocol is described in src/include/lib/hashServer.hpp.\n"
+        "Options:\n"
+        "  --socket <path>         the Unix domain socket to listen on (only its owner may connect)\n"
+        "  -j <threads>            count of threads hashing the requests of all the clients (default: count of cores)\n"
+        "  --max-queue <n>         requests in progress over all the clients, the next ones are answered as busy (default: 4096)\n"
+        "  --max-in-flight <n>     unanswered requests per client, its connection isn't read beyond them (default: 256)\n"
+        "  --max-frame-size <n>    the larger frames close the connection (default: 67108864)\n"
+        "  --max-connections <n>   the connections beyond this count are closed (default: 64)\n"
+        "  --no-mmap, --buffer-size <n>, --io-depth <n>, --direct, --no-io-uring, --impl <name>  the same as above\n"
+        "\n"
+        "Usage: zippy compress [options] [<file>]\n"
+        "       zippy decompress [options] [<file>]\n"
+        "Compresses the file (or the standard input) into the gzip format, or decompresses it, to the standard output.\n"
+        "The blocks of the input are compressed on all the cores; the output is a single stream any gunzip reads.\n"
+        "Options:\n"
+        "  -0 ... -9               compression level: 0 stores, 1 is the fastest, 9 is the smallest (default: 6)\n"
+        "  -j <threads>            count of threads compressing the blocks (default: count of cores)\n"
+        "  --block-size <n>        size of the blocks compressed in parallel in bytes, at least 32768 (default: 131072)\n"
+        "  -o <file>               write the output into the file instead of the standard output\n"
+        "  --sha256                print the SHA-256 of the uncompressed data, computed in the same pass\n"
+        "                          (to the standard error if the output goes to the standard output)\n"
+        "  --stats                 print the time of the stages, the throughput and the ratio to the standard error\n"
+        "  --no-mmap, --buffer-size <n>, --io-depth <n>, --direct, --no-io-uring, --impl <name>  the same as above\n"
+        "\n"
+        "Usage: zippy kdf pbkdf2 <algorithm> --salt <hex> --iterations <n> [options] [<file>]\n"
+        "       zippy kdf hkdf <algorithm> [--salt <hex>] [--info <hex>] [options] [<file>]\n"
+        "Derives the key from the password (PBKDF2) or the input key material (HKDF), the whole content of the file\n"
+        "(or the standard input), by HMAC of the SHA-2 algorithm, and prints it in hexadecimal.\n"
+        "Options:\n"
+        "  --salt <hex>            the salt (the empty one of HKDF means the zeroes)\n"
+        "  --iterations <n>        PBKDF2 only: the count of iterations\n"
+        "  --info <hex>            HKDF only: the context the key is bound to\n"
+        "  --length <n>            size of the key in bytes (default: the digest size)\n"
+        "  --lines                 PBKDF2 only: each line of the input is a password, their keys are printed line by line\n"
+        "                          (the passwords are iterated in the SIMD lanes at once)\n"
+        "  --impl <name>           the same as above\n"
+        "\n"
+        "Usage: zippy encrypt --key-file <file> [options] [<file>]\n"
+        "       zippy decrypt --key-file <file> [options] [<file>]\n"
+        "Encrypts the file (or the standard input) with the authenticated encryption, or decrypts it, to the standard output.\n"
+        "The segments of the input are encrypted on all the cores, each of them is authenticated on its own.\n"
+        "Options:\n"
+        "  --key-file <file>       the key: 32 bytes or 64 hexadecimal digits, e.g. made by head -c 32 /dev/urandom\n"
+        "  --algorithm <name>      chacha20-poly1305 or aes-256-gcm (default: aes-256-gcm if the CPU has AES-NI)\n"
+        "  --segment-size <n>      size of the segments in bytes, a power of two from 4096 to 16777216 (default: 65536)\n"
+        "  -j <threads>            count of threads encrypting the segments (default: count of cores)\n"
+        "  -o <file>               write the output into the file instead of the standard output\n"
+        "                          (removed if the decryption fails, the standard output gets the authenticated part)\n"
+        "  --stats                 print the time of the stages and the throughput to the standard error\n"
+        "  --no-mmap, --buffer-size <n>, --io-depth <n>, --direct, --no-io-uring, --impl <name>  the same as above" << endl;
+}
+
+// The special characters of the file name are escaped the way sha256sum (and the other GNU coreutils) does.
+// The line is prefixed with the backslash if there are any of them
+bool isEscapingNeeded(string_view filePath) {
+    return filePath.find_first_of("\\\n") != string::npos;
+}
+
+void printFilePath(string_view filePath, bool isEscaped) {
+    if (!isEscaped) {
+        cout << filePath;
+        return;
+    }
+    for (char character : filePath) {
+        if (character == '\\') {
+            cout << "\\\\";
+        } else if (character == '\n') {
+            cout << "\\n";
+        } else {
+            cout << character;
+        }
+    }
+}
+
+// The digest is encoded into the buffer on the stack, so the printing doesn't allocate
+void printDigest(const HashDigest &digest, bool useBase64) {
+    char encoded[max(HashDigest::MAX_HEX_SIZE, HashDigest::MAX_BASE64_SIZE)];
+    char *end = useBase64 ? digest.encodeBase64(encoded) : digest.encodeHex(encoded);
+    cout.write(encoded, end - encoded);
+}
+
+// Prints the line in the format of sha256sum
+void printHashLine(const HashDigest &digest, const string &filePath, bool useBase64) {
+    bool isEscaped = isEscapingNeeded(filePath);
+    if (isEscaped) {
+        cout << "\\";
+    }
+    printDigest(digest, useBase64);
+    cout << "  ";
+    printFilePath(filePath, isEscaped);
+    cout << "\n";
+}
+
+// Prints the line in the BSD-style format of `sha256sum --tag`, which tells the algorithm of each digest
+void printTaggedHashLine(const string &tag, const HashDigest &digest, const string &filePath, bool useBase64) {
+    bool isEscaped = isEscapingNeeded(filePath);
+    cout << (isEscaped ? "\\" : "") << tag << " (";
+    printFilePath(filePath, isEscaped);
+    cout << ") = ";
+    printDigest(digest, useBase64);
+    cout << "\n";
+}
+
+// A single algorithm is printed in the format of sha256sum, several ones in the tagged format.
+// There is a digest per algorithm
+void printHashLines(const vector<const HashAlgorithm *> &algorithms, const HashDigest *digests, const string &filePath, bool useBase64) {
+    if (algorithms.size() == 1) {
+        printHashLine(digests[0], filePath, useBase64);
+        return;
+    }
+    for (size_t i = 0; i < algorithms.size(); i++) {
+        printTaggedHashLine(algorithms[i]->tag, digests[i], filePath, useBase64);
+    }
+}
+
+// The times of the stages in milliseconds, e.g. "open 0.02 ms, read 1.10 ms, hash 5.20 ms".
+// The compression and the encryption are printed only if there has been any
+void printStageTimes(ostream &output, const StatsCounters &stats, size_t stagesCount) {
+    const char *names[STAGES_COUNT] = { "open", "read", "hash", "format", "compress", "encrypt" };
+    for (size_t i = 0; i < stagesCount; i++) {
+        if ((i == (size_t)Stage::Compress || i == (size_t)Stage::Encrypt) && stats.ticks[i] == 0) {
+            continue;
+        }
+        output << (i == 0 ? "" : ", ") << names[i] << " " << ticksToSeconds(stats.ticks[i]) * 1e3 << " ms";
+    }
+}
+
+// E.g. "zippy: stats: file.bin: 10485760 bytes in 10 reads, open 0.02 ms, read 1.10 ms, hash 5.20 ms, 1.69 GB/s".
+// The standard error isn't buffered, so the line is written at once
+void printFileStats(const string &filePath, const StatsCounters &stats) {
+#if ZIPPY_STATS
+    double seconds = ticksToSeconds(stats.getTicks(Stage::Open) + stats.getTicks(Stage::Read) + stats.getTicks(Stage::Hash));
+    ostringstream line;
+    line << fixed << setprecision(2) << "zippy: stats: " << filePath << ": " << stats.bytes << " bytes in " << stats.reads << " reads, ";
+    printStageTimes(line, stats, (size_t)Stage::Format);
+    line << ", " << (seconds > 0 ? stats.bytes / seconds / 1e9 : 0) << " GB/s\n";
+    cerr << line.str();
+#endif
+}
+
+// The stages are summed over all the threads, so they may take longer than the wall time.
+// The time of opening and reading is the I/O, the time of hashing, compression and encryption is the compute
+void printTotalStats(const StatsCounters &stats, double wallSeconds, const PerfCounters *perfCounters) {
+    ostringstream lines;
+    lines << fixed << setprecision(2);
+#if ZIPPY_STATS
+    lines << "zippy: stats: total: " << stats.files << " files, " << stats.bytes << " bytes in " << stats.reads << " reads, "
+        << wallSeconds * 1e3 << " ms, " << (wallSeconds > 0 ? stats.bytes / wallSeconds / 1e9 : 0) << " GB/s\n";
+
+    lines << "zippy: stats: stages (summed over threads): ";
+    printStageTimes(lines, stats, STAGES_COUNT);
+    uint64 ioTicks = stats.getTicks(Stage::Open) + stats.getTicks(Stage::Read);
+    uint64 totalTicks = ioTicks + stats.getTicks(Stage::Hash) + stats.getTicks(Stage::Compress)
+        + stats.getTicks(Stage::Encrypt);
+    double ioShare = totalTicks != 0 ? 100.0 * ioTicks / totalTicks : 0;
+    lines << "; I/O " << setprecision(1) << ioShare << "%, compute " << (totalTicks != 0 ? 100 - ioShare : 0) << "%\n";
+#else
+    lines << "zippy: stats: the instrumentation is compiled out (ZIPPY_STATS=OFF)\n";
+#endif
+
+    if (perfCounters == nullptr || !perfCounters->isAvailable()) {
+        lines << "zippy: stats: perf: unavailable (see /proc/sys/kernel/perf_event_paranoid)\n";
+    } else {
+        PerfReadout readout = perfCounters->read();
+        lines << "zippy: stats: perf: " << readout.cycles << " cycles, " << readout.instructions << " instructions ("
+            << setprecision(2) << (readout.cycles != 0 ? double(readout.instructions) / readout.cycles : 0) << " IPC), "
+            << readout.cacheMisses << " cache misses\n";
+    }
+    cerr << lines.str() << flush;
+}
+
+// Parses the comma-separated list of algorithms. Returns false if any of them is unknown
+bool parseAlgorithms(const string &names, vector<const HashAlgorithm *> &algorithms, string &unknownName) {
+    size_t start = 0;
+    while (true) {
+        size_t end = names.find(',', start);
+        string name = names.substr(start, end == string::npos ? string::npos : end - start);
+        const HashAlgorithm *algorithm = findHashAlgorithm(name);
+        if (algorithm == nullptr) {
+            unknownName = name;
+            return false;
+        }
+        // The repeated algorithm is computed once
+        if (find(algorithms.begin(), algorithms.end(), algorithm) == algorithms.end()) {
+            algorithms.push_back(algorithm);
+        }
+        if (end == string::npos) {
+            return true;
+        }
+        start = end + 1;
+    }
+}
+
+struct CheckOptions {
+    bool quiet = false;
+    bool status = false;
+    bool strict = false;
+    bool ignoreMissing = false;
+    bool failFast = false;
+};
+
+// The warning in the format of sha256sum, e.g. "WARNING: 2 computed checksums did NOT match"
+void printCheckWarning(size_t count, const string &singular, const string &plural) {
+    if (count > 0) {
+        cerr << "zippy: WARNING: " << count << " " << (count == 1 ? singular : plural) << endl;
+    }
+}
+
+// Verifies the checksum files one by one, the files listed in each of them are hashed in parallel.
+// Prints the result of each file the way `sha256sum -c` does
+int runCheck(const vector<string> &checksumFilePaths, const HashAlgorithm *forcedAlgorithm, const BatchOptions &batchOptions, const CheckOptions &options) {
+    int exitCode = 0;
+    bool isStopped = false;
+    for (size_t i = 0; i < checksumFilePaths.size() && !isStopped; i++) {
+        const string &checksumFilePath = checksumFilePaths[i];
+        unique_ptr<ChecksumFile> checksumFile;
+        try {
+            checksumFile.reset(new ChecksumFile(checksumFilePath, forcedAlgorithm));
+        } catch (const exception &error) {
+            cerr << "zippy: " << checksumFilePath << ": " << error.what() << endl;
+            exitCode = 1;
+            continue;
+        }
+
+        if (checksumFile->getEntries().empty()) {
+            cerr << "zippy: " << checksumFilePath << ": no properly formatted checksum lines found" << endl;
+            exitCode = 1;
+            continue;
+        }
+
+        const vector<ChecksumEntry> *entries = &checksumFile->getEntries();
+        vector<ChecksumEntry> presentEntries;
+        if (options.ignoreMissing) {
+            for (const ChecksumEntry &entry : *entries) {
+                error_code error;
+                if (entry.filePath == "-" || fs::exists(entry.filePath, error)) {
+                    presentEntries.push_back(entry);
+                }
+            }
+            entries = &presentEntries;
+        }
+
+        size_t failedCount = 0;
+        size_t unreadableCount = 0;
+        verifyChecksums(*entries, batchOptions, [&](const ChecksumEntry &entry, ChecksumStatus status, const string &error) {
+            if (status == ChecksumStatus::Unreadable) {
+                unreadableCount++;
+                if (!options.status) {
+                    cout.flush();
+                    cerr << "zippy: " << entry.filePath << ": " << error << endl;
+                }
+            } else if (status == ChecksumStatus::Failed) {
+                failedCount++;
+            }
+
+            if (!options.status && (status != ChecksumStatus::Ok || !options.quiet)) {
+                bool isEscaped = isEscapingNeeded(entry.filePath);
+                cout << (isEscaped ? "\\" : "");
+                printFilePath(entry.filePath, isEscaped);
+                cout << (status == ChecksumStatus::Ok ? ": OK\n" : status == ChecksumStatus::Failed ? ": FAILED\n" : ": FAILED open or read\n");
+            }
+
+            isStopped = options.failFast && status != ChecksumStatus::Ok;
+            return !isStopped;
+        });
+        cout.flush();
+
+        size_t malformedLinesCount = checksumFile->getMalformedLinesCount();
+        if (!options.status) {
+            printCheckWarning(malformedLinesCount, "line is improperly formatted", "lines are improperly formatted");
+            printCheckWarning(unreadableCount, "listed file could not be read", "listed files could not be read");
+            printCheckWarning(failedCount, "computed checksum did NOT match", "computed checksums did NOT match");
+        }
+        if (entries->empty()) {
+            cerr << "zippy: " << checksumFilePath << ": no file was verified" << endl;
+        }
+        if (failedCount > 0 || unreadableCount > 0 || entries->empty() || (options.strict && malformedLinesCount > 0)) {
+            exitCode = 1;
+        }
+    }
+    return exitCode;
+}
+
+// Computes HMAC of the files one by one. The MACs depend on the key, so they are never taken from the cache
+int runHmac(const HmacAlgorithm &algorithm, const vector<uchar> &key, const vector<string> &filePaths, const InputOptions &inputOptions, bool useBase64) {
+    int exitCode = 0;
+    unique_ptr<StreamingHasher> hasher = algorithm.createHasher(key.data(), key.size());
+    for (const string &filePath : filePaths) {
+        try {
+            InputReader reader(filePath, inputOptions);
+            const uchar *data;
+            size_t size;
+            while (reader.next(data, size)) {
+                hasher->update(data, size);
+            }
+            HashDigest digest = hasher->final();
+            if (filePaths.size() == 1) {
+                printDigest(digest, useBase64);
+                cout << "\n";
+            } else {
+                printHashLine(digest, filePath, useBase64);
+            }
+        } catch (const exception &error) {
+            cout.flush();
+            cerr << "zippy: " << filePath << ": " << error.what() << endl;
+            exitCode = 1;
+            hasher = algorithm.createHasher(key.data(), key.size());
+        }
+    }
+    cout.flush();
+    return exitCode;
+}
+
+// Hashes the files by BLAKE3 in the mode of the `hasher` (keyed or key derivation) one by one, each by all the threads.
+// The digests depend on the key, so they are never taken from the cache
+int runBlake3WithKey(const blake3::Blake3Hasher &hasher, const vector<string> &filePaths, const InputOptions &inputOptions, bool useBase64) {
+    int exitCode = 0;
+    for (const string &filePath : filePaths) {
+        try {
+            HashDigest digest = blake3::hashFileWith(hasher, filePath, inputOptions);
+            if (filePaths.size() == 1) {
+                printDigest(digest, useBase64);
+                cout << "\n";
+            } else {
+                printHashLine(digest, filePath, useBase64);
+            }
+        } catch (const exception &error) {
+            cout.flush();
+            cerr << "zippy: " << filePath << ": " << error.what() << endl;
+            exitCode = 1;
+        }
+    }
+    cout.flush();
+    return exitCode;
+}
+
+// The value of the numeric option: the decimal digits only, within the range of the `value`.
+// The invalid one is reported along with the usage, the caller exits with 1
+template <typename T>
+bool parseNumberOption(const string &option, const char *text, T &value) {
+    char *end = nullptr;
+    errno = 0;
+    unsigned long long number = strtoull(text, &end, 10);
+    if (text[0] < '0' || text[0] > '9' || *end != '\0' || errno == ERANGE || number > numeric_limits<T>::max()) {
+        cout << "Invalid value of " << option << ": " << text << endl;
+        printUsage();
+        return false;
+    }
+    value = T(number);
+    return true;
+}
+
+// The options of reading the input shared by all the commands. Returns false if the `option` isn't one of them,
+// `isInvalid` is set if it is, but its value can't be parsed
+bool parseInputOption(const string &option, int argc, char* argv[], int &i, InputOptions &options, bool &isInvalid) {
+    bool hasValue = i + 1 < argc;
+    isInvalid = false;
+    if (option == "--no-mmap") {
+        // The memory-mapping of the input file may be disabled in order to compare it with the stream-based reading
+        options.allowMapping = false;
+    } else if (option == "--buffer-size" && hasValue) {
+        isInvalid = !parseNumberOption(option, argv[++i], options.readBufferSize);
+    } else if (option == "--io-depth" && hasValue) {
+        isInvalid = !parseNumberOption(option, argv[++i], options.ioDepth);
+    } else if (option == "--direct") {
+        options.directIo = true;
+    } else if (option == "--no-io-uring") {
+        options.allowIoUring = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// The direct reads are made by the pipeline only
+void completeInputOptions(InputOptions &options) {
+    if (options.directIo && options.ioDepth == 0) {
+        options.ioDepth = DEFAULT_IO_DEPTH;
+    }
+}
+
+int runChunkDiff(const string &oldManifestPath, const string &newManifestPath) {
+    ManifestDiff diff;
+    ChunkManifest newManifest;
+    try {
+        ChunkManifest oldManifest = readManifest(oldManifestPath);
+        newManifest = readManifest(newManifestPath);
+        diff = diffManifests(oldManifest, newManifest);
+    } catch (const exception &error) {
+        cerr << "zippy: " << error.what() << endl;
+        return 2;
+    }
+
+    for (size_t index : diff.changedChunks) {
+        const Chunk &chunk = newManifest.chunks[index];
+        cout << chunk.offset << " " << chunk.size << " ";
+        printDigest(chunk.digest, false);
+        cout << "\n";
+    }
+    cout.flush();
+    cerr << "Changed: " << diff.changedChunks.size() << " chunks, " << diff.changedSize << " bytes; reused: "
+        << newManifest.chunks.size() - diff.changedChunks.size() << " chunks, " << diff.reusedSize << " bytes" << endl;
+
+    return diff.changedChunks.empty() ? 0 : 1;
+}
+
+int runChunkCommand(int argc, char* argv[]) {
+    if (argc == 5 && string(argv[2]) == "diff") {
+        return runChunkDiff(argv[3], argv[4]);
+    }
+
+    vector<string> filePaths;
+    ChunkingOptions options;
+    ManifestFormat format = ManifestFormat::Json;
+    string outputPath;
+
+    for (int i = 2; i < argc; i++) {
+        string option = string(argv[i]);
+        bool hasValue = i + 1 < argc;
+        bool isInvalidValue = false;
+        if (option == "-" || option[0] != '-') {
+            filePaths.push_back(option);
+        } else if (option == "--min" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], options.parameters.minSize)) {
+                return 1;
+            }
+        } else if (option == "--avg" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], options.parameters.averageSize)) {
+                return 1;
+            }
+        } else if (option == "--max" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], options.parameters.maxSize)) {
+                return 1;
+            }
+        } else if (option == "--format" && hasValue && (string(argv[i + 1]) == "json" || string(argv[i + 1]) == "binary")) {
+            format = string(argv[++i]) == "json" ? ManifestFormat::Json : ManifestFormat::Binary;
+        } else if (option == "-o" && hasValue) {
+            outputPath = argv[++i];
+        } else if (option == "-j" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], options.threadsCount)) {
+                return 1;
+            }
+        } else if (parseInputOption(option, argc, argv, i, options.inputOptions, isInvalidValue)) {
+            if (isInvalidValue) {
+                return 1;
+            }
+            continue;
+        } else if (option == "--impl" && hasValue) {
+            Implementation implementation;
+            if (!parseImplementation(argv[++i], implementation)) {
+                cout << "Unknown implementation: " << argv[i] << endl;
+                return 1;
+            }
+            forceImplementation(implementation);
+        } else {
+            cout << "Unknown option: " << option << endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    completeInputOptions(options.inputOptions);
+
+    if (filePaths.size() != 1) {
+        cout << "Exactly one file has to be chunked" << endl;
+        return 1;
+    }
+
+    try {
+        ChunkManifest manifest = chunkFile(filePaths[0], options);
+        if (outputPath.empty()) {
+            writeManifest(manifest, format, cout);
+            cout.flush();
+        } else {
+            ofstream output(outputPath, ios::out | ios::binary | ios::trunc);
+            writeManifest(manifest, format, output);
+            output.close();
+            if (!output) {
+                throw invalid_argument("Can't write the manifest: " + outputPath);
+            }
+        }
+    } catch (const exception &error) {
+        cerr << "zippy: " << filePaths[0] << ": " << error.what() << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// `zippy compress` and `zippy decompress`
+int runCompressionCommand(int argc, char* argv[], bool isDecompressing) {
+    string filePath;
+    string outputPath;
+    CompressionOptions compressionOptions;
+    bool computeSha256 = false;
+    bool printStats = false;
+    InputOptions inputOptions;
+
+    for (int i = 2; i < argc; i++) {
+        string option = string(argv[i]);
+        bool hasValue = i + 1 < argc;
+        bool isInvalidValue = false;
+        if ((option == "-" || option[0] != '-') && filePath.empty()) {
+            filePath = option;
+        } else if (!isDecompressing && option.size() == 2 && option[1] >= '0' && option[1] <= '9') {
+            compressionOptions.level = option[1] - '0';
+        } else if (!isDecompressing && option == "--block-size" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], compressionOptions.blockSize)) {
+                return 1;
+            }
+        } else if (!isDecompressing && option == "-j" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], compressionOptions.threadsCount)) {
+                return 1;
+            }
+        } else if (option == "-o" && hasValue) {
+            outputPath = argv[++i];
+        } else if (option == "--sha256") {
+            computeSha256 = true;
+        } else if (option == "--stats") {
+            printStats = true;
+        } else if (parseInputOption(option, argc, argv, i, inputOptions, isInvalidValue)) {
+            if (isInvalidValue) {
+                return 1;
+            }
+            continue;
+        } else if (option == "--impl" && hasValue) {
+            Implementation implementation;
+            if (!parseImplementation(argv[++i], implementation)) {
+                cout << "Unknown implementation: " << argv[i] << endl;
+                return 1;
+            }
+            forceImplementation(implementation);
+        } else {
+            cout << "Unknown option: " << option << endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    completeInputOptions(inputOptions);
+    if (filePath.empty()) {
+        filePath = "-";
+    }
+
+    unique_ptr<PerfCounters> perfCounters(printStats ? new PerfCounters() : nullptr);
+    if (printStats) {
+        ticksToSeconds(0);
+    }
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    ofstream outputFile;
+    if (!outputPath.empty()) {
+        outputFile.open(outputPath, ios::out | ios::binary | ios::trunc);
+        if (!outputFile) {
+            cerr << "zippy: Can't open the output file: " << outputPath << endl;
+            return 1;
+        }
+    }
+    ostream &output = outputPath.empty() ? cout : outputFile;
+
+    CompressionResult result;
+    try {
+        if (isDecompressing) {
+            DecompressionOptions options;
+            options.computeSha256 = computeSha256;
+            options.inputOptions = inputOptions;
+            result = decompressFile(filePath, output, options);
+        } else {
+            compressionOptions.computeSha256 = computeSha256;
+            compressionOptions.inputOptions = inputOptions;
+            result = compressFile(filePath, output, compressionOptions);
+        }
+        if (!outputPath.empty()) {
+            outputFile.close();
+            if (!outputFile) {
+                throw invalid_argument("Can't write the output file: " + outputPath);
+            }
+        }
+    } catch (const exception &error) {
+        cerr << "zippy: " << filePath << ": " << error.what() << endl;
+        if (!outputPath.empty()) {
+            outputFile.close();
+            error_code removeError;
+            fs::remove(outputPath, removeError);
+        }
+        return 1;
+    }
+
+    // The digest of the uncompressed data in the format of sha256sum, named after the uncompressed file.
+    // It goes to the standard error if the data itself is written to the standard output
+    if (computeSha256) {
+        ostream &digestOutput = outputPath.empty() ? cerr : cout;
+        digestOutput << HashDigest(result.sha256) << "  " << (isDecompressing ? (outputPath.empty() ? "-" : outputPath) : filePath) << endl;
+    }
+    if (printStats) {
+        StatsCounters stats = getProcessStats();
+        stats.files = 1;
+        printTotalStats(stats, chrono::duration<double>(chrono::steady_clock::now() - startTime).count(), perfCounters.get());
+        cerr << "zippy: stats: " << result.uncompressedSize << " bytes uncompressed, " << result.compressedSize << " bytes compressed ("
+            << fixed << setprecision(2) << (result.uncompressedSize != 0 ? 100.0 * result.compressedSize / result.uncompressedSize : 0) << "%)" << endl;
+    }
+    return 0;
+}
+
+// `zippy encrypt` and `zippy decrypt`
+int runEncryptionCommand(int argc, char* argv[], bool isDecrypting) {
+    string filePath;
+    string outputPath;
+    string keyFilePath;
+    EncryptionOptions encryptionOptions;
+    uint32 threadsCount = 0;
+    bool printStats = false;
+    InputOptions inputOptions;
+
+    for (int i = 2; i < argc; i++) {
+        string option = string(argv[i]);
+        bool hasValue = i + 1 < argc;
+        bool isInvalidValue = false;
+        if ((option == "-" || option[0] != '-') && filePath.empty()) {
+            filePath = option;
+        } else if (option == "--key-file" && hasValue) {
+            keyFilePath = argv[++i];
+        } else if (!isDecrypting && option == "--algorithm" && hasValue) {
+            if (!aead::parseAlgorithm(argv[++i], encryptionOptions.algorithm)) {
+                cout << "Unknown encryption algorithm: " << argv[i] << endl;
+                return 1;
+            }
+        } else if (!isDecrypting && option == "--segment-size" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], encryptionOptions.segmentSize)) {
+                return 1;
+            }
+        } else if (option == "-j" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], threadsCount)) {
+                return 1;
+            }
+        } else if (option == "-o" && hasValue) {
+            outputPath = argv[++i];
+        } else if (option == "--stats") {
+            printStats = true;
+        } else if (parseInputOption(option, argc, argv, i, inputOptions, isInvalidValue)) {
+            if (isInvalidValue) {
+                return 1;
+            }
+            continue;
+        } else if (option == "--impl" && hasValue) {
+            Implementation implementation;
+            if (!parseImplementation(argv[++i], implementation)) {
+                cout << "Unknown implementation: " << argv[i] << endl;
+                return 1;
+            }
+            forceImplementation(implementation);
+        } else {
+            cout << "Unknown option: " << option << endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (keyFilePath.empty()) {
+        cout << "The key file is required: --key-file <file>" << endl;
+        return 1;
+    }
+    completeInputOptions(inputOptions);
+    if (filePath.empty()) {
+        filePath = "-";
+    }
+
+    aead::Key key;
+    try {
+        key = readKeyFile(keyFilePath);
+    } catch (const exception &error) {
+        cerr << "zippy: " << error.what() << endl;
+        return 1;
+    }
+
+    unique_ptr<PerfCounters> perfCounters(printStats ? new PerfCounters() : nullptr);
+    if (printStats) {
+        ticksToSeconds(0);
+    }
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    ofstream outputFile;
+    if (!outputPath.empty()) {
+        outputFile.open(outputPath, ios::out | ios::binary | ios::trunc);
+        if (!outputFile) {
+            cerr << "zippy: Can't open the output file: " << outputPath << endl;
+            return 1;
+        }
+    }
+    ostream &output = outputPath.empty() ? cout : outputFile;
+
+    EncryptionResult result;
+    try {
+        if (isDecrypting) {
+            DecryptionOptions options;
+            options.threadsCount = threadsCount;
+            options.inputOptions = inputOptions;
+            result = decryptFile(filePath, output, key, options);
+        } else {
+            encryptionOptions.threadsCount = threadsCount;
+            encryptionOptions.inputOptions = inputOptions;
+            result = encryptFile(filePath, output, key, encryptionOptions);
+        }
+        if (!outputPath.empty()) {
+            outputFile.close();
+            if (!outputFile) {
+                throw invalid_argument("Can't write the output file: " + outputPath);
+            }
+        }
+    } catch (const exception &error) {
+        cerr << "zippy: " << filePath << ": " << error.what() << endl;
+        if (!outputPath.empty()) {
+            outputFile.close();
+            error_code removeError;
+            fs::remove(outputPath, removeError);
+        }
+        return 1;
+    }
+    fill(key.begin(), key.end(), 0);
+
+    if (printStats) {
+        StatsCounters stats = getProcessStats();
+        stats.files = 1;
+        printTotalStats(stats, chrono::duration<double>(chrono::steady_clock::now() - startTime).count(), perfCounters.get());
+        cerr << "zippy: stats: " << result.plaintextSize << " bytes of plaintext, " << result.ciphertextSize << " bytes encrypted with "
+            << aead::algorithmName(result.algorithm) << " in the segments of " << result.segmentSize << " bytes" << endl;
+    }
+    return 0;
+}
+
+// Decodes the hexadecimal option value of any even length
+bool parseHexOption(const string &text, vector<uchar> &bytes) {
+    bytes.resize(text.size() / 2);
+    return text.size() % 2 == 0 && decodeHex(text.data(), bytes.size(), bytes.data());
+}
+
+// `zippy kdf pbkdf2` and `zippy kdf hkdf`
+int runKdfCommand(int argc, char* argv[]) {
+    string function = argc >= 3 ? argv[2] : "";
+    const HmacAlgorithm *algorithm = argc >= 4 ? findHmacAlgorithm(argv[3]) : nullptr;
+    if ((function != "pbkdf2" && function != "hkdf") || algorithm == nullptr) {
+        cout << "Usage: zippy kdf <pbkdf2|hkdf> <SHA-2 algorithm> [options] [<file>]" << endl;
+        return 1;
+    }
+    bool isPbkdf2 = function == "pbkdf2";
+
+    string filePath;
+    vector<uchar> salt;
+    bool hasSalt = false;
+    vector<uchar> info;
+    uint32 iterations = 0;
+    size_t length = algorithm->digestSize;
+    bool useLines = false;
+    InputOptions inputOptions;
+
+    for (int i = 4; i < argc; i++) {
+        string option = string(argv[i]);
+        bool hasValue = i + 1 < argc;
+        if ((option == "-" || option[0] != '-') && filePath.empty()) {
+            filePath = option;
+        } else if (option == "--salt" && hasValue) {
+            if (!parseHexOption(argv[++i], salt)) {
+                cout << "The salt must be an even count of hexadecimal digits" << endl;
+                return 1;
+            }
+            hasSalt = true;
+        } else if (!isPbkdf2 && option == "--info" && hasValue) {
+            if (!parseHexOption(argv[++i], info)) {
+                cout << "The info must be an even count of hexadecimal digits" << endl;
+                return 1;
+            }
+        } else if (isPbkdf2 && option == "--iterations" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], iterations)) {
+                return 1;
+            }
+        } else if (option == "--length" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], length)) {
+                return 1;
+            }
+        } else if (isPbkdf2 && option == "--lines") {
+            useLines = true;
+        } else if (option == "--impl" && hasValue) {
+            Implementation implementation;
+            if (!parseImplementation(argv[++i], implementation)) {
+                cout << "Unknown implementation: " << argv[i] << endl;
+                return 1;
+            }
+            forceImplementation(implementation);
+        } else {
+            cout << "Unknown option: " << option << endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (isPbkdf2 && (!hasSalt || iterations == 0)) {
+        cout << "PBKDF2 requires the salt and the count of iterations: --salt <hex> --iterations <n>" << endl;
+        return 1;
+    }
+    if (filePath.empty()) {
+        filePath = "-";
+    }
+
+    try {
+        // The secret is the whole content of the file, or each of its lines
+        vector<uchar> content;
+        InputReader reader(filePath, inputOptions);
+        const uchar *data;
+        size_t size;
+        while (reader.next(data, size)) {
+            content.insert(content.end(), data, data + size);
+        }
+
+        vector<ByteView> secrets;
+        if (useLines) {
+            for (size_t start = 0; start < content.size();) {
+                size_t end = find(content.begin() + start, content.end(), '\n') - content.begin();
+                secrets.push_back({ content.data() + start, end - start });
+                start = end + 1;
+            }
+        } else {
+            secrets.push_back({ content.data(), content.size() });
+        }
+
+        vector<uchar> keys(secrets.size() * length);
+        if (isPbkdf2) {
+            algorithm->pbkdf2Batch(secrets, vector<ByteView>(secrets.size(), { salt.data(), salt.size() }), iterations, keys.data(), length);
+        } else {
+            algorithm->hkdf(salt.data(), salt.size(), content.data(), content.size(), info.data(), info.size(), keys.data(), length);
+        }
+        for (size_t i = 0; i < secrets.size(); i++) {
+            cout << toHex(keys.data() + i * length, length) << "\n";
+        }
+        fill(content.begin(), content.end(), 0);
+        fill(keys.begin(), keys.end(), 0);
+    } catch (const exception &error) {
+        cout.flush();
+        cerr << "zippy: " << filePath << ": " << error.what() << endl;
+        return 1;
+    }
+    cout.flush();
+    return 0;
+}
+
+// The server being run by `zippy serve`, stopped by the signals
+HashServer *runningServer = nullptr;
+
+void stopServer(int) {
+    runningServer->stop();
+}
+
+int runServeCommand(int argc, char* argv[]) {
+    ServeOptions options;
+    for (int i = 2; i < argc; i++) {
+        string option = string(argv[i]);
+        bool hasValue = i + 1 < argc;
+        bool isInvalidValue = false;
+        if (option == "--socket" && hasValue) {
+            options.socketPath = argv[++i];
+        } else if (option == "-j" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], options.threadsCount)) {
+                return 1;
+            }
+        } else if (option == "--max-queue" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], options.maxQueuedRequests)) {
+                return 1;
+            }
+        } else if (option == "--max-in-flight" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], options.maxConnectionRequests)) {
+                return 1;
+            }
+            options.maxConnectionRequests = max(1u, options.maxConnectionRequests);
+        } else if (option == "--max-frame-size" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], options.maxFrameSize)) {
+                return 1;
+            }
+        } else if (option == "--max-connections" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], options.maxConnections)) {
+                return 1;
+            }
+        } else if (parseInputOption(option, argc, argv, i, options.inputOptions, isInvalidValue)) {
+            if (isInvalidValue) {
+                return 1;
+            }
+            continue;
+        } else if (option == "--impl" && hasValue) {
+            Implementation implementation;
+            if (!parseImplementation(argv[++i], implementation)) {
+                cout << "Unknown implementation: " << argv[i] << endl;
+                return 1;
+            }
+            forceImplementation(implementation);
+        } else {
+            cout << "Unknown option: " << option << endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    completeInputOptions(options.inputOptions);
+
+    if (options.socketPath.empty()) {
+        cout << "The socket to listen on has to be set: --socket <path>" << endl;
+        return 1;
+    }
+
+    mutex errorLock;
+    options.errorHandler = [&errorLock](const string &message) {
+        lock_guard<mutex> guard(errorLock);
+        cerr << "zippy: serve: " << message << endl;
+    };
+
+    try {
+        HashServer server(options);
+        runningServer = &server;
+        signal(SIGINT, stopServer);
+        signal(SIGTERM, stopServer);
+        cerr << "zippy: serving on " << options.socketPath << endl;
+        server.run();
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        runningServer = nullptr;
+    } catch (const exception &error) {
+        cerr << "zippy: " << error.what() << endl;
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[])
 {
     // TODO: https://ru.wikipedia.org/wiki/Tiger_(%D1%85%D0%B5%D1%88-%D1%84%D1%83%D0%BD%D0%BA%D1%86%D0%B8%D1%8F)
     // SHA-1
     // SHA-2 https://tools.ietf.org/html/rfc4634
-    // SHA-3
     // OpenSSL support https://mind-control.fandom.com/wiki/OpenSSL
+    // The standard input is compressed if there is no file
+    if (argc >= 2 && (string(argv[1]) == "compress" || string(argv[1]) == "decompress")) {
+        return runCompressionCommand(argc, argv, string(argv[1]) == "decompress");
+    }
+    if (argc >= 2 && (string(argv[1]) == "encrypt" || string(argv[1]) == "decrypt")) {
+        return runEncryptionCommand(argc, argv, string(argv[1]) == "decrypt");
+    }
     if (argc < 3) {
         cout << "Unsupported arguments count: " << argc << endl;
+        printUsage();
         return 1;
     }
 
-    string algorithm = string(argv[1]);
-    string filePath = string(argv[2]);
+    if (string(argv[1]) == "chunk") {
+        return runChunkCommand(argc, argv);
+    }
+    if (string(argv[1]) == "serve") {
+        return runServeCommand(argc, argv);
+    }
+    if (string(argv[1]) == "kdf") {
+        return runKdfCommand(argc, argv);
+    }
 
-    if (algorithm == "sha256") {
-        string stringHash = sha2::sha256(filePath);
-        cout << stringHash << endl;
-    } else if (algorithm == "sha512") {
-        string stringHash = sha2::sha512(filePath);
-        cout << stringHash << endl;
-    } else if (algorithm == "md5") {
-        string stringHash = md::md5(filePath);
-        cout << stringHash << endl;
-    } else {
-        cout << "Unkonwn algorithm: " << algorithm << endl;
+    // The algorithm is optional for the verification of the checksum files
+    vector<const HashAlgorithm *> algorithms;
+    int firstOption = 1;
+    if (string(argv[1]) != "-c" && string(argv[1]) != "--check") {
+        string algorithmName;
+        if (!parseAlgorithms(string(argv[1]), algorithms, algorithmName)) {
+            cout << "Unkonwn algorithm: " << algorithmName << endl;
+            return 1;
+        }
+        firstOption = 2;
+    }
+
+    vector<string> filePaths;
+    vector<string> directories;
+    BatchOptions batchOptions;
+    InputOptions &inputOptions = batchOptions.inputOptions;
+    MultiDigestOptions multiDigestOptions;
+    bool useBase64 = false;
+    bool printStats = false;
+    const char *defaultCachePath = getenv("ZIPPY_CACHE");
+    string cachePath = defaultCachePath != nullptr ? defaultCachePath : "";
+    bool verifyCache = false;
+    vector<string> checksumFilePaths;
+    CheckOptions checkOptions;
+    unique_ptr<blake3::Blake3Hasher> blake3Hasher;
+    bool useHmac = false;
+    vector<uchar> hmacKey;
+
+    for (int i = firstOption; i < argc; i++) {
+        string option = string(argv[i]);
+        bool hasValue = i + 1 < argc;
+        bool isInvalidValue = false;
+        if (option == "-" || option[0] != '-') {
+            filePaths.push_back(option);
+        } else if (option == "-r" && hasValue) {
+            directories.push_back(argv[++i]);
+        } else if (option == "-j" && hasValue) {
+            if (!parseNumberOption(option, argv[++i], batchOptions.threadsCount)) {
+                return 1;
+            }
+        } else if (option == "--keep-order") {
+            batchOptions.keepOrder = true;
+        } else if (parseInputOption(option, argc, argv, i, inputOptions, isInvalidValue)) {
+            if (isInvalidValue) {
+                return 1;
+            }
+            continue;
+        } else if (option == "--impl" && hasValue) {
+            // Forces the particular variant of the algorithm's core: auto, scalar, ssse3, avx2, avx512, shani, aesni, sse42 or pclmul
+            Implementation implementation;
+            if (!parseImplementation(argv[++i], implementation)) {
+                cout << "Unknown implementation: " << argv[i] << endl;
+                return 1;
+            }
+            forceImplementation(implementation);
+        } else if (option == "--thread-per-algorithm") {
+            multiDigestOptions.threadPerAlgorithm = true;
+        } else if (option == "--base64") {
+            useBase64 = true;
+        } else if (option == "--stats") {
+            printStats = true;
+        } else if (option == "--cache" && hasValue) {
+            cachePath = argv[++i];
+        } else if (option == "--no-cache") {
+            cachePath.clear();
+        } else if (option == "--verify-cache") {
+            verifyCache = true;
+        } else if (option == "--key" && hasValue) {
+            blake3::Blake3Key key;
+            string hexKey = argv[++i];
+            if (hexKey.size() != key.size() * 2 || !decodeHex(hexKey.data(), key.size(), key.data())) {
+                cout << "The key must be " << key.size() * 2 << " hexadecimal digits" << endl;
+                return 1;
+            }
+            blake3Hasher.reset(new blake3::Blake3Hasher(key));
+        } else if (option == "--derive-key" && hasValue) {
+            blake3Hasher.reset(new blake3::Blake3Hasher(string(argv[++i])));
+        } else if (option == "--hmac" && hasValue) {
+            string hexKey = argv[++i];
+            hmacKey.resize(hexKey.size() / 2);
+            if (hexKey.size() % 2 != 0 || !decodeHex(hexKey.data(), hmacKey.size(), hmacKey.data())) {
+                cout << "The HMAC key must be an even count of hexadecimal digits" << endl;
+                return 1;
+            }
+            useHmac = true;
+        } else if ((option == "-c" || option == "--check") && hasValue) {
+            checksumFilePaths.push_back(argv[++i]);
+        } else if (option == "--quiet") {
+            checkOptions.quiet = true;
+        } else if (option == "--status") {
+            checkOptions.status = true;
+        } else if (option == "--strict") {
+            checkOptions.strict = true;
+        } else if (option == "--ignore-missing") {
+            checkOptions.ignoreMissing = true;
+        } else if (option == "--fail-fast") {
+            checkOptions.failFast = true;
+        } else {
+            cout << "Unknown option: " << option << endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    completeInputOptions(inputOptions);
+
+    if (!checksumFilePaths.empty()) {
+        if (!filePaths.empty() || !directories.empty()) {
+            cout << "The files to hash can't be combined with the checksum files" << endl;
+            return 1;
+        }
+        if (algorithms.size() > 1) {
+            cout << "At most one algorithm may be set for the checksum files" << endl;
+            return 1;
+        }
+    } else if (filePaths.empty() && directories.empty()) {
+        cout << "No files to hash" << endl;
         return 1;
     }
 
-    __int128_t a = 0;
+    if (blake3Hasher != nullptr) {
+        if (algorithms.size() != 1 || algorithms[0]->name != "blake3" || !directories.empty() || !checksumFilePaths.empty()) {
+            cout << "The key may be set for a single blake3 algorithm and the files only" << endl;
+            return 1;
+        }
+        InputOptions fileOptions = inputOptions;
+        fileOptions.threadsCount = batchOptions.threadsCount;
+        return runBlake3WithKey(*blake3Hasher, filePaths, fileOptions, useBase64);
+    }
 
-    return 0;
+    if (useHmac) {
+        const HmacAlgorithm *hmacAlgorithm = algorithms.size() == 1 ? findHmacAlgorithm(algorithms[0]->name) : nullptr;
+        if (hmacAlgorithm == nullptr || !directories.empty() || !checksumFilePaths.empty()) {
+            cout << "The HMAC key may be set for a single SHA-2 algorithm and the files only" << endl;
+            return 1;
+        }
+        return runHmac(*hmacAlgorithm, hmacKey, filePaths, inputOptions, useBase64);
+    }
+
+    unique_ptr<HashCache> cache;
+    if (!cachePath.empty()) {
+        try {
+            cache.reset(new HashCache(cachePath, verifyCache));
+        } catch (const exception &error) {
+            cerr << "zippy: " << error.what() << endl;
+            return 1;
+        }
+    } else if (verifyCache) {
+        cout << "The cache to verify isn't set: pass --cache <file> or set ZIPPY_CACHE" << endl;
+        return 1;
+    }
+    batchOptions.cache = cache.get();
+
+    // The failure to update the cache doesn't affect the digests, so it's reported as a warning
+    auto saveCache = [&cache]() {
+        if (cache == nullptr) {
+            return;
+        }
+        try {
+            cache->save();
+        } catch (const exception &error) {
+            cerr << "zippy: warning: " << error.what() << endl;
+        }
+    };
+
+    // The counters are opened before the workers are started, so the workers are counted as well
+    unique_ptr<PerfCounters> perfCounters(printStats ? new PerfCounters() : nullptr);
+    if (printStats) {
+        // The rate of the timestamps is measured once, out of the measured time
+        ticksToSeconds(0);
+    }
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    auto reportStats = [&]() {
+        if (printStats) {
+            cout.flush();
+            printTotalStats(getProcessStats(), chrono::duration<double>(chrono::steady_clock::now() - startTime).count(), perfCounters.get());
+        }
+    };
+
+    if (!checksumFilePaths.empty()) {
+        int exitCode = runCheck(checksumFilePaths, algorithms.empty() ? nullptr : algorithms[0], batchOptions, checkOptions);
+        saveCache();
+        reportStats();
+        return exitCode;
+    }
+
+    // The hash of the single file is printed as is (unless there are several algorithms)
+    if (filePaths.size() == 1 && directories.empty()) {
+        int exitCode = 0;
+        try {
+            FileStatsScope statsScope;
+            vector<HashDigest> digests(algorithms.size());
+            FileIdentity identity;
+            bool isCacheable = cache != nullptr && getFileIdentity(filePaths[0], identity);
+            if (!isCacheable || !cache->find(identity, algorithms, digests.data())) {
+                if (algorithms.size() == 1) {
+                    // The tree-based algorithms hash the single file by all the threads
+                    InputOptions fileOptions = inputOptions;
+                    fileOptions.threadsCount = batchOptions.threadsCount;
+                    digests[0] = algorithms[0]->hashFile(filePaths[0], fileOptions);
+                } else {
+                    multiDigestOptions.inputOptions = inputOptions;
+                    digests = hashWithAlgorithms(filePaths[0], algorithms, multiDigestOptions);
+                }
+                if (isCacheable) {
+                    cache->store(filePaths[0], identity, algorithms, digests.data());
+                }
+            }
+            StatsCounters fileStats = statsScope.finish();
+
+            {
+                StageTimer timer(Stage::Format);
+                if (algorithms.size() == 1) {
+                    printDigest(digests[0], useBase64);
+                    cout << endl;
+                } else {
+                    printHashLines(algorithms, digests.data(), filePaths[0], useBase64);
+                    cout.flush();
+                }
+            }
+            if (printStats) {
+                printFileStats(filePaths[0], fileStats);
+            }
+        } catch (const exception &error) {
+            cerr << "zippy: " << filePaths[0] << ": " << error.what() << endl;
+            exitCode = 1;
+        }
+        saveCache();
+        reportStats();
+        return exitCode;
+    }
+
+    size_t errorsCount = hashFilesInParallel(algorithms, filePaths, directories, batchOptions, [&](const BatchResult &result) {
+        if (result.error.empty()) {
+            StageTimer timer(Stage::Format);
+            printHashLines(algorithms, result.digests.data(), result.filePath, useBase64);
+        } else {
+            cout.flush();
+            cerr << "zippy: " << result.filePath << ": " << result.error << endl;
+        }
+        if (printStats && result.error.empty()) {
+            printFileStats(result.filePath, result.stats);
+        }
+        return true;
+    });
+    cout.flush();
+    saveCache();
+    reportStats();
+
+    return errorsCount == 0 ? 0 : 1;
 }
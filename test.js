@@ -1,22 +1,192 @@
 const fs = require("fs");
 const path = require("path");
 const cp = require('child_process');
+const net = require("net");
+const os = require("os");
 
 const usePredefined = process.argv.some(arg => arg === "-pd" || arg === "--predefined");
+const useKnownAnswers = process.argv.some(arg => arg === "-kat" || arg === "--known-answers");
+const useServer = process.argv.some(arg => arg === "-s" || arg === "--serve");
+const useCompression = process.argv.some(arg => arg === "-z" || arg === "--compression");
+const useEncryption = process.argv.some(arg => arg === "-e" || arg === "--encryption");
+const useKdf = process.argv.some(arg => arg === "-k" || arg === "--kdf");
+const implementationFlagIndex = process.argv.findIndex(arg => arg === "-i" || arg === "--impl");
+const implementationArgs = implementationFlagIndex !== -1 ? ` --impl ${process.argv[implementationFlagIndex + 1]}` : "";
 const algorithmFlagIndex = process.argv.findIndex(arg => arg === "-a" || arg === "--algorithm");
-if (algorithmFlagIndex === -1 || !process.argv[algorithmFlagIndex + 1]) {
+if (!useCompression && !useEncryption && !useKdf && (algorithmFlagIndex === -1 || !process.argv[algorithmFlagIndex + 1])) {
     console.error("The algorithm must be provided. For example: -a sha256");
     return 1;
 }
 const algorithm = process.argv[algorithmFlagIndex + 1];
 
 const standardAlgorithmCommands = {
+    "sha224": { command: "/usr/local/bin/shasum -a 224", parser: (output) => output.split("  ")[0].trim() },
     "sha256": { command: "/usr/local/bin/shasum -a 256", parser: (output) => output.split("  ")[0].trim() },
+    "sha384": { command: "/usr/local/bin/shasum -a 384", parser: (output) => output.split("  ")[0].trim() },
     "sha512": { command: "/usr/local/bin/shasum -a 512", parser: (output) => output.split("  ")[0].trim() },
-    "md5": { command: "/sbin/md5", parser: (output) => output.split(" = ")[1].trim() }
+    "sha512-224": { command: "/usr/local/bin/shasum -a 512224", parser: (output) => output.split("  ")[0].trim() },
+    "sha512-256": { command: "/usr/local/bin/shasum -a 512256", parser: (output) => output.split("  ")[0].trim() },
+    "sha3-224": { command: "openssl dgst -sha3-224 -r", parser: (output) => output.split(" ")[0].trim() },
+    "sha3-256": { command: "openssl dgst -sha3-256 -r", parser: (output) => output.split(" ")[0].trim() },
+    "sha3-384": { command: "openssl dgst -sha3-384 -r", parser: (output) => output.split(" ")[0].trim() },
+    "sha3-512": { command: "openssl dgst -sha3-512 -r", parser: (output) => output.split(" ")[0].trim() },
+    "shake128": { command: "openssl dgst -shake128 -xoflen 32 -r", parser: (output) => output.split(" ")[0].trim() },
+    "shake256": { command: "openssl dgst -shake256 -xoflen 64 -r", parser: (output) => output.split(" ")[0].trim() },
+    "blake3": { command: "b3sum", parser: (output) => output.split("  ")[0].trim() },
+    "md5": { command: "/sbin/md5", parser: (output) => output.split(" = ")[1].trim() },
+    "crc32": {
+        command: `node -e "for (const f of process.argv.slice(1)) console.log(require('zlib').crc32(require('fs').readFileSync(f)).toString(16).padStart(8, '0') + '  ' + f)"`,
+        parser: (output) => output.split("  ")[0].trim()
+    },
+    // The bitwise CRC-32C: there is no common tool for it
+    "crc32c": {
+        command: `node -e "const t = []; for (let i = 0; i < 256; i++) { let c = i; for (let k = 0; k < 8; k++) c = (c >>> 1) ^ (0x82F63B78 & -(c & 1)); t.push(c >>> 0) }
+            for (const f of process.argv.slice(1)) { let c = ~0; for (const b of require('fs').readFileSync(f)) c = (c >>> 8) ^ t[(c ^ b) & 0xFF];
+            console.log((~c >>> 0).toString(16).padStart(8, '0') + '  ' + f) }"`,
+        parser: (output) => output.split("  ")[0].trim()
+    },
+    "xxh64": { command: "xxhsum -H1", parser: (output) => output.split("  ")[0].trim() },
+    "xxh3": { command: "xxhsum -H3", parser: (output) => output.split("  ")[0].trim().replace(/^XXH3_/, "") }
 }
 
-if (usePredefined) {
+// Known answers (FIPS 180-4, FIPS 202, RFC 1321, the BLAKE3 and xxHash reference implementations and the CRC catalogue check values) checked against each implementation of the algorithm's core
+const knownAnswers = {
+    "sha224": [
+        { message: "", hash: "d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f" },
+        { message: "abc", hash: "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "75388b16512776cc5dba5da1fd890150b0c6455cb4f58b1952522525" },
+        { message: "a".repeat(1000000), hash: "20794655980c91d8bbb4c1ea97618a4bf03f42581948b2ee4ee7ad67" },
+    ],
+    "sha256": [
+        { message: "", hash: "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+        { message: "abc", hash: "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+        { message: "a".repeat(1000000), hash: "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+    ],
+    "sha384": [
+        { message: "", hash: "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b" },
+        { message: "abc", hash: "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712fcc7c71a557e2db966c3e9fa91746039" },
+        { message: "a".repeat(1000000), hash: "9d0e1809716474cb086e834e310a4a1ced149e9c00f248527972cec5704c2a5b07b8b3dc38ecc4ebae97ddd87f3d8985" },
+    ],
+    "sha512": [
+        { message: "", hash: "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e" },
+        { message: "abc", hash: "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909" },
+        { message: "a".repeat(1000000), hash: "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973ebde0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b" },
+    ],
+    "sha512-224": [
+        { message: "", hash: "6ed0dd02806fa89e25de060c19d3ac86cabb87d6a0ddd05c333b84f4" },
+        { message: "abc", hash: "4634270f707b6a54daae7530460842e20e37ed265ceee9a43e8924aa" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "23fec5bb94d60b23308192640b0c453335d664734fe40e7268674af9" },
+        { message: "a".repeat(1000000), hash: "37ab331d76f0d36de422bd0edeb22a28accd487b7a8453ae965dd287" },
+    ],
+    "sha512-256": [
+        { message: "", hash: "c672b8d1ef56ed28ab87c3622c5114069bdd3ad7b8f9737498d0c01ecef0967a" },
+        { message: "abc", hash: "53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "3928e184fb8690f840da3988121d31be65cb9d3ef83ee6146feac861e19b563a" },
+        { message: "a".repeat(1000000), hash: "9a59a052930187a97038cae692f30708aa6491923ef5194394dc68d56c74fb21" },
+    ],
+    "sha3-224": [
+        { message: "", hash: "6b4e03423667dbb73b6e15454f0eb1abd4597f9a1b078e3f5b5a6bc7" },
+        { message: "abc", hash: "e642824c3f8cf24ad09234ee7d3c766fc9a3a5168d0c94ad73b46fdf" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "8a24108b154ada21c9fd5574494479ba5c7e7ab76ef264ead0fcce33" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "543e6868e1666c1a643630df77367ae5a62a85070a51c14cbf665cbc" },
+        { message: "a".repeat(1000000), hash: "d69335b93325192e516a912e6d19a15cb51c6ed5c15243e7a7fd653c" },
+    ],
+    "sha3-256": [
+        { message: "", hash: "a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a" },
+        { message: "abc", hash: "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "41c0dba2a9d6240849100376a8235e2c82e1b9998a999e21db32dd97496d3376" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "916f6061fe879741ca6469b43971dfdb28b1a32dc36cb3254e812be27aad1d18" },
+        { message: "a".repeat(1000000), hash: "5c8875ae474a3634ba4fd55ec85bffd661f32aca75c6d699d0cdcb6c115891c1" },
+    ],
+    "sha3-384": [
+        { message: "", hash: "0c63a75b845e4f7d01107d852e4c2485c51a50aaaa94fc61995e71bbee983a2ac3713831264adb47fb6bd1e058d5f004" },
+        { message: "abc", hash: "ec01498288516fc926459f58e2c6ad8df9b473cb0fc08c2596da7cf0e49be4b298d88cea927ac7f539f1edf228376d25" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "991c665755eb3a4b6bbdfb75c78a492e8c56a22c5c4d7e429bfdbc32b9d4ad5aa04a1f076e62fea19eef51acd0657c22" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "79407d3b5916b59c3e30b09822974791c313fb9ecc849e406f23592d04f625dc8c709b98b43b3852b337216179aa7fc7" },
+        { message: "a".repeat(1000000), hash: "eee9e24d78c1855337983451df97c8ad9eedf256c6334f8e948d252d5e0e76847aa0774ddb90a842190d2c558b4b8340" },
+    ],
+    "sha3-512": [
+        { message: "", hash: "a69f73cca23a9ac5c8b567dc185a756e97c982164fe25859e0d1dcc1475c80a615b2123af1f5f94c11e3e9402c3ac558f500199d95b6d3e301758586281dcd26" },
+        { message: "abc", hash: "b751850b1a57168a5693cd924b6b096e08f621827444f70d884f5d0240d2712e10e116e9192af3c91a7ec57647e3934057340b4cf408d5a56592f8274eec53f0" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "04a371e84ecfb5b8b77cb48610fca8182dd457ce6f326a0fd3d7ec2f1e91636dee691fbe0c985302ba1b0d8dc78c086346b533b49c030d99a27daf1139d6e75e" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "afebb2ef542e6579c50cad06d2e578f9f8dd6881d7dc824d26360feebf18a4fa73e3261122948efcfd492e74e82e2189ed0fb440d187f382270cb455f21dd185" },
+        { message: "a".repeat(1000000), hash: "3c3a876da14034ab60627c077bb98f7e120a2a5370212dffb3385a18d4f38859ed311d0a9d5141ce9cc5c66ee689b266a8aa18ace8282a0e0db596c90b0a7b87" },
+    ],
+    "shake128": [
+        { message: "", hash: "7f9c2ba4e88f827d616045507605853ed73b8093f6efbc88eb1a6eacfa66ef26" },
+        { message: "abc", hash: "5881092dd818bf5cf8a3ddb793fbcba74097d5c526a6d35f97b83351940f2cc8" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "1a96182b50fb8c7e74e0a707788f55e98209b8d91fade8f32f8dd5cff7bf21f5" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "7b6df6ff181173b6d7898d7ff63fb07b7c237daf471a5ae5602adbccef9ccf4b" },
+        { message: "a".repeat(1000000), hash: "9d222c79c4ff9d092cf6ca86143aa411e369973808ef97093255826c5572ef58" },
+    ],
+    "shake256": [
+        { message: "", hash: "46b9dd2b0ba88d13233b3feb743eeb243fcd52ea62b81b82b50c27646ed5762fd75dc4ddd8c0f200cb05019d67b592f6fc821c49479ab48640292eacb3b7c4be" },
+        { message: "abc", hash: "483366601360a8771c6863080cc4114d8db44530f8f1e1ee4f94ea37e78b5739d5a15bef186a5386c75744c0527e1faa9f8726e462a12a4feb06bd8801e751e4" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "4d8c2dd2435a0128eefbb8c36f6f87133a7911e18d979ee1ae6be5d4fd2e332940d8688a4e6a59aa8060f1f9bc996c05aca3c696a8b66279dc672c740bb224ec" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "98be04516c04cc73593fef3ed0352ea9f6443942d6950e29a372a681c3deaf4535423709b02843948684e029010badcc0acd8303fc85fdad3eabf4f78cae1656" },
+        { message: "a".repeat(1000000), hash: "3578a7a4ca9137569cdf76ed617d31bb994fca9c1bbf8b184013de8234dfd13a3fd124d4df76c0a539ee7dd2f6e1ec346124c815d9410e145eb561bcd97b18ab" },
+    ],
+    "blake3": [
+        { message: "", hash: "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262" },
+        { message: "abc", hash: "6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "c19012cc2aaf0dc3d8e5c45a1b79114d2df42abb2a410bf54be09e891af06ff8" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "553e1aa2a477cb3166e6ab38c12d59f6c5017f0885aaf079f217da00cfca363f" },
+        { message: "a".repeat(1000000), hash: "616f575a1b58d4c9797d4217b9730ae5e6eb319d76edef6549b46f4efe31ff8b" },
+    ],
+    "md5": [
+        { message: "", hash: "d41d8cd98f00b204e9800998ecf8427e" },
+        { message: "abc", hash: "900150983cd24fb0d6963f7d28e17f72" },
+        { message: "12345678901234567890123456789012345678901234567890123456789012345678901234567890", hash: "57edf4a22be3c955ac49da2e2107b67a" },
+    ],
+    "crc32": [
+        { message: "", hash: "00000000" },
+        { message: "123456789", hash: "cbf43926" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "171a3f5f" },
+        { message: "a".repeat(1000000), hash: "dc25bfbc" },
+    ],
+    "crc32c": [
+        { message: "", hash: "00000000" },
+        { message: "123456789", hash: "e3069283" },
+        { message: "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", hash: "071325f5" },
+        { message: "a".repeat(1000000), hash: "436fe240" },
+    ],
+    "xxh64": [
+        { message: "", hash: "ef46db3751d8e999" },
+        { message: "abc", hash: "44bc2cf5ad770999" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "bafc02122ded1d21" },
+        { message: "a".repeat(1000000), hash: "dc483aaa9b4fdc40" },
+    ],
+    "xxh3": [
+        { message: "", hash: "2d06800538d394c2" },
+        { message: "abc", hash: "78af5f94892f3950" },
+        { message: "123456789", hash: "72dcb18b67a17dff" },
+        { message: "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", hash: "458619cd5260aa9a" },
+        { message: "a".repeat(200), hash: "ac2bd404bce6c995" },
+        { message: "a".repeat(1000000), hash: "b1fd6fae5285c4eb" },
+    ]
+};
+const implementations = ["scalar", "ssse3", "avx2", "avx512", "shani", "sse42", "pclmul"];
+
+if (useCompression) {
+    console.log("Running compression tests");
+    runCompressionTests()
+        .then(process.exit);
+} else if (useEncryption) {
+    console.log("Running encryption tests");
+    runEncryptionTests()
+        .then(process.exit);
+} else if (useKdf) {
+    console.log("Running key derivation tests");
+    runKdfTests()
+        .then(process.exit);
+} else if (useKnownAnswers) {
+    console.log(`Running known answer tests. Algorithm: ${algorithm}`);
+    runKnownAnswerTests()
+        .then(process.exit);
+} else if (usePredefined) {
     console.log(`Running predefined tests. Algorithm: ${algorithm}`);
     runPredefinedTests()
         .then(process.exit);
@@ -40,7 +210,7 @@ async function runPredefinedTests() {
         );
 
         // Execute zippy
-        const zippyOutput = cp.execSync(`out/zippy ${algorithm} ${filePath}`).toString("utf-8").trim();
+        const zippyOutput = cp.execSync(`out/zippy ${algorithm} ${filePath}${implementationArgs}`).toString("utf-8").trim();
 
         // Comparing the results
         if (standardOutput !== zippyOutput) {
@@ -66,6 +236,81 @@ async function runPredefinedTests() {
     return 0;
 }
 
+async function runKnownAnswerTests() {
+    const testSuitsDirectory = "knownAnswerTestFiles";
+    if (!fs.existsSync(testSuitsDirectory)) {
+        fs.mkdirSync(testSuitsDirectory);
+    }
+
+    const assertions = [];
+    try {
+        const filePaths = [];
+        for (const [index, knownAnswer] of knownAnswers[algorithm].entries()) {
+            const filePath = path.join(testSuitsDirectory, `message-${index}`);
+            fs.writeFileSync(filePath, knownAnswer.message);
+            filePaths.push(filePath);
+
+            for (const implementation of implementations) {
+                let zippyOutput;
+                try {
+                    zippyOutput = cp.execSync(`out/zippy ${algorithm} ${filePath} --impl ${implementation}`, { stdio: "pipe" })
+                        .toString("utf-8").trim();
+                } catch (error) {
+                    // The implementation isn't supported by this CPU
+                    continue;
+                }
+
+                if (knownAnswer.hash !== zippyOutput) {
+                    assertions.push({
+                        message: `${knownAnswer.message.slice(0, 16)}... (${knownAnswer.message.length} bytes)`,
+                        implementation,
+                        expectedHash: knownAnswer.hash,
+                        actualHash: zippyOutput
+                    });
+                }
+            }
+        }
+
+        // All the messages at once go through the multi-buffer cores: each message takes its own lane
+        for (const implementation of implementations) {
+            let zippyOutput;
+            try {
+                zippyOutput = cp.execSync(`out/zippy ${algorithm} ${filePaths.join(" ")} -j 1 --keep-order --impl ${implementation}`, { stdio: "pipe" })
+                    .toString("utf-8").trim().split("\n");
+            } catch (error) {
+                continue;
+            }
+
+            for (const [index, knownAnswer] of knownAnswers[algorithm].entries()) {
+                const zippyHash = zippyOutput[index].split("  ")[0];
+                if (knownAnswer.hash !== zippyHash) {
+                    assertions.push({
+                        message: `${knownAnswer.message.slice(0, 16)}... (${knownAnswer.message.length} bytes, batch)`,
+                        implementation,
+                        expectedHash: knownAnswer.hash,
+                        actualHash: zippyHash
+                    });
+                }
+            }
+        }
+    } finally {
+        fs.rmdirSync(testSuitsDirectory, {recursive: true});
+    }
+
+    if (assertions.length) {
+        console.error("Some tests has been failed:");
+        assertions.forEach(assertion => {
+            console.error(
+                `\n\tMessage: ${assertion.message}\n\tImplementation: ${assertion.implementation}\n\tExpected hash: ${assertion.expectedHash}\n\tActual hash:   ${assertion.actualHash}\n`
+            );
+        });
+        return 1;
+    }
+
+    console.log("All tests has been passed!");
+    return 0;
+}
+
 async function runRandomGeneratedTests() {
     const testSuitsDirectory = "randomTestFiles";
     if (!fs.existsSync(testSuitsDirectory)) {
@@ -91,33 +336,43 @@ async function runRandomGeneratedTests() {
         // {fileSize: 1024 * 1024 * 1024, repetitions: 1},
     ];
 
+    // The files are hashed by the single `zippy serve` daemon instead of a process per size
+    const server = useServer ? await startServer() : null;
+
     const assertions = [];
     try {
         for (const config of fileConfigs) {
             console.log(`Testing of ${config.fileSize} bytes files`);
 
+            const filePaths = [];
             for (let i = 0; i < config.repetitions; i++) {
-                const filePath = await generateTestFile(testSuitsDirectory, config.fileSize, i);
+                filePaths.push(await generateTestFile(testSuitsDirectory, config.fileSize, i));
+            }
 
-                // Execute standard utility
-                const standardOutput = standardAlgorithmCommands[algorithm].parser(
-                    cp.execSync(`${standardAlgorithmCommands[algorithm].command} ${filePath}`).toString("utf-8").split("  ")[0]
-                );
+            // Execute standard utility
+            const standardOutputs = cp.execSync(`${standardAlgorithmCommands[algorithm].command} ${filePaths.join(" ")}`)
+                .toString("utf-8").trim().split("\n")
+                .map(line => standardAlgorithmCommands[algorithm].parser(line.split("  ")[0]));
 
-                // Execute zippy
-                const zippyOutput = cp.execSync(`out/zippy ${algorithm} ${filePath}`).toString("utf-8").trim();
+            // Execute zippy once for all the files of this size: they are hashed in parallel
+            const zippyOutputs = server
+                ? await server.hashFiles(filePaths)
+                : cp.execSync(`out/zippy ${algorithm} ${filePaths.join(" ")} --keep-order${implementationArgs}`)
+                    .toString("utf-8").trim().split("\n")
+                    .map(line => filePaths.length > 1 ? line.split("  ")[0] : line);
 
-                // Comparing the results
-                if (standardOutput !== zippyOutput) {
+            // Comparing the results
+            filePaths.forEach((filePath, i) => {
+                if (standardOutputs[i] !== zippyOutputs[i]) {
                     assertions.push({
                         fileSize: config.fileSize,
-                        expectedHash: standardOutput,
-                        actualHash: zippyOutput
+                        expectedHash: standardOutputs[i],
+                        actualHash: zippyOutputs[i]
                     });
                 }
 
                 fs.rmSync(filePath);
-            }
+            });
         }
     } catch (error) {
         console.error("Some error has been occurred. Details:");
@@ -125,6 +380,9 @@ async function runRandomGeneratedTests() {
         return 1;
     } finally {
         fs.rmdirSync(testSuitsDirectory, {recursive: true});
+        if (server) {
+            server.stop();
+        }
     }
 
     if (assertions.length) {
@@ -142,6 +400,289 @@ async function runRandomGeneratedTests() {
     return 0;
 }
 
+// The files compressed by zippy are decompressed by zlib and the ones compressed by zlib are decompressed by zippy.
+// The blocks are smaller than the larger files, so they are compressed in parallel and refer to the previous blocks
+async function runCompressionTests() {
+    const zlib = require("zlib");
+    const testSuitsDirectory = "compressionTestFiles";
+    if (!fs.existsSync(testSuitsDirectory)) {
+        fs.mkdirSync(testSuitsDirectory);
+    }
+
+    const fileSizes = [0, 1, 1000, 100 * 1024, 1024 * 1024, 10 * 1024 * 1024];
+    const levels = [0, 1, 6, 9];
+    const execOptions = { maxBuffer: 64 * 1024 * 1024 };
+
+    const assertions = [];
+    try {
+        for (const fileSize of fileSizes) {
+            console.log(`Testing of ${fileSize} bytes files`);
+            const filePaths = [
+                await generateTestFile(testSuitsDirectory, fileSize, 0),
+                await generateCompressibleTestFile(testSuitsDirectory, fileSize, 1)
+            ];
+
+            for (const filePath of filePaths) {
+                const original = fs.readFileSync(filePath);
+                for (const level of levels) {
+                    const compressed = cp.execSync(`out/zippy compress -${level} --block-size 65536 ${filePath}${implementationArgs}`, execOptions);
+                    if (!zlib.gunzipSync(compressed).equals(original)) {
+                        assertions.push({ file: filePath, direction: "zippy compress, zlib decompress", level });
+                    }
+
+                    const decompressed = cp.execSync(`out/zippy decompress${implementationArgs}`, { ...execOptions, input: zlib.gzipSync(original, { level }) });
+                    if (!decompressed.equals(original)) {
+                        assertions.push({ file: filePath, direction: "zlib compress, zippy decompress", level });
+                    }
+                }
+                fs.rmSync(filePath);
+            }
+        }
+    } catch (error) {
+        console.error("Some error has been occurred. Details:");
+        console.log(error);
+        return 1;
+    } finally {
+        fs.rmdirSync(testSuitsDirectory, {recursive: true});
+    }
+
+    if (assertions.length) {
+        console.error("Some tests has been failed:");
+        assertions.forEach(assertion => {
+            console.error(`\n\tFile: ${assertion.file}\n\tDirection: ${assertion.direction}\n\tLevel: ${assertion.level}\n`);
+        });
+        return 1;
+    }
+
+    console.log("All tests has been passed!");
+    return 0;
+}
+
+// Each file is encrypted by every core supported by this CPU and decrypted by every other one, then the modified copies
+// of the encrypted file (a flipped bit, the segments truncated, appended or swapped) and the wrong key must be rejected
+async function runEncryptionTests() {
+    const testSuitsDirectory = "encryptionTestFiles";
+    if (!fs.existsSync(testSuitsDirectory)) {
+        fs.mkdirSync(testSuitsDirectory);
+    }
+
+    const fileSizes = [0, 1, 4095, 4096, 4097, 64 * 1024, 1024 * 1024 + 3, 3 * 1024 * 1024];
+    const encryptionAlgorithms = ["chacha20-poly1305", "aes-256-gcm"];
+    const encryptionImplementations = ["scalar", "ssse3", "avx2", "aesni"];
+    const segmentSize = 4096;
+    const tagSize = 16;
+    const execOptions = { maxBuffer: 64 * 1024 * 1024, stdio: "pipe" };
+
+    const keyPath = path.join(testSuitsDirectory, "key");
+    const wrongKeyPath = path.join(testSuitsDirectory, "wrong-key");
+    fs.writeFileSync(keyPath, require("crypto").randomBytes(32));
+    // The key may also be given by its hexadecimal digits
+    fs.writeFileSync(wrongKeyPath, require("crypto").randomBytes(32).toString("hex") + "\n");
+
+    const isRejected = (filePath, keyFilePath) => {
+        try {
+            cp.execSync(`out/zippy decrypt --key-file ${keyFilePath} ${filePath}`, execOptions);
+            return false;
+        } catch (error) {
+            return true;
+        }
+    };
+
+    const assertions = [];
+    try {
+        for (const fileSize of fileSizes) {
+            console.log(`Testing of ${fileSize} bytes files`);
+            const filePath = await generateTestFile(testSuitsDirectory, fileSize, 0);
+            const encryptedPath = `${filePath}.zpe`;
+            const original = fs.readFileSync(filePath);
+            const expectedSize = 32 + fileSize + tagSize * Math.max(1, Math.ceil(fileSize / segmentSize));
+
+            for (const encryptionAlgorithm of encryptionAlgorithms) {
+                for (const implementation of encryptionImplementations) {
+                    try {
+                        cp.execSync(`out/zippy encrypt --key-file ${keyPath} --algorithm ${encryptionAlgorithm} --segment-size ${segmentSize}`
+                            + ` --impl ${implementation} -o ${encryptedPath} ${filePath}`, execOptions);
+                    } catch (error) {
+                        // The implementation isn't supported by this CPU
+                        continue;
+                    }
+                    const encrypted = fs.readFileSync(encryptedPath);
+                    if (encrypted.length !== expectedSize) {
+                        assertions.push({ file: filePath, algorithm: encryptionAlgorithm, implementation, check: `size ${encrypted.length} instead of ${expectedSize}` });
+                    }
+
+                    for (const decryptingImplementation of encryptionImplementations) {
+                        let decrypted;
+                        try {
+                            decrypted = cp.execSync(`out/zippy decrypt --key-file ${keyPath} --impl ${decryptingImplementation} ${encryptedPath}`, execOptions);
+                        } catch (error) {
+                            if (error.stderr.toString().includes("isn't supported")) {
+                                continue;
+                            }
+                            decrypted = null;
+                        }
+                        if (!decrypted || !decrypted.equals(original)) {
+                            assertions.push({ file: filePath, algorithm: encryptionAlgorithm, implementation, check: `decrypted by ${decryptingImplementation}` });
+                        }
+                    }
+
+                    const segmentsStart = 32;
+                    const stride = segmentSize + tagSize;
+                    const modifications = {
+                        "flipped bit": () => {
+                            const modified = Buffer.from(encrypted);
+                            modified[Math.floor(Math.random() * modified.length)] ^= 1 << Math.floor(Math.random() * 8);
+                            return modified;
+                        },
+                        "truncated segment": () => encrypted.subarray(0, encrypted.length - 1),
+                        "removed last segment": () => encrypted.length > segmentsStart + stride ? encrypted.subarray(0, segmentsStart + stride) : null,
+                        "appended segment": () => Buffer.concat([encrypted, encrypted.subarray(segmentsStart, Math.min(encrypted.length, segmentsStart + stride))]),
+                        "swapped segments": () => encrypted.length >= segmentsStart + 2 * stride ? Buffer.concat([
+                            encrypted.subarray(0, segmentsStart),
+                            encrypted.subarray(segmentsStart + stride, segmentsStart + 2 * stride),
+                            encrypted.subarray(segmentsStart, segmentsStart + stride),
+                            encrypted.subarray(segmentsStart + 2 * stride)
+                        ]) : null
+                    };
+                    const modifiedPath = `${encryptedPath}.modified`;
+                    for (const [modification, modify] of Object.entries(modifications)) {
+                        const modified = modify();
+                        if (!modified) {
+                            continue;
+                        }
+                        fs.writeFileSync(modifiedPath, modified);
+                        if (!isRejected(modifiedPath, keyPath)) {
+                            assertions.push({ file: filePath, algorithm: encryptionAlgorithm, implementation, check: `${modification} accepted` });
+                        }
+                    }
+                    if (!isRejected(encryptedPath, wrongKeyPath)) {
+                        assertions.push({ file: filePath, algorithm: encryptionAlgorithm, implementation, check: "wrong key accepted" });
+                    }
+                    fs.rmSync(modifiedPath, { force: true });
+                    fs.rmSync(encryptedPath);
+                }
+            }
+            fs.rmSync(filePath);
+        }
+    } catch (error) {
+        console.error("Some error has been occurred. Details:");
+        console.log(error);
+        return 1;
+    } finally {
+        fs.rmdirSync(testSuitsDirectory, {recursive: true});
+    }
+
+    if (assertions.length) {
+        console.error("Some tests has been failed:");
+        assertions.forEach(assertion => {
+            console.error(`\n\tFile: ${assertion.file}\n\tAlgorithm: ${assertion.algorithm}\n\tImplementation: ${assertion.implementation}\n\tCheck: ${assertion.check}\n`);
+        });
+        return 1;
+    }
+
+    console.log("All tests has been passed!");
+    return 0;
+}
+
+async function runKdfTests() {
+    const crypto = require("crypto");
+    const testSuitsDirectory = "kdfTestFiles";
+    if (!fs.existsSync(testSuitsDirectory)) {
+        fs.mkdirSync(testSuitsDirectory);
+    }
+
+    const kdfAlgorithms = ["sha224", "sha256", "sha384", "sha512", "sha512-224", "sha512-256"];
+    const kdfImplementations = ["scalar", "ssse3", "avx2", "avx512", "shani", "auto"];
+    // The keys shorter than the block, of the block size and longer than the block of both SHA-2 families
+    const keySizes = [0, 20, 64, 128, 200];
+    const fileSizes = [0, 1, 55, 64, 1000, 1024 * 1024 + 3];
+    const execOptions = { maxBuffer: 64 * 1024 * 1024, stdio: "pipe" };
+
+    const run = (command, implementation) => {
+        try {
+            return cp.execSync(`out/zippy ${command} --impl ${implementation}`, execOptions).toString().trim().split("\n");
+        } catch (error) {
+            if (error.stderr.toString().includes("isn't supported")) {
+                return null;
+            }
+            return [error.stderr.toString().trim()];
+        }
+    };
+
+    const assertions = [];
+    try {
+        const filePaths = [];
+        for (const fileSize of fileSizes) {
+            filePaths.push(await generateTestFile(testSuitsDirectory, fileSize, 0));
+        }
+        // The passwords of many lengths for the batches: some of them share the lanes, the rest are the single streams
+        const passwords = Array.from({ length: 37 }, (_, i) => crypto.randomBytes(i * 7 % 150).toString("hex"));
+        const passwordsPath = path.join(testSuitsDirectory, "passwords");
+        fs.writeFileSync(passwordsPath, passwords.join("\n"));
+        const secretPath = path.join(testSuitsDirectory, "secret");
+        const secret = crypto.randomBytes(77);
+        fs.writeFileSync(secretPath, secret);
+
+        for (const kdfAlgorithm of kdfAlgorithms) {
+            console.log(`Testing of ${kdfAlgorithm}`);
+            const digestSize = crypto.createHash(kdfAlgorithm).digest().length;
+            for (const implementation of kdfImplementations) {
+                const check = (actual, expected, description) => {
+                    if (actual && (actual.length !== expected.length || actual.some((line, i) => line !== expected[i]))) {
+                        assertions.push({ algorithm: kdfAlgorithm, implementation, check: description });
+                    }
+                };
+
+                for (const keySize of keySizes) {
+                    const key = crypto.randomBytes(keySize);
+                    const actual = run(`${kdfAlgorithm} --hmac ${key.toString("hex") || "''"} ${filePaths.join(" ")}`, implementation);
+                    const expected = filePaths.map(filePath =>
+                        `${crypto.createHmac(kdfAlgorithm, key).update(fs.readFileSync(filePath)).digest("hex")}  ${filePath}`);
+                    check(actual, expected, `HMAC with the key of ${keySize} bytes`);
+                }
+
+                const salt = crypto.randomBytes(16);
+                for (const [iterations, length] of [[1, digestSize], [1000, 1], [37, 5 * digestSize + 3]]) {
+                    const actual = run(`kdf pbkdf2 ${kdfAlgorithm} --salt ${salt.toString("hex")} --iterations ${iterations} --length ${length} ${secretPath}`, implementation);
+                    check(actual, [crypto.pbkdf2Sync(secret, salt, iterations, length, kdfAlgorithm).toString("hex")],
+                        `PBKDF2 of ${iterations} iterations, ${length} bytes`);
+                }
+                for (const length of [digestSize, 2 * digestSize + 1]) {
+                    const actual = run(`kdf pbkdf2 ${kdfAlgorithm} --salt ${salt.toString("hex")} --iterations 50 --length ${length} --lines ${passwordsPath}`, implementation);
+                    const expected = passwords.map(password => crypto.pbkdf2Sync(password, salt, 50, length, kdfAlgorithm).toString("hex"));
+                    check(actual, expected, `PBKDF2 of the passwords batch, ${length} bytes`);
+                }
+
+                for (const [saltSize, infoSize, length] of [[0, 0, digestSize], [13, 7, 1], [32, 100, 255 * digestSize]]) {
+                    const hkdfSalt = crypto.randomBytes(saltSize);
+                    const info = crypto.randomBytes(infoSize);
+                    const options = (saltSize ? ` --salt ${hkdfSalt.toString("hex")}` : "") + (infoSize ? ` --info ${info.toString("hex")}` : "");
+                    const actual = run(`kdf hkdf ${kdfAlgorithm}${options} --length ${length} ${secretPath}`, implementation);
+                    check(actual, [Buffer.from(crypto.hkdfSync(kdfAlgorithm, secret, hkdfSalt, info, length)).toString("hex")],
+                        `HKDF of ${length} bytes`);
+                }
+            }
+        }
+    } catch (error) {
+        console.error("Some error has been occurred. Details:");
+        console.log(error);
+        return 1;
+    } finally {
+        fs.rmdirSync(testSuitsDirectory, {recursive: true});
+    }
+
+    if (assertions.length) {
+        console.error("Some tests has been failed:");
+        assertions.forEach(assertion => {
+            console.error(`\n\tAlgorithm: ${assertion.algorithm}\n\tImplementation: ${assertion.implementation}\n\tCheck: ${assertion.check}\n`);
+        });
+        return 1;
+    }
+
+    console.log("All tests has been passed!");
+    return 0;
+}
+
 async function generateTestFile(fileDirectory, fileSize, repetition) {
     const filePath = path.join(fileDirectory, `file-${fileSize}-${repetition}`);
 
@@ -156,3 +697,87 @@ async function generateTestFile(fileDirectory, fileSize, repetition) {
 
     return filePath;
 }
+
+// The words of a small vocabulary in random order: the content has many matches, near and far
+async function generateCompressibleTestFile(fileDirectory, fileSize, repetition) {
+    const filePath = path.join(fileDirectory, `text-${fileSize}-${repetition}`);
+    const words = ["zippy", "hash", "compress", "block", "window", "match", "literal", "huffman", "the", "of", "\n", " "];
+
+    let text = "";
+    while (text.length < fileSize) {
+        text += words[Math.floor(Math.random() * words.length)] + " ";
+    }
+    fs.writeFileSync(filePath, text.slice(0, fileSize));
+
+    return filePath;
+}
+
+// Starts `zippy serve` and connects to it. The files are requested by their paths in a single frame,
+// the responses come out of order and are matched by the ids (see src/include/lib/hashServer.hpp for the protocol)
+async function startServer() {
+    const socketPath = path.join(os.tmpdir(), `zippy-test-${process.pid}.sock`);
+    const serverProcess = cp.spawn("out/zippy", ["serve", "--socket", socketPath, ...implementationArgs.trim().split(" ").filter(Boolean)], { stdio: "inherit" });
+    let socket;
+    for (let attempt = 0; !socket; attempt++) {
+        try {
+            socket = await new Promise((resolve, reject) => {
+                const connection = net.createConnection(socketPath, () => resolve(connection));
+                connection.once("error", reject);
+            });
+        } catch (error) {
+            if (attempt === 50) {
+                throw error;
+            }
+            await new Promise(resolve => setTimeout(resolve, 100));
+        }
+    }
+
+    const pending = new Map();
+    let nextId = 0;
+    let received = Buffer.alloc(0);
+    socket.on("data", data => {
+        received = Buffer.concat([received, data]);
+        while (received.length >= 4 && received.length >= 4 + received.readUInt32LE(0)) {
+            const size = received.readUInt32LE(0);
+            const response = received.subarray(4, 4 + size);
+            received = received.subarray(4 + size);
+
+            const id = Number(response.readBigUInt64LE(0));
+            const status = response.readUInt8(8);
+            const digest = status === 0
+                ? response.subarray(11, 11 + response.readUInt8(10)).toString("hex")
+                : `error ${status}: ${response.subarray(11, 11 + response.readUInt16LE(9)).toString("utf-8")}`;
+            pending.get(id)(digest);
+            pending.delete(id);
+        }
+    });
+
+    return {
+        hashFiles(filePaths) {
+            const requests = filePaths.map(filePath => {
+                const id = nextId++;
+                const filePathBytes = Buffer.from(filePath, "utf-8");
+                const request = Buffer.alloc(8 + 2 + 1 + algorithm.length + 4);
+                request.writeBigUInt64LE(BigInt(id), 0);
+                request.writeUInt8(0, 8);
+                request.writeUInt8(1, 9);
+                request.writeUInt8(algorithm.length, 10);
+                request.write(algorithm, 11, "utf-8");
+                request.writeUInt32LE(filePathBytes.length, 11 + algorithm.length);
+                return { id, bytes: Buffer.concat([request, filePathBytes]) };
+            });
+
+            const body = Buffer.concat([Buffer.alloc(4), ...requests.map(request => request.bytes)]);
+            body.writeUInt32LE(requests.length, 0);
+            const header = Buffer.alloc(4);
+            header.writeUInt32LE(body.length, 0);
+            const digests = requests.map(request => new Promise(resolve => pending.set(request.id, resolve)));
+            socket.write(Buffer.concat([header, body]));
+            return Promise.all(digests);
+        },
+        stop() {
+            socket.destroy();
+            serverProcess.kill("SIGTERM");
+        }
+    };
+}